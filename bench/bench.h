@@ -0,0 +1,69 @@
+// bench.h
+#pragma once
+#include "sigtest.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/resource.h>
+#include <time.h>
+
+/*
+ * Scaffolding shared by the framework self-benchmarks (`make bench`).
+ * Scenarios run as ordinary test cases and time themselves with bench_now_ns; the recorded
+ * results are printed with the peak RSS of the process once the run has finished. Case
+ * scenarios time the cases between a `start` and a `stop` case, so the numbers cover the
+ * whole per-case path of the runner: hooks, log output, timing and allocation accounting.
+ */
+#define BENCH_MAX_RESULTS 16
+#define BENCH_CASE_COUNT 100000
+
+typedef struct {
+   const char *name;
+   size_t ops;
+   uint64_t ns;
+} bench_result;
+static bench_result bench_results[BENCH_MAX_RESULTS];
+static size_t bench_result_count = 0;
+static const char *bench_cases_name = NULL;
+static uint64_t bench_cases_start = 0;
+
+static inline uint64_t bench_now_ns(void) {
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+static inline void bench_record(const char *name, size_t ops, uint64_t ns) {
+   if (bench_result_count < BENCH_MAX_RESULTS)
+      bench_results[bench_result_count++] = (bench_result){name, ops, ns};
+}
+// test cases - case scenarios
+static inline void bench_start_cases(void) {
+   bench_cases_start = bench_now_ns();
+}
+static inline void bench_empty_case(void) {
+}
+static inline void bench_stop_cases(void) {
+   bench_record(bench_cases_name, BENCH_CASE_COUNT, bench_now_ns() - bench_cases_start);
+}
+// register BENCH_CASE_COUNT empty cases between the start and stop cases in the current set
+static inline void bench_register_cases(const char *name) {
+   bench_cases_name = name;
+   testcase("start", bench_start_cases);
+   for (size_t i = 0; i < BENCH_CASE_COUNT; i++)
+      testcase("empty", bench_empty_case);
+   testcase("stop", bench_stop_cases);
+}
+
+__attribute__((destructor)) static void bench_report(void) {
+   if (bench_result_count == 0)
+      return;
+   struct rusage usage;
+   getrusage(RUSAGE_SELF, &usage);
+   printf("\n%-36s %12s %12s %12s\n", "Scenario", "Operations", "Total ms", "ns/op");
+   for (size_t i = 0; i < bench_result_count; i++) {
+      const bench_result *result = &bench_results[i];
+      printf("%-36s %12zu %12.2f %12.2f\n", result->name, result->ops, result->ns / 1e6,
+             result->ops ? (double)result->ns / (double)result->ops : 0.0);
+   }
+   printf("Peak RSS: %ld KiB\n", usage.ru_maxrss);
+   fflush(stdout);
+}
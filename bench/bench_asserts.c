@@ -0,0 +1,53 @@
+// bench_asserts.c
+#include "bench.h"
+
+/*
+ * Cost of a passing assertion, for each assertion style. Operands come from a table the
+ * compiler cannot see through, so every check really compares.
+ */
+#define ASSERT_COUNT 10000000
+#define TABLE_SIZE 1024
+
+static int table[TABLE_SIZE];
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("/dev/null", "w");
+   for (int i = 0; i < TABLE_SIZE; i++)
+      table[i] = i;
+}
+// test cases
+static void bench_is_true(void) {
+   uint64_t start = bench_now_ns();
+   for (int i = 0; i < ASSERT_COUNT; i++)
+      Assert.isTrue(table[i & (TABLE_SIZE - 1)] == (i & (TABLE_SIZE - 1)), "index %d", i);
+   bench_record("Assert.isTrue", ASSERT_COUNT, bench_now_ns() - start);
+}
+static void bench_are_equal(void) {
+   uint64_t start = bench_now_ns();
+   for (int i = 0; i < ASSERT_COUNT; i++) {
+      int expected = i & (TABLE_SIZE - 1);
+      Assert.areEqual(&expected, &table[expected], INT, "index %d", i);
+   }
+   bench_record("Assert.areEqual (INT)", ASSERT_COUNT, bench_now_ns() - start);
+}
+static void bench_inline_true(void) {
+   uint64_t start = bench_now_ns();
+   for (int i = 0; i < ASSERT_COUNT; i++)
+      ST_ASSERT_TRUE(table[i & (TABLE_SIZE - 1)] == (i & (TABLE_SIZE - 1)), "index %d", i);
+   bench_record("ST_ASSERT_TRUE", ASSERT_COUNT, bench_now_ns() - start);
+}
+static void bench_typed_eq(void) {
+   uint64_t start = bench_now_ns();
+   for (int i = 0; i < ASSERT_COUNT; i++)
+      ST_ASSERT_EQ(i & (TABLE_SIZE - 1), table[i & (TABLE_SIZE - 1)], "index %d", i);
+   bench_record("ST_ASSERT_EQ", ASSERT_COUNT, bench_now_ns() - start);
+}
+
+// Register test cases
+__attribute__((constructor)) void init_assert_bench(void) {
+   testset("bench_asserts", set_config, NULL);
+   testcase("is_true", bench_is_true);
+   testcase("are_equal", bench_are_equal);
+   testcase("inline_true", bench_inline_true);
+   testcase("typed_eq", bench_typed_eq);
+}
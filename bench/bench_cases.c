@@ -0,0 +1,19 @@
+// bench_cases.c
+#include "bench.h"
+
+/*
+ * Framework cost of a test case: registering and running BENCH_CASE_COUNT empty cases with
+ * the default hooks. The set log goes to /dev/null, so formatting and the per-case flush are
+ * counted but no disk is involved.
+ */
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("/dev/null", "w");
+}
+
+// Register test cases
+__attribute__((constructor)) void init_case_bench(void) {
+   uint64_t start = bench_now_ns();
+   testset("bench_cases", set_config, NULL);
+   bench_register_cases("run empty test case");
+   bench_record("register test case", BENCH_CASE_COUNT, bench_now_ns() - start);
+}
@@ -0,0 +1,22 @@
+// bench_json_hooks.c
+#include "hooks/json_hooks.h"
+#include "bench.h"
+
+/*
+ * Cost of a test case reported through the JSON hooks: BENCH_CASE_COUNT empty cases written
+ * to a JSON report. Compare with `bench_cases` for the cost of the hooks themselves.
+ */
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("reports/bench_json_hooks.json", "w");
+}
+
+// Register test cases
+__attribute__((constructor)) void init_json_hooks_bench(void) {
+   static struct JsonHookContext ctx = {0};
+   testset("bench_json_hooks", set_config, NULL);
+
+   json_hooks.context = (tc_context *)&ctx;
+   register_hooks((ST_Hooks)&json_hooks);
+
+   bench_register_cases("JSON hooks test case");
+}
@@ -0,0 +1,23 @@
+// bench_junit_hooks.c
+#include "hooks/junit_hooks.h"
+#include "bench.h"
+
+/*
+ * Cost of a test case reported through the JUnit hooks: BENCH_CASE_COUNT empty cases written
+ * to the JUnit report (`reports/junit_report.xml`). Compare with `bench_cases` for the cost of
+ * the hooks themselves.
+ */
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("/dev/null", "w");
+}
+
+// Register test cases
+__attribute__((constructor)) void init_junit_hooks_bench(void) {
+   static struct JunitHookContext ctx = {0};
+   testset("bench_junit_hooks", set_config, NULL);
+
+   junit_hooks.context = (tc_context *)&ctx;
+   register_hooks((ST_Hooks)&junit_hooks);
+
+   bench_register_cases("JUnit hooks test case");
+}
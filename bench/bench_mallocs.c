@@ -0,0 +1,41 @@
+// bench_mallocs.c
+#include "bench.h"
+#include <stdlib.h>
+
+/*
+ * Cost of the allocation wrappers: malloc/free pairs made by test code, which go through the
+ * counting (and with `--track-leaks` or a heap budget, tracking) wrappers, against the same
+ * pairs made on the real allocator.
+ */
+#define PAIR_COUNT 1000000
+#define BLOCK_SIZE 64
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("/dev/null", "w");
+}
+// test cases
+static void bench_wrapped(void) {
+   void *volatile block;
+   uint64_t start = bench_now_ns();
+   for (int i = 0; i < PAIR_COUNT; i++) {
+      block = malloc(BLOCK_SIZE);
+      free(block);
+   }
+   bench_record("malloc/free (wrapped)", PAIR_COUNT, bench_now_ns() - start);
+}
+static void bench_real(void) {
+   void *volatile block;
+   uint64_t start = bench_now_ns();
+   for (int i = 0; i < PAIR_COUNT; i++) {
+      block = __real_malloc(BLOCK_SIZE);
+      __real_free(block);
+   }
+   bench_record("malloc/free (real)", PAIR_COUNT, bench_now_ns() - start);
+}
+
+// Register test cases
+__attribute__((constructor)) void init_malloc_bench(void) {
+   testset("bench_mallocs", set_config, NULL);
+   testcase("wrapped", bench_wrapped);
+   testcase("real", bench_real);
+}
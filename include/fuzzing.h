@@ -41,9 +41,18 @@ typedef enum {
    FUZZ_SIZE_T,
    FUZZ_FLOAT,
    FUZZ_BYTE,
+   FUZZ_BUFFER, /* Byte buffer of varying length; the function receives a `FuzzBuffer *` */
    // Add more fuzz input types as needed
 } FuzzType;
 
+/**
+ * @brief Input of a FUZZ_BUFFER test case; the data ends exactly at `data + size`
+ */
+typedef struct {
+   const unsigned char *data;
+   size_t size;
+} FuzzBuffer;
+
 typedef void (*FuzzyFunc)(void *); // Fuzzy test function pointer
 
 /**
@@ -39,6 +39,8 @@ struct JsonHookContext {
    } info;
    object data;
    TsInfo set;
+   ReportWriter writer; /* Background writer serializing the set report */
+   FILE *stream;        /* Set log stream the report is written to */
 };
 
 extern struct st_hooks_s json_hooks;
@@ -50,4 +52,6 @@ void json_after_test(tc_context *context);
 void json_on_start_test(tc_context *context);
 void json_on_end_test(tc_context *context);
 void json_on_error(const char *message, tc_context *context);
-void json_on_test_result(const TsInfo set, tc_context *context);
\ No newline at end of file
+void json_on_test_result(const TsInfo set, tc_context *context);
+void json_on_bench_result(const TsInfo set, tc_context *context, const st_bench_stats *stats);
+void json_on_param_result(const TsInfo set, tc_context *context, const st_param_results *results);
\ No newline at end of file
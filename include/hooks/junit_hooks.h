@@ -47,6 +47,11 @@ struct JunitExtraData {
    int failures;
    int skipped;
    TsInfo set;
+   FILE *file;          /* Report file */
+   ReportWriter writer; /* Background writer serializing the set report */
+   char *cases;         /* Testcase XML, written with the testsuite totals */
+   size_t cases_used;
+   size_t cases_size;
 };
 
 struct JunitHookContext {
@@ -65,4 +70,5 @@ extern struct st_hooks_s junit_hooks;
 
 void junit_before_set(const TsInfo set, tc_context *context);
 void junit_after_set(const TsInfo set, tc_context *context);
-void junit_on_test_result(const TsInfo set, tc_context *context);
\ No newline at end of file
+void junit_on_test_result(const TsInfo set, tc_context *context);
+void junit_on_param_result(const TsInfo set, tc_context *context, const st_param_results *results);
\ No newline at end of file
@@ -0,0 +1,53 @@
+/*
+ * SigmaTest
+ * Copyright (c) 2025 David Boarman (BadKraft) and contributors
+ * QuantumOverride [Q|]
+ * ----------------------------------------------
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * ----------------------------------------------
+ * File: perf_hooks.h
+ * Description: Header file for hardware performance counter hooks for SigmaTest
+ */
+#pragma once
+
+#include "sigtest.h"
+
+/*
+ * Hardware performance counters per test case (`perf_event_open`).
+ * The perf hooks wrap another hook set: every callback is handed on unchanged, and the
+ * counters are enabled right after the wrapped `on_start_test` and read right before the
+ * wrapped `on_end_test`. The counts are stored in the case info (`st_case_info_s.perf`) ahead
+ * of `on_test_result`, so the default output, `json_hooks` and `junit_hooks` all report them.
+ * One hook set can be wrapped per process; wrapping it again returns the same perf hooks.
+ */
+/**
+ * @brief Wraps a hook set with hardware counter measurement
+ * @param inner :the hooks to forward to; NULL for the default output
+ * @return the perf hooks, ready for `register_hooks`; NULL when they already wrap another hook set
+ */
+ST_Hooks perf_hooks_wrap(ST_Hooks);
+/**
+ * @brief Checks whether the host exposes hardware counters to this process
+ * @return the PerfCounter bits that can be measured; 0 when none can
+ */
+unsigned perf_hooks_available(void);
+
+void perf_after_set(const TsInfo set, tc_context *context);
+void perf_on_start_test(tc_context *context);
+void perf_on_end_test(tc_context *context);
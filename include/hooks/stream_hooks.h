@@ -0,0 +1,91 @@
+/*
+ * SigmaTest
+ * Copyright (c) 2025 David Boarman (BadKraft) and contributors
+ * QuantumOverride [Q|]
+ * ----------------------------------------------
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * ----------------------------------------------
+ * File: stream_hooks.h
+ * Description: Header file for binary result stream hooks for SigmaTest
+ */
+#pragma once
+
+#include "sigtest.h"
+#include <stdint.h>
+
+/*
+ * Stream layout: one st_stream_header, then length prefixed records. Each record is an
+ * st_stream_record followed by its NUL terminated strings and padded to 8 bytes, so `length`
+ * always lands on the next record. Integers are in host byte order; `order` tells a reader on
+ * another host which order that was.
+ */
+#define ST_STREAM_MAGIC "STRS"
+#define ST_STREAM_VERSION 1
+#define ST_STREAM_ORDER 0x01020304u
+
+typedef struct st_stream_header_s {
+   char magic[4];        /* ST_STREAM_MAGIC */
+   uint16_t version;     /* ST_STREAM_VERSION */
+   uint16_t record_size; /* sizeof(st_stream_record) of the writer */
+   uint32_t order;       /* ST_STREAM_ORDER as the writer stored it */
+   uint32_t reserved;
+} st_stream_header;
+
+typedef enum {
+   STREAM_SET_BEGIN = 1, /* A test set starts; `time_ns` is its start in ns since the epoch, `message` the host name */
+   STREAM_CASE = 2,      /* A test case finished */
+   STREAM_SET_END = 3,   /* A test set ended; `time_ns` is its duration */
+} StreamKind;
+
+typedef struct st_stream_record_s {
+   uint32_t length;  /* Record size in bytes, strings and padding included */
+   uint8_t kind;     /* StreamKind */
+   uint8_t state;    /* TestState of a case */
+   uint16_t reserved;
+   uint32_t set_id;  /* Index of the set in the stream */
+   uint32_t case_id; /* Index of the case in its set */
+   uint64_t time_ns; /* Case duration, or see StreamKind */
+   uint64_t allocs;  /* Allocations of the case; run totals at a set end */
+   uint64_t frees;   /* Frees of the case; run totals at a set end */
+   uint32_t name;    /* Offset of the set or case name from the record start (0 = none) */
+   uint32_t message; /* Offset of the result message from the record start (0 = none) */
+} st_stream_record;
+
+struct StreamHookContext {
+   struct {
+      int count;
+      int verbose;
+      ts_time start;
+      ts_time end;
+      RunnerState state;
+      Logger logger;
+   } info;
+   object data;
+   const char *target; /* Report file, `unix:<path>` for a socket, or NULL for each set's log stream */
+   FILE *out;          /* Stream the records are written to */
+   uint32_t set_id;
+   uint32_t case_id;
+   ts_time set_start;
+   ts_time test_start;
+};
+
+extern struct st_hooks_s stream_hooks;
+
+void stream_before_set(const TsInfo set, tc_context *context);
+void stream_after_set(const TsInfo set, tc_context *context);
+void stream_on_start_test(tc_context *context);
+void stream_on_test_result(const TsInfo set, tc_context *context);
+void stream_on_param_result(const TsInfo set, tc_context *context, const st_param_results *results);
@@ -40,6 +40,8 @@ typedef enum {
    EXECUTE_TEST,
    FUZZING_INIT,
    FUZZING_LOOP,
+   BENCH_INIT,
+   PARAM_INIT,
    HANDLE_EXCEPTION,
    END_TEST,
    TEARDOWN_TEST,
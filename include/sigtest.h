@@ -30,6 +30,7 @@
 #include "internal/memwrap.h"
 #include "internal/runner_states.h"
 #include <stdarg.h>
+#include <stdint.h>
 #include <sys/syscall.h>
 #include <unistd.h>
 
@@ -54,6 +55,8 @@ typedef void (*CaseOp)(void);                 // Test case operation function po
 typedef void (*ConfigFunc)(FILE **);          // Test set config function pointer
 typedef void (*CleanupFunc)(void);            // Test set cleanup function pointer
 typedef void (*SetOp)(const TestSet, object); // Test set operation function pointer
+typedef void (*ParamFunc)(const void *);      // Parameterized test function; receives one table row
+typedef void (*ParamFormat)(const void *, char *, size_t); // Formats a table row as a label
 
 extern TestSet test_sets; // Global test set registry
 
@@ -75,7 +78,10 @@ typedef enum {
  */
 typedef enum { PASS,
                FAIL,
-               SKIP } TestState;
+               SKIP,
+               TIMEOUT,    /* Aborted at its wall or CPU time budget */
+               OVERBUDGET, /* Aborted at its heap or allocation budget */
+} TestState;
 
 /**
  * @brief Assert interface structure with function pointers
@@ -152,12 +158,219 @@ typedef struct st_assert_i {
     * @param fmt :the format message to display
     */
    void (*skip)(const string, ...);
+   /**
+    * @brief Asserts that two arrays hold equal elements, compared like areEqual.
+    * @param expected :expected array.
+    * @param actual :actual array to compare.
+    * @param count :number of elements.
+    * @param type :the element type; STRING compares arrays of strings
+    * @param fmt :format message to display if assertion fails.
+    */
+   void (*arrayEqual)(object, object, size_t, AssertType, const string, ...);
+   /**
+    * @brief Asserts that two FLOAT or DOUBLE arrays agree element-wise within a tolerance.
+    * @param expected :expected array.
+    * @param actual :actual array to compare.
+    * @param count :number of elements.
+    * @param type :FLOAT or DOUBLE
+    * @param tolerance :the largest allowed difference per element.
+    * @param fmt :format message to display if assertion fails.
+    */
+   void (*arrayWithin)(object, object, size_t, AssertType, double, const string, ...);
+   /**
+    * @brief Asserts that two memory regions hold the same bytes.
+    * @param expected :expected bytes.
+    * @param actual :actual bytes to compare.
+    * @param size :number of bytes.
+    * @param fmt :format message to display if assertion fails.
+    */
+   void (*memEqual)(object, object, size_t, const string, ...);
 } st_assert_i;
 /**
  * @brief Global instance of the IAssert interface for use in tests
  */
 extern const st_assert_i Assert;
 
+/*
+ * Inline checks
+ * Each macro compares in the caller and only calls the out-of-line formatter on failure, so
+ * a passing check costs the comparison alone. Operands are evaluated once; the optional
+ * message must be a string literal format, e.g. ST_ASSERT_EQ_INT(4, n, "after %d pushes", k).
+ */
+#define ST_ASSERT_TRUE(condition, ...) \
+   ST_CHECK_(!(condition), st_assert_fail("Expected true, but was false", "" __VA_ARGS__))
+#define ST_ASSERT_FALSE(condition, ...) \
+   ST_CHECK_((condition), st_assert_fail("Expected false, but was true", "" __VA_ARGS__))
+#define ST_ASSERT_NULL(ptr, ...) \
+   ST_CHECK_((ptr) != NULL, st_assert_fail("Pointer is not NULL", "" __VA_ARGS__))
+#define ST_ASSERT_NOT_NULL(ptr, ...) \
+   ST_CHECK_((ptr) == NULL, st_assert_fail("Pointer is NULL", "" __VA_ARGS__))
+#define ST_ASSERT_EQ_INT(expected, actual, ...)                                \
+   do {                                                                        \
+      long long st_expected_ = (expected), st_actual_ = (actual);              \
+      ST_CHECK_(st_expected_ != st_actual_,                                    \
+                st_assert_fail_int(st_expected_, st_actual_, "" __VA_ARGS__)); \
+   } while (0)
+#define ST_ASSERT_EQ_PTR(expected, actual, ...)                                \
+   do {                                                                        \
+      const void *st_expected_ = (expected), *st_actual_ = (actual);           \
+      ST_CHECK_(st_expected_ != st_actual_,                                    \
+                st_assert_fail_ptr(st_expected_, st_actual_, "" __VA_ARGS__)); \
+   } while (0)
+#define ST_ASSERT_WITHIN(value, min, max, ...)                                      \
+   do {                                                                             \
+      double st_value_ = (value), st_min_ = (min), st_max_ = (max);                 \
+      ST_CHECK_(!(st_value_ >= st_min_ && st_value_ <= st_max_),                    \
+                st_assert_fail_range(st_value_, st_min_, st_max_, "" __VA_ARGS__)); \
+   } while (0)
+#define ST_ASSERT_EQ_STR(expected, actual, ...)                                \
+   do {                                                                        \
+      const char *st_expected_ = (expected), *st_actual_ = (actual);           \
+      ST_CHECK_(__builtin_strcmp(st_expected_, st_actual_) != 0,               \
+                st_assert_fail_str(st_expected_, st_actual_, "" __VA_ARGS__)); \
+   } while (0)
+#define ST_CHECK_(failed, report)          \
+   do {                                    \
+      if (__builtin_expect(!!(failed), 0)) \
+         report;                           \
+   } while (0)
+
+/**
+ * @brief Fails the running test with the check description and the formatted message
+ * @param check :what the check expected
+ * @param fmt :the format message; may be empty
+ */
+void st_assert_fail(const char *check, const char *fmt, ...) __attribute__((cold));
+/**
+ * @brief Fails the running test after an integer comparison
+ * @param expected :the expected value
+ * @param actual :the actual value
+ * @param fmt :the format message; may be empty
+ */
+void st_assert_fail_int(long long expected, long long actual, const char *fmt, ...) __attribute__((cold));
+/**
+ * @brief Fails the running test after a pointer comparison
+ * @param expected :the expected pointer
+ * @param actual :the actual pointer
+ * @param fmt :the format message; may be empty
+ */
+void st_assert_fail_ptr(const void *expected, const void *actual, const char *fmt, ...) __attribute__((cold));
+/**
+ * @brief Fails the running test after a range check
+ * @param value :the checked value
+ * @param min :the lower bound
+ * @param max :the upper bound
+ * @param fmt :the format message; may be empty
+ */
+void st_assert_fail_range(double value, double min, double max, const char *fmt, ...) __attribute__((cold));
+/**
+ * @brief Fails the running test after a string comparison
+ * @param expected :the expected string
+ * @param actual :the actual string
+ * @param fmt :the format message; may be empty
+ */
+void st_assert_fail_str(const char *expected, const char *actual, const char *fmt, ...) __attribute__((cold));
+
+/*
+ * Typed checks
+ * ST_ASSERT_EQ and ST_ASSERT_NE take their operands by value and compare them in their common
+ * type, as `==` would, with the comparison and the failure formatter chosen at compile time by
+ * `_Generic`. Signed and unsigned integers of every width compare exactly, floating point
+ * values within FLT_EPSILON or DBL_EPSILON like Assert.areEqual, `char *` by content and other
+ * pointers by address; operands with no such type (structs) do not compile. Operands are
+ * evaluated once, e.g. ST_ASSERT_EQ(4u, stack_size(s), "after %d pushes", k).
+ */
+#define ST_ASSERT_EQ(expected, actual, ...) ST_ASSERT_CMP_(1, expected, actual, __VA_ARGS__)
+#define ST_ASSERT_NE(expected, actual, ...) ST_ASSERT_CMP_(0, expected, actual, __VA_ARGS__)
+#define ST_ASSERT_CMP_(equal, expected, actual, ...)                                            \
+   do {                                                                                         \
+      __typeof__(1 ? (expected) : (actual)) st_expected_ = (expected), st_actual_ = (actual);   \
+      ST_CHECK_(ST_EQUAL_(st_expected_, st_actual_) != (equal),                                 \
+                ST_FAIL_CMP_(st_actual_)(equal, st_expected_, st_actual_, "" __VA_ARGS__));     \
+   } while (0)
+#define ST_EQUAL_(expected, actual)                                           \
+   _Generic((actual),                                                         \
+       int: st_equal_signed_, long: st_equal_signed_, long long: st_equal_signed_, \
+       unsigned: st_equal_unsigned_, unsigned long: st_equal_unsigned_,       \
+       unsigned long long: st_equal_unsigned_,                                \
+       float: st_equal_float_, double: st_equal_double_,                      \
+       long double: st_equal_long_double_,                                    \
+       char *: st_equal_string_, const char *: st_equal_string_,              \
+       default: st_equal_pointer_)(expected, actual)
+#define ST_FAIL_CMP_(actual)                                                          \
+   _Generic((actual),                                                                 \
+       int: st_assert_fail_signed, long: st_assert_fail_signed,                       \
+       long long: st_assert_fail_signed,                                              \
+       unsigned: st_assert_fail_unsigned, unsigned long: st_assert_fail_unsigned,     \
+       unsigned long long: st_assert_fail_unsigned,                                   \
+       float: st_assert_fail_real, double: st_assert_fail_real,                       \
+       long double: st_assert_fail_real,                                              \
+       char *: st_assert_fail_string, const char *: st_assert_fail_string,            \
+       default: st_assert_fail_pointer)
+
+static inline int st_equal_signed_(long long expected, long long actual) {
+   return expected == actual;
+}
+static inline int st_equal_unsigned_(unsigned long long expected, unsigned long long actual) {
+   return expected == actual;
+}
+static inline int st_equal_float_(float expected, float actual) {
+   return expected == actual || __builtin_fabsf(expected - actual) <= __FLT_EPSILON__;
+}
+static inline int st_equal_double_(double expected, double actual) {
+   return expected == actual || __builtin_fabs(expected - actual) <= __DBL_EPSILON__;
+}
+static inline int st_equal_long_double_(long double expected, long double actual) {
+   return expected == actual || __builtin_fabsl(expected - actual) <= __LDBL_EPSILON__;
+}
+static inline int st_equal_string_(const char *expected, const char *actual) {
+   return expected == actual || (expected && actual && __builtin_strcmp(expected, actual) == 0);
+}
+static inline int st_equal_pointer_(const void *expected, const void *actual) {
+   return expected == actual;
+}
+/**
+ * @brief Fails the running test after a typed check of signed integers
+ * @param equal :1 if the check expected the values to be equal, 0 if it expected them to differ
+ * @param expected :the expected value
+ * @param actual :the actual value
+ * @param fmt :the format message; may be empty
+ */
+void st_assert_fail_signed(int equal, long long expected, long long actual, const char *fmt, ...) __attribute__((cold));
+/**
+ * @brief Fails the running test after a typed check of unsigned integers
+ * @param equal :1 if the check expected the values to be equal, 0 if it expected them to differ
+ * @param expected :the expected value
+ * @param actual :the actual value
+ * @param fmt :the format message; may be empty
+ */
+void st_assert_fail_unsigned(int equal, unsigned long long expected, unsigned long long actual, const char *fmt, ...)
+    __attribute__((cold));
+/**
+ * @brief Fails the running test after a typed check of floating point values
+ * @param equal :1 if the check expected the values to be equal, 0 if it expected them to differ
+ * @param expected :the expected value
+ * @param actual :the actual value
+ * @param fmt :the format message; may be empty
+ */
+void st_assert_fail_real(int equal, long double expected, long double actual, const char *fmt, ...) __attribute__((cold));
+/**
+ * @brief Fails the running test after a typed check of strings
+ * @param equal :1 if the check expected the strings to be equal, 0 if it expected them to differ
+ * @param expected :the expected string; may be NULL
+ * @param actual :the actual string; may be NULL
+ * @param fmt :the format message; may be empty
+ */
+void st_assert_fail_string(int equal, const char *expected, const char *actual, const char *fmt, ...) __attribute__((cold));
+/**
+ * @brief Fails the running test after a typed check of pointers
+ * @param equal :1 if the check expected the pointers to be equal, 0 if it expected them to differ
+ * @param expected :the expected pointer
+ * @param actual :the actual pointer
+ * @param fmt :the format message; may be empty
+ */
+void st_assert_fail_pointer(int equal, const void *expected, const void *actual, const char *fmt, ...) __attribute__((cold));
+
 /**
  * @brief Logger structure for test set logging
  */
@@ -169,6 +382,27 @@ typedef struct st_logger_s {
 
 // Global debug logger instance
 extern const st_logger_s DebugLogger;
+/**
+ * @brief Hardware performance counters, as bits of `st_perf_counts.valid`
+ */
+typedef enum {
+   PERF_CYCLES = 1 << 0,
+   PERF_INSTRUCTIONS = 1 << 1,
+   PERF_L1D_MISSES = 1 << 2,
+   PERF_LLC_MISSES = 1 << 3,
+   PERF_BRANCH_MISSES = 1 << 4,
+} PerfCounter;
+/**
+ * @brief Hardware performance counts of one test case run (measured by `perf_hooks`)
+ */
+typedef struct st_perf_counts_s {
+   unsigned valid;         /* PerfCounter bits of the measured counters; 0 when not measured */
+   uint64_t cycles;        /* CPU cycles in user space */
+   uint64_t instructions;  /* Retired instructions */
+   uint64_t l1d_misses;    /* L1 data cache read misses */
+   uint64_t llc_misses;    /* Last level cache read misses */
+   uint64_t branch_misses; /* Mispredicted branches */
+} st_perf_counts;
 /**
  * @brief Test case info structure
  */
@@ -178,7 +412,9 @@ typedef struct st_case_info_s {
       TestState state;
       string message;
    } result;
-   int has_next; /* Flag indicating if there is a next test case */
+   int has_next;        /* Flag indicating if there is a next test case */
+   size_t index;        /* Position of the test case within its set */
+   st_perf_counts perf; /* Hardware counters of the last run, when measured */
 } st_case_info_s;
 /**
  * @brief Test set info structure
@@ -190,7 +426,59 @@ typedef struct st_set_info_s {
    int passed;     /* Number of passed test cases */
    int failed;     /* Number of failed test cases */
    int skipped;    /* Number of skipped test cases */
+   int regressed;  /* Number of failed cases that are benchmark regressions */
 } st_set_info_s;
+/**
+ * @brief Gets the number of registered test cases across all test sets
+ * @return the test case count
+ */
+size_t st_case_total(void);
+/**
+ * @brief Gets a registered test case by registry index (registration order)
+ * @param index :the registry index
+ * @return the test case info, or NULL if out of range
+ */
+TcInfo st_case_at(size_t);
+/**
+ * @brief Gets a test case of a test set by position
+ * @param set :the test set info
+ * @param index :the position within the set
+ * @return the test case info, or NULL if out of range
+ */
+TcInfo st_set_case(const TsInfo, size_t);
+/**
+ * @brief Gets the test case running on the calling thread
+ * @return the test case info, or NULL outside of a test case
+ */
+TcInfo st_current_case(void);
+/**
+ * @brief Checks whether a test case is the last one of its test set
+ * @param set :the test set info
+ * @param tc :the test case info
+ * @return non-zero if no test case follows
+ */
+int st_is_last_case(const TsInfo, const TcInfo);
+/**
+ * @brief Gets the statistics of the last run of a benchmark test case
+ * @param tc :the test case info
+ * @return the benchmark statistics, or NULL if the case is not a benchmark or has not run
+ */
+const struct st_bench_stats_s *st_bench_result(const TcInfo);
+/**
+ * @brief Gets the row results of the last run of a parameterized test case
+ * @param tc :the test case info
+ * @return the row results, or NULL if the case is not parameterized
+ */
+const struct st_param_results_s *st_param_result(const TcInfo);
+/**
+ * @brief Formats the label of a table row with the case formatter, or as `#row` without one
+ * @param results :the row results
+ * @param row :the row index
+ * @param buffer :the output buffer
+ * @param size :the buffer size
+ * @return the buffer
+ */
+const char *st_param_label(const struct st_param_results_s *, size_t, char *, size_t);
 /**
  * @brief Test context structure for hook functions
  */
@@ -233,6 +521,124 @@ void fail_testcase(string name, TestFunc func);
  * @param  func :the test function
  */
 void testcase_throws(string name, TestFunc func);
+/**
+ * @brief Registers a benchmark test case; the function is timed over auto-calibrated
+ *        iterations after warmup rounds and reported with its sample statistics
+ * @param  name :the benchmark name
+ * @param  func :the function to benchmark (one iteration per call)
+ */
+void bench_testcase(string name, TestFunc func);
+/**
+ * @brief Registers a parameterized test case; the function runs once per table row and each
+ *        row is reported as a sub-result. The table is used in place and must outlive the run
+ * @param  name :the test name
+ * @param  func :the test function, called with a pointer to the row
+ * @param  table :the row table
+ * @param  count :the number of rows
+ * @param  elem_size :the size of one row
+ * @param  format :formats a row label for reports (may be NULL)
+ */
+void param_testcase(string name, ParamFunc func, const void *table, size_t count, size_t elem_size, ParamFormat format);
+/**
+ * @brief Tags the most recently registered test case for `--tag` selection
+ * @param  tags :comma separated tag names
+ */
+void tag_testcase(const char *);
+/**
+ * @brief Tags the current test set; every test case of the set inherits the tags
+ * @param  tags :comma separated tag names
+ */
+void tag_testset(const char *);
+/**
+ * @brief Resource budget of a test case; a zero field is unlimited
+ */
+typedef struct st_budget_s {
+   int wall_ms;       /* Wall clock time of the test body */
+   int cpu_ms;        /* CPU time of the thread running the test body */
+   size_t heap_bytes; /* Peak live heap allocated by the case (uses the leak tracker) */
+   size_t allocs;     /* Allocations made by the case */
+} st_budget;
+/**
+ * @brief Sets the budget of the most recently registered test case; a case that exceeds it is
+ *        aborted and reported as TIMEOUT (time) or OVERBUDGET (heap, allocations)
+ * @param  budget :the limits; zero fields fall back to the set, then the runner budget
+ */
+void budget_testcase(st_budget);
+/**
+ * @brief Sets the budget of every test case of the current test set
+ * @param  budget :the limits; zero fields fall back to the runner budget
+ */
+void budget_testset(st_budget);
+/**
+ * @brief Lifetime of a fixture
+ */
+typedef enum {
+   FIXTURE_SET,     /* Belongs to the set it is registered in; torn down at the latest when the set ends */
+   FIXTURE_PROCESS, /* Shared by every set; torn down at the latest when the run ends */
+} FixtureScope;
+typedef struct st_fixture_s *Fixture;
+typedef object (*FixtureSetup)(void);
+typedef void (*FixtureTeardown)(object);
+/**
+ * @brief Registers a fixture: built the first time a running case asks for it with
+ *        `st_fixture`, shared by the cases that use it, and torn down after its last
+ *        selected user finishes
+ * @param  name :the fixture name
+ * @param  scope :FIXTURE_SET (must be registered after its `testset`) or FIXTURE_PROCESS
+ * @param  setup :builds the fixture value
+ * @param  teardown :releases the fixture value (may be NULL)
+ * @return the fixture, or NULL if it could not be registered
+ */
+Fixture testfixture(string, FixtureScope, FixtureSetup, FixtureTeardown);
+/**
+ * @brief Declares that the most recently registered test case uses a fixture, so the fixture
+ *        is kept until that case has finished
+ * @param  fixture :the fixture
+ */
+void fixture_testcase(Fixture);
+/**
+ * @brief Declares that every test case of the current test set uses a fixture
+ * @param  fixture :the fixture
+ */
+void fixture_testset(Fixture);
+/**
+ * @brief Gets the value of a fixture, building it on first use; the value is shared with
+ *        other cases (and runner threads) and must be treated as read-only
+ * @param  fixture :the fixture
+ * @return the fixture value
+ */
+object st_fixture(Fixture);
+
+/**
+ * @brief Start and end of the workload of one st_thread_pool thread
+ */
+typedef struct {
+   ts_time start; /* Taken once every thread of the pool was started */
+   ts_time end;   /* Taken when the workload returned or failed an assertion */
+} st_thread_time;
+typedef void (*ThreadWork)(size_t, object);
+/**
+ * @brief Runs a workload on `threads` threads of the running test case and joins them; the
+ *        threads start together, and assertions failed on them fail the case once all joined
+ * @param  threads :the number of threads
+ * @param  work :the workload, given the zero based thread index and `arg`
+ * @param  arg :the workload argument
+ * @param  times :receives the per-thread timestamps (`threads` entries; may be NULL)
+ * @return 0 on success, -1 if the threads could not be started (none ran the workload)
+ */
+int st_thread_pool(size_t, ThreadWork, object, st_thread_time *);
+/**
+ * @brief Gets the test case running on the calling thread, to hand to threads started by
+ *        test code with `st_thread_attach`
+ * @return the test case, or NULL outside a test case
+ */
+TestCase st_thread_case(void);
+/**
+ * @brief Attaches the calling thread to a test case: assertions failed and output written on
+ *        it are reported with that case; threads must be joined before the case returns
+ * @param  tc :the test case from `st_thread_case`, or NULL to detach the thread
+ */
+void st_thread_attach(TestCase);
 /**
  * @brief Registers the test case setup function
  * @param  setup :the test case setup function
@@ -277,9 +683,48 @@ typedef struct st_summary_s {
    int tc_passed;
    int tc_failed;
    int tc_skipped;
+   int tc_regressed; /* Failed cases that are benchmark regressions */
    size_t total_mallocs;
    size_t total_frees;
 } st_summary;
+/**
+ * @brief Benchmark statistics; all times are per iteration, in nanoseconds
+ */
+typedef struct st_bench_stats_s {
+   size_t iterations;       /* Iterations per sample (auto-calibrated) */
+   size_t samples;          /* Number of timed samples */
+   double min_ns;           /* Fastest sample */
+   double median_ns;        /* Median sample */
+   double p99_ns;           /* 99th percentile sample */
+   double stddev_ns;        /* Sample standard deviation */
+   double ns_per_op;        /* Mean over all timed iterations */
+   const double *sample_ns; /* Each sample, in run order */
+   double baseline_ns;      /* Baseline median; 0 when the case has no baseline */
+   double p_value;          /* One sided Mann-Whitney p value for "slower than the baseline" */
+   int regressed;           /* Slower than the baseline beyond the tolerance; the case fails */
+} st_bench_stats;
+/**
+ * @brief Result of one row of a parameterized test case
+ */
+typedef struct st_param_row_s {
+   TestState state; /* Row result */
+   string message;  /* Failure or skip message (may be NULL) */
+} st_param_row;
+/**
+ * @brief Row results of a parameterized test case
+ */
+typedef struct st_param_results_s {
+   const void *table;  /* Row table */
+   size_t count;       /* Number of rows */
+   size_t elem_size;   /* Size of one row */
+   ParamFormat format; /* Row label formatter (may be NULL) */
+   size_t first;       /* First row run; with sharding each shard runs rows [first, last) */
+   size_t last;
+   size_t passed;
+   size_t failed;
+   size_t skipped;
+   st_param_row *rows; /* Result of each row */
+} st_param_results;
 
 /**
  * @brief Test hooks structure
@@ -298,6 +743,8 @@ typedef struct st_hooks_s {
    void (*on_memory_free)(object, tc_context *);                      // Callback on memory freed
    void (*on_set_summary)(const TsInfo, tc_context *, st_summary *);  // Callback for set summary
    void (*on_debug_log)(tc_context *, DebugLevel, const char *, ...); // Callback for debug logging
+   void (*on_bench_result)(const TsInfo, tc_context *, const st_bench_stats *); // Benchmark statistics, before on_test_result
+   void (*on_param_result)(const TsInfo, tc_context *, const st_param_results *); // Parameterized rows, before on_test_result
    tc_context *context;                                               // Hook internal context
 } st_hooks_s;
 /**
@@ -314,6 +761,138 @@ typedef struct hook_registry_s {
  */
 ST_Hooks init_hooks(const char *);
 
+/**
+ * @brief Report record kinds
+ */
+typedef enum {
+   REPORT_SET_BEGIN, /* A test set starts; `name` is the set name */
+   REPORT_CASE,      /* A test case finished; `name`, `state`, `message` and `elapsed_ms` are set */
+   REPORT_SET_END,   /* A test set ended; `name` is the set name and `counts` hold its totals */
+   REPORT_NOTE,      /* Free form output; `message` is copied when pushed */
+} ReportKind;
+/**
+ * @brief Compact result record handed from the runner thread to a report writer
+ * @note `name` and `message` must stay valid until the writer is closed; the names and
+ *       result messages of the runner do
+ */
+typedef struct st_report_record_s {
+   ReportKind kind;
+   TestState state;     /* Test case result state */
+   int last;            /* Non-zero for the last selected case of its set */
+   double elapsed_ms;   /* Test case duration */
+   const char *name;    /* Set or case name */
+   const char *message; /* Result message or note text (may be NULL) */
+   const st_bench_stats *bench; /* Statistics of a benchmark case (may be NULL) */
+   const st_perf_counts *perf;  /* Hardware counters of the case (may be NULL) */
+   const st_param_results *params; /* Row results of a parameterized case (may be NULL) */
+   struct {
+      int total;
+      int passed;
+      int failed;
+      int skipped;
+      size_t mallocs;
+      size_t frees;
+   } counts; /* Set totals */
+} st_report_record;
+typedef struct st_report_writer_s *ReportWriter;
+typedef void (*ReportWrite)(const st_report_record *, object); // Serializes one record
+/**
+ * @brief Starts a background report writer; records pushed to it are serialized in order on
+ *        the writer thread, keeping formatting and I/O off the test thread
+ * @param write :the record serializer, called on the writer thread
+ * @param data :user data handed to the serializer
+ * @return the report writer, or NULL if it could not be started
+ */
+ReportWriter st_report_open(ReportWrite, object);
+/**
+ * @brief Queues a record for the writer; a single thread may push to a writer. Blocks only
+ *        while the ring is full
+ * @param writer :the report writer
+ * @param record :the record to copy into the ring
+ */
+void st_report_push(ReportWriter, const st_report_record *);
+/**
+ * @brief Drains the queued records and stops the writer
+ * @param writer :the report writer
+ */
+void st_report_close(ReportWriter);
+/**
+ * @brief Gets the log stream of the test set running on the calling thread
+ * @return the set log stream, or stdout outside a set
+ */
+FILE *st_log_stream(void);
+/**
+ * @brief Gets the allocations and frees counted since the previous test case finished: the
+ *        setup and body of the running case when called from `on_test_result`
+ * @param allocs :receives the allocation count
+ * @param frees :receives the free count
+ */
+void st_case_allocs(size_t *, size_t *);
+
+/**
+ * @brief Order test sets and cases run in (`--order`)
+ */
+typedef enum {
+   ORDER_REGISTERED,    /* Sets newest first, cases in registration order */
+   ORDER_FAILED_FIRST,  /* Cases that failed in the recorded history first */
+   ORDER_LONGEST_FIRST, /* Longest recorded duration first; feeds `--jobs` a longest processing time schedule */
+   ORDER_RANDOM,        /* Shuffled with `seed` */
+} RunOrder;
+/**
+ * @brief Output captured per test case and written to the log only when it fails (`--capture`)
+ */
+typedef enum {
+   CAPTURE_OFF,  /* Output goes straight to the set log */
+   CAPTURE_LOG,  /* `writef`, `writelnf` and debug logs */
+   CAPTURE_FDS,  /* Also fd 1 and 2 of the code under test (`--capture-fds`); serial sets or `--isolate` */
+} CaptureMode;
+/**
+ * @brief Test runner options
+ */
+typedef struct st_options_s {
+   int jobs;           /* Number of parallel test set workers (1 = serial, 0 = one per online CPU) */
+   int isolate;        /* Run each test case in a pre-forked worker process */
+   int track_leaks;    /* Record every live allocation for the leak report */
+   const char *filter; /* Run only cases matching this glob (or `/regex/`) on `set/case` */
+   const char *tags;   /* Run only cases with one of these comma separated tags; `!tag` excludes */
+   int shard_index;    /* Zero based shard to run when sharding */
+   int shard_count;    /* Number of shards the selected cases are split into (0 or 1 = no sharding) */
+   const char *shard_durations; /* Recorded `set/case<TAB>ms` durations used to balance the shards */
+   const char *bench_baseline;  /* Benchmark baseline file to compare against and extend */
+   int bench_tolerance;         /* Allowed median slowdown against the baseline, in percent */
+   int bench_update;            /* Replace existing baseline entries with this run's samples */
+   int fuzz_runs;               /* Run fuzz cases in engine mode for this many inputs */
+   int fuzz_time_ms;            /* Run fuzz cases in engine mode for this long */
+   int fuzz_jobs;               /* Worker threads of each fuzz engine session */
+   const char *fuzz_crash_dir;  /* Directory failing fuzz inputs are written to */
+   const char *fuzz_replay;     /* Run fuzz cases once on the input in this file */
+   st_budget budget;            /* Budget of every case (`--timeout`, `--cpu-time`, `--max-heap`, `--max-allocs`) */
+   RunOrder order;              /* Order sets and cases run in */
+   unsigned long seed;          /* Seed of ORDER_RANDOM (0 = from the clock; printed so it can be replayed) */
+   const char *history;         /* Case outcome and duration history read by `order` and written after the run */
+   CaptureMode capture;         /* Hold the output of each case until it is known to have failed */
+   const char *profile;         /* Directory the sampled call stacks of each case are folded into */
+} st_options;
+/**
+ * @brief Global test runner options; may be set from a test constructor or the command line
+ */
+extern st_options runner_options;
+/**
+ * @brief Parses test runner command line arguments into the global runner options
+ * @param argc :the argument count
+ * @param argv :the argument values
+ * @return 0 on success, non-zero if an argument is invalid
+ */
+int parse_runner_args(int, char **);
+/**
+ * @brief Gets the per-shard name of a report file; `reports/run.xml` becomes `reports/run.shard-K.xml`
+ * @param path :the report path
+ * @param buffer :the buffer receiving the shard path
+ * @param size :the buffer size
+ * @return the shard path, or `path` itself when not sharding
+ */
+const char *st_shard_path(const char *, char *, size_t);
+
 /**
  * @brief Registers a test set with the given name
  * @param  sets :the test sets under test
@@ -322,6 +901,28 @@ ST_Hooks init_hooks(const char *);
  */
 int run_tests(TestSet, ST_Hooks);
 
+typedef struct st_module_s *TestModule;
+/**
+ * @brief Loads a shared object of test sets into the running process; its constructors register
+ *        the sets, cases and hooks as they would in a test executable
+ * @param path :the shared object path
+ * @param replaces :a loaded module the new one takes the place of, or NULL; replaced only
+ *        once the new module has loaded
+ * @return the loaded module, or NULL if it could not be loaded
+ */
+TestModule st_module_load(const char *, TestModule);
+/**
+ * @brief Removes the sets, cases and hooks of a module from the registries and unloads it
+ * @param module :the loaded module
+ */
+void st_module_unload(TestModule);
+/**
+ * @brief Runs only the test sets of a module, with the hooks and runner options it registered
+ * @param module :the loaded module
+ * @return 0 if all tests pass, 1 if any test fails
+ */
+int st_module_run(TestModule);
+
 /**
  * @brief Test runner interface structure with function pointers
  */
@@ -54,31 +54,206 @@ struct st_hooks_s json_hooks = {
     .on_test_result = json_on_test_result,
     .on_set_summary = json_on_set_summary,
     .on_debug_log = NULL,
+    .on_bench_result = json_on_bench_result,
+    .on_param_result = json_on_param_result,
     .context = NULL,
 };
 
+// write a JSON string body, escaping quotes, backslashes and newlines
+static void json_escape(FILE *out, const char *text) {
+   for (const char *src = text ? text : ""; *src; src++) {
+      if (*src == '"' || *src == '\\') {
+         fputc('\\', out);
+         fputc(*src, out);
+      } else if (*src == '\n') {
+         fputs("\\n", out);
+      } else {
+         fputc(*src, out);
+      }
+   }
+}
+// Serialize one report record; runs on the report writer thread
+static void json_write(const st_report_record *record, object data) {
+   FILE *out = (FILE *)data;
+
+   switch (record->kind) {
+   case REPORT_SET_BEGIN: {
+      char timestamp[32];
+      get_timestamp(timestamp, "%Y-%m-%d %H:%M:%S");
+      fprintf(out, "{\n");
+      fprintf(out, "  \"test_set\": \"");
+      json_escape(out, record->name);
+      fprintf(out, "\",\n");
+      fprintf(out, "  \"timestamp\": \"%s\",\n", timestamp);
+      fprintf(out, "  \"tests\": [\n");
+
+      break;
+   }
+   case REPORT_CASE: {
+      // get test state label
+      const char *status = NULL;
+      switch (record->state) {
+      case PASS:
+         status = "PASS";
+         break;
+      case FAIL:
+         status = "FAIL";
+         break;
+      case SKIP:
+         status = "SKIP";
+         break;
+      case TIMEOUT:
+         status = "TIMEOUT";
+         break;
+      case OVERBUDGET:
+         status = "OVERBUDGET";
+         break;
+      default:
+         status = "UNKNOWN";
+         break;
+      }
+
+      fprintf(out, "    {\n");
+      fprintf(out, "      \"test\": \"");
+      json_escape(out, record->name);
+      fprintf(out, "\",\n");
+      fprintf(out, "      \"status\": \"%s\",\n", status);
+      fprintf(out, "      \"duration_us\": %.3f,\n", record->elapsed_ms * 1000.0);
+      if (record->bench) {
+         const st_bench_stats *bench = record->bench;
+         fprintf(out, "      \"bench\": {\"iterations\": %zu, \"samples\": %zu, \"ns_per_op\": %.3f, "
+                      "\"min_ns\": %.3f, \"median_ns\": %.3f, \"p99_ns\": %.3f, \"stddev_ns\": %.3f",
+                 bench->iterations, bench->samples, bench->ns_per_op,
+                 bench->min_ns, bench->median_ns, bench->p99_ns, bench->stddev_ns);
+         if (bench->baseline_ns > 0) {
+            fprintf(out, ", \"baseline_ns\": %.3f, \"p_value\": %.4f, \"regressed\": %s",
+                    bench->baseline_ns, bench->p_value, bench->regressed ? "true" : "false");
+         }
+         fprintf(out, "},\n");
+      }
+      if (record->perf) {
+         // counters the host could not measure are left out
+         const st_perf_counts *perf = record->perf;
+         const struct {
+            unsigned bit;
+            const char *name;
+            uint64_t value;
+         } counters[] = {
+             {PERF_CYCLES, "cycles", perf->cycles},
+             {PERF_INSTRUCTIONS, "instructions", perf->instructions},
+             {PERF_L1D_MISSES, "l1d_misses", perf->l1d_misses},
+             {PERF_LLC_MISSES, "llc_misses", perf->llc_misses},
+             {PERF_BRANCH_MISSES, "branch_misses", perf->branch_misses},
+         };
+         const char *sep = "";
+         fprintf(out, "      \"perf\": {");
+         for (size_t i = 0; i < sizeof(counters) / sizeof(counters[0]); i++) {
+            if (perf->valid & counters[i].bit) {
+               fprintf(out, "%s\"%s\": %llu", sep, counters[i].name, (unsigned long long)counters[i].value);
+               sep = ", ";
+            }
+         }
+         fprintf(out, "},\n");
+      }
+      if (record->params) {
+         const st_param_results *params = record->params;
+         static const char *const states[] = {"PASS", "FAIL", "SKIP", "TIMEOUT", "OVERBUDGET"};
+         char label[128];
+         fprintf(out, "      \"rows\": [");
+         for (size_t row = params->first; row < params->last; row++) {
+            const st_param_row *result = &params->rows[row];
+            fprintf(out, "%s\n        {\"row\": %zu, \"label\": \"", row == params->first ? "" : ",", row);
+            json_escape(out, st_param_label(params, row, label, sizeof(label)));
+            fprintf(out, "\", \"status\": \"%s\"", states[result->state]);
+            if (result->message) {
+               fprintf(out, ", \"message\": \"");
+               json_escape(out, result->message);
+               fprintf(out, "\"");
+            }
+            fprintf(out, "}");
+         }
+         fprintf(out, "%s],\n", params->last > params->first ? "\n      " : "");
+      }
+      fprintf(out, "      \"message\": \"");
+      json_escape(out, record->message);
+      fprintf(out, "\"\n");
+      fprintf(out, "    }%s\n", record->last ? "" : ",");
+
+      break;
+   }
+   case REPORT_SET_END:
+      fprintf(out, "  ],\n");
+      fprintf(out, "  \"summary\": {\n");
+      fprintf(out, "    \"total\": %d,\n", record->counts.total);
+      fprintf(out, "    \"passed\": %d,\n", record->counts.passed);
+      fprintf(out, "    \"failed\": %d,\n", record->counts.failed);
+      fprintf(out, "    \"skipped\": %d,\n", record->counts.skipped);
+      fprintf(out, "    \"total_mallocs\": %zu,\n", record->counts.mallocs);
+      fprintf(out, "    \"total_frees\": %zu\n", record->counts.frees);
+      fprintf(out, "  }\n");
+      fprintf(out, "}\n");
+
+      break;
+   case REPORT_NOTE:
+      fprintf(out, "%s\n", record->message ? record->message : "");
+
+      break;
+   }
+}
+// Hand a record to the report writer, or serialize it in place without one
+static void json_emit(struct JsonHookContext *ctx, const st_report_record *record) {
+   if (ctx->writer) {
+      st_report_push(ctx->writer, record);
+   } else {
+      json_write(record, ctx->stream);
+   }
+}
+// queue a verbose `"key": "value",` report line, with the value escaped as in json_escape
+static void json_note(struct JsonHookContext *ctx, const char *key, const char *value) {
+   char note[640];
+   size_t len = (size_t)snprintf(note, sizeof(note), "    \"%s\": \"", key);
+   for (const char *src = value ? value : ""; *src && len < sizeof(note) - 8; src++) {
+      if (*src == '"' || *src == '\\') {
+         note[len++] = '\\';
+         note[len++] = *src;
+      } else if (*src == '\n') {
+         note[len++] = '\\';
+         note[len++] = 'n';
+      } else {
+         note[len++] = *src;
+      }
+   }
+   memcpy(note + len, "\",", 3);
+   json_emit(ctx, &(st_report_record){.kind = REPORT_NOTE, .message = note});
+}
+
 void json_before_set(const TsInfo set, tc_context *context) {
    struct JsonHookContext *ctx = (struct JsonHookContext *)context;
    ctx->set = set; // Store set for use in other hooks
+   ctx->stream = st_log_stream();
+   ctx->writer = st_report_open(json_write, ctx->stream);
 
-   char timestamp[32];
-   get_timestamp(timestamp, "%Y-%m-%d %H:%M:%S");
-   context->info.logger->log("{");
-   context->info.logger->log("  \"test_set\": \"%s\",", set->name);
-   context->info.logger->log("  \"timestamp\": \"%s\",", timestamp);
-   context->info.logger->log("  \"tests\": [");
+   json_emit(ctx, &(st_report_record){.kind = REPORT_SET_BEGIN, .name = set->name});
 }
 void json_after_set(const TsInfo set, tc_context *context) {
-   context->info.logger->log("  ],");
-   context->info.logger->log("  \"summary\": {");
-   context->info.logger->log("    \"total\": %d,", set->count);
-   context->info.logger->log("    \"passed\": %d,", set->passed);
-   context->info.logger->log("    \"failed\": %d,", set->failed);
-   context->info.logger->log("    \"skipped\": %d,", set->skipped);
-   context->info.logger->log("    \"total_mallocs\": %zu,", _sigtest_alloc_count);
-   context->info.logger->log("    \"total_frees\": %zu", _sigtest_free_count);
-   context->info.logger->log("  }");
-   context->info.logger->log("}");
+   struct JsonHookContext *ctx = (struct JsonHookContext *)context;
+   st_report_record record = {
+       .kind = REPORT_SET_END,
+       .name = set->name,
+       .counts = {
+           .total = set->passed + set->failed + set->skipped,
+           .passed = set->passed,
+           .failed = set->failed,
+           .skipped = set->skipped,
+           .mallocs = _sigtest_alloc_count,
+           .frees = _sigtest_free_count,
+       },
+   };
+   json_emit(ctx, &record);
+
+   // the report is complete once the writer drains
+   st_report_close(ctx->writer);
+   ctx->writer = NULL;
 }
 void json_before_test(tc_context *context) {
    // Placeholder for any setup before each test
@@ -89,17 +264,17 @@ void json_after_test(tc_context *context) {
 void json_on_start_test(tc_context *context) {
    struct JsonHookContext *ctx = (struct JsonHookContext *)context;
 
+   if (ctx->info.verbose && ctx->set) {
+      json_note(ctx, "start_test", ctx->set->tc_info->name);
+   }
+
    ctx->info.end.tv_sec = 0;
    ctx->info.end.tv_nsec = 0;
-
+   // start timing last so the test duration excludes report output
    if (sys_gettime(&ctx->info.start) == -1) {
       DebugLogger.flog(stderr, "Error: Failed to get system start time");
       exit(EXIT_FAILURE);
    }
-
-   if (ctx->info.verbose && ctx->set) {
-      context->info.logger->log("    \"start_test\": \"%s\",\n", ctx->set->tc_info->name);
-   }
 }
 void json_on_end_test(tc_context *context) {
    struct JsonHookContext *ctx = (struct JsonHookContext *)context;
@@ -110,70 +285,47 @@ void json_on_end_test(tc_context *context) {
    }
 
    if (ctx->info.verbose && ctx->set) {
-      context->info.logger->log("    \"end_test\": \"%s\",\n", ctx->set->tc_info->name);
+      json_note(ctx, "end_test", ctx->set->tc_info->name);
    }
 }
 void json_on_error(const char *message, tc_context *context) {
    struct JsonHookContext *ctx = (struct JsonHookContext *)context;
 
    if (ctx->info.verbose && ctx->set) {
-      char escaped[512];
-      char *dst = escaped;
-      for (const char *src = message; *src && dst < escaped + sizeof(escaped) - 2; src++) {
-         if (*src == '"')
-            *dst++ = '\\';
-         *dst++ = *src;
-      }
-      *dst = '\0';
-      context->info.logger->log("    \"error\": \"%s\",\n", escaped);
+      json_note(ctx, "error", message);
    }
 }
 void json_on_test_result(const TsInfo set, tc_context *context) {
    struct JsonHookContext *ctx = (struct JsonHookContext *)context;
 
-   // get test state label
-   const char *status = NULL;
-   switch (set->tc_info->result.state) {
-   case PASS:
-      status = "PASS";
-      break;
-   case FAIL:
-      status = "FAIL";
-      break;
-   case SKIP:
-      status = "SKIP";
-      break;
-   default:
-      status = "UNKNOWN";
-      break;
+   st_report_record record = {
+       .kind = REPORT_CASE,
+       .state = set->tc_info->result.state,
+       .last = st_is_last_case(set, set->tc_info),
+       .elapsed_ms = get_elapsed_ms(&ctx->info.start, &ctx->info.end),
+       .name = set->tc_info->name,
+       .message = set->tc_info->result.message,
+       .bench = st_bench_result(set->tc_info),
+       .perf = set->tc_info->perf.valid ? &set->tc_info->perf : NULL,
+       .params = st_param_result(set->tc_info),
+   };
+   json_emit(ctx, &record);
+}
+void json_on_bench_result(const TsInfo set, tc_context *context, const st_bench_stats *stats) {
+   struct JsonHookContext *ctx = (struct JsonHookContext *)context;
+   // statistics are written with the test record; keep the default text out of the report
+   if (ctx->info.verbose) {
+      json_note(ctx, "bench_result", set->tc_info->name);
    }
-
-   // Output test result in JSON format
-   double elapsed_ms = get_elapsed_ms(&ctx->info.start, &ctx->info.end);
-
-   char message[256];
-   snprintf(message, sizeof(message), "%s", set->tc_info->result.message ? set->tc_info->result.message : "");
-   char escaped_message[512];
-   char *dst = escaped_message;
-   for (const char *src = message; *src && dst < escaped_message + sizeof(escaped_message) - 2; src++) {
-      if (*src == '"') {
-         *dst++ = '\\';
-         *dst++ = '"';
-      } else if (*src == '\n') {
-         *dst++ = '\\';
-         *dst++ = 'n';
-      } else {
-         *dst++ = *src;
-      }
+   (void)stats; // unused
+}
+void json_on_param_result(const TsInfo set, tc_context *context, const st_param_results *results) {
+   struct JsonHookContext *ctx = (struct JsonHookContext *)context;
+   // rows are written with the test record; keep the default text out of the report
+   if (ctx->info.verbose) {
+      json_note(ctx, "param_result", set->tc_info->name);
    }
-   *dst = '\0';
-
-   context->info.logger->log("    {");
-   context->info.logger->log("      \"test\": \"%s\",", set->tc_info->name);
-   context->info.logger->log("      \"status\": \"%s\",", status);
-   context->info.logger->log("      \"duration_us\": %.3f,", elapsed_ms * 1000.0);
-   context->info.logger->log("      \"message\": \"%s\"", escaped_message);
-   context->info.logger->log("    }%s", set->tc_info->has_next ? "," : "");
+   (void)results; // unused
 }
 
 void json_on_set_summary(const TsInfo set, tc_context *context, st_summary *summary) {
@@ -48,39 +48,31 @@ extern int sys_gettime(ts_time *);
 #define COLOR_RED "\033[0;31m"
 #define COLOR_YELLOW "\033[1;33m"
 #define COLOR_RESET "\033[0m"
-#define JUNIT_XML_BUFFER_SIZE (1024 * 1024)
 
-static char junit_xml_buffer[JUNIT_XML_BUFFER_SIZE];
-static size_t junit_xml_used = 0;
-static FILE *junit_file;
-static char *junit_testcase_xml = NULL;
-static size_t junit_testcase_allocated = 0;
-
-static void junit_append_testcase(const char *fmt, ...) {
+// Append formatted XML to the testcase buffer; grows geometrically, so appends stay linear
+static void junit_append_testcase(struct JunitExtraData *extra, const char *fmt, ...) {
    va_list args;
    va_start(args, fmt);
    int needed = vsnprintf(NULL, 0, fmt, args);
    va_end(args);
+   if (needed < 0)
+      return;
 
-   if (junit_testcase_allocated == 0) {
-      junit_testcase_allocated = 1024;
-      junit_testcase_xml = __real_malloc(junit_testcase_allocated);
-      if (!junit_testcase_xml)
-         return;
-      junit_testcase_xml[0] = '\0';
-   }
-
-   size_t current_len = strlen(junit_testcase_xml);
-   if (current_len + needed + 1 > junit_testcase_allocated) {
-      junit_testcase_allocated = current_len + needed + 1;
-      junit_testcase_xml = __real_realloc(junit_testcase_xml, junit_testcase_allocated);
-      if (!junit_testcase_xml)
+   if (extra->cases_used + needed + 1 > extra->cases_size) {
+      size_t size = extra->cases_size ? extra->cases_size : 1024;
+      while (extra->cases_used + needed + 1 > size)
+         size *= 2;
+      char *cases = __real_realloc(extra->cases, size);
+      if (!cases)
          return;
+      extra->cases = cases;
+      extra->cases_size = size;
    }
 
    va_start(args, fmt);
-   vsnprintf(junit_testcase_xml + current_len, needed + 1, fmt, args);
+   vsnprintf(extra->cases + extra->cases_used, needed + 1, fmt, args);
    va_end(args);
+   extra->cases_used += needed;
 }
 
 static int get_hostname(char *buffer, size_t size) {
@@ -95,7 +87,7 @@ static int get_hostname(char *buffer, size_t size) {
 // Escape special XML characters in a string
 static char *xml_escape(const char *input) {
    if (!input)
-      return strdup("");
+      input = "";
 
    size_t len = strlen(input);
    size_t needed = len;
@@ -150,27 +142,11 @@ static char *xml_escape(const char *input) {
    return dst;
 }
 
-// Append formatted XML to the JUnit report
-static void junit_append(const char *fmt, ...) {
-   va_list args;
-   va_start(args, fmt);
-   int written = vsnprintf(junit_xml_buffer + junit_xml_used,
-                           JUNIT_XML_BUFFER_SIZE - junit_xml_used,
-                           fmt, args);
-   va_end(args);
-
-   if (written < 0 || (size_t)written >= JUNIT_XML_BUFFER_SIZE - junit_xml_used) {
-      // Truncate gracefully — never overflow
-      junit_xml_buffer[JUNIT_XML_BUFFER_SIZE - 1] = '\0';
-   } else {
-      junit_xml_used += written;
-   }
-}
-
 void junit_before_set(const TsInfo set, tc_context *context);
 void junit_after_set(const TsInfo set, tc_context *context);
 void junit_on_set_summary(const TsInfo set, tc_context *context, st_summary *summary);
 void junit_on_test_result(const TsInfo set, tc_context *context);
+void junit_on_param_result(const TsInfo set, tc_context *context, const st_param_results *results);
 void junit_on_start_test(tc_context *context);
 
 struct st_hooks_s junit_hooks = {
@@ -183,6 +159,7 @@ struct st_hooks_s junit_hooks = {
     .on_end_test = NULL,
     .on_error = NULL,
     .on_test_result = junit_on_test_result,
+    .on_param_result = junit_on_param_result,
     .on_memory_alloc = NULL,
     .on_memory_free = NULL,
     .on_set_summary = junit_on_set_summary,
@@ -190,9 +167,134 @@ struct st_hooks_s junit_hooks = {
     .context = NULL,
 };
 
+// hardware counters as testcase properties; counters the host could not measure are left out
+static void junit_append_perf(struct JunitExtraData *extra, const st_perf_counts *perf) {
+   const struct {
+      unsigned bit;
+      const char *name;
+      uint64_t value;
+   } counters[] = {
+       {PERF_CYCLES, "cycles", perf->cycles},
+       {PERF_INSTRUCTIONS, "instructions", perf->instructions},
+       {PERF_L1D_MISSES, "l1d_misses", perf->l1d_misses},
+       {PERF_LLC_MISSES, "llc_misses", perf->llc_misses},
+       {PERF_BRANCH_MISSES, "branch_misses", perf->branch_misses},
+   };
+   for (size_t i = 0; i < sizeof(counters) / sizeof(counters[0]); i++) {
+      if (perf->valid & counters[i].bit)
+         junit_append_testcase(extra, "        <property name=\"%s\" value=\"%llu\"/>\n",
+                               counters[i].name, (unsigned long long)counters[i].value);
+   }
+}
+// row counts, and each row that did not pass, as testcase properties
+static void junit_append_params(struct JunitExtraData *extra, const st_param_results *params) {
+   junit_append_testcase(extra, "        <property name=\"rows_passed\" value=\"%zu\"/>\n", params->passed);
+   junit_append_testcase(extra, "        <property name=\"rows_failed\" value=\"%zu\"/>\n", params->failed);
+   junit_append_testcase(extra, "        <property name=\"rows_skipped\" value=\"%zu\"/>\n", params->skipped);
+   char label[128];
+   for (size_t row = params->first; row < params->last; row++) {
+      const st_param_row *result = &params->rows[row];
+      if (result->state == PASS)
+         continue;
+      char *name = xml_escape(st_param_label(params, row, label, sizeof(label)));
+      char *message = xml_escape(result->message ? result->message : "");
+      junit_append_testcase(extra, "        <property name=\"row.%zu\" value=\"%s %s: %s\"/>\n", row,
+                            result->state == FAIL ? "FAIL" : "SKIP", name ? name : "", message ? message : "");
+      __real_free(name);
+      __real_free(message);
+   }
+}
+// Serialize one report record; runs on the report writer thread
+static void junit_write(const st_report_record *record, object data) {
+   struct JunitExtraData *extra = (struct JunitExtraData *)data;
+
+   switch (record->kind) {
+   case REPORT_CASE: {
+      extra->total_tests++;
+      // a case aborted at its budget is a failure of its own type
+      int failed = record->state == FAIL || record->state == TIMEOUT || record->state == OVERBUDGET;
+      if (failed) {
+         extra->failures++;
+      } else if (record->state == SKIP) {
+         extra->skipped++;
+      }
+      // For pass, just increment total_tests
+
+      char *name = xml_escape(record->name);
+      junit_append_testcase(extra, "    <testcase name=\"%s\" time=\"%.3f\"", name ? name : "", record->elapsed_ms / 1000.0);
+      if (!failed && record->state != SKIP && !record->bench && !record->perf && !record->params) {
+         junit_append_testcase(extra, "/>\n");
+         __real_free(name);
+
+         break;
+      }
+      junit_append_testcase(extra, ">\n");
+      if (record->bench || record->perf || record->params)
+         junit_append_testcase(extra, "      <properties>\n");
+      if (record->bench) {
+         const st_bench_stats *bench = record->bench;
+         junit_append_testcase(extra, "        <property name=\"iterations\" value=\"%zu\"/>\n", bench->iterations);
+         junit_append_testcase(extra, "        <property name=\"samples\" value=\"%zu\"/>\n", bench->samples);
+         junit_append_testcase(extra, "        <property name=\"ns_per_op\" value=\"%.3f\"/>\n", bench->ns_per_op);
+         junit_append_testcase(extra, "        <property name=\"min_ns\" value=\"%.3f\"/>\n", bench->min_ns);
+         junit_append_testcase(extra, "        <property name=\"median_ns\" value=\"%.3f\"/>\n", bench->median_ns);
+         junit_append_testcase(extra, "        <property name=\"p99_ns\" value=\"%.3f\"/>\n", bench->p99_ns);
+         junit_append_testcase(extra, "        <property name=\"stddev_ns\" value=\"%.3f\"/>\n", bench->stddev_ns);
+         if (bench->baseline_ns > 0) {
+            junit_append_testcase(extra, "        <property name=\"baseline_ns\" value=\"%.3f\"/>\n", bench->baseline_ns);
+            junit_append_testcase(extra, "        <property name=\"p_value\" value=\"%.4f\"/>\n", bench->p_value);
+            junit_append_testcase(extra, "        <property name=\"regressed\" value=\"%s\"/>\n", bench->regressed ? "true" : "false");
+         }
+      }
+      if (record->perf) {
+         junit_append_perf(extra, record->perf);
+      }
+      if (record->params) {
+         junit_append_params(extra, record->params);
+      }
+      if (record->bench || record->perf || record->params)
+         junit_append_testcase(extra, "      </properties>\n");
+      if (failed) {
+         char *message = xml_escape(record->message ? record->message : "Unknown failure");
+         const char *type = record->state == TIMEOUT ? " type=\"timeout\"" : record->state == OVERBUDGET ? " type=\"overbudget\"" : "";
+         junit_append_testcase(extra, "      <failure%s message=\"%s\">%s</failure>\n", type, message ? message : "", message ? message : "");
+         __real_free(message);
+      } else if (record->state == SKIP) {
+         junit_append_testcase(extra, "      <skipped/>\n");
+      }
+      junit_append_testcase(extra, "    </testcase>\n");
+      __real_free(name);
+
+      break;
+   }
+   case REPORT_SET_END: {
+      FILE *out = extra->file;
+      char *name = xml_escape(record->name);
+      fprintf(out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+      fprintf(out, "<testsuites>\n");
+      fprintf(out, "  <testsuite name=\"%s\" timestamp=\"%s\" hostname=\"%s\" "
+                   "tests=\"%d\" failures=\"%d\" skipped=\"%d\" time=\"%.3f\">\n",
+              name ? name : "", extra->timestamp, extra->hostname, extra->total_tests, extra->failures, extra->skipped,
+              record->elapsed_ms / 1000.0);
+      if (extra->cases_used) {
+         fwrite(extra->cases, 1, extra->cases_used, out);
+      }
+      fprintf(out, "  </testsuite>\n");
+      fprintf(out, "</testsuites>\n");
+      __real_free(name);
+
+      break;
+   }
+   case REPORT_SET_BEGIN:
+   case REPORT_NOTE:
+      // the testsuite header needs the totals; it is written with the set end
+      break;
+   }
+}
+
 void junit_before_set(const TsInfo set, tc_context *context) {
    struct JunitHookContext *ctx = (struct JunitHookContext *)context;
-   struct JunitExtraData *extra = __real_malloc(sizeof(struct JunitExtraData));
+   struct JunitExtraData *extra = __real_calloc(1, sizeof(struct JunitExtraData));
    if (!extra) {
       // Handle allocation failure
       return;
@@ -200,25 +302,22 @@ void junit_before_set(const TsInfo set, tc_context *context) {
    ctx->data = extra;
 
    extra->set = set;
-   extra->total_tests = 0;
-   extra->failures = 0;
-   extra->skipped = 0;
 
    if (sys_gettime(&extra->start_time) == -1) {
       // Handle error
    }
 
-   junit_file = fopen("reports/junit_report.xml", "w");
-   if (!junit_file) {
+   // each shard writes its own report; `merge_reports` combines them
+   char path[256];
+   extra->file = fopen(st_shard_path("reports/junit_report.xml", path, sizeof(path)), "w");
+   if (!extra->file) {
       // fallback to stdout
-      junit_file = stdout;
+      extra->file = stdout;
    }
 
    get_timestamp(extra->timestamp, "%Y-%m-%dT%H:%M:%SZ");
    get_hostname(extra->hostname, sizeof(extra->hostname));
-
-   junit_append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
-   junit_append("<testsuites>\n");
+   extra->writer = st_report_open(junit_write, extra);
 }
 
 void junit_on_set_summary(const TsInfo set, tc_context *context, st_summary *summary) {
@@ -228,47 +327,40 @@ void junit_on_set_summary(const TsInfo set, tc_context *context, st_summary *sum
    // Summary is handled in XML output in after_set
 }
 
+// Hand a record to the report writer, or serialize it in place without one
+static void junit_emit(struct JunitExtraData *extra, const st_report_record *record) {
+   if (extra->writer) {
+      st_report_push(extra->writer, record);
+   } else {
+      junit_write(record, extra);
+   }
+}
+
 void junit_after_set(const TsInfo set, tc_context *context) {
-   (void)set; // unused
    struct JunitHookContext *ctx = (struct JunitHookContext *)context;
    struct JunitExtraData *extra = (struct JunitExtraData *)ctx->data;
+   if (!extra)
+      return;
 
    ts_time end_time;
    if (sys_gettime(&end_time) == -1) {
       // Handle error
    }
-   double total_elapsed = get_elapsed_ms(&extra->start_time, &end_time) / 1000.0;
-
-   // Build the testsuite line with actual numbers
-   char testsuite_line[512];
-   sprintf(testsuite_line, "  <testsuite name=\"%s\" timestamp=\"%s\" hostname=\"%s\" "
-                           "tests=\"%d\" failures=\"%d\" skipped=\"%d\" time=\"%.3f\">\n",
-           set->name, extra->timestamp, extra->hostname, extra->total_tests, extra->failures, extra->skipped, total_elapsed);
-   junit_append("%s", testsuite_line);
-
-   // Append testcase XML
-   if (junit_testcase_xml) {
-      junit_append("%s", junit_testcase_xml);
-   }
-
-   // Close the testsuite
-   junit_append("  </testsuite>\n");
-   junit_append("</testsuites>\n");
-
-   // Final output
-   fprintf(junit_file, "%s", junit_xml_buffer);
-   if (junit_file != stdout) {
-      fclose(junit_file);
+   junit_emit(extra, &(st_report_record){
+                         .kind = REPORT_SET_END,
+                         .name = set->name,
+                         .elapsed_ms = get_elapsed_ms(&extra->start_time, &end_time),
+                     });
+   // the report is complete once the writer drains
+   st_report_close(extra->writer);
+
+   if (extra->file != stdout) {
+      fclose(extra->file);
    }
-
+   __real_free(extra->cases);
    extra->set = NULL;
    __real_free(extra);
    ctx->data = NULL;
-   if (junit_testcase_xml) {
-      __real_free(junit_testcase_xml);
-      junit_testcase_xml = NULL;
-      junit_testcase_allocated = 0;
-   }
 }
 
 void junit_on_start_test(tc_context *context) {
@@ -287,29 +379,22 @@ void junit_on_test_result(const TsInfo set, tc_context *context) {
    if (sys_gettime(&test_end) == -1) {
       // Handle error
    }
-   double test_elapsed = get_elapsed_ms(&extra->test_start, &test_end) / 1000.0;
 
-   extra->total_tests++;
-   if (set->tc_info->result.state == FAIL) {
-      extra->failures++;
-   } else if (set->tc_info->result.state == SKIP) {
-      extra->skipped++;
-   }
-   // For pass, just increment total_tests
-
-   // Append testcase XML
-   junit_append_testcase("    <testcase name=\"%s\" time=\"%.3f\"", xml_escape(set->tc_info->name), test_elapsed);
-   if (set->tc_info->result.state == FAIL) {
-      junit_append_testcase(">\n");
-      junit_append_testcase("      <failure message=\"%s\">%s</failure>\n",
-                            xml_escape(set->tc_info->result.message ? set->tc_info->result.message : "Unknown failure"),
-                            xml_escape(set->tc_info->result.message ? set->tc_info->result.message : "Unknown failure"));
-      junit_append_testcase("    </testcase>\n");
-   } else if (set->tc_info->result.state == SKIP) {
-      junit_append_testcase(">\n");
-      junit_append_testcase("      <skipped/>\n");
-      junit_append_testcase("    </testcase>\n");
-   } else {
-      junit_append_testcase("/>\n");
-   }
-}
\ No newline at end of file
+   st_report_record record = {
+       .kind = REPORT_CASE,
+       .state = set->tc_info->result.state,
+       .elapsed_ms = get_elapsed_ms(&extra->test_start, &test_end),
+       .name = set->tc_info->name,
+       .message = set->tc_info->result.message,
+       .bench = st_bench_result(set->tc_info),
+       .perf = set->tc_info->perf.valid ? &set->tc_info->perf : NULL,
+       .params = st_param_result(set->tc_info),
+   };
+   junit_emit(extra, &record);
+}
+void junit_on_param_result(const TsInfo set, tc_context *context, const st_param_results *results) {
+   // rows are written as testcase properties; keep the default text out of the report
+   (void)set;     // unused
+   (void)context; // unused
+   (void)results; // unused
+}
@@ -0,0 +1,214 @@
+/*
+ * SigmaTest
+ * Copyright (c) 2025 David Boarman (BadKraft) and contributors
+ * QuantumOverride [Q|]
+ * ----------------------------------------------
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * ----------------------------------------------
+ * File: perf_hooks.c
+ * Description: Source file for hardware performance counter hooks for SigmaTest
+ */
+#include "hooks/perf_hooks.h"
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+
+#define PERF_MAX_COUNTERS 5
+
+// counters in group order; the first one that opens leads the group
+static const struct {
+   PerfCounter bit;
+   uint32_t type;
+   uint64_t config;
+} PERF_EVENTS[PERF_MAX_COUNTERS] = {
+    {PERF_CYCLES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_L1D_MISSES, PERF_TYPE_HW_CACHE,
+     PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_LLC_MISSES, PERF_TYPE_HW_CACHE,
+     PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_BRANCH_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+// one counter group per runner thread; counters follow the thread that opened them
+typedef struct {
+   int leader;                     // group leader fd; -1 while closed
+   int fds[PERF_MAX_COUNTERS];     // member fds in read order
+   PerfCounter bits[PERF_MAX_COUNTERS];
+   int count;                      // counters in the group
+   int failed;                     // nothing could be opened for this set
+} perf_group;
+
+static _Thread_local perf_group group = {.leader = -1};
+static struct st_hooks_s inner_hooks; // the wrapped hooks
+static ST_Hooks wrapped = NULL;       // the hook set inner_hooks was copied from
+static int warned = 0;
+
+static struct st_hooks_s perf_hooks; // the wrapped hooks with the counter callbacks swapped in
+
+static int perf_open(uint32_t type, uint64_t config, int leader) {
+   struct perf_event_attr attr;
+   memset(&attr, 0, sizeof(attr));
+   attr.size = sizeof(attr);
+   attr.type = type;
+   attr.config = config;
+   attr.disabled = leader == -1; // members follow the leader
+   attr.exclude_kernel = 1;
+   attr.exclude_hv = 1;
+   attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+   return (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+}
+static void perf_close(perf_group *g) {
+   for (int i = 0; i < g->count; i++)
+      close(g->fds[i]);
+   g->leader = -1;
+   g->count = 0;
+}
+static int perf_group_open(perf_group *g) {
+   int error = 0;
+   for (int i = 0; i < PERF_MAX_COUNTERS; i++) {
+      int fd = perf_open(PERF_EVENTS[i].type, PERF_EVENTS[i].config, g->leader);
+      if (fd < 0) {
+         if (!error)
+            error = errno;
+         continue;
+      }
+      if (g->leader == -1)
+         g->leader = fd;
+      g->fds[g->count] = fd;
+      g->bits[g->count] = PERF_EVENTS[i].bit;
+      g->count++;
+   }
+   if (g->leader == -1) {
+      g->failed = 1;
+      if (!warned) {
+         warned = 1;
+         DebugLogger.flog(stderr, "Warning: Hardware counters are unavailable (%s); tests run unmeasured", strerror(error));
+      }
+      return -1;
+   }
+   return 0;
+}
+
+unsigned perf_hooks_available(void) {
+   perf_group probe = {.leader = -1};
+   int was_warned = warned;
+   warned = 1; // probing is silent
+   unsigned bits = 0;
+   if (perf_group_open(&probe) == 0) {
+      for (int i = 0; i < probe.count; i++)
+         bits |= probe.bits[i];
+      perf_close(&probe);
+   }
+   warned = was_warned;
+   return bits;
+}
+ST_Hooks perf_hooks_wrap(ST_Hooks inner) {
+   ST_Hooks target = inner ? inner : init_hooks("default");
+   // the callbacks get the wrapped hooks' own context, so they can forward to one hook set only
+   if (wrapped) {
+      if (wrapped == target)
+         return &perf_hooks;
+      DebugLogger.flog(stderr, "Error: The perf hooks already wrap '%s' and cannot also wrap '%s'",
+                       wrapped->name ? wrapped->name : "(unnamed)", target->name ? target->name : "(unnamed)");
+      return NULL;
+   }
+   wrapped = target;
+   inner_hooks = *target;
+   // every callback and the context are those of the wrapped hooks; the core passes the
+   // wrapped context straight through and fills in its defaults as usual
+   perf_hooks = *target;
+   perf_hooks.name = "perf";
+   perf_hooks.after_set = perf_after_set;
+   perf_hooks.on_start_test = perf_on_start_test;
+   perf_hooks.on_end_test = perf_on_end_test;
+   return &perf_hooks;
+}
+
+void perf_after_set(const TsInfo set, tc_context *context) {
+   if (inner_hooks.after_set)
+      inner_hooks.after_set(set, context);
+   perf_close(&group);
+   group.failed = 0; // retry with the next set
+}
+void perf_on_start_test(tc_context *context) {
+   if (inner_hooks.on_start_test) {
+      inner_hooks.on_start_test(context);
+   } else {
+      ST_Hooks defaults = init_hooks("default");
+      defaults->on_start_test(context);
+   }
+
+   TcInfo tc = st_current_case();
+   if (tc)
+      memset(&tc->perf, 0, sizeof(st_perf_counts));
+   // the runner process does not execute isolated cases; its counts would be meaningless
+   if (runner_options.isolate || group.failed)
+      return;
+   if (group.leader == -1 && perf_group_open(&group) != 0)
+      return;
+   // enable last so the wrapped hook's output is not counted
+   ioctl(group.leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+   ioctl(group.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+void perf_on_end_test(tc_context *context) {
+   if (group.leader != -1) {
+      ioctl(group.leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+      // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, value[nr]
+      uint64_t values[3 + PERF_MAX_COUNTERS];
+      ssize_t size = read(group.leader, values, sizeof(values));
+      TcInfo tc = st_current_case();
+      if (size >= (ssize_t)(3 * sizeof(uint64_t)) && values[2] > 0 && tc) {
+         st_perf_counts *perf = &tc->perf;
+         // scale up when the kernel multiplexed the group with other events
+         double scale = values[2] < values[1] ? (double)values[1] / (double)values[2] : 1.0;
+         for (uint64_t i = 0; i < values[0] && i < (uint64_t)group.count; i++) {
+            uint64_t value = (uint64_t)((double)values[3 + i] * scale);
+            switch (group.bits[i]) {
+            case PERF_CYCLES:
+               perf->cycles = value;
+               break;
+            case PERF_INSTRUCTIONS:
+               perf->instructions = value;
+               break;
+            case PERF_L1D_MISSES:
+               perf->l1d_misses = value;
+               break;
+            case PERF_LLC_MISSES:
+               perf->llc_misses = value;
+               break;
+            case PERF_BRANCH_MISSES:
+               perf->branch_misses = value;
+               break;
+            }
+            perf->valid |= group.bits[i];
+         }
+      }
+   }
+
+   if (inner_hooks.on_end_test) {
+      inner_hooks.on_end_test(context);
+   } else {
+      ST_Hooks defaults = init_hooks("default");
+      defaults->on_end_test(context);
+   }
+}
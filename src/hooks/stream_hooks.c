@@ -0,0 +1,205 @@
+/*
+ * SigmaTest
+ * Copyright (c) 2025 David Boarman (BadKraft) and contributors
+ * QuantumOverride [Q|]
+ * ----------------------------------------------
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * ----------------------------------------------
+ * ----------------------------------------------
+ * File: stream_hooks.c
+ * Description: Source file for binary result stream hooks for SigmaTest
+ */
+#include "hooks/stream_hooks.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+   Test hooks writing results as compact binary records for offline conversion
+   (`tools/stream_report.c`) or a collector listening on a Unix socket. A record is a copy of
+   fixed fields and two strings, so it is written in place rather than on a report writer.
+ */
+
+extern int sys_gettime(ts_time *);
+extern size_t _sigtest_alloc_count;
+extern size_t _sigtest_free_count;
+
+#define STREAM_SOCKET_PREFIX "unix:"
+
+struct st_hooks_s stream_hooks = {
+    .name = "stream",
+    .before_set = stream_before_set,
+    .after_set = stream_after_set,
+    .before_test = NULL,
+    .after_test = NULL,
+    .on_start_test = stream_on_start_test,
+    .on_end_test = NULL,
+    .on_error = NULL,
+    .on_test_result = stream_on_test_result,
+    .on_memory_alloc = NULL,
+    .on_memory_free = NULL,
+    .on_set_summary = NULL,
+    .on_debug_log = NULL,
+    .on_bench_result = NULL,
+    .on_param_result = stream_on_param_result,
+    .context = NULL,
+};
+
+static uint64_t elapsed_ns(const ts_time *start, const ts_time *end) {
+   return (uint64_t)(end->tv_sec - start->tv_sec) * 1000000000ull + (uint64_t)end->tv_nsec - (uint64_t)start->tv_nsec;
+}
+// connect to a collector's Unix socket
+static FILE *stream_connect(const char *path) {
+   struct sockaddr_un addr = {.sun_family = AF_UNIX};
+   if (strlen(path) >= sizeof(addr.sun_path)) {
+      DebugLogger.flog(stderr, "Error: Socket path too long: %s", path);
+      return NULL;
+   }
+   strcpy(addr.sun_path, path);
+
+   int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+      DebugLogger.flog(stderr, "Error: Failed to connect to %s", path);
+      if (fd >= 0)
+         close(fd);
+      return NULL;
+   }
+   return fdopen(fd, "w");
+}
+// Open the target once; the stream header goes first
+static FILE *stream_open(struct StreamHookContext *ctx) {
+   FILE *out;
+   if (!ctx->target) {
+      out = st_log_stream();
+   } else if (strncmp(ctx->target, STREAM_SOCKET_PREFIX, strlen(STREAM_SOCKET_PREFIX)) == 0) {
+      out = stream_connect(ctx->target + strlen(STREAM_SOCKET_PREFIX));
+   } else {
+      // each shard writes its own stream
+      char path[256];
+      out = fopen(st_shard_path(ctx->target, path, sizeof(path)), "wb");
+      if (!out)
+         DebugLogger.flog(stderr, "Error: Failed to open result stream %s", ctx->target);
+   }
+   if (!out)
+      return NULL;
+
+   st_stream_header header = {
+       .magic = ST_STREAM_MAGIC,
+       .version = ST_STREAM_VERSION,
+       .record_size = sizeof(st_stream_record),
+       .order = ST_STREAM_ORDER,
+   };
+   fwrite(&header, sizeof(header), 1, out);
+   return out;
+}
+// Write one record with its strings, padded to the next 8 byte boundary
+static void stream_write(struct StreamHookContext *ctx, st_stream_record *record, const char *name, const char *message) {
+   static const char padding[8] = {0};
+   size_t name_len = name ? strlen(name) + 1 : 0;
+   size_t message_len = message ? strlen(message) + 1 : 0;
+   size_t length = sizeof(*record) + name_len + message_len;
+   size_t padded = (length + 7) & ~(size_t)7;
+
+   record->length = (uint32_t)padded;
+   record->name = name ? sizeof(*record) : 0;
+   record->message = message ? sizeof(*record) + name_len : 0;
+   fwrite(record, sizeof(*record), 1, ctx->out);
+   if (name_len)
+      fwrite(name, 1, name_len, ctx->out);
+   if (message_len)
+      fwrite(message, 1, message_len, ctx->out);
+   if (padded > length)
+      fwrite(padding, 1, padded - length, ctx->out);
+}
+
+void stream_before_set(const TsInfo set, tc_context *context) {
+   struct StreamHookContext *ctx = (struct StreamHookContext *)context;
+   // a shared target stays open across sets; a set log stream is the set's own
+   if (!ctx->target || !ctx->out)
+      ctx->out = stream_open(ctx);
+   ctx->case_id = 0;
+   sys_gettime(&ctx->set_start);
+   if (!ctx->out)
+      return;
+
+   struct timespec now;
+   clock_gettime(CLOCK_REALTIME, &now);
+   st_stream_record record = {
+       .kind = STREAM_SET_BEGIN,
+       .set_id = ctx->set_id,
+       .time_ns = (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec,
+   };
+   char hostname[256] = "localhost";
+   gethostname(hostname, sizeof(hostname) - 1);
+   stream_write(ctx, &record, set->name, hostname);
+}
+void stream_after_set(const TsInfo set, tc_context *context) {
+   struct StreamHookContext *ctx = (struct StreamHookContext *)context;
+   if (ctx->out) {
+      ts_time end;
+      sys_gettime(&end);
+      st_stream_record record = {
+          .kind = STREAM_SET_END,
+          .set_id = ctx->set_id,
+          .case_id = ctx->case_id,
+          .time_ns = elapsed_ns(&ctx->set_start, &end),
+          .allocs = _sigtest_alloc_count,
+          .frees = _sigtest_free_count,
+      };
+      stream_write(ctx, &record, set->name, NULL);
+      fflush(ctx->out);
+   }
+   if (!ctx->target)
+      ctx->out = NULL; // closed by the runner with the set
+   ctx->set_id++;
+}
+void stream_on_start_test(tc_context *context) {
+   struct StreamHookContext *ctx = (struct StreamHookContext *)context;
+   sys_gettime(&ctx->test_start);
+}
+void stream_on_test_result(const TsInfo set, tc_context *context) {
+   struct StreamHookContext *ctx = (struct StreamHookContext *)context;
+   ts_time end;
+   sys_gettime(&end);
+   if (!ctx->out)
+      return;
+
+   size_t allocs, frees;
+   st_case_allocs(&allocs, &frees);
+   st_stream_record record = {
+       .kind = STREAM_CASE,
+       .state = (uint8_t)set->tc_info->result.state,
+       .set_id = ctx->set_id,
+       .case_id = ctx->case_id++,
+       .time_ns = elapsed_ns(&ctx->test_start, &end),
+       .allocs = allocs,
+       .frees = frees,
+   };
+   stream_write(ctx, &record, set->tc_info->name, set->tc_info->result.message);
+}
+void stream_on_param_result(const TsInfo set, tc_context *context, const st_param_results *results) {
+   // the case record carries the summary; keep the default text out of the stream
+   (void)set;     // unused
+   (void)context; // unused
+   (void)results; // unused
+}
@@ -24,30 +24,55 @@
  * File: sigtest.c
  * Description: Source file for SigmaTest core interfaces and implementations
  */
+#define _GNU_SOURCE // for dladdr
 #include "sigtest.h"
 #include "fuzzing.h"
 #include "internal/logging.h"
 #include "internal/runner_states.h"
 #include <assert.h>
+#include <ctype.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <fcntl.h>
 #include <float.h> //	for FLT_EPSILON && DBL_EPSILON
+#include <fnmatch.h>
+#include <link.h> // for ElfW
+#include <limits.h>
 #include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <regex.h>
 #include <setjmp.h>
+#include <signal.h>
 #include <stdarg.h>
 #include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h> // 	for jmp_buf and related functions
 #include <strings.h>
+#include <sys/auxv.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 #define SIGMATEST_VERSION "1.00.1-pre"
 
 // Global test set "registry"
 TestSet test_sets = NULL;
-static TestSet current_set = NULL;
+// Executing (or registering) test set; one per runner thread
+static _Thread_local TestSet current_set = NULL;
 
-// Static buffer for jump
-static jmp_buf jmpbuffer;
+// Per-thread buffer for jump
+static _Thread_local jmp_buf jmpbuffer;
 
 // Forward declaration for DebugLogger
 extern const st_logger_s DebugLogger;
@@ -63,6 +88,8 @@ const char *TEST_STATES[] = {
     "PASS",
     "FAIL",
     "SKIP",
+    "TIMEOUT",
+    "OVERBUDGET",
     NULL,
 };
 // For dynamic log level annotation
@@ -79,32 +106,107 @@ static const char *DBG_LEVELS[] = {
 #define CLOCK_MONOTONIC 1
 
 static ST_Hooks current_hooks = {0};
-static atomic_size_t global_allocs = 0;
-static atomic_size_t global_frees = 0;
-static int inside_test = 0;
-static int set_started = 0;
-static TestCase current_tc = NULL;
+/*
+ * Allocation counters
+ * Each thread counts into its own cache-line sized slot so allocation-heavy threads never
+ * share a line; slots are swept into the totals when a test case finishes. An exiting thread
+ * hands its pending counts to the shared slot and frees its slot for the next thread, so only
+ * threads beyond ST_ALLOC_SLOTS alive at once share it.
+ */
+#define ST_CACHE_LINE 64
+#define ST_ALLOC_SLOTS 64
+typedef struct st_alloc_slot_s {
+   _Alignas(ST_CACHE_LINE) atomic_size_t allocs;
+   atomic_size_t frees;
+} st_alloc_slot;
+static st_alloc_slot alloc_slots[ST_ALLOC_SLOTS + 1]; /* The last one is shared */
+static atomic_int alloc_slots_used = 0;                /* Slots ever claimed, at most ST_ALLOC_SLOTS */
+static int alloc_slots_free[ST_ALLOC_SLOTS];           /* Slots released by exited threads */
+static int alloc_slots_free_count = 0;
+static pthread_mutex_t alloc_slots_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t alloc_slot_key;
+static _Thread_local st_alloc_slot *alloc_slot __attribute__((tls_model("initial-exec"))) = NULL;
+static _Thread_local int inside_test = 0;
+/*
+ * Framework code that takes locks (the memory wrappers, assertions and log writes) must not be
+ * unwound by an exceeded time budget: a budget signal arriving inside it only marks the jump
+ * pending, and the outermost BUDGET_RELEASE takes it once the locks are released.
+ */
+static _Thread_local struct {
+   volatile sig_atomic_t depth;   /* Nesting of held framework calls */
+   volatile sig_atomic_t pending; /* A budget was exceeded while held */
+} budget_hold __attribute__((tls_model("initial-exec")));
+static void budget_unwind(void);
+#define BUDGET_HOLD() (budget_hold.depth++)
+#define BUDGET_RELEASE()                                     \
+   do {                                                      \
+      if (--budget_hold.depth == 0 && budget_hold.pending)   \
+         budget_unwind();                                    \
+   } while (0)
+// the current line of the set log holds test output without a newline yet
+static _Thread_local int line_open = 0;
+static _Thread_local int set_started = 0;
+static _Thread_local TestCase current_tc = NULL;
+static _Thread_local TestCase worker_case = NULL; /* Copy of the case a fuzz or row worker thread reports into */
+// Context handed to hooks by the executing runner thread
+static _Thread_local tc_context *current_ctx = NULL;
 size_t _sigtest_alloc_count = 0;
 size_t _sigtest_free_count = 0;
+// Guards the aggregate allocation counters when sets run in parallel
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Runner options
+st_options runner_options = {
+    .jobs = 1,
+    .bench_tolerance = 5,
+};
 
 int sys_gettime(ts_time *ts) {
    return clock_gettime(CLOCK_MONOTONIC, ts);
 }
 double get_elapsed_ms(ts_time *start, ts_time *end) {
-   return (end->tv_nsec - start->tv_nsec) / 1000.0;
+   return (double)(end->tv_sec - start->tv_sec) * 1000.0 + (end->tv_nsec - start->tv_nsec) / 1000000.0;
 }
 //	internal logger declarations
 // internal clean up
 static void default_on_testcase_finish(void);
 static void default_on_testset_finished(void);
+static void leak_reset(void);
+static void install_crash_flush(void);
 // hooks registry
 static HookRegistry *hook_registry = NULL;
 
+// Benchmark sampling (bench_testcase)
+#define ST_BENCH_SAMPLES 50             // timed samples per benchmark
+#define ST_BENCH_WARMUP 3               // untimed samples ahead of them
+#define ST_BENCH_SAMPLE_NS 1000000ULL   // calibrated duration of one sample (1 ms)
+#define ST_BENCH_BUDGET_NS 2000000000ULL // sampling stops earlier for slow functions (2 s)
+typedef struct st_bench_run_s {
+   st_bench_stats stats;
+   double samples[ST_BENCH_SAMPLES];
+} st_bench_run;
+
 /*
  * Test case structure
- * Encapsulates the name of the test and the test case function pointer
+ * Encapsulates the name of the test and the test case function pointer. Cases live in the
+ * flat case registry; the fields the runner reads for every case come first, names and
+ * messages are stored out of line.
  */
 typedef struct st_case_s {
+   // encapsulate fuzzy test function pointer
+   union {
+      TestFunc test;   /* Regular test function */
+      FuzzyFunc fuzz;  /* Fuzzy test function */
+      ParamFunc param; /* Parameterized test function */
+   } func;
+   unsigned expect_fail : 1;  /* Expect failure flag */
+   unsigned expect_throw : 1; /* Expect throw flag */
+   unsigned is_fuzz : 1;      /* Is fuzz test flag */
+   unsigned is_bench : 1;     /* Is benchmark flag */
+   unsigned is_param : 1;     /* Is parameterized test flag */
+   unsigned selected : 1;     /* Selected by --filter/--tag */
+   FuzzType fuzz_type;        /* Fuzz input type */
+   uint64_t tags;             /* Tag bits (see tag_testcase) */
    struct {
       string name;
       struct {
@@ -112,22 +214,36 @@ typedef struct st_case_s {
          string message;
       } result;
       int has_next;
+      size_t index;
+      st_perf_counts perf;
    } info;
-   TestFunc test_func; /* Test function pointer */
-   // encapsulate fuzzy test function pointer
-   union {
-      TestFunc test;  /* Regular test function */
-      FuzzyFunc fuzz; /* Fuzzy test function */
-   } func;
-   int expect_fail;    /* Expect failure flag */
-   int expect_throw;   /* Expect throw flag */
-   int is_fuzz;        /* Is fuzz test flag */
-   FuzzType fuzz_type; /* Fuzz input type */
-   TestCase next;      /* Pointer to the next test case */
+   TestSet set; /* Owning test set */
    int ran_no_newline;
    int had_debug;
    int running_len;
+   int iso_setup_failed; /* Setup died in the isolation worker */
+   size_t leak_live;     /* Bytes allocated by the case and not yet freed (--track-leaks) */
+   size_t leak_peak;     /* Peak of leak_live */
+   st_budget budget;     /* Limits set by budget_testcase */
+   int budget_hit;       /* BUDGET_* limit the case exceeded, or 0 */
+   size_t budget_allocs; /* Allocations charged to the case */
+   double elapsed_ms;    /* Wall time of setup, body and teardown, recorded in the --history file */
+   struct st_fixture_use_s *fixtures; /* Fixtures the case uses (fixture_testcase) */
+   struct st_cross_s *cross;          /* Failure and output reported by threads of test code */
+   int profiled;                      /* Its profile was written in this run (--profile) */
+   struct st_bench_run_s *bench; /* Benchmark statistics and samples (bench_testcase) */
+   st_param_results *params;     /* Row table and row results (param_testcase) */
 } st_case_s;
+/*
+ * Case registry
+ * Every registered case in registration order; each set owns the contiguous range
+ * [first, first + count). Grown while constructors register cases, fixed once tests run.
+ */
+static struct {
+   st_case_s *cases;
+   size_t count;
+   size_t capacity;
+} registry = {0};
 /**
  * @brief Test set structure for global setup and cleanup
  */
@@ -139,18 +255,33 @@ typedef struct st_set_s {
       int passed;     /* Number of passed test cases */
       int failed;     /* Number of failed test cases */
       int skipped;    /* Number of skipped test cases */
+      int regressed;  /* Number of failed cases that are benchmark regressions */
    } info;
+   ConfigFunc config;   /* Test set config function; deferred until the set runs */
    CleanupFunc cleanup; /* Test set cleanup function */
    CaseOp setup;        /* Test case setup function */
    CaseOp teardown;     /* Test case teardown function */
+   struct st_fixture_use_s *fixtures; /* Fixtures every case of the set uses (fixture_testset) */
    FILE *log_stream;    /* Log stream for the test set */
-   TestCase cases;      /* Pointer to the test cases */
-   TestCase tail;       /* Pointer to the last test case */
+   size_t first;        /* Registry index of the first test case */
    TestCase current;    /* Current test case */
    TestSet next;        /* Pointer to the next test set */
    ST_Hooks hooks;      /* Hooks for the test set */
    Logger logger;       /* Logger for the test set */
+   uint64_t tags;       /* Tag bits inherited by every case of the set */
+   st_budget budget;    /* Limits of every case of the set (budget_testset) */
+   int selected;        /* Number of selected test cases */
+   size_t last;         /* Index (within the set) of the last selected case in run order */
+   size_t *order;       /* Run order of the case indexes (--order), or NULL for registration order */
+   int configured;      /* Config has run */
+   FILE *pending;       /* Log output written before config ran */
+   char *pending_buf;
+   size_t pending_len;
 } st_set_s;
+// the case at a run position of the set
+static inline TestCase set_case(TestSet set, size_t position) {
+   return &registry.cases[set->first + (set->order ? set->order[position] : position)];
+}
 
 /*
  * hook_ctx_t - shared hook context structure
@@ -179,6 +310,78 @@ typedef struct hook_ctx_s {
    int running_len;
 } hook_ctx_t;
 
+/*
+ * Runner arena
+ * Sets, cases, hook registry entries, names and result messages live until the runner is torn
+ * down, so they are bump-allocated from zeroed chunks and released with one call in
+ * cleanup_test_runner. Requests larger than a quarter chunk get a chunk of their own.
+ */
+#define ARENA_CHUNK_SIZE (64 * 1024)
+
+typedef struct st_arena_chunk_s {
+   struct st_arena_chunk_s *next;
+   size_t used;
+   size_t size;
+   _Alignas(max_align_t) char data[];
+} st_arena_chunk;
+
+static st_arena_chunk *arena_head = NULL; // current chunk is always at the head
+static pthread_mutex_t arena_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// allocate zeroed memory that lives until arena_release
+static void *arena_alloc(size_t size) {
+   const size_t align = _Alignof(max_align_t);
+   size = (size + align - 1) & ~(align - 1);
+
+   pthread_mutex_lock(&arena_lock);
+   st_arena_chunk *chunk = arena_head;
+   if (!chunk || chunk->size - chunk->used < size) {
+      size_t capacity = size > ARENA_CHUNK_SIZE / 4 ? size : ARENA_CHUNK_SIZE;
+      chunk = __real_calloc(1, sizeof(st_arena_chunk) + capacity);
+      if (!chunk) {
+         pthread_mutex_unlock(&arena_lock);
+         return NULL;
+      }
+      chunk->size = capacity;
+      if (capacity > ARENA_CHUNK_SIZE || !arena_head) {
+         // oversized chunks go behind the current one so its free space is not abandoned
+         chunk->next = arena_head ? arena_head->next : NULL;
+         if (arena_head)
+            arena_head->next = chunk;
+         else
+            arena_head = chunk;
+      } else {
+         chunk->next = arena_head;
+         arena_head = chunk;
+      }
+   }
+
+   void *p = chunk->data + chunk->used;
+   chunk->used += size;
+   pthread_mutex_unlock(&arena_lock);
+
+   return p;
+}
+static string arena_strdup(const char *str) {
+   size_t len = strlen(str) + 1;
+   string copy = arena_alloc(len);
+   if (copy)
+      memcpy(copy, str, len);
+   return copy;
+}
+// release everything allocated from the arena
+static void arena_release(void) {
+   pthread_mutex_lock(&arena_lock);
+   st_arena_chunk *chunk = arena_head;
+   while (chunk) {
+      st_arena_chunk *next = chunk->next;
+      __real_free(chunk);
+      chunk = next;
+   }
+   arena_head = NULL;
+   pthread_mutex_unlock(&arena_lock);
+}
+
 //	Implementations for internal helpers
 /**
  * Formats the current time into a buffer using the specified format
@@ -196,7 +399,6 @@ static void print_sep(FILE *stream, int width) {
    for (int i = 0; i < width; ++i)
       fputc('=', stream);
    fputc('\n', stream);
-   fflush(stream);
 }
 // Initialize hooks with the given name/label
 ST_Hooks init_hooks(const char *name) {
@@ -212,19 +414,18 @@ ST_Hooks init_hooks(const char *name) {
       }
    }
    // or create a new one
-   ST_Hooks hooks = __real_malloc(sizeof(struct st_hooks_s));
+   ST_Hooks hooks = arena_alloc(sizeof(struct st_hooks_s));
+   string hooks_name = hooks ? arena_strdup(name) : NULL;
    if (!hooks) {
       fwritelnf(stderr, "Error: Failed to allocate memory for hooks");
       return NULL; // Memory allocation failed
    }
-   hooks->name = strdup(name);
-   if (!hooks->name) {
+   if (!hooks_name) {
       fwritelnf(stderr, "Error: Failed to duplicate hook name");
-      __real_free(hooks);
       return NULL; // Memory allocation failed
    }
    *hooks = (struct st_hooks_s){
-       .name = strdup(name),
+       .name = hooks_name,
        .before_set = NULL,
        .after_set = NULL,
        .before_test = NULL,
@@ -246,95 +447,109 @@ static void cleanup_test_runner(void) {
    if (!test_sets)
       return; // Already cleaned up
 
-   TestSet set = test_sets;
-   while (set) {
-      TestSet next = set->next;
-      // __real_free test cases
-      TestCase tc = set->cases;
-      while (tc) {
-         TestCase next_tc = tc->next;
-         __real_free(tc->info.name);
-         if (tc->info.result.message)
-            __real_free(tc->info.result.message);
-
-         __real_free(tc);
-         tc = next_tc;
-      }
-
-      // __real_free test set
-      __real_free(set->info.name);
-      if (set->log_stream != stdout && set->log_stream) {
+   // close set log streams; sets, cases, names and messages all go with the arena
+   for (TestSet set = test_sets; set; set = set->next) {
+      if (set->pending) {
+         // never configured: the held output goes with it
+         fclose(set->pending);
+         __real_free(set->pending_buf); // allocated by open_memstream
+      } else if (set->log_stream != stdout && set->log_stream) {
          fclose(set->log_stream);
-         set->log_stream = NULL;
       }
-
-      __real_free(set);
-      set = next;
+      set->log_stream = NULL;
+      set->pending = NULL;
    }
    /* do not free logger pointer here - logger may point to static data */
 
-   // Reset the test set registry
+   // Reset the test set and hooks registries
    test_sets = NULL;
    current_set = NULL;
+   hook_registry = NULL;
+   current_hooks = NULL;
+   __real_free(registry.cases);
+   registry.cases = NULL;
+   registry.count = registry.capacity = 0;
+   arena_release();
+   leak_reset();
 }
-//	generate formatted message
-static string format_msg(const string fmt, va_list args) {
-   static char msg_buffer[256];
-   vsnprintf(msg_buffer, sizeof(msg_buffer), fmt ? fmt : "", args);
-
-   return msg_buffer;
+static void cross_fail(TestState, const string);
+void set_test_context(TestState result, const string message) {
+   TestCase tc = worker_case ? worker_case : current_set ? current_set->current : NULL;
+   // a thread of the code under test has no runner frame to unwind into
+   if (!tc) {
+      cross_fail(result, message);
+   } else {
+      BUDGET_HOLD();
+      tc->info.result.state = result;
+      tc->info.result.message = message ? arena_strdup(message) : NULL;
+      if (result != PASS) {
+         // Stop assertions for this test; a pending budget is reported by budget_disarm
+         budget_hold.depth--;
+         budget_hold.pending = 0;
+         longjmp(jmpbuffer, 1);
+      }
+      BUDGET_RELEASE();
+   }
 }
-// get defined message or default message
-// format_message was inlined into specific assert handlers; removed unused helper
-// generate message for assertEquals
-static string gen_equals_fail_msg(object expected, object actual, AssertType type, const string fmt, va_list args) {
-   static char msg_buffer[256];
-   char exp_str[20], act_str[20];
-
+/*
+ * Assertion failure messages
+ * Passing assertions never format: each check compares first and only a failure builds its
+ * message, into a per-thread buffer that holds the failure of the test running on that
+ * thread until set_test_context copies it into the arena.
+ */
+#define ST_MESSAGE_SIZE 1024
+#define MESSAGE_SEPARATOR "\n    - "
+
+static _Thread_local char fail_buffer[ST_MESSAGE_SIZE];
+
+// compose "<check>\n    - <user message>"; an empty user message leaves the check alone
+static string fail_message(const char *check, const string fmt, va_list args) {
+   int used = snprintf(fail_buffer, sizeof(fail_buffer), "%s" MESSAGE_SEPARATOR, check);
+   if (used >= (int)sizeof(fail_buffer))
+      return fail_buffer;
+   if (fmt)
+      vsnprintf(fail_buffer + used, sizeof(fail_buffer) - used, fmt, args);
+   if (!fmt || fail_buffer[used] == '\0')
+      fail_buffer[used - (int)strlen(MESSAGE_SEPARATOR)] = '\0';
+   return fail_buffer;
+}
+// report a failed check with the caller's message
+static void fail_with(TestState state, const char *check, const string fmt, va_list args) {
+   set_test_context(state, fail_message(check, fmt, args));
+}
+// format a typed value for assertEquals
+static void format_value(char *buf, size_t size, object value, AssertType type) {
    switch (type) {
    case INT:
-      snprintf(exp_str, sizeof(exp_str), "%d", *(int *)expected);
-      snprintf(act_str, sizeof(act_str), "%d", *(int *)actual);
-
+      snprintf(buf, size, "%d", *(int *)value);
+      break;
+   case LONG:
+      snprintf(buf, size, "%ld", *(long *)value);
       break;
    case FLOAT:
-      snprintf(exp_str, sizeof(exp_str), "%.5f", *(float *)expected);
-      snprintf(act_str, sizeof(act_str), "%.5f", *(float *)actual);
-
+      snprintf(buf, size, "%.5f", *(float *)value);
       break;
    case DOUBLE:
-      snprintf(exp_str, sizeof(exp_str), "%.5f", *(double *)expected);
-      snprintf(act_str, sizeof(act_str), "%.5f", *(double *)actual);
-
+      snprintf(buf, size, "%.5f", *(double *)value);
       break;
    case CHAR:
-      snprintf(exp_str, sizeof(exp_str), "%c", *(char *)expected);
-      snprintf(act_str, sizeof(act_str), "%c", *(char *)actual);
-
+      snprintf(buf, size, "%c", *(char *)value);
       break;
    case STRING:
-      strncpy(exp_str, (string)expected, sizeof(exp_str) - 1);
-      exp_str[sizeof(exp_str) - 1] = '\0';
-      strncpy(act_str, (string)actual, sizeof(act_str) - 1);
-      act_str[sizeof(act_str) - 1] = '\0';
-
+      snprintf(buf, size, "%.19s", (string)value);
       break;
    case PTR:
-      snprintf(exp_str, sizeof(exp_str), "%p", expected);
-      snprintf(act_str, sizeof(act_str), "%p", actual);
-
+      snprintf(buf, size, "%p", value);
       break;
-   default:
-      return "Unsupported type for comparison";
-   }
-
-   string user_msg = fmt ? format_msg(fmt, args) : "";
-   snprintf(msg_buffer, sizeof(msg_buffer), MESSAGE_EQUAL_FAIL, exp_str, act_str);
-   if (user_msg[0] != '\0') {
-      strncat(msg_buffer, "\n    - ", sizeof(msg_buffer) - strlen(msg_buffer) - 1);
-      strncat(msg_buffer, user_msg, sizeof(msg_buffer) - strlen(msg_buffer) - 1);
    }
-   return msg_buffer;
+}
+// report a failed assertEquals
+static void fail_equals(object expected, object actual, AssertType type, const string fmt, va_list args) {
+   char exp_str[32], act_str[32], check[96];
+   format_value(exp_str, sizeof(exp_str), expected, type);
+   format_value(act_str, sizeof(act_str), actual, type);
+   snprintf(check, sizeof(check), MESSAGE_EQUAL_FAIL, exp_str, act_str);
+   fail_with(FAIL, check, fmt, args);
 }
 // format fuzz value for logging
 static void format_fuzz_value(FuzzType type, const void *ptr, char *buf, size_t bufsize) {
@@ -358,23 +573,19 @@ static void format_fuzz_value(FuzzType type, const void *ptr, char *buf, size_t
    case FUZZ_BYTE:
       snprintf(buf, bufsize, "%d", (int)*(const signed char *)ptr);
       break;
+   case FUZZ_BUFFER: {
+      const FuzzBuffer *input = ptr;
+      int used = snprintf(buf, bufsize, "%zu bytes:", input->size);
+      for (size_t i = 0; i < input->size && used + 4 < (int)bufsize; i++)
+         used += snprintf(buf + used, bufsize - used, " %02x", input->data[i]);
+      if (used + 4 >= (int)bufsize && bufsize > 4)
+         strcpy(buf + bufsize - 4, "...");
+      break;
    }
-}
-
-void set_test_context(TestState result, const string message) {
-   if (current_set && current_set->current) {
-      current_set->current->info.result.state = result;
-      if (current_set->current->info.result.message) {
-         __real_free(current_set->current->info.result.message);
-      }
-      current_set->current->info.result.message = message ? strdup(message) : NULL;
-      if (result != PASS) {
-         // Stop assertions for this test
-         longjmp(jmpbuffer, 1);
-      }
    }
 }
 
+
 void test_context(object ctx) {
    struct ctx {
       FILE *log_stream;
@@ -392,336 +603,1373 @@ const char *st_version(void) {
    return SIGMATEST_VERSION;
 }
 
-#if 1 // Implementations for assertions (public interface)
-// Asserts the condition is TRUE
-static void assert_is_true(int condition, const string fmt, ...) {
-   va_list args;
-   va_start(args, fmt);
-   if (!condition) {
-      string user_msg = fmt ? format_msg(fmt, args) : "";
-      if (user_msg && user_msg[0] != '\0') {
-         static char buf[256];
-         snprintf(buf, sizeof(buf), "%s\n    - %s", MESSAGE_TRUE_FAIL, user_msg);
-         set_test_context(FAIL, buf);
-      } else {
-         set_test_context(FAIL, MESSAGE_TRUE_FAIL);
-      }
-   } else {
-      set_test_context(PASS, NULL);
+/*
+ * Bulk comparison kernels (`arrayEqual`, `arrayWithin`, `memEqual`)
+ * Each kernel returns the index of the first mismatch, or the count when there is none.
+ * Exact comparisons of integer and pointer arrays reduce to a byte scan; FLOAT and DOUBLE
+ * compare within a tolerance, where equal values (including infinities) always match and
+ * NaN never does. AVX2 is picked at runtime when the CPU has it, SSE2 is the x86-64
+ * baseline, NEON covers aarch64 and the scalar loops cover everything else plus the tails.
+ */
+#define ST_WINDOW_BEFORE 4 /* Elements shown before the mismatch */
+#define ST_WINDOW_AFTER 4  /* Elements shown after the mismatch */
+#define ST_HEX_WINDOW 8    /* Bytes shown on each side of a memory mismatch */
+
+static size_t mismatch_bytes_scalar(const unsigned char *a, const unsigned char *b, size_t i, size_t n) {
+   while (i < n && a[i] == b[i])
+      i++;
+   return i;
+}
+static size_t outside_float_scalar(const float *a, const float *b, size_t i, size_t n, float tolerance) {
+   while (i < n && (a[i] == b[i] || fabsf(a[i] - b[i]) <= tolerance))
+      i++;
+   return i;
+}
+static size_t outside_double_scalar(const double *a, const double *b, size_t i, size_t n, double tolerance) {
+   while (i < n && (a[i] == b[i] || fabs(a[i] - b[i]) <= tolerance))
+      i++;
+   return i;
+}
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2"))) static size_t mismatch_bytes_avx2(const unsigned char *a, const unsigned char *b, size_t n) {
+   size_t i = 0;
+   for (; i + 32 <= n; i += 32) {
+      __m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i)), _mm256_loadu_si256((const __m256i *)(b + i)));
+      unsigned int mask = (unsigned int)_mm256_movemask_epi8(eq);
+      if (mask != 0xFFFFFFFFu)
+         return i + __builtin_ctz(~mask);
    }
-
-   va_end(args);
+   return mismatch_bytes_scalar(a, b, i, n);
 }
-// Asserts the condition is FALSE
-static void assert_is_false(int condition, const string fmt, ...) {
-   va_list args;
-   va_start(args, fmt);
-   if (condition) {
-      string user_msg = fmt ? format_msg(fmt, args) : "";
-      if (user_msg && user_msg[0] != '\0') {
-         static char buf[256];
-         snprintf(buf, sizeof(buf), "%s\n    - %s", MESSAGE_FALSE_FAIL, user_msg);
-         set_test_context(FAIL, buf);
-      } else {
-         set_test_context(FAIL, MESSAGE_FALSE_FAIL);
-      }
-   } else {
-      set_test_context(PASS, NULL);
+__attribute__((target("avx2"))) static size_t outside_float_avx2(const float *a, const float *b, size_t n, float tolerance) {
+   const __m256 sign = _mm256_set1_ps(-0.0f), limit = _mm256_set1_ps(tolerance);
+   size_t i = 0;
+   for (; i + 8 <= n; i += 8) {
+      __m256 x = _mm256_loadu_ps(a + i), y = _mm256_loadu_ps(b + i);
+      __m256 diff = _mm256_andnot_ps(sign, _mm256_sub_ps(x, y));
+      __m256 ok = _mm256_or_ps(_mm256_cmp_ps(x, y, _CMP_EQ_OQ), _mm256_cmp_ps(diff, limit, _CMP_LE_OQ));
+      int mask = _mm256_movemask_ps(ok);
+      if (mask != 0xFF)
+         return i + __builtin_ctz(~mask);
    }
-
-   va_end(args);
+   return outside_float_scalar(a, b, i, n, tolerance);
 }
-// Asserts the pointer is NULL
-static void assert_is_null(object ptr, const string fmt, ...) {
-   va_list args;
-   va_start(args, fmt);
-   if (ptr != NULL) {
-      string user_msg = fmt ? format_msg(fmt, args) : "";
-      if (user_msg && user_msg[0] != '\0') {
-         static char buf[256];
-         snprintf(buf, sizeof(buf), "%s\n    - %s", "Pointer is not NULL", user_msg);
-         set_test_context(FAIL, buf);
-      } else {
-         set_test_context(FAIL, "Pointer is not NULL");
-      }
-   } else {
-      set_test_context(PASS, NULL);
+__attribute__((target("avx2"))) static size_t outside_double_avx2(const double *a, const double *b, size_t n, double tolerance) {
+   const __m256d sign = _mm256_set1_pd(-0.0), limit = _mm256_set1_pd(tolerance);
+   size_t i = 0;
+   for (; i + 4 <= n; i += 4) {
+      __m256d x = _mm256_loadu_pd(a + i), y = _mm256_loadu_pd(b + i);
+      __m256d diff = _mm256_andnot_pd(sign, _mm256_sub_pd(x, y));
+      __m256d ok = _mm256_or_pd(_mm256_cmp_pd(x, y, _CMP_EQ_OQ), _mm256_cmp_pd(diff, limit, _CMP_LE_OQ));
+      int mask = _mm256_movemask_pd(ok);
+      if (mask != 0xF)
+         return i + __builtin_ctz(~mask);
    }
-
-   va_end(args);
+   return outside_double_scalar(a, b, i, n, tolerance);
 }
-// Asserts the pointer is not NULL
-static void assert_is_not_null(object ptr, const string fmt, ...) {
-   va_list args;
-   va_start(args, fmt);
-   if (ptr == NULL) {
-      string user_msg = fmt ? format_msg(fmt, args) : "";
-      if (user_msg && user_msg[0] != '\0') {
-         static char buf[256];
-         snprintf(buf, sizeof(buf), "%s\n    - %s", "Pointer is NULL", user_msg);
-         set_test_context(FAIL, buf);
-      } else {
-         set_test_context(FAIL, "Pointer is NULL");
-      }
-   } else {
-      set_test_context(PASS, NULL);
+#endif
+#if defined(__SSE2__)
+static size_t mismatch_bytes_sse2(const unsigned char *a, const unsigned char *b, size_t n) {
+   size_t i = 0;
+   for (; i + 16 <= n; i += 16) {
+      __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i)));
+      unsigned int mask = (unsigned int)_mm_movemask_epi8(eq);
+      if (mask != 0xFFFFu)
+         return i + __builtin_ctz(~mask);
    }
-
-   va_end(args);
+   return mismatch_bytes_scalar(a, b, i, n);
 }
-// Asserts two values are equal
-static void assert_are_equal(object expected, object actual, AssertType type, const string fmt, ...) {
-   va_list args;
-   va_start(args, fmt);
-
-   // char messageBuffer[256];
-   enum {
-      PASS,
-      FAIL
-   } result = PASS;
-   string failMessage = NULL;
-
+static size_t outside_float_sse2(const float *a, const float *b, size_t n, float tolerance) {
+   const __m128 sign = _mm_set1_ps(-0.0f), limit = _mm_set1_ps(tolerance);
+   size_t i = 0;
+   for (; i + 4 <= n; i += 4) {
+      __m128 x = _mm_loadu_ps(a + i), y = _mm_loadu_ps(b + i);
+      __m128 diff = _mm_andnot_ps(sign, _mm_sub_ps(x, y));
+      int mask = _mm_movemask_ps(_mm_or_ps(_mm_cmpeq_ps(x, y), _mm_cmple_ps(diff, limit)));
+      if (mask != 0xF)
+         return i + __builtin_ctz(~mask);
+   }
+   return outside_float_scalar(a, b, i, n, tolerance);
+}
+static size_t outside_double_sse2(const double *a, const double *b, size_t n, double tolerance) {
+   const __m128d sign = _mm_set1_pd(-0.0), limit = _mm_set1_pd(tolerance);
+   size_t i = 0;
+   for (; i + 2 <= n; i += 2) {
+      __m128d x = _mm_loadu_pd(a + i), y = _mm_loadu_pd(b + i);
+      __m128d diff = _mm_andnot_pd(sign, _mm_sub_pd(x, y));
+      int mask = _mm_movemask_pd(_mm_or_pd(_mm_cmpeq_pd(x, y), _mm_cmple_pd(diff, limit)));
+      if (mask != 0x3)
+         return i + __builtin_ctz(~mask);
+   }
+   return outside_double_scalar(a, b, i, n, tolerance);
+}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+static size_t mismatch_bytes_neon(const unsigned char *a, const unsigned char *b, size_t n) {
+   size_t i = 0;
+   // find the mismatching block, the scalar scan pins the byte
+   for (; i + 16 <= n; i += 16) {
+      if (vminvq_u8(vceqq_u8(vld1q_u8(a + i), vld1q_u8(b + i))) != 0xFF)
+         return mismatch_bytes_scalar(a, b, i, n);
+   }
+   return mismatch_bytes_scalar(a, b, i, n);
+}
+static size_t outside_float_neon(const float *a, const float *b, size_t n, float tolerance) {
+   const float32x4_t limit = vdupq_n_f32(tolerance);
+   size_t i = 0;
+   for (; i + 4 <= n; i += 4) {
+      float32x4_t x = vld1q_f32(a + i), y = vld1q_f32(b + i);
+      uint32x4_t ok = vorrq_u32(vceqq_f32(x, y), vcleq_f32(vabdq_f32(x, y), limit));
+      if (vminvq_u32(ok) != 0xFFFFFFFFu)
+         return outside_float_scalar(a, b, i, n, tolerance);
+   }
+   return outside_float_scalar(a, b, i, n, tolerance);
+}
+static size_t outside_double_neon(const double *a, const double *b, size_t n, double tolerance) {
+   const float64x2_t limit = vdupq_n_f64(tolerance);
+   size_t i = 0;
+   for (; i + 2 <= n; i += 2) {
+      float64x2_t x = vld1q_f64(a + i), y = vld1q_f64(b + i);
+      uint64x2_t ok = vorrq_u64(vceqq_f64(x, y), vcleq_f64(vabdq_f64(x, y), limit));
+      if ((vgetq_lane_u64(ok, 0) & vgetq_lane_u64(ok, 1)) != UINT64_MAX)
+         return outside_double_scalar(a, b, i, n, tolerance);
+   }
+   return outside_double_scalar(a, b, i, n, tolerance);
+}
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+// AVX2 is decided once; the answer cannot change while the process runs
+static int simd_avx2(void) {
+   static int avx2 = -1;
+   if (avx2 < 0)
+      avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+   return avx2;
+}
+#endif
+// first byte where a and b differ
+static size_t mismatch_bytes(const unsigned char *a, const unsigned char *b, size_t n) {
+#if defined(__x86_64__) || defined(__i386__)
+   if (simd_avx2())
+      return mismatch_bytes_avx2(a, b, n);
+#endif
+#if defined(__SSE2__)
+   return mismatch_bytes_sse2(a, b, n);
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+   return mismatch_bytes_neon(a, b, n);
+#else
+   return mismatch_bytes_scalar(a, b, 0, n);
+#endif
+}
+// first float pair further apart than the tolerance
+static size_t outside_float(const float *a, const float *b, size_t n, float tolerance) {
+#if defined(__x86_64__) || defined(__i386__)
+   if (simd_avx2())
+      return outside_float_avx2(a, b, n, tolerance);
+#endif
+#if defined(__SSE2__)
+   return outside_float_sse2(a, b, n, tolerance);
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+   return outside_float_neon(a, b, n, tolerance);
+#else
+   return outside_float_scalar(a, b, 0, n, tolerance);
+#endif
+}
+// first double pair further apart than the tolerance
+static size_t outside_double(const double *a, const double *b, size_t n, double tolerance) {
+#if defined(__x86_64__) || defined(__i386__)
+   if (simd_avx2())
+      return outside_double_avx2(a, b, n, tolerance);
+#endif
+#if defined(__SSE2__)
+   return outside_double_sse2(a, b, n, tolerance);
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+   return outside_double_neon(a, b, n, tolerance);
+#else
+   return outside_double_scalar(a, b, 0, n, tolerance);
+#endif
+}
+// element size of an array of the given type; 0 when arrays of it are not supported
+static size_t element_size(AssertType type) {
    switch (type) {
    case INT:
-      if (*(int *)expected != *(int *)actual) {
-         failMessage = gen_equals_fail_msg(expected, actual, type, fmt, args);
-         result = FAIL;
-      }
-
-      break;
+      return sizeof(int);
    case LONG:
-      if (*(long *)expected != *(long *)actual) {
-         failMessage = gen_equals_fail_msg(expected, actual, type, fmt, args);
-         result = FAIL;
-      }
-
-      break;
+      return sizeof(long);
    case FLOAT:
-      if (fabs(*(float *)expected - *(float *)actual) > FLT_EPSILON) {
-         failMessage = gen_equals_fail_msg(expected, actual, type, fmt, args);
-         result = FAIL;
-      }
-
-      break;
+      return sizeof(float);
    case DOUBLE:
-      if (fabs(*(double *)expected - *(double *)actual) > DBL_EPSILON) {
-         failMessage = gen_equals_fail_msg(expected, actual, type, fmt, args);
-         result = FAIL;
-      }
-
-      break;
+      return sizeof(double);
    case CHAR:
-      if (*(char *)expected != *(char *)actual) {
-         failMessage = gen_equals_fail_msg(expected, actual, type, fmt, args);
-         result = FAIL;
-      }
-
-      break;
+      return sizeof(char);
    case PTR:
-      if (expected != actual) {
-         failMessage = gen_equals_fail_msg(expected, actual, type, fmt, args);
-         result = FAIL;
-      }
-
-      break;
+      return sizeof(object);
    case STRING:
-      failMessage = "Use Assert.stringEqual for string comparison";
-      result = FAIL;
-
-      break;
+      return sizeof(string);
    default:
-
-      failMessage = "Unsupported type for comparison";
-      result = FAIL;
-
-      break;
-      // Add cases for other types as needed
+      return 0;
    }
-
-   // if (result == FAIL)
-   // {
-   // 	debugf("Assertion failed: %s", failMessage); /* Log failure */
-   // }
-
-   set_test_context(result, failMessage);
-
-   va_end(args);
 }
-// Asserts two values are not equal
-static void assert_are_not_equal(object expected, object actual, AssertType type, const string fmt, ...) {
-   va_list args;
-   va_start(args, fmt);
+// format element i of an array; floating values get enough digits to show small differences
+static int format_element(char *buf, size_t size, const void *array, size_t i, AssertType type) {
+   switch (type) {
+   case FLOAT:
+      return snprintf(buf, size, "%.7g", ((const float *)array)[i]);
+   case DOUBLE:
+      return snprintf(buf, size, "%.10g", ((const double *)array)[i]);
+   case STRING:
+      return snprintf(buf, size, "\"%.19s\"", ((const string *)array)[i]);
+   case PTR:
+      return snprintf(buf, size, "%p", ((object const *)array)[i]);
+   default: {
+      char value[32];
+      format_value(value, sizeof(value), (object)((const char *)array + i * element_size(type)), type);
+      return snprintf(buf, size, "%s", value);
+   }
+   }
+}
+// append one window line: "<label> [first]: v v <v> v"
+static int format_window(char *buf, size_t size, const char *label, const void *array, size_t count, size_t at,
+                         AssertType type) {
+   size_t first = at > ST_WINDOW_BEFORE ? at - ST_WINDOW_BEFORE : 0;
+   size_t last = count - at > ST_WINDOW_AFTER ? at + ST_WINDOW_AFTER : count - 1;
+   int used = snprintf(buf, size, "\n    %-8s [%zu]:", label, first);
+   for (size_t i = first; i <= last && used < (int)size; i++) {
+      char value[48];
+      format_element(value, sizeof(value), array, i, type);
+      used += snprintf(buf + used, size - used, i == at ? " <%s>" : " %s", value);
+   }
+   return used;
+}
+// append one hex window line around byte at
+static int format_hex_window(char *buf, size_t size, const char *label, const unsigned char *bytes, size_t count,
+                             size_t at) {
+   size_t first = at > ST_HEX_WINDOW ? at - ST_HEX_WINDOW : 0;
+   size_t last = count - at > ST_HEX_WINDOW ? at + ST_HEX_WINDOW : count - 1;
+   int used = snprintf(buf, size, "\n    %-8s [%zu]:", label, first);
+   for (size_t i = first; i <= last && used < (int)size; i++)
+      used += snprintf(buf + used, size - used, i == at ? " <%02x>" : " %02x", bytes[i]);
+   return used;
+}
+// report the first mismatching element with a window of values around it
+static void fail_array(const char *what, object expected, object actual, size_t count, size_t at, AssertType type,
+                       const string fmt, va_list args) {
+   char check[ST_MESSAGE_SIZE / 2];
+   int used = snprintf(check, sizeof(check), "%s at index %zu of %zu", what, at, count);
+   if (used < (int)sizeof(check))
+      used += format_window(check + used, sizeof(check) - used, "expected", expected, count, at, type);
+   if (used < (int)sizeof(check))
+      format_window(check + used, sizeof(check) - used, "actual", actual, count, at, type);
+   fail_with(FAIL, check, fmt, args);
+}
 
-   // char messageBuffer[256];
-   enum {
-      PASS,
-      FAIL
-   } result = PASS;
-   string failMessage = NULL;
+#if 1 // Implementations for assertions (public interface)
+// Checks compare before touching their arguments; a pass returns without any further call
+#define ASSERT_FAIL(state, check, fmt)              \
+   do {                                             \
+      va_list args;                                 \
+      va_start(args, fmt);                          \
+      fail_with(state, check, (string)fmt, args);   \
+      va_end(args);                                 \
+   } while (0)
 
+// Asserts the condition is TRUE
+static void assert_is_true(int condition, const string fmt, ...) {
+   if (__builtin_expect(!condition, 0))
+      ASSERT_FAIL(FAIL, MESSAGE_TRUE_FAIL, fmt);
+}
+// Asserts the condition is FALSE
+static void assert_is_false(int condition, const string fmt, ...) {
+   if (__builtin_expect(condition, 0))
+      ASSERT_FAIL(FAIL, MESSAGE_FALSE_FAIL, fmt);
+}
+// Asserts the pointer is NULL
+static void assert_is_null(object ptr, const string fmt, ...) {
+   if (__builtin_expect(ptr != NULL, 0))
+      ASSERT_FAIL(FAIL, "Pointer is not NULL", fmt);
+}
+// Asserts the pointer is not NULL
+static void assert_is_not_null(object ptr, const string fmt, ...) {
+   if (__builtin_expect(ptr == NULL, 0))
+      ASSERT_FAIL(FAIL, "Pointer is NULL", fmt);
+}
+// compare two typed values; returns -1 for types assertEquals does not support
+static int values_equal(object expected, object actual, AssertType type) {
    switch (type) {
    case INT:
-      if (*(int *)expected == *(int *)actual) {
-         failMessage = gen_equals_fail_msg(expected, actual, type, fmt, args);
-         result = FAIL;
-      }
-
-      break;
+      return *(int *)expected == *(int *)actual;
+   case LONG:
+      return *(long *)expected == *(long *)actual;
    case FLOAT:
-      if (fabs(*(float *)expected - *(float *)actual) <= FLT_EPSILON) {
-         failMessage = gen_equals_fail_msg(expected, actual, type, fmt, args);
-         result = FAIL;
-      }
-
-      break;
+      return fabs(*(float *)expected - *(float *)actual) <= FLT_EPSILON;
    case DOUBLE:
-      if (fabs(*(double *)expected - *(double *)actual) <= DBL_EPSILON) {
-         failMessage = gen_equals_fail_msg(expected, actual, type, fmt, args);
-         result = FAIL;
-      }
-
-      break;
+      return fabs(*(double *)expected - *(double *)actual) <= DBL_EPSILON;
    case CHAR:
-      if (*(char *)expected == *(char *)actual) {
-         failMessage = gen_equals_fail_msg(expected, actual, type, fmt, args);
-         result = FAIL;
-      }
-
-      break;
+      return *(char *)expected == *(char *)actual;
    case PTR:
-      if (expected == actual) {
-         failMessage = gen_equals_fail_msg(expected, actual, type, fmt, args);
-         result = FAIL;
-      }
-
-      break;
-   case STRING:
-      failMessage = "Use Assert.stringEqual for string comparison";
-      result = FAIL;
-
-      break;
+      return expected == actual;
    default:
-
-      failMessage = "Unsupported type for comparison";
-      result = FAIL;
-
-      break; // Add cases for other types as needed
+      return -1;
    }
-
-   // if (result == FAIL)
-   // {
-   // 	debugf("Assertion failed: %s", failMessage); /* Log failure */
-   // }
-
-   set_test_context(result, failMessage);
-
-   va_end(args);
 }
-// Asserts that a float value is within a specified tolerance
-static void assert_float_within(float value, float min, float max, const string fmt, ...) {
+// report a comparison that could not be made
+static void fail_unsupported(AssertType type) {
+   set_test_context(FAIL, type == STRING ? "Use Assert.stringEqual for string comparison"
+                                         : "Unsupported type for comparison");
+}
+// Asserts two values are equal
+static void assert_are_equal(object expected, object actual, AssertType type, const string fmt, ...) {
+   int equal = values_equal(expected, actual, type);
+   if (__builtin_expect(equal == 1, 1))
+      return;
+   if (equal < 0) {
+      fail_unsupported(type);
+      return;
+   }
    va_list args;
    va_start(args, fmt);
-
-   if (value < min || value > max) {
-      string user_msg = fmt ? format_msg(fmt, args) : "";
-      if (user_msg && user_msg[0] != '\0') {
-         static char buf[256];
-         snprintf(buf, sizeof(buf), "%s\n    - %s", "Value out of range", user_msg);
-         set_test_context(FAIL, buf);
-      } else {
-         set_test_context(FAIL, "Value out of range");
-      }
-   } else {
-      set_test_context(PASS, NULL);
+   fail_equals(expected, actual, type, fmt, args);
+   va_end(args);
+}
+// Asserts two values are not equal
+static void assert_are_not_equal(object expected, object actual, AssertType type, const string fmt, ...) {
+   int equal = values_equal(expected, actual, type);
+   if (__builtin_expect(equal == 0, 1))
+      return;
+   if (equal < 0) {
+      fail_unsupported(type);
+      return;
    }
-
+   va_list args;
+   va_start(args, fmt);
+   fail_equals(expected, actual, type, fmt, args);
    va_end(args);
 }
+// Asserts that a float value is within a specified tolerance
+static void assert_float_within(float value, float min, float max, const string fmt, ...) {
+   if (__builtin_expect(value < min || value > max, 0))
+      ASSERT_FAIL(FAIL, "Value out of range", fmt);
+}
 // Asserts that two strings are equal with respect to case sensitivity
 static void assert_string_equal(string expected, string actual, int case_sensitive, const string fmt, ...) {
+   int equal = case_sensitive ? strcmp(expected, actual) == 0 : strcasecmp(expected, actual) == 0;
+   if (__builtin_expect(equal, 1))
+      return;
    va_list args;
    va_start(args, fmt);
-
-   int equal = case_sensitive ? strcmp(expected, actual) == 0 : strcasecmp(expected, actual) == 0;
-   if (!equal) {
-      string failMessage = gen_equals_fail_msg(expected, actual, STRING, fmt, args);
-      // debugf("Assertion failed: %s", failMessage);
-      set_test_context(FAIL, failMessage);
-   } else {
-      set_test_context(PASS, NULL);
-   }
-
+   fail_equals(expected, actual, STRING, fmt, args);
    va_end(args);
 }
-// Assert throws
-static void assert_throw(const string fmt, ...) {
-   va_list args;
-   va_start(args, fmt);
-
-   string user_msg = fmt ? format_msg(fmt, args) : "";
-   if (user_msg && user_msg[0] != '\0') {
-      static char buf[256];
-      snprintf(buf, sizeof(buf), "%s\n    - %s", "Explicit throw triggered", user_msg);
-      set_test_context(FAIL, buf);
-   } else {
-      set_test_context(FAIL, "Explicit throw triggered");
+// Asserts two arrays hold equal elements, compared like areEqual
+static void assert_array_equal(object expected, object actual, size_t count, AssertType type, const string fmt, ...) {
+   size_t size = element_size(type);
+   // off a case's thread a failure returns here, so each one must end the check
+   if (__builtin_expect(size == 0, 0)) {
+      set_test_context(FAIL, "Unsupported type for comparison");
+      return;
+   }
+   if (count == 0 || expected == actual)
+      return;
+   if (!expected || !actual) {
+      ASSERT_FAIL(FAIL, "Array is NULL", fmt);
+      return;
    }
 
+   size_t at;
+   switch (type) {
+   case FLOAT:
+      at = outside_float(expected, actual, count, FLT_EPSILON);
+      break;
+   case DOUBLE:
+      at = outside_double(expected, actual, count, DBL_EPSILON);
+      break;
+   case STRING:
+      for (at = 0; at < count && strcmp(((string *)expected)[at], ((string *)actual)[at]) == 0; at++)
+         ;
+      break;
+   default:
+      at = mismatch_bytes(expected, actual, count * size) / size;
+      break;
+   }
+   if (__builtin_expect(at == count, 1))
+      return;
+   va_list args;
+   va_start(args, fmt);
+   fail_array("Arrays differ", expected, actual, count, at, type, fmt, args);
    va_end(args);
 }
-// Assert fail
-static void assert_fail(const string fmt, ...) {
+// Asserts two FLOAT or DOUBLE arrays agree element-wise within a tolerance
+static void assert_array_within(object expected, object actual, size_t count, AssertType type, double tolerance,
+                                const string fmt, ...) {
+   if (__builtin_expect(type != FLOAT && type != DOUBLE, 0)) {
+      set_test_context(FAIL, "arrayWithin supports FLOAT and DOUBLE arrays");
+      return;
+   }
+   if (count == 0 || expected == actual)
+      return;
+   if (!expected || !actual) {
+      ASSERT_FAIL(FAIL, "Array is NULL", fmt);
+      return;
+   }
+
+   size_t at = type == FLOAT ? outside_float(expected, actual, count, (float)tolerance)
+                             : outside_double(expected, actual, count, tolerance);
+   if (__builtin_expect(at == count, 1))
+      return;
+   char what[64];
+   snprintf(what, sizeof(what), "Arrays differ by more than %g", tolerance);
    va_list args;
    va_start(args, fmt);
-
-   string user_msg = fmt ? format_msg(fmt, args) : "";
-   if (user_msg && user_msg[0] != '\0') {
-      static char buf[256];
-      snprintf(buf, sizeof(buf), "%s\n    - %s", "Explicit failure triggered", user_msg);
-      set_test_context(FAIL, buf);
-   } else {
-      set_test_context(FAIL, "Explicit failure triggered");
+   fail_array(what, expected, actual, count, at, type, fmt, args);
+   va_end(args);
+}
+// Asserts two memory regions hold the same bytes
+static void assert_mem_equal(object expected, object actual, size_t size, const string fmt, ...) {
+   if (size == 0 || expected == actual)
+      return;
+   if (!expected || !actual) {
+      ASSERT_FAIL(FAIL, "Memory region is NULL", fmt);
+      return;
    }
 
-   va_end(args);
+   size_t at = mismatch_bytes(expected, actual, size);
+   if (__builtin_expect(at == size, 1))
+      return;
+   char check[ST_MESSAGE_SIZE / 2];
+   int used = snprintf(check, sizeof(check), "Memory differs at byte %zu of %zu", at, size);
+   used += format_hex_window(check + used, sizeof(check) - used, "expected", expected, size, at);
+   if (used < (int)sizeof(check))
+      format_hex_window(check + used, sizeof(check) - used, "actual", actual, size, at);
+   ASSERT_FAIL(FAIL, check, fmt);
+}
+// Assert throws
+static void assert_throw(const string fmt, ...) {
+   ASSERT_FAIL(FAIL, "Explicit throw triggered", fmt);
+}
+// Assert fail
+static void assert_fail(const string fmt, ...) {
+   ASSERT_FAIL(FAIL, "Explicit failure triggered", fmt);
 }
 // Assert skip
 static void assert_skip(const string fmt, ...) {
-   va_list args;
-   va_start(args, fmt);
+   ASSERT_FAIL(SKIP, "Testcase skipped", fmt);
+}
+// Formatters behind the inline ST_ASSERT_* checks; only reached on failure
+#define ASSERT_FAIL_VALUES(fmt, check_fmt, ...)               \
+   do {                                                       \
+      char check[ST_MESSAGE_SIZE / 2];                        \
+      snprintf(check, sizeof(check), check_fmt, __VA_ARGS__); \
+      ASSERT_FAIL(FAIL, check, fmt);                          \
+   } while (0)
+
+void st_assert_fail(const char *check, const char *fmt, ...) {
+   ASSERT_FAIL(FAIL, check, fmt);
+}
+void st_assert_fail_int(long long expected, long long actual, const char *fmt, ...) {
+   ASSERT_FAIL_VALUES(fmt, "Expected %lld, but was %lld", expected, actual);
+}
+void st_assert_fail_ptr(const void *expected, const void *actual, const char *fmt, ...) {
+   ASSERT_FAIL_VALUES(fmt, "Expected %p, but was %p", expected, actual);
+}
+void st_assert_fail_range(double value, double min, double max, const char *fmt, ...) {
+   ASSERT_FAIL_VALUES(fmt, "Value %g out of range [%g, %g]", value, min, max);
+}
+void st_assert_fail_str(const char *expected, const char *actual, const char *fmt, ...) {
+   ASSERT_FAIL_VALUES(fmt, "Expected \"%s\", but was \"%s\"", expected, actual);
+}
+// typed checks report the expected value, or the value they expected to differ from
+void st_assert_fail_signed(int equal, long long expected, long long actual, const char *fmt, ...) {
+   if (equal)
+      ASSERT_FAIL_VALUES(fmt, "Expected %lld, but was %lld", expected, actual);
+   else
+      ASSERT_FAIL_VALUES(fmt, "Expected a value other than %lld", expected);
+}
+void st_assert_fail_unsigned(int equal, unsigned long long expected, unsigned long long actual, const char *fmt, ...) {
+   if (equal)
+      ASSERT_FAIL_VALUES(fmt, "Expected %llu, but was %llu", expected, actual);
+   else
+      ASSERT_FAIL_VALUES(fmt, "Expected a value other than %llu", expected);
+}
+void st_assert_fail_real(int equal, long double expected, long double actual, const char *fmt, ...) {
+   // enough digits to tell apart values closer than the comparison tolerance
+   if (equal)
+      ASSERT_FAIL_VALUES(fmt, "Expected %.17Lg, but was %.17Lg", expected, actual);
+   else
+      ASSERT_FAIL_VALUES(fmt, "Expected a value other than %.17Lg", expected);
+}
+// a string operand as it reads in a check message: quoted, or NULL
+static const char *quote_operand(char *buf, size_t size, const char *text) {
+   if (!text)
+      return "NULL";
+   snprintf(buf, size, "\"%s\"", text);
+   return buf;
+}
+void st_assert_fail_string(int equal, const char *expected, const char *actual, const char *fmt, ...) {
+   // both quoted operands and the check text fit one check
+   char quoted_expected[ST_MESSAGE_SIZE / 4 - 16], quoted_actual[ST_MESSAGE_SIZE / 4 - 16];
+   if (equal)
+      ASSERT_FAIL_VALUES(fmt, "Expected %s, but was %s", quote_operand(quoted_expected, sizeof(quoted_expected), expected),
+                         quote_operand(quoted_actual, sizeof(quoted_actual), actual));
+   else
+      ASSERT_FAIL_VALUES(fmt, "Expected a string other than %s",
+                         quote_operand(quoted_expected, sizeof(quoted_expected), expected));
+}
+void st_assert_fail_pointer(int equal, const void *expected, const void *actual, const char *fmt, ...) {
+   if (equal)
+      ASSERT_FAIL_VALUES(fmt, "Expected %p, but was %p", expected, actual);
+   else
+      ASSERT_FAIL_VALUES(fmt, "Expected a pointer other than %p", expected);
+}
+#endif
 
-   string user_msg = fmt ? format_msg(fmt, args) : "";
-   if (user_msg && user_msg[0] != '\0') {
-      static char buf[256];
-      snprintf(buf, sizeof(buf), "%s\n    - %s", "Testcase skipped", user_msg);
-      set_test_context(SKIP, buf);
+/*
+ * Leak tracker (`--track-leaks`)
+ * Live allocations are kept in an open-addressing table keyed by pointer (linear probing,
+ * tombstones on free) with their size, call site and owning test case. The table is backed
+ * by __real_malloc and doubles once it is half full, so every lookup stays O(1).
+ */
+#define LEAK_TOMBSTONE ((void *)1)
+#define LEAK_MIN_CAPACITY 1024
+#define LEAK_TOP_SITES 5
+
+typedef struct st_alloc_entry_s {
+   void *ptr;      /* Allocation (NULL = empty, LEAK_TOMBSTONE = freed) */
+   size_t size;    /* Requested size */
+   void *caller;   /* Return address of the allocating call */
+   TestCase owner; /* Test case running when the allocation was made */
+} st_alloc_entry;
+
+static st_alloc_entry *leak_table = NULL;
+static size_t leak_capacity = 0; /* Always a power of 2 */
+static size_t leak_live = 0;     /* Live entries */
+static size_t leak_tombs = 0;    /* Tombstone entries */
+static pthread_mutex_t leak_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static inline size_t leak_hash(const void *ptr) {
+   // fibonacci hashing; the low bits of heap pointers carry no information
+   return (size_t)(((uintptr_t)ptr >> 4) * 11400714819323198485ull);
+}
+static st_alloc_entry *leak_find(void *ptr) {
+   size_t mask = leak_capacity - 1;
+   for (size_t i = leak_hash(ptr) & mask;; i = (i + 1) & mask) {
+      if (leak_table[i].ptr == ptr)
+         return &leak_table[i];
+      if (!leak_table[i].ptr)
+         return NULL;
+   }
+}
+static int leak_grow(void) {
+   size_t capacity = leak_capacity ? leak_capacity : LEAK_MIN_CAPACITY;
+   // only grow when live entries fill the table; otherwise rehashing drops the tombstones
+   if ((leak_live + 1) * 2 > capacity)
+      capacity *= 2;
+
+   st_alloc_entry *table = __real_calloc(capacity, sizeof(st_alloc_entry));
+   if (!table)
+      return -1;
+
+   size_t mask = capacity - 1;
+   for (size_t i = 0; i < leak_capacity; i++) {
+      void *ptr = leak_table[i].ptr;
+      if (!ptr || ptr == LEAK_TOMBSTONE)
+         continue;
+      size_t j = leak_hash(ptr) & mask;
+      while (table[j].ptr)
+         j = (j + 1) & mask;
+      table[j] = leak_table[i];
+   }
+   __real_free(leak_table);
+   leak_table = table;
+   leak_capacity = capacity;
+   leak_tombs = 0;
+   return 0;
+}
+static TestCase leak_owner(void) {
+   return current_set ? current_set->current : NULL;
+}
+// callers hold leak_lock
+static void leak_insert(void *ptr, size_t size, void *caller) {
+   if ((leak_live + leak_tombs + 1) * 2 > leak_capacity && leak_grow() != 0)
+      return; // out of memory for the table; this allocation goes untracked
+
+   size_t mask = leak_capacity - 1;
+   size_t i = leak_hash(ptr) & mask;
+   while (leak_table[i].ptr && leak_table[i].ptr != LEAK_TOMBSTONE)
+      i = (i + 1) & mask;
+   if (leak_table[i].ptr == LEAK_TOMBSTONE)
+      leak_tombs--;
+
+   TestCase owner = leak_owner();
+   leak_table[i] = (st_alloc_entry){ptr, size, caller, owner};
+   leak_live++;
+   if (owner) {
+      owner->leak_live += size;
+      if (owner->leak_live > owner->leak_peak)
+         owner->leak_peak = owner->leak_live;
+   }
+}
+static void leak_remove(void *ptr) {
+   st_alloc_entry *entry = leak_table ? leak_find(ptr) : NULL;
+   if (entry) {
+      // memory belongs to the case that allocated it, whoever frees it
+      if (entry->owner)
+         entry->owner->leak_live -= entry->size;
+      entry->ptr = LEAK_TOMBSTONE;
+      leak_live--;
+      leak_tombs++;
+   }
+}
+// write the call site as `symbol+offset` (or `module+offset` for addr2line)
+static void format_call_site(void *caller, char *buf, size_t len) {
+   Dl_info info;
+   int found = dladdr(caller, &info);
+   if (found && info.dli_sname) {
+      snprintf(buf, len, "%s+0x%tx", info.dli_sname, (char *)caller - (char *)info.dli_saddr);
+   } else if (found && info.dli_fname) {
+      const char *module = strrchr(info.dli_fname, '/');
+      snprintf(buf, len, "%s+0x%tx", module ? module + 1 : info.dli_fname, (char *)caller - (char *)info.dli_fbase);
    } else {
-      set_test_context(SKIP, "Testcase skipped");
+      snprintf(buf, len, "%p", caller);
+   }
+}
+typedef struct st_leak_site_s {
+   void *caller;
+   size_t bytes;
+   size_t count;
+   TestCase owner; /* Owner of the first leak seen at this site */
+} st_leak_site;
+
+static int compare_site_callers(const void *a, const void *b) {
+   const st_leak_site *x = a, *y = b;
+   return (x->caller > y->caller) - (x->caller < y->caller);
+}
+static int compare_site_bytes(const void *a, const void *b) {
+   const st_leak_site *x = a, *y = b;
+   return (x->bytes < y->bytes) - (x->bytes > y->bytes);
+}
+// print the bytes still live and the call sites leaking the most
+static void leak_report(FILE *stream) {
+   pthread_mutex_lock(&leak_lock);
+   size_t count = 0, bytes = 0;
+   st_leak_site *sites = leak_live ? __real_malloc(leak_live * sizeof(st_leak_site)) : NULL;
+   for (size_t i = 0; sites && i < leak_capacity; i++) {
+      st_alloc_entry *entry = &leak_table[i];
+      if (entry->ptr && entry->ptr != LEAK_TOMBSTONE) {
+         sites[count++] = (st_leak_site){entry->caller, entry->size, 1, entry->owner};
+         bytes += entry->size;
+      }
    }
+   pthread_mutex_unlock(&leak_lock);
 
-   va_end(args);
+   fwritelnf(stream, "Leaked:                     %zu bytes in %zu allocation(s)", bytes, count);
+   if (count == 0) {
+      __real_free(sites);
+      return;
+   }
+
+   // fold the leaks into one entry per call site
+   qsort(sites, count, sizeof(st_leak_site), compare_site_callers);
+   size_t unique = 0;
+   for (size_t i = 0; i < count; i++) {
+      if (unique > 0 && sites[unique - 1].caller == sites[i].caller) {
+         sites[unique - 1].bytes += sites[i].bytes;
+         sites[unique - 1].count++;
+      } else {
+         sites[unique++] = sites[i];
+      }
+   }
+   qsort(sites, unique, sizeof(st_leak_site), compare_site_bytes);
+
+   fwritelnf(stream, "Top leaking call sites:");
+   for (size_t i = 0; i < unique && i < LEAK_TOP_SITES; i++) {
+      char site[256];
+      format_call_site(sites[i].caller, site, sizeof(site));
+      fwritelnf(stream, "  %zu. %-36s %8zu bytes in %zu allocation(s)%s%s", i + 1, site,
+                sites[i].bytes, sites[i].count,
+                sites[i].owner ? " from " : "", sites[i].owner ? sites[i].owner->info.name : "");
+   }
+   __real_free(sites);
+}
+// release the allocation table
+static void leak_reset(void) {
+   pthread_mutex_lock(&leak_lock);
+   __real_free(leak_table);
+   leak_table = NULL;
+   leak_capacity = leak_live = leak_tombs = 0;
+   pthread_mutex_unlock(&leak_lock);
 }
+// print leaked and peak live bytes of each case in the set
+static void leak_set_report(TestSet set) {
+   fwritelnf(set->log_stream, "Leak tracking (bytes leaked / peak live):");
+   pthread_mutex_lock(&leak_lock);
+   for (int i = 0; i < set->info.count; i++) {
+      TestCase tc = &registry.cases[set->first + i];
+      if (!tc->selected)
+         continue;
+      fwritelnf(set->log_stream, "  %-40s %10zu / %zu", tc->info.name, tc->leak_live, tc->leak_peak);
+   }
+   pthread_mutex_unlock(&leak_lock);
+}
+
+/*
+ * Resource budgets (`--timeout`, `--cpu-time`, `--max-heap`, `--max-allocs`, budget_testcase)
+ * Limits of a case are taken field by field from the case, its set and the runner options. Wall
+ * and CPU time run on per-thread POSIX timers that signal the thread running the case; heap and
+ * allocation counts are charged by the memory wrappers. An exceeded budget unwinds through
+ * `jmpbuffer` while test code runs; otherwise it is only flagged, and loops over rows, inputs or
+ * samples stop at the next one. In `--isolate` mode the runner also kills a worker that outlives
+ * its wall budget.
+ */
+#define ST_BUDGET_SIGNAL (SIGRTMIN + 1)
+#define ST_BUDGET_GRACE_MS 250 // time an isolation worker gets past its wall budget to report
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
 #endif
+enum {
+   BUDGET_WALL = 1,
+   BUDGET_CPU,
+   BUDGET_HEAP,
+   BUDGET_ALLOCS,
+};
+static int budget_heap = 0; /* Some case has a heap budget; keeps the leak tracker on */
+static _Thread_local struct {
+   TestCase tc;                /* Case whose budget is armed on this thread */
+   st_budget limits;
+   volatile sig_atomic_t jump; /* Test code is running under a live jmpbuffer */
+   timer_t timers[2];          /* Wall and CPU time of this thread */
+   int timers_ready;           /* 1 = created, -1 = unavailable */
+} budget_thread;
+
+// brackets a call into test code that an exceeded budget may unwind; a failed assertion skips
+// the reset, so the frame holding `jmpbuffer` clears it with BUDGET_LEAVE before returning
+#define BUDGET_CALL(call)      \
+   do {                        \
+      budget_thread.jump = 1;  \
+      call;                    \
+      budget_thread.jump = 0;  \
+   } while (0)
+#define BUDGET_LEAVE() (budget_thread.jump = 0)
+
+static void budget_exceeded(int kind) {
+   TestCase tc = budget_thread.tc;
+   if (!tc || tc->budget_hit)
+      return;
+   tc->budget_hit = kind;
+   if (budget_thread.jump) {
+      if (budget_hold.depth) {
+         budget_hold.pending = 1;
+         return;
+      }
+      budget_thread.jump = 0;
+      longjmp(jmpbuffer, 1);
+   }
+}
+// take a jump held back by framework code, once it released its locks
+static void budget_unwind(void) {
+   budget_hold.pending = 0;
+   TestCase tc = budget_thread.tc;
+   if (budget_thread.jump && tc && tc->budget_hit) {
+      budget_thread.jump = 0;
+      longjmp(jmpbuffer, 1);
+   }
+}
+static void budget_signal(int sig, siginfo_t *info, void *context) {
+   (void)sig;
+   (void)context;
+   budget_exceeded(info->si_value.sival_int);
+}
+// the handler leaves the signal unblocked, since it may never return
+static void budget_install(void) {
+   struct sigaction action;
+   memset(&action, 0, sizeof(action));
+   action.sa_sigaction = budget_signal;
+   action.sa_flags = SA_SIGINFO | SA_NODEFER | SA_RESTART;
+   sigemptyset(&action.sa_mask);
+   sigaction(ST_BUDGET_SIGNAL, &action, NULL);
+}
+// create the timers of the calling thread once; 1 if they are available
+static int budget_timers(void) {
+   static pthread_once_t installed = PTHREAD_ONCE_INIT;
+   if (budget_thread.timers_ready)
+      return budget_thread.timers_ready;
+   pthread_once(&installed, budget_install);
+
+   const clockid_t clocks[2] = {CLOCK_MONOTONIC, CLOCK_THREAD_CPUTIME_ID};
+   budget_thread.timers_ready = 1;
+   for (int i = 0; i < 2; i++) {
+      struct sigevent event = {
+          .sigev_notify = SIGEV_THREAD_ID,
+          .sigev_signo = ST_BUDGET_SIGNAL,
+          .sigev_value.sival_int = i == 0 ? BUDGET_WALL : BUDGET_CPU,
+      };
+      event.sigev_notify_thread_id = gettid();
+      if (timer_create(clocks[i], &event, &budget_thread.timers[i]) != 0) {
+         fwritelnf(stderr, "Warning: Time budgets are unavailable (%s)", strerror(errno));
+         budget_thread.timers_ready = -1;
+         break;
+      }
+   }
+   return budget_thread.timers_ready;
+}
+static void budget_set_timer(int i, int ms) {
+   struct itimerspec spec = {.it_value = {ms / 1000, (long)(ms % 1000) * 1000000L}};
+   timer_settime(budget_thread.timers[i], 0, &spec, NULL);
+}
+// limits of a case, field by field from the case, its set and the runner options
+static st_budget budget_of(TestCase tc) {
+   const st_budget *levels[3] = {&tc->budget, &tc->set->budget, &runner_options.budget};
+   st_budget limits = {0};
+   for (int i = 0; i < 3; i++) {
+      limits.wall_ms = limits.wall_ms ? limits.wall_ms : levels[i]->wall_ms;
+      limits.cpu_ms = limits.cpu_ms ? limits.cpu_ms : levels[i]->cpu_ms;
+      limits.heap_bytes = limits.heap_bytes ? limits.heap_bytes : levels[i]->heap_bytes;
+      limits.allocs = limits.allocs ? limits.allocs : levels[i]->allocs;
+   }
+   return limits;
+}
+// start charging the case for its time and memory
+static void budget_arm(TestCase tc) {
+   st_budget limits = budget_of(tc);
+   tc->budget_hit = 0;
+   tc->budget_allocs = 0;
+   if (!limits.wall_ms && !limits.cpu_ms && !limits.heap_bytes && !limits.allocs)
+      return;
+   budget_thread.limits = limits;
+   budget_thread.tc = tc;
+   if ((limits.wall_ms || limits.cpu_ms) && budget_timers() > 0) {
+      if (limits.wall_ms)
+         budget_set_timer(0, limits.wall_ms);
+      if (limits.cpu_ms)
+         budget_set_timer(1, limits.cpu_ms);
+   }
+}
+// stop charging the case; an exceeded budget replaces whatever result the case reached
+static void budget_disarm(TestCase tc) {
+   if (budget_thread.tc != tc)
+      return;
+   budget_thread.tc = NULL;
+   st_budget limits = budget_thread.limits;
+   if ((limits.wall_ms || limits.cpu_ms) && budget_thread.timers_ready > 0) {
+      budget_set_timer(0, 0);
+      budget_set_timer(1, 0);
+   }
+   if (!tc->budget_hit)
+      return;
+
+   char message[128];
+   switch (tc->budget_hit) {
+   case BUDGET_WALL:
+      snprintf(message, sizeof(message), "Timeout: exceeded the %d ms wall time budget", limits.wall_ms);
+      break;
+   case BUDGET_CPU:
+      snprintf(message, sizeof(message), "Timeout: exceeded the %d ms CPU time budget", limits.cpu_ms);
+      break;
+   case BUDGET_HEAP:
+      snprintf(message, sizeof(message), "Over budget: %zu bytes of live heap exceed the %zu byte budget", tc->leak_peak,
+               limits.heap_bytes);
+      break;
+   default:
+      snprintf(message, sizeof(message), "Over budget: more than %zu allocations", limits.allocs);
+      break;
+   }
+   tc->info.result.state = tc->budget_hit <= BUDGET_CPU ? TIMEOUT : OVERBUDGET;
+   tc->info.result.message = arena_strdup(message);
+}
+// charge an allocation (or a resize) to the case armed on this thread
+static inline void budget_charge(int counted) {
+   TestCase tc = budget_thread.tc;
+   if (__builtin_expect(!tc, 1))
+      return;
+   if (counted && budget_thread.limits.allocs && ++tc->budget_allocs > budget_thread.limits.allocs)
+      budget_exceeded(BUDGET_ALLOCS);
+   else if (budget_thread.limits.heap_bytes && tc->leak_peak > budget_thread.limits.heap_bytes)
+      budget_exceeded(BUDGET_HEAP);
+}
+// the leak tracker also runs for heap budgets
+static inline int tracking_heap(void) {
+   return runner_options.track_leaks || budget_heap || runner_options.budget.heap_bytes;
+}
+// Set the budget of the most recently registered test case
+void budget_testcase(st_budget budget) {
+   if (current_set && current_set->info.count > 0) {
+      registry.cases[registry.count - 1].budget = budget;
+      budget_heap |= budget.heap_bytes > 0;
+   }
+}
+// Set the budget of the current test set
+void budget_testset(st_budget budget) {
+   if (current_set) {
+      current_set->budget = budget;
+      budget_heap |= budget.heap_bytes > 0;
+   }
+}
+
+/*
+ * Sampling profiler (`--profile <dir>`)
+ * A CPU time timer of each thread running a case, or a pool thread of one, raises SIGPROF about
+ * every millisecond; the kernel checks it at its tick, so a slower tick lowers the rate. While
+ * a case is armed on the thread, the handler unwinds with `backtrace` into a buffer owned by that
+ * thread. Only the handler writes it, and only the same thread reads it after disarming, so no
+ * lock is taken. The samples are folded into `<dir>/<set>.<case>.folded`, one
+ * `outer;...;leaf count` line per distinct stack, as read by flamegraph.pl and speedscope.
+ */
+#define ST_PROFILE_HZ 997          // per second of CPU time; off the round rates of periodic work
+#define ST_PROFILE_DEPTH 64        // frames kept per sample
+#define ST_PROFILE_SKIP 2          // the handler and the signal trampoline
+#define ST_PROFILE_SLOTS (1 << 21) // frame slots per thread; reserved, touched only as used
+static _Thread_local struct {
+   TestCase tc;              /* Case sampled on this thread */
+   void **frames;            /* Samples: a depth, then that many frames */
+   volatile size_t used;     /* Slots written by the handler */
+   volatile size_t dropped;  /* Samples that did not fit */
+   timer_t timer;            /* CPU time of this thread */
+   int ready;                /* 1 = sampling, -1 = unavailable */
+} profile_thread;
+
+static void profile_signal(int sig) {
+   (void)sig;
+   if (!profile_thread.tc)
+      return;
+   int saved = errno;
+   size_t at = profile_thread.used;
+   if (at + 1 + ST_PROFILE_DEPTH > ST_PROFILE_SLOTS) {
+      profile_thread.dropped++;
+   } else {
+      int depth = backtrace(&profile_thread.frames[at + 1], ST_PROFILE_DEPTH);
+      profile_thread.frames[at] = (void *)(intptr_t)depth;
+      atomic_signal_fence(memory_order_release);
+      profile_thread.used = at + 1 + depth;
+   }
+   errno = saved;
+}
+// a forked worker inherits the samples buffer of the forking thread, but not its timer
+static void profile_forked(void) {
+   if (profile_thread.ready > 0)
+      profile_thread.ready = 0;
+}
+static void profile_install(void) {
+   // the first backtrace loads the unwinder, which allocates; keep that out of the handler
+   void *frame;
+   backtrace(&frame, 1);
+   pthread_atfork(NULL, NULL, profile_forked);
+   struct sigaction action;
+   memset(&action, 0, sizeof(action));
+   action.sa_handler = profile_signal;
+   action.sa_flags = SA_RESTART;
+   sigemptyset(&action.sa_mask);
+   sigaction(SIGPROF, &action, NULL);
+}
+// create the sample buffer and timer of the calling thread once; 1 if they are available
+static int profile_timer(void) {
+   static pthread_once_t installed = PTHREAD_ONCE_INIT;
+   if (profile_thread.ready)
+      return profile_thread.ready;
+   pthread_once(&installed, profile_install);
+
+   profile_thread.ready = -1;
+   if (!profile_thread.frames) {
+      void *frames = mmap(NULL, ST_PROFILE_SLOTS * sizeof(void *), PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      if (frames == MAP_FAILED) {
+         fwritelnf(stderr, "Warning: Profiling is unavailable (%s)", strerror(errno));
+         return -1;
+      }
+      profile_thread.frames = frames;
+   }
+   struct sigevent event = {.sigev_notify = SIGEV_THREAD_ID, .sigev_signo = SIGPROF};
+   event.sigev_notify_thread_id = gettid();
+   if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &profile_thread.timer) != 0) {
+      fwritelnf(stderr, "Warning: Profiling is unavailable (%s)", strerror(errno));
+      return -1;
+   }
+   // the timer keeps running between cases, where the handler returns at once; arming a case
+   // then costs no system call
+   long ns = 1000000000L / ST_PROFILE_HZ;
+   struct itimerspec spec = {.it_interval = {0, ns}, .it_value = {0, ns}};
+   timer_settime(profile_thread.timer, 0, &spec, NULL);
+   return profile_thread.ready = 1;
+}
+// `<dir>/<set>.<case>.folded`, with anything but [A-Za-z0-9_.-] in the names as '_'
+static int profile_path(TestCase tc, char *path, size_t size) {
+   const char *dir = runner_options.profile;
+   int len = snprintf(path, size, "%s/%s.%s.folded", dir, tc->set->info.name, tc->info.name);
+   if (len < 0 || (size_t)len >= size)
+      return -1;
+   for (char *c = path + strlen(dir) + 1; *c; c++) {
+      if (!isalnum((unsigned char)*c) && *c != '_' && *c != '.' && *c != '-')
+         *c = '_';
+   }
+   return 0;
+}
+// start sampling the case on the calling thread
+static void profile_arm(TestCase tc) {
+   if (!runner_options.profile || profile_timer() < 0)
+      return;
+   profile_thread.used = 0;
+   profile_thread.dropped = 0;
+   atomic_signal_fence(memory_order_release);
+   profile_thread.tc = tc;
+}
+// free the sampler of a thread that is about to exit
+static void profile_release(void) {
+   if (profile_thread.ready > 0)
+      timer_delete(profile_thread.timer);
+   if (profile_thread.frames)
+      munmap(profile_thread.frames, ST_PROFILE_SLOTS * sizeof(void *));
+   profile_thread.frames = NULL;
+   profile_thread.ready = 0;
+}
+// functions of the symbol table of a loaded object; static functions are not in its dynamic
+// symbols, so `dladdr` does not name them
+typedef struct {
+   uintptr_t start;
+   uintptr_t size;
+   const char *name;
+} st_symbol;
+typedef struct st_symbol_file_s {
+   struct st_symbol_file_s *next;
+   void *base;         /* Load address of the object */
+   st_symbol *symbols; /* By start address; names point into the mapped file */
+   size_t count;
+} st_symbol_file;
+static st_symbol_file *symbol_files = NULL;
+static pthread_mutex_t symbol_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int symbol_compare(const void *a, const void *b) {
+   uintptr_t x = ((const st_symbol *)a)->start, y = ((const st_symbol *)b)->start;
+   return x < y ? -1 : x > y;
+}
+// read the function symbols of `path`, loaded at `base`; an object without any has none
+static void symbol_load(st_symbol_file *file, const char *path) {
+   int fd = open(path, O_RDONLY | O_CLOEXEC);
+   struct stat st;
+   if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ElfW(Ehdr))) {
+      if (fd >= 0)
+         close(fd);
+      return;
+   }
+   size_t size = (size_t)st.st_size;
+   const char *image = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (image == MAP_FAILED)
+      return;
+   const ElfW(Ehdr) *header = (const void *)image;
+   if (memcmp(header->e_ident, ELFMAG, SELFMAG) != 0 || header->e_shoff == 0 ||
+       header->e_shoff + (size_t)header->e_shnum * sizeof(ElfW(Shdr)) > size) {
+      munmap((void *)image, size);
+      return;
+   }
+   const ElfW(Shdr) *sections = (const void *)(image + header->e_shoff);
+   uintptr_t bias = header->e_type == ET_DYN ? (uintptr_t)file->base : 0;
+   for (int i = 0; i < header->e_shnum; i++) {
+      const ElfW(Shdr) *table = &sections[i];
+      if (table->sh_type != SHT_SYMTAB || table->sh_link >= header->e_shnum)
+         continue;
+      const ElfW(Shdr) *strings = &sections[table->sh_link];
+      if (table->sh_offset + table->sh_size > size || strings->sh_offset + strings->sh_size > size)
+         continue;
+      const ElfW(Sym) *symbols = (const void *)(image + table->sh_offset);
+      size_t count = table->sh_size / sizeof(ElfW(Sym));
+      file->symbols = __real_malloc(count * sizeof(st_symbol));
+      for (size_t j = 0; file->symbols && j < count; j++) {
+         const ElfW(Sym) *symbol = &symbols[j];
+         if (ELF64_ST_TYPE(symbol->st_info) != STT_FUNC || symbol->st_shndx == SHN_UNDEF || !symbol->st_value ||
+             symbol->st_name >= strings->sh_size)
+            continue;
+         file->symbols[file->count++] = (st_symbol){bias + symbol->st_value, symbol->st_size,
+                                                    image + strings->sh_offset + symbol->st_name};
+      }
+      break;
+   }
+   if (file->count) {
+      qsort(file->symbols, file->count, sizeof(st_symbol), symbol_compare);
+   } else {
+      __real_free(file->symbols);
+      file->symbols = NULL;
+      munmap((void *)image, size);
+   }
+}
+// the function symbol holding `pc` in the object described by `info`
+static const st_symbol *symbol_find(const Dl_info *info, uintptr_t pc) {
+   static void *main_base = NULL;
+   pthread_mutex_lock(&symbol_lock);
+   if (!main_base) {
+      Dl_info entry;
+      main_base = dladdr((void *)getauxval(AT_ENTRY), &entry) ? entry.dli_fbase : (void *)-1;
+   }
+   st_symbol_file *file = symbol_files;
+   while (file && file->base != info->dli_fbase)
+      file = file->next;
+   if (!file && (file = __real_calloc(1, sizeof(*file)))) {
+      file->base = info->dli_fbase;
+      // the name of the main program is how it was started, which need not be a path
+      symbol_load(file, info->dli_fbase == main_base ? "/proc/self/exe" : info->dli_fname);
+      file->next = symbol_files;
+      symbol_files = file;
+   }
+   pthread_mutex_unlock(&symbol_lock);
+   if (!file)
+      return NULL;
+
+   size_t low = 0, high = file->count;
+   while (low < high) {
+      size_t mid = low + (high - low) / 2;
+      if (file->symbols[mid].start <= pc)
+         low = mid + 1;
+      else
+         high = mid;
+   }
+   const st_symbol *symbol = low ? &file->symbols[low - 1] : NULL;
+   return symbol && (pc < symbol->start + symbol->size || pc == symbol->start) ? symbol : NULL;
+}
+// the function holding `pc`: its start address, with its name; `pc` itself if it has none
+static void *profile_function(void *pc, const char **name, Dl_info *info) {
+   *name = NULL;
+   if (!dladdr(pc, info)) {
+      info->dli_fname = NULL;
+      return pc;
+   }
+   if (info->dli_sname && info->dli_saddr) {
+      *name = info->dli_sname;
+      return info->dli_saddr;
+   }
+   const st_symbol *symbol = symbol_find(info, (uintptr_t)pc);
+   if (!symbol)
+      return pc;
+   *name = symbol->name;
+   return (void *)symbol->start;
+}
+// name of a frame: its function, else its offset in the object holding it
+static void profile_frame(FILE *out, void *frame) {
+   Dl_info info;
+   const char *name;
+   profile_function(frame, &name, &info);
+   if (name) {
+      fputs(name, out);
+   } else if (info.dli_fname) {
+      const char *base = strrchr(info.dli_fname, '/');
+      fprintf(out, "%s+0x%lx", base ? base + 1 : info.dli_fname, (unsigned long)((char *)frame - (char *)info.dli_fbase));
+   } else {
+      fprintf(out, "%p", frame);
+   }
+}
+static int profile_compare(const void *a, const void *b) {
+   void *const *x = *(void **const *)a, *const *y = *(void **const *)b;
+   intptr_t dx = (intptr_t)x[0], dy = (intptr_t)y[0];
+   if (dx != dy)
+      return dx < dy ? -1 : 1;
+   for (intptr_t i = 1; i <= dx; i++) {
+      if (x[i] != y[i])
+         return (uintptr_t)x[i] < (uintptr_t)y[i] ? -1 : 1;
+   }
+   return 0;
+}
+// stop sampling the case and fold its samples into its profile
+static void profile_disarm(TestCase tc) {
+   if (profile_thread.tc != tc || !tc)
+      return;
+   profile_thread.tc = NULL;
+   atomic_signal_fence(memory_order_acquire);
+
+   size_t used = profile_thread.used, count = 0;
+   for (size_t at = 0; at < used; at += 1 + (intptr_t)profile_thread.frames[at])
+      count++;
+   if (profile_thread.dropped)
+      fwritelnf(stderr, "Warning: The profile of %s dropped %zu samples", tc->info.name, (size_t)profile_thread.dropped);
+   if (!count)
+      return;
+   void ***samples = __real_malloc(count * sizeof(*samples));
+   if (!samples)
+      return;
+   // stacks through the same functions fold into one line, wherever in them they were sampled
+   count = 0;
+   for (size_t at = 0; at < used; at += 1 + (intptr_t)profile_thread.frames[at]) {
+      void **stack = &profile_thread.frames[at];
+      samples[count++] = stack;
+      for (intptr_t f = 1; f <= (intptr_t)stack[0]; f++) {
+         Dl_info info;
+         const char *name;
+         // return addresses point past the call; the interrupted frame is exact
+         void *pc = f > ST_PROFILE_SKIP + 1 ? (char *)stack[f] - 1 : stack[f];
+         stack[f] = f > ST_PROFILE_SKIP ? profile_function(pc, &name, &info) : NULL;
+      }
+   }
+   qsort(samples, count, sizeof(*samples), profile_compare);
+
+   // the first thread of the case to report replaces the profile of an earlier run, the others
+   // append their stacks to it
+   static pthread_mutex_t profile_lock = PTHREAD_MUTEX_INITIALIZER;
+   const char *dir = runner_options.profile;
+   char path[PATH_MAX];
+   FILE *out = NULL;
+   pthread_mutex_lock(&profile_lock);
+   if (mkdir(dir, 0755) != 0 && errno != EEXIST)
+      fwritelnf(stderr, "Error: Cannot create profile directory %s: %s", dir, strerror(errno));
+   else if (profile_path(tc, path, sizeof(path)) == 0 && !(out = fopen(path, tc->profiled ? "a" : "w")))
+      fwritelnf(stderr, "Error: Cannot write profile %s: %s", path, strerror(errno));
+   tc->profiled |= out != NULL;
+   if (!out) {
+      pthread_mutex_unlock(&profile_lock);
+      __real_free(samples);
+      return;
+   }
+
+   for (size_t i = 0, run; i < count; i += run) {
+      for (run = 1; i + run < count && profile_compare(&samples[i], &samples[i + run]) == 0; run++)
+         ;
+      void **stack = samples[i];
+      intptr_t depth = (intptr_t)stack[0];
+      for (intptr_t f = depth; f > ST_PROFILE_SKIP; f--) {
+         profile_frame(out, stack[f]);
+         fputc(f > ST_PROFILE_SKIP + 1 ? ';' : ' ', out);
+      }
+      if (depth > ST_PROFILE_SKIP)
+         fprintf(out, "%zu\n", run);
+   }
+   fclose(out);
+   pthread_mutex_unlock(&profile_lock);
+   __real_free(samples);
+}
 
 #if 1 // Region: Memory wrappers
+// thread exit: the pending counts still belong to the running case, so the shared slot takes
+// them; the slot goes back to the free list
+static void release_alloc_slot(void *value) {
+   st_alloc_slot *slot = value, *shared = &alloc_slots[ST_ALLOC_SLOTS];
+   atomic_fetch_add_explicit(&shared->allocs, atomic_exchange_explicit(&slot->allocs, 0, memory_order_relaxed),
+                             memory_order_relaxed);
+   atomic_fetch_add_explicit(&shared->frees, atomic_exchange_explicit(&slot->frees, 0, memory_order_relaxed),
+                             memory_order_relaxed);
+   // later thread destructors may still allocate
+   alloc_slot = shared;
+   pthread_mutex_lock(&alloc_slots_lock);
+   alloc_slots_free[alloc_slots_free_count++] = (int)(slot - alloc_slots);
+   pthread_mutex_unlock(&alloc_slots_lock);
+}
+static void create_alloc_slot_key(void) {
+   pthread_key_create(&alloc_slot_key, release_alloc_slot);
+}
+// claim the calling thread's counter slot: a released one, else a fresh one, else the shared one
+static st_alloc_slot *claim_alloc_slot(void) {
+   static pthread_once_t keyed = PTHREAD_ONCE_INIT;
+   pthread_once(&keyed, create_alloc_slot_key);
+   int index = ST_ALLOC_SLOTS;
+   pthread_mutex_lock(&alloc_slots_lock);
+   int used = atomic_load_explicit(&alloc_slots_used, memory_order_relaxed);
+   if (alloc_slots_free_count > 0)
+      index = alloc_slots_free[--alloc_slots_free_count];
+   else if (used < ST_ALLOC_SLOTS)
+      index = atomic_fetch_add_explicit(&alloc_slots_used, 1, memory_order_relaxed);
+   pthread_mutex_unlock(&alloc_slots_lock);
+   alloc_slot = &alloc_slots[index];
+   if (index < ST_ALLOC_SLOTS)
+      pthread_setspecific(alloc_slot_key, alloc_slot);
+   return alloc_slot;
+}
+// Index of the counter slot of the calling thread; ST_ALLOC_SLOTS is the shared one
+int _sigtest_alloc_slot(void) {
+   return (int)((alloc_slot ? alloc_slot : claim_alloc_slot()) - alloc_slots);
+}
+// take and reset the counts of every slot
+static void take_alloc_counts(size_t *allocs, size_t *frees) {
+   int used = atomic_load_explicit(&alloc_slots_used, memory_order_relaxed);
+   *allocs = 0;
+   *frees = 0;
+   // the claimed slots, then the shared one
+   for (int i = 0; i <= used; i++) {
+      st_alloc_slot *slot = &alloc_slots[i < used ? i : ST_ALLOC_SLOTS];
+      *allocs += atomic_exchange_explicit(&slot->allocs, 0, memory_order_relaxed);
+      *frees += atomic_exchange_explicit(&slot->frees, 0, memory_order_relaxed);
+   }
+}
+// credit counts made elsewhere (e.g. by an isolation worker) to the calling thread
+static void add_alloc_counts(size_t allocs, size_t frees) {
+   st_alloc_slot *slot = alloc_slot ? alloc_slot : claim_alloc_slot();
+   atomic_fetch_add_explicit(&slot->allocs, allocs, memory_order_relaxed);
+   atomic_fetch_add_explicit(&slot->frees, frees, memory_order_relaxed);
+}
+static void count_alloc(size_t s, void *p) {
+   st_alloc_slot *slot = alloc_slot ? alloc_slot : claim_alloc_slot();
+   atomic_fetch_add_explicit(&slot->allocs, 1, memory_order_relaxed);
+   ST_Hooks hooks = current_hooks;
+   if (hooks && hooks->on_memory_alloc) {
+      hooks->on_memory_alloc(s, p, hooks->context);
+   }
+}
+static void count_free(void *p) {
+   st_alloc_slot *slot = alloc_slot ? alloc_slot : claim_alloc_slot();
+   atomic_fetch_add_explicit(&slot->frees, 1, memory_order_relaxed);
+   ST_Hooks hooks = current_hooks;
+   if (hooks && hooks->on_memory_free) {
+      hooks->on_memory_free(p, hooks->context);
+   }
+}
+// the allocator and the leak table hold locks; an exceeded budget unwinds at the return
 void *__wrap_malloc(size_t s) {
+   BUDGET_HOLD();
    void *p = __real_malloc(s);
    if (p) {
-      atomic_fetch_add(&global_allocs, 1);
-      if (current_hooks && current_hooks->on_memory_alloc) {
-         current_hooks->on_memory_alloc(s, p, current_hooks->context);
+      if (tracking_heap()) {
+         pthread_mutex_lock(&leak_lock);
+         leak_insert(p, s, __builtin_return_address(0));
+         pthread_mutex_unlock(&leak_lock);
       }
+      count_alloc(s, p);
+      budget_charge(1);
    }
+   BUDGET_RELEASE();
    return p;
 }
+void *__wrap_calloc(size_t n, size_t s) {
+   BUDGET_HOLD();
+   void *p = __real_calloc(n, s);
+   if (p) {
+      if (tracking_heap()) {
+         pthread_mutex_lock(&leak_lock);
+         leak_insert(p, n * s, __builtin_return_address(0));
+         pthread_mutex_unlock(&leak_lock);
+      }
+      count_alloc(n * s, p);
+      budget_charge(1);
+   }
+   BUDGET_RELEASE();
+   return p;
+}
+void *__wrap_realloc(void *p, size_t s) {
+   void *r;
+   BUDGET_HOLD();
+   if (tracking_heap()) {
+      // hold the table across the call so a freed block handed to another thread isn't confused with ours
+      pthread_mutex_lock(&leak_lock);
+      r = __real_realloc(p, s);
+      if (p && (r || s == 0))
+         leak_remove(p);
+      if (r)
+         leak_insert(r, s, __builtin_return_address(0));
+      pthread_mutex_unlock(&leak_lock);
+   } else {
+      r = __real_realloc(p, s);
+   }
+   // a resize in place or a move is neither an allocation nor a free
+   if (!p && r)
+      count_alloc(s, r);
+   else if (p && s == 0)
+      count_free(p);
+   if (r)
+      budget_charge(!p);
+   BUDGET_RELEASE();
+   return r;
+}
 void __wrap_free(void *p) {
+   BUDGET_HOLD();
    if (p) {
-      atomic_fetch_add(&global_frees, 1);
-      if (current_hooks && current_hooks->on_memory_free) {
-         current_hooks->on_memory_free(p, current_hooks->context);
+      if (tracking_heap()) {
+         pthread_mutex_lock(&leak_lock);
+         leak_remove(p);
+         pthread_mutex_unlock(&leak_lock);
       }
+      count_free(p);
    }
    __real_free(p);
+   BUDGET_RELEASE();
 }
 #endif
 
@@ -738,6 +1986,9 @@ const st_assert_i Assert = {
     .throw = assert_throw,
     .fail = assert_fail,
     .skip = assert_skip,
+    .arrayEqual = assert_array_equal,
+    .arrayWithin = assert_array_within,
+    .memEqual = assert_mem_equal,
 };
 
 // Register test set
@@ -752,34 +2003,35 @@ void testset(string name, ConfigFunc config, CleanupFunc cleanup) {
       atexit_registered = 1;
    }
 
-   TestSet set = __real_malloc(sizeof(struct st_set_s));
+   TestSet set = arena_alloc(sizeof(struct st_set_s));
    if (!set) {
       fwritelnf(stdout, "Failed to allocate memory for test set\n");
       exit(EXIT_FAILURE);
    }
-   set->info.name = strdup(name);
+   set->info.name = arena_strdup(name);
    set->cleanup = cleanup;
    set->setup = NULL;
    set->teardown = NULL;
    set->log_stream = stdout;
-   set->cases = NULL;
-   set->tail = NULL;
+   set->first = registry.count;
    set->info.count = 0;
    set->info.passed = 0;
    set->info.failed = 0;
    set->info.skipped = 0;
+   set->info.regressed = 0;
    set->current = NULL;
    set->next = test_sets;
    /* do not allocate a logger here; assign default logger during set_init */
    set->logger = NULL;
 
-   // Execute config immediately if provided (open log stream first)
+   // Config is deferred until the set is selected to run; anything logged to the set before
+   // then is held and replayed into the configured stream
+   set->config = config;
+   set->configured = !config;
    if (config) {
-      config(&set->log_stream);
-      if (!set->log_stream) {
-         set->log_stream = stdout; // Fallback to stdout if config fails
-      }
-      /* Do not write header here — runner's before_set will write it when executing */
+      set->pending = open_memstream(&set->pending_buf, &set->pending_len);
+      if (set->pending)
+         set->log_stream = set->pending;
    } else {
       // no config function we need to default log_stream to console output
       set->log_stream = stdout;
@@ -789,9 +2041,9 @@ void testset(string name, ConfigFunc config, CleanupFunc cleanup) {
 
    // Handle allocation failure after config
    if (!set->info.name) {
-      if (set->log_stream != stdout && set->log_stream)
-         fclose(set->log_stream);
-      __real_free(set);
+      if (set->pending)
+         fclose(set->pending);
+      __real_free(set->pending_buf);
       writelnf("Failed to allocate memory for test set name\n");
       exit(EXIT_FAILURE);
    }
@@ -809,16 +2061,6 @@ void testcase(string name, TestFunc func) {
 
    TestCase tc = create_testcase(name);
    tc->func.test = func;
-
-   if (!current_set->cases) {
-      current_set->cases = tc;
-      current_set->tail = tc;
-   } else {
-      current_set->tail->next = tc;
-      current_set->tail = tc;
-   }
-
-   current_set->info.count++;
 }
 // Register test to test registry with expectation to fail
 void fail_testcase(string name, void (*func)(void)) {
@@ -829,16 +2071,6 @@ void fail_testcase(string name, void (*func)(void)) {
    TestCase tc = create_testcase(name);
    tc->func.test = func;
    tc->expect_fail = TRUE;
-
-   if (!current_set->cases) {
-      current_set->cases = tc;
-      current_set->tail = tc;
-   } else {
-      current_set->tail->next = tc;
-      current_set->tail = tc;
-   }
-
-   current_set->info.count++;
 }
 // Register test to test registry with expectation to throw
 void testcase_throws(string name, void (*func)(void)) {
@@ -849,16 +2081,6 @@ void testcase_throws(string name, void (*func)(void)) {
    TestCase tc = create_testcase(name);
    tc->func.test = func;
    tc->expect_throw = TRUE;
-
-   if (!current_set->cases) {
-      current_set->cases = tc;
-      current_set->tail = tc;
-   } else {
-      current_set->tail->next = tc;
-      current_set->tail = tc;
-   }
-
-   current_set->info.count++;
 }
 // Register a fuzz test case
 void fuzz_testcase(string name, FuzzyFunc func, FuzzType type) {
@@ -870,18 +2092,117 @@ void fuzz_testcase(string name, FuzzyFunc func, FuzzType type) {
    tc->is_fuzz = TRUE;
    tc->func.fuzz = func;
    tc->fuzz_type = type;
+}
+// Register a benchmark test case
+void bench_testcase(string name, TestFunc func) {
+   if (!current_set) {
+      testset("default", NULL, NULL);
+   }
 
-   if (!current_set->cases) {
-      current_set->cases = tc;
-      current_set->tail = tc;
-   } else {
-      current_set->tail->next = tc;
-      current_set->tail = tc;
+   TestCase tc = create_testcase(name);
+   tc->is_bench = TRUE;
+   tc->func.test = func;
+   tc->bench = arena_alloc(sizeof(struct st_bench_run_s));
+   if (!tc->bench) {
+      fwritelnf(stderr, "Error: Failed to allocate benchmark `%s`", name);
+      exit(EXIT_FAILURE);
    }
+}
 
-   current_set->info.count++;
+// Register a parameterized test case; row results are allocated once, with the case
+void param_testcase(string name, ParamFunc func, const void *table, size_t count, size_t elem_size, ParamFormat format) {
+   if (!current_set) {
+      testset("default", NULL, NULL);
+   }
+
+   TestCase tc = create_testcase(name);
+   tc->is_param = TRUE;
+   tc->func.param = func;
+   tc->params = arena_alloc(sizeof(st_param_results));
+   if (tc->params)
+      tc->params->rows = arena_alloc((count ? count : 1) * sizeof(st_param_row));
+   if (!tc->params || !tc->params->rows) {
+      fwritelnf(stderr, "Error: Failed to allocate parameterized test `%s`", name);
+      exit(EXIT_FAILURE);
+   }
+   tc->params->table = table;
+   tc->params->count = count;
+   tc->params->elem_size = elem_size;
+   tc->params->format = format;
+   tc->params->last = count;
 }
 
+// Tag registry: tag names map to bits of the case/set tag masks
+#define MAX_TAGS 64
+static string tag_names[MAX_TAGS];
+static int tag_count = 0;
+
+// look up (or register) a tag; returns its bit or 0 if the table is full
+static uint64_t tag_bit(const char *name, size_t len, int create) {
+   for (int i = 0; i < tag_count; i++) {
+      if (strlen(tag_names[i]) == len && strncmp(tag_names[i], name, len) == 0)
+         return 1ull << i;
+   }
+   if (!create)
+      return 0;
+   if (tag_count == MAX_TAGS) {
+      fwritelnf(stderr, "Warning: More than %d tags registered; ignoring '%.*s'", MAX_TAGS, (int)len, name);
+      return 0;
+   }
+   string copy = arena_alloc(len + 1);
+   if (!copy)
+      return 0;
+   memcpy(copy, name, len);
+   copy[len] = '\0';
+   tag_names[tag_count] = copy;
+   return 1ull << tag_count++;
+}
+// parse a comma separated tag list into a tag mask; `!tag` entries go to the exclude mask and
+// `plain` counts the other entries, known or not
+static uint64_t parse_tags(const char *tags, int create, uint64_t *exclude, int *plain) {
+   uint64_t mask = 0;
+   while (tags && *tags) {
+      size_t len = strcspn(tags, ",");
+      const char *name = tags;
+      while (len > 0 && *name == ' ') {
+         name++;
+         len--;
+      }
+      int negate = exclude && len > 0 && *name == '!';
+      if (negate) {
+         name++;
+         len--;
+      }
+      while (len > 0 && name[len - 1] == ' ')
+         len--;
+      if (len > 0) {
+         uint64_t bit = tag_bit(name, len, create);
+         if (negate) {
+            *exclude |= bit;
+         } else {
+            mask |= bit;
+            if (plain)
+               (*plain)++;
+         }
+      }
+      tags += strcspn(tags, ",");
+      if (*tags == ',')
+         tags++;
+   }
+   return mask;
+}
+// Tag the most recently registered test case
+void tag_testcase(const char *tags) {
+   if (current_set && current_set->info.count > 0) {
+      registry.cases[registry.count - 1].tags |= parse_tags(tags, TRUE, NULL, NULL);
+   }
+}
+// Tag the current test set
+void tag_testset(const char *tags) {
+   if (current_set) {
+      current_set->tags |= parse_tags(tags, TRUE, NULL, NULL);
+   }
+}
 // Setup test case
 void setup_testcase(CaseOp setup) {
    if (current_set) {
@@ -894,38 +2215,628 @@ void teardown_testcase(CaseOp teardown) {
       current_set->teardown = teardown;
    }
 }
-// Create a test case with common defaults
-static TestCase create_testcase(string name) {
-   TestCase tc = __real_malloc(sizeof(struct st_case_s));
-   if (!tc) {
-      writef("Failed to allocate memory for test case `%s`\n", name);
-      exit(EXIT_FAILURE);
+
+/*
+ * Captured output (`--capture`, `--capture-fds`)
+ * What a case writes through `writef`, `writelnf` and the default debug log is held in a
+ * per-thread ring reused by every case, and in an unlinked spill file once a case outgrows the
+ * ring. The capture reaches the set log only when the case fails, written straight from the
+ * ring and a mapping of the file; a passing case just rewinds them, so it costs no log I/O.
+ * With `--capture-fds` fd 1 and 2 of the case are redirected into the spill file as well, and
+ * the other output follows them there to keep the order. Descriptors are process wide, so that
+ * needs serial sets, or `--isolate` where each worker redirects its own.
+ */
+#define ST_CAPTURE_RING (64 * 1024)
+typedef struct st_capture_s {
+   char *ring;       // ST_CAPTURE_RING bytes, allocated by the first capture on the thread
+   size_t used;      // ring bytes of the current case
+   int fd;           // spill file; -1 until the thread first needs it
+   int to_file;      // output goes to the spill file: the ring overflowed or fd 1 and 2 are there
+   int active;       // a case is being captured
+   int saved_fds[2]; // fd 1 and 2 while redirected, else -1
+} st_capture;
+static _Thread_local st_capture captured = {.fd = -1, .saved_fds = {-1, -1}};
+static CaptureMode capture_mode = CAPTURE_OFF; // runner_options.capture as resolved for the run
+static int write_full(int, const void *, size_t);
+
+// the spill file of this thread; a memfd where available, so it never touches a disk
+static int capture_file(void) {
+   if (captured.fd >= 0)
+      return captured.fd;
+#ifdef MFD_CLOEXEC
+   captured.fd = memfd_create("sigtest-capture", MFD_CLOEXEC);
+#endif
+   if (captured.fd < 0) {
+      char path[] = "/tmp/sigtest-capture-XXXXXX";
+      captured.fd = mkstemp(path);
+      if (captured.fd >= 0)
+         unlink(path);
    }
-   memset(&tc->info, 0, sizeof(TcInfo));
-   tc->info.name = strdup(name);
+   return captured.fd;
+}
+// a forked worker must not share the spill file (and its offset) of the runner thread
+static void capture_forked(void) {
+   if (captured.fd >= 0)
+      close(captured.fd);
+   captured.fd = -1;
+   captured.used = 0;
+   captured.to_file = 0;
+   captured.active = 0;
+}
+static void capture_write(const char *text, size_t len) {
+   if (!captured.to_file && captured.used + len <= ST_CAPTURE_RING) {
+      memcpy(captured.ring + captured.used, text, len);
+      captured.used += len;
+      return;
+   }
+   // stdio output of the case is ahead of this in the redirected descriptors
+   if (captured.saved_fds[0] >= 0) {
+      fflush(stdout);
+      fflush(stderr);
+   }
+   // output that cannot be kept is dropped like the rest of a passing case
+   if (capture_file() >= 0 && write_full(captured.fd, text, len) == 0)
+      captured.to_file = 1;
+}
+// start capturing the case about to run; `fds` also redirects fd 1 and 2 in CAPTURE_FDS mode
+static void capture_begin(int fds) {
+   if (capture_mode == CAPTURE_OFF)
+      return;
+   if (!captured.ring && !(captured.ring = __real_malloc(ST_CAPTURE_RING)))
+      return;
+   captured.used = 0;
+   captured.to_file = 0;
+   if (fds && capture_mode == CAPTURE_FDS && capture_file() >= 0) {
+      fflush(stdout);
+      fflush(stderr);
+      for (int i = 0; i < 2; i++) {
+         captured.saved_fds[i] = dup(STDOUT_FILENO + i);
+         if (captured.saved_fds[i] >= 0)
+            dup2(captured.fd, STDOUT_FILENO + i);
+      }
+      captured.to_file = 1;
+   }
+   captured.active = 1;
+   line_open = 0;
+}
+// give fd 1 and 2 back; the rest of the case output is still captured
+static void capture_release_fds(void) {
+   if (captured.saved_fds[0] < 0 && captured.saved_fds[1] < 0)
+      return;
+   fflush(stdout);
+   fflush(stderr);
+   for (int i = 0; i < 2; i++) {
+      if (captured.saved_fds[i] < 0)
+         continue;
+      dup2(captured.saved_fds[i], STDOUT_FILENO + i);
+      close(captured.saved_fds[i]);
+      captured.saved_fds[i] = -1;
+   }
+}
+// write captured bytes to the log without another copy: straight to its descriptor when it has one
+static void capture_emit(FILE *stream, const char *data, size_t len) {
+   int out = fileno(stream);
+   if (out >= 0) {
+      fflush(stream);
+      write_full(out, data, len);
+   } else {
+      fwrite(data, 1, len, stream);
+   }
+}
+// end the capture of a case; `keep` writes it to the set log, otherwise it is discarded
+static void capture_finish(int keep) {
+   if (!captured.active)
+      return;
+   capture_release_fds();
+   captured.active = 0;
+
+   struct stat spill;
+   size_t spilled = 0;
+   if (captured.to_file && fstat(captured.fd, &spill) == 0)
+      spilled = (size_t)spill.st_size;
+   if (keep && (captured.used || spilled)) {
+      FILE *stream = st_log_stream();
+      // the output starts below the open Running line
+      if (current_tc && current_tc->ran_no_newline) {
+         fputc('\n', stream);
+         current_tc->ran_no_newline = 0;
+         current_tc->had_debug = 1;
+      }
+      capture_emit(stream, captured.ring, captured.used);
+      if (spilled) {
+         void *map = mmap(NULL, spilled, PROT_READ, MAP_SHARED, captured.fd, 0);
+         if (map != MAP_FAILED) {
+            capture_emit(stream, map, spilled);
+            munmap(map, spilled);
+         }
+      }
+      fflush(stream);
+   }
+
+   captured.used = 0;
+   if (captured.to_file) {
+      captured.to_file = 0;
+      if (ftruncate(captured.fd, 0) != 0 || lseek(captured.fd, 0, SEEK_SET) != 0) {
+         close(captured.fd);
+         captured.fd = -1;
+      }
+   }
+}
+
+/*
+ * Cross-thread assertions (`st_thread_pool`, `st_thread_attach`)
+ * Threads started by test code have no runner state, so a failed assertion there must not
+ * unwind into the runner's jump buffer. Instead the failure is recorded with the case the
+ * thread belongs to (the first failure wins) and reported by the runner thread once the body
+ * returns. Output written on such a thread is held with the case and logged at the same
+ * point, so only the runner thread touches the log line state. A thread belongs to the case
+ * it was attached to, or started for by st_thread_pool; any other thread belongs to the
+ * running case while it is the only one running. Pool threads stop their workload at a failed
+ * assertion, as the runner does; other threads carry on after it.
+ */
+typedef struct st_cross_s {
+   TestState state; // first failure reported by another thread, or PASS
+   string message;
+   char *output; // lines other threads wrote for the case
+   size_t used;
+   size_t size;
+} st_cross;
+typedef struct {
+   pthread_mutex_t lock;
+   pthread_cond_t changed;
+   int state; // 0 while the pool starts, 1 to run, -1 to give up
+} st_pool_gate;
+typedef struct {
+   pthread_t thread;
+   ThreadWork work;
+   object arg;
+   size_t index;
+   TestCase tc;
+   st_thread_time *time;
+   st_pool_gate *gate;
+} st_pool_thread;
+static pthread_mutex_t cross_lock = PTHREAD_MUTEX_INITIALIZER;
+static int cases_running = 0;       // under cross_lock
+static uintptr_t running_sum = 0;   // sum of the running cases; the case itself while only one runs
+static TestCase _Atomic solo_case = NULL; // the running case while only one is
+static _Thread_local TestCase attached_case = NULL;
+static _Thread_local int pool_thread = 0; // failures unwind the workload of this st_thread_pool thread
+
+// the case a failure or output of this thread belongs to, or NULL on a runner thread
+static inline TestCase running_case(void) {
+   return worker_case ? worker_case : current_set ? current_set->current : NULL;
+}
+static TestCase cross_case(void) {
+   if (attached_case)
+      return attached_case;
+   return atomic_load(&solo_case);
+}
+// the reports of a case; called under cross_lock
+static st_cross *cross_of(TestCase tc) {
+   if (!tc->cross)
+      tc->cross = __real_calloc(1, sizeof(st_cross));
+   return tc->cross;
+}
+static void cross_fail(TestState state, const string message) {
+   TestCase tc = cross_case();
+   if (state == PASS)
+      return;
+   if (!tc) {
+      fwritelnf(stderr, "Warning: An assertion failed on a thread of no single running case; attach it with "
+                        "st_thread_attach: %s", message ? message : "");
+      return;
+   }
+   pthread_mutex_lock(&cross_lock);
+   st_cross *cross = cross_of(tc);
+   if (cross && cross->state == PASS) {
+      cross->state = state;
+      cross->message = message ? arena_strdup(message) : NULL;
+   }
+   pthread_mutex_unlock(&cross_lock);
+   if (pool_thread)
+      longjmp(jmpbuffer, 1);
+}
+// hold one `writef` of another thread as a log line of its case; 0 if it has no case
+static int cross_write(const char *text, size_t len) {
+   TestCase tc = cross_case();
+   if (!tc)
+      return 0;
+   pthread_mutex_lock(&cross_lock);
+   st_cross *cross = cross_of(tc);
+   size_t need = len + 6; // "  - ", a newline and the terminator
+   if (cross && cross->used + need > cross->size) {
+      size_t size = cross->size ? cross->size : 1024;
+      while (cross->used + need > size)
+         size *= 2;
+      char *output = __real_realloc(cross->output, size);
+      if (output) {
+         cross->output = output;
+         cross->size = size;
+      }
+   }
+   if (cross && cross->used + need <= cross->size) {
+      memcpy(cross->output + cross->used, "  - ", 4);
+      memcpy(cross->output + cross->used + 4, text, len);
+      cross->used += len + 4;
+      if (!len || text[len - 1] != '\n')
+         cross->output[cross->used++] = '\n';
+   }
+   pthread_mutex_unlock(&cross_lock);
+   return 1;
+}
+// report what other threads recorded for the case; returns 1 if that failed the case
+static int cross_take(TestCase tc) {
+   pthread_mutex_lock(&cross_lock);
+   st_cross *cross = tc->cross;
+   tc->cross = NULL;
+   pthread_mutex_unlock(&cross_lock);
+   if (!cross)
+      return 0;
+
+   if (cross->used && captured.active) {
+      capture_write(cross->output, cross->used);
+   } else if (cross->used) {
+      FILE *stream = st_log_stream();
+      if (tc->ran_no_newline) {
+         fputc('\n', stream);
+         tc->ran_no_newline = 0;
+         tc->had_debug = 1;
+      }
+      fwrite(cross->output, 1, cross->used, stream);
+   }
+   int failed = cross->state != PASS && tc->info.result.state == PASS;
+   if (failed) {
+      tc->info.result.state = cross->state;
+      tc->info.result.message = cross->message;
+   }
+   __real_free(cross->output);
+   __real_free(cross);
+   return failed;
+}
+// recount the running cases; the solo case follows every start and end, so a case that
+// outlives the others running beside it owns the unattached threads again
+static void cross_count(TestCase tc, int delta) {
+   pthread_mutex_lock(&cross_lock);
+   cases_running += delta;
+   running_sum += delta > 0 ? (uintptr_t)tc : -(uintptr_t)tc;
+   atomic_store(&solo_case, cases_running == 1 ? (TestCase)running_sum : NULL);
+   pthread_mutex_unlock(&cross_lock);
+}
+// a case starts running on this runner thread
+static void cross_begin(TestCase tc) {
+   cross_count(tc, 1);
+}
+// the body of the case returned; its threads are done
+static void cross_end(TestCase tc) {
+   cross_count(tc, -1);
+   cross_take(tc);
+}
+static void *pool_thread_main(void *arg) {
+   st_pool_thread *t = arg;
+   attached_case = t->tc;
+   pool_thread = 1;
+   pthread_mutex_lock(&t->gate->lock);
+   while (t->gate->state == 0)
+      pthread_cond_wait(&t->gate->changed, &t->gate->lock);
+   int run = t->gate->state > 0;
+   pthread_mutex_unlock(&t->gate->lock);
+   if (!run)
+      return NULL;
+
+   profile_arm(t->tc);
+   if (t->time)
+      sys_gettime(&t->time->start);
+   if (setjmp(jmpbuffer) == 0)
+      t->work(t->index, t->arg);
+   if (t->time)
+      sys_gettime(&t->time->end);
+   profile_disarm(t->tc);
+   profile_release();
+   return NULL;
+}
+// Run a workload on threads of the running case and join them
+int st_thread_pool(size_t threads, ThreadWork work, object arg, st_thread_time *times) {
+   TestCase tc = running_case();
+   if (!tc)
+      tc = cross_case();
+   if (threads == 0 || !work)
+      return 0;
+   st_pool_thread *pool = __real_calloc(threads, sizeof(st_pool_thread));
+   if (!pool)
+      return -1;
+
+   st_pool_gate gate = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0};
+   size_t started = 0;
+   for (; started < threads; started++) {
+      pool[started] = (st_pool_thread){
+          .work = work,
+          .arg = arg,
+          .index = started,
+          .tc = tc,
+          .time = times ? &times[started] : NULL,
+          .gate = &gate,
+      };
+      if (pthread_create(&pool[started].thread, NULL, pool_thread_main, &pool[started]) != 0)
+         break;
+   }
+   // open the gate together, so the timestamps measure contention rather than thread start up
+   pthread_mutex_lock(&gate.lock);
+   gate.state = started == threads ? 1 : -1;
+   pthread_cond_broadcast(&gate.changed);
+   pthread_mutex_unlock(&gate.lock);
+   for (size_t i = 0; i < started; i++)
+      pthread_join(pool[i].thread, NULL);
+   __real_free(pool);
+   pthread_cond_destroy(&gate.changed);
+   pthread_mutex_destroy(&gate.lock);
+   if (started < threads)
+      return -1;
+
+   // a failure on a pool thread stops the case here like an assertion of its own
+   if (tc && tc == running_case() && cross_take(tc))
+      longjmp(jmpbuffer, 1);
+   return 0;
+}
+TestCase st_thread_case(void) {
+   TestCase tc = running_case();
+   return tc ? tc : cross_case();
+}
+void st_thread_attach(TestCase tc) {
+   attached_case = tc;
+}
+
+/*
+ * Fixtures (`testfixture`, `st_fixture`)
+ * A fixture is built lazily by the first case that asks for it and counts the selected cases
+ * declared to use it; the last of them to finish tears it down. Set fixtures left built are
+ * torn down when their set ends, process fixtures when the run ends. Under `--isolate` the
+ * worker process running a case builds and releases its own copy; copies are swept when the
+ * worker exits.
+ */
+typedef struct st_fixture_s {
+   string name;
+   FixtureScope scope;
+   FixtureSetup setup;
+   FixtureTeardown teardown;
+   TestSet set;       /* Owning set of a FIXTURE_SET fixture */
+   object value;
+   int built;
+   int building;      /* A thread is running setup */
+   pthread_t builder; /* The thread running setup */
+   int users;         /* Selected users of the run that have not finished */
+   pthread_mutex_t lock;
+   pthread_cond_t ready;
+   struct st_fixture_s *next;
+} st_fixture_s;
+typedef struct st_fixture_use_s {
+   Fixture fixture;
+   struct st_fixture_use_s *next;
+} st_fixture_use;
+
+static Fixture fixture_list = NULL;
+
+// Register a fixture
+Fixture testfixture(string name, FixtureScope scope, FixtureSetup setup, FixtureTeardown teardown) {
+   if (!setup || (scope == FIXTURE_SET && !current_set)) {
+      fwritelnf(stderr, "Error: Fixture '%s' needs a setup function%s", name ? name : "(null)",
+                setup ? " and, with set scope, a test set" : "");
+      return NULL;
+   }
+   Fixture fixture = arena_alloc(sizeof(st_fixture_s));
+   if (!fixture) {
+      fwritelnf(stderr, "Error: Failed to allocate fixture '%s'", name);
+      return NULL;
+   }
+   *fixture = (st_fixture_s){
+       .name = arena_strdup(name ? name : ""),
+       .scope = scope,
+       .setup = setup,
+       .teardown = teardown,
+       .set = scope == FIXTURE_SET ? current_set : NULL,
+       .lock = PTHREAD_MUTEX_INITIALIZER,
+       .ready = PTHREAD_COND_INITIALIZER,
+       .next = fixture_list,
+   };
+   fixture_list = fixture;
+   return fixture;
+}
+// add a fixture to a use list; set fixtures only serve their own set
+static void fixture_use(st_fixture_use **uses, Fixture fixture) {
+   if (!fixture || !current_set)
+      return;
+   if (fixture->set && fixture->set != current_set) {
+      fwritelnf(stderr, "Error: Fixture '%s' belongs to set '%s', not '%s'", fixture->name,
+                fixture->set->info.name, current_set->info.name);
+      return;
+   }
+   st_fixture_use *use = arena_alloc(sizeof(st_fixture_use));
+   if (!use) {
+      fwritelnf(stderr, "Error: Failed to allocate fixture use");
+      return;
+   }
+   *use = (st_fixture_use){.fixture = fixture, .next = *uses};
+   *uses = use;
+}
+// Declare a fixture used by the most recently registered test case
+void fixture_testcase(Fixture fixture) {
+   if (current_set && current_set->info.count > 0)
+      fixture_use(&registry.cases[registry.count - 1].fixtures, fixture);
+}
+// Declare a fixture used by every test case of the current test set
+void fixture_testset(Fixture fixture) {
+   if (current_set)
+      fixture_use(&current_set->fixtures, fixture);
+}
+// Get a fixture value, building it on first use
+object st_fixture(Fixture fixture) {
+   if (!fixture)
+      return NULL;
+   pthread_mutex_lock(&fixture->lock);
+   while (fixture->building && !fixture->built)
+      pthread_cond_wait(&fixture->ready, &fixture->lock);
+   if (fixture->built) {
+      object value = fixture->value;
+      pthread_mutex_unlock(&fixture->lock);
+      return value;
+   }
+   // build outside the lock: setup may fail an assertion and unwind past this frame
+   fixture->building = 1;
+   fixture->builder = pthread_self();
+   pthread_mutex_unlock(&fixture->lock);
+
+   object value = fixture->setup();
+
+   pthread_mutex_lock(&fixture->lock);
+   fixture->value = value;
+   fixture->built = 1;
+   fixture->building = 0;
+   pthread_cond_broadcast(&fixture->ready);
+   pthread_mutex_unlock(&fixture->lock);
+   return value;
+}
+// tear a built fixture down; the caller holds its lock
+static void fixture_teardown(Fixture fixture) {
+   if (!fixture->built)
+      return;
+   if (fixture->teardown)
+      fixture->teardown(fixture->value);
+   fixture->value = NULL;
+   fixture->built = 0;
+}
+// count the selected users of every fixture for the run
+static void fixture_count(TestSet sets) {
+   for (Fixture fixture = fixture_list; fixture; fixture = fixture->next)
+      fixture->users = 0;
+   for (TestSet set = sets; set; set = set->next) {
+      for (int i = 0; i < set->info.count; i++) {
+         TestCase tc = &registry.cases[set->first + i];
+         if (!tc->selected)
+            continue;
+         for (st_fixture_use *use = tc->fixtures; use; use = use->next)
+            use->fixture->users++;
+         for (st_fixture_use *use = set->fixtures; use; use = use->next)
+            use->fixture->users++;
+      }
+   }
+}
+static void fixture_release_uses(st_fixture_use *uses) {
+   for (st_fixture_use *use = uses; use; use = use->next) {
+      Fixture fixture = use->fixture;
+      pthread_mutex_lock(&fixture->lock);
+      if (fixture->building && !fixture->built && pthread_equal(fixture->builder, pthread_self())) {
+         // setup unwound; let a waiting case try again
+         fixture->building = 0;
+         pthread_cond_broadcast(&fixture->ready);
+      }
+      if (fixture->users > 0 && --fixture->users == 0)
+         fixture_teardown(fixture);
+      pthread_mutex_unlock(&fixture->lock);
+   }
+}
+// a case finished: release the fixtures it used
+static void fixture_release(TestCase tc) {
+   fixture_release_uses(tc->fixtures);
+   fixture_release_uses(tc->set->fixtures);
+}
+// tear down what is still built: the fixtures of a set, or every fixture when `set` is NULL
+static void fixture_sweep(TestSet set) {
+   for (Fixture fixture = fixture_list; fixture; fixture = fixture->next) {
+      if (set && fixture->set != set)
+         continue;
+      pthread_mutex_lock(&fixture->lock);
+      fixture_teardown(fixture);
+      pthread_mutex_unlock(&fixture->lock);
+   }
+}
+// Create a test case with common defaults at the end of the registry (and the current set)
+static TestCase create_testcase(string name) {
+   if (registry.count == registry.capacity) {
+      size_t capacity = registry.capacity ? registry.capacity * 2 : 64;
+      st_case_s *cases = __real_realloc(registry.cases, capacity * sizeof(st_case_s));
+      if (!cases) {
+         writef("Failed to allocate memory for test case `%s`\n", name);
+         exit(EXIT_FAILURE);
+      }
+      registry.cases = cases;
+      registry.capacity = capacity;
+   }
+   TestCase tc = &registry.cases[registry.count];
+   memset(tc, 0, sizeof(st_case_s));
+   tc->info.name = arena_strdup(name);
    if (!tc->info.name) {
       writef("Failed to allocate memory for test case name `%s`\n", name);
-      __real_free(tc);
       exit(EXIT_FAILURE);
    }
    tc->info.result.state = PASS;
    tc->info.result.message = NULL;
    tc->info.has_next = FALSE;
+   tc->info.index = current_set->info.count;
+   tc->info.perf = (st_perf_counts){0};
 
    tc->is_fuzz = FALSE;
    tc->func.test = NULL;
    tc->expect_fail = FALSE;
    tc->expect_throw = FALSE;
-   tc->next = NULL;
+   tc->set = current_set;
    tc->ran_no_newline = 0;
    tc->had_debug = 0;
    tc->running_len = 0;
+   tc->iso_setup_failed = 0;
+   tc->leak_live = 0;
+   tc->leak_peak = 0;
+   tc->budget = (st_budget){0};
+   tc->budget_hit = 0;
+   tc->budget_allocs = 0;
+   tc->bench = NULL;
+   tc->params = NULL;
+
+   registry.count++;
+   current_set->info.count++;
    return tc;
 }
 
+// Case registry iteration
+size_t st_case_total(void) {
+   return registry.count;
+}
+TcInfo st_case_at(size_t index) {
+   return index < registry.count ? (TcInfo)&registry.cases[index].info : NULL;
+}
+TcInfo st_set_case(const TsInfo ts, size_t index) {
+   TestSet set = (TestSet)ts; // set info is the first member of the set
+   if (!set || index >= (size_t)set->info.count)
+      return NULL;
+   return (TcInfo)&registry.cases[set->first + index].info;
+}
+TcInfo st_current_case(void) {
+   return current_tc ? (TcInfo)&current_tc->info : NULL;
+}
+int st_is_last_case(const TsInfo ts, const TcInfo tc) {
+   return !ts || !tc || tc->index == ((TestSet)ts)->last;
+}
+const st_bench_stats *st_bench_result(const TcInfo info) {
+   // case info is embedded in the registry entry
+   TestCase tc = info ? (TestCase)((char *)info - offsetof(st_case_s, info)) : NULL;
+   return tc && tc->bench && tc->bench->stats.samples ? &tc->bench->stats : NULL;
+}
+const st_param_results *st_param_result(const TcInfo info) {
+   TestCase tc = info ? (TestCase)((char *)info - offsetof(st_case_s, info)) : NULL;
+   return tc ? tc->params : NULL;
+}
+const char *st_param_label(const st_param_results *results, size_t row, char *buffer, size_t size) {
+   if (!size)
+      return buffer;
+   buffer[0] = '\0';
+   if (results && results->format && row < results->count)
+      results->format((const char *)results->table + row * results->elem_size, buffer, size);
+   else
+      snprintf(buffer, size, "#%zu", row);
+   return buffer;
+}
+
 // Register test hooks
 void register_hooks(ST_Hooks hooks) {
-   HookRegistry *entry = __real_malloc(sizeof(HookRegistry));
+   HookRegistry *entry = arena_alloc(sizeof(HookRegistry));
    if (!entry) {
       fwritelnf(stderr, "Error: Failed to allocate hook registry entry");
       return; // Memory allocation failed
@@ -945,23 +2856,42 @@ void register_hooks(ST_Hooks hooks) {
 tc_context default_ctx = {{0, 0, {0, 0}, {0, 0}, RUNNER_IDLE, NULL}, NULL};
 
 static void default_before_test(tc_context *ctx) {
-   (void)*ctx; // unused
-   default_ctx.info.count++;
+   ctx->info.count++;
 }
-static void append_to_buffer(tc_context *ctx, const char *str) {
-   size_t len = strlen(str);
+// format into `local`, or into an allocation the caller frees when it does not fit; NULL on error
+static char *format_text(char *local, size_t size, int *len, const char *fmt, va_list args) {
+   va_list copy;
+   va_copy(copy, args);
+   *len = vsnprintf(local, size, fmt, copy);
+   va_end(copy);
+   if (*len < 0)
+      return NULL;
+   if ((size_t)*len < size)
+      return local;
+   char *text = __real_malloc((size_t)*len + 1);
+   if (text)
+      vsnprintf(text, (size_t)*len + 1, fmt, args);
+   return text;
+}
+static void append_bytes(tc_context *ctx, const char *str, size_t len) {
    if (ctx->buffer_used + len >= ctx->buffer_size) {
-      ctx->buffer_size = (ctx->buffer_size + len + 1024) & ~1023; // round up to 1024
-      ctx->output_buffer = __real_realloc(ctx->output_buffer, ctx->buffer_size);
+      // doubling keeps long debug output to a few reallocations
+      size_t size = ctx->buffer_size ? ctx->buffer_size : 2048;
+      while (ctx->buffer_used + len >= size)
+         size *= 2;
+      char *buffer = __real_realloc(ctx->output_buffer, size);
+      if (!buffer)
+         return;
+      ctx->output_buffer = buffer;
+      ctx->buffer_size = size;
    }
    memcpy(ctx->output_buffer + ctx->buffer_used, str, len);
    ctx->buffer_used += len;
 }
+static void append_to_buffer(tc_context *ctx, const char *str) {
+   append_bytes(ctx, str, strlen(str));
+}
 static void default_on_start_test(tc_context *ctx) {
-   if (sys_gettime(&ctx->test_start) == -1) {
-      fwritelnf(stderr, "Error: Failed to get system start time");
-      exit(EXIT_FAILURE);
-   }
    // zero out the end time
    ctx->info.end = (ts_time){0, 0};
 
@@ -985,6 +2915,12 @@ static void default_on_start_test(tc_context *ctx) {
       current_tc->ran_no_newline = 1;
       current_tc->had_debug = 0;
       current_tc->running_len = len;
+      line_open = 0;
+   }
+   // start timing last so the test duration excludes the report output
+   if (sys_gettime(&ctx->test_start) == -1) {
+      fwritelnf(stderr, "Error: Failed to get system start time");
+      exit(EXIT_FAILURE);
    }
 }
 static void default_on_end_test(tc_context *ctx) {
@@ -997,8 +2933,43 @@ static void default_on_end_test(tc_context *ctx) {
    /* end time recorded; final result printing occurs in on_test_result after process_result */
 }
 static void default_after_test(tc_context *ctx) {
-   (void)*ctx; // unused
-   default_ctx.info.count--;
+   ctx->info.count--;
+}
+// format a hardware counter with a K/M/G suffix
+static void format_count(uint64_t count, char *buffer, size_t size) {
+   if (count < 10000)
+      snprintf(buffer, size, "%llu", (unsigned long long)count);
+   else if (count < 1000000)
+      snprintf(buffer, size, "%.1fK", (double)count / 1e3);
+   else if (count < 1000000000)
+      snprintf(buffer, size, "%.1fM", (double)count / 1e6);
+   else
+      snprintf(buffer, size, "%.1fG", (double)count / 1e9);
+}
+// one line summary of the measured hardware counters of a case
+static void format_perf(const st_perf_counts *perf, char *buffer, size_t size) {
+   const struct {
+      unsigned bit;
+      uint64_t value;
+      const char *label;
+   } parts[] = {
+       {PERF_CYCLES, perf->cycles, "cycles"},
+       {PERF_INSTRUCTIONS, perf->instructions, "instructions"},
+       {PERF_L1D_MISSES, perf->l1d_misses, "L1D misses"},
+       {PERF_LLC_MISSES, perf->llc_misses, "LLC misses"},
+       {PERF_BRANCH_MISSES, perf->branch_misses, "branch misses"},
+   };
+   char count[32];
+   int used = 0;
+   buffer[0] = '\0';
+   for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]) && used < (int)size; i++) {
+      if (!(perf->valid & parts[i].bit))
+         continue;
+      format_count(parts[i].value, count, sizeof(count));
+      used += snprintf(buffer + used, size - used, "%s%s %s", used ? ", " : "", count, parts[i].label);
+      if (parts[i].bit == PERF_INSTRUCTIONS && (perf->valid & PERF_CYCLES) && perf->cycles && used < (int)size)
+         used += snprintf(buffer + used, size - used, " (%.2f IPC)", (double)perf->instructions / (double)perf->cycles);
+   }
 }
 static void default_on_test_result(const TsInfo ts, tc_context *ctx) {
    if (!ts || !ts->tc_info)
@@ -1017,7 +2988,7 @@ static void default_on_test_result(const TsInfo ts, tc_context *ctx) {
    char result_buf[64];
    snprintf(result_buf, sizeof(result_buf), "%.3f %s [%s]", display_time, unit, state_str);
 
-   if (ts->tc_info->result.state == FAIL && ts->tc_info->result.message) {
+   if (ts->tc_info->result.state != PASS && ts->tc_info->result.state != SKIP && ts->tc_info->result.message) {
       /* append failure message indented */
       char msg_buf[512];
       snprintf(msg_buf, sizeof(msg_buf), "\n  - %s", ts->tc_info->result.message);
@@ -1050,6 +3021,13 @@ static void default_on_test_result(const TsInfo ts, tc_context *ctx) {
       append_to_buffer(ctx, result_buf);
       append_to_buffer(ctx, "\n");
    }
+   if (ts->tc_info->perf.valid) {
+      char perf_buf[256];
+      format_perf(&ts->tc_info->perf, perf_buf, sizeof(perf_buf));
+      append_to_buffer(ctx, "  - ");
+      append_to_buffer(ctx, perf_buf);
+      append_to_buffer(ctx, "\n");
+   }
 
    // Flush the buffer
    if (ctx->output_buffer && ctx->buffer_used > 0) {
@@ -1064,13 +3042,23 @@ static void default_on_test_result(const TsInfo ts, tc_context *ctx) {
    current_tc->running_len = 0;
 }
 static void default_on_debug_log(tc_context *ctx, DebugLevel level, const char *fmt, ...) {
+   (void)level;
+   char local[1024];
+   int len;
    va_list args;
    va_start(args, fmt);
-   char buf[2048];
-   vsnprintf(buf, sizeof(buf), fmt, args);
+   char *text = format_text(local, sizeof(local), &len, fmt, args);
    va_end(args);
-   append_to_buffer(ctx, buf);
-   current_tc->had_debug = 1;
+   if (!text)
+      return;
+   if (captured.active) {
+      capture_write(text, (size_t)len);
+   } else {
+      append_bytes(ctx, text, (size_t)len);
+      current_tc->had_debug = 1;
+   }
+   if (text != local)
+      __real_free(text);
 }
 static void default_on_error(const char *message, tc_context *ctx) {
    (void)*ctx;    // unused
@@ -1078,12 +3066,14 @@ static void default_on_error(const char *message, tc_context *ctx) {
    // Default error handling: do nothing
 }
 static void default_on_testcase_finish(void) {
-   //  total up atomic allocation counts
-   _sigtest_alloc_count += atomic_load(&global_allocs);
-   _sigtest_free_count += atomic_load(&global_frees);
-   // reset atomic allocation counters
-   atomic_store(&global_allocs, 0);
-   atomic_store(&global_frees, 0);
+   //  take and reset the per-thread allocation counts
+   size_t allocs, frees;
+   take_alloc_counts(&allocs, &frees);
+   // total up allocation counts; other runner threads may be finishing tests too
+   pthread_mutex_lock(&stats_lock);
+   _sigtest_alloc_count += allocs;
+   _sigtest_free_count += frees;
+   pthread_mutex_unlock(&stats_lock);
 }
 static void default_on_testset_finished(void) {
    //  get the atomic allocation counts
@@ -1129,9 +3119,9 @@ static const st_hooks_s default_hooks = {
     .context = &default_ctx,
 };
 
-//	 initialize on start up
-__attribute__((constructor)) static void init_default_hooks(void) {
-   HookRegistry *entry = __real_malloc(sizeof(HookRegistry));
+//	 initialize on start up, ahead of the test constructors so they can look up the default hooks
+__attribute__((constructor(101))) static void init_default_hooks(void) {
+   HookRegistry *entry = arena_alloc(sizeof(HookRegistry));
    // if we don't have a valid hooks registry, we exit
    if (!entry) {
       fwritelnf(stderr, "Error: Failed to allocate hooks registry entry");
@@ -1143,11 +3133,235 @@ __attribute__((constructor)) static void init_default_hooks(void) {
    hook_registry = entry;
 }
 
+/*
+ * Test modules (`stest --watch`)
+ * A module is a test shared object loaded into a long-lived runner. Its constructors prepend
+ * its sets to `test_sets`, its cases to the registry, its fixtures to `fixture_list` and its
+ * hooks to the hook registry, so each of those is one contiguous run owned by the module. Reloading a changed module moves
+ * the new runs into the place of the old ones before the old module is unloaded; sets and
+ * cases of other modules stay where they are and keep their registry indices valid.
+ */
+struct st_module_s {
+   void *handle;
+   TestSet first;          /* Newest set of the module; its sets run through `last` */
+   TestSet last;           /* Oldest set; holds the first case of the module */
+   HookRegistry *hooks_first;
+   HookRegistry *hooks_last;
+   Fixture fixtures_first; /* Newest fixture of the module; its run ends at `fixtures_last` */
+   Fixture fixtures_last;
+   ST_Hooks hooks;         /* Hooks the module registered last, or NULL */
+   st_options options;     /* Runner options as left by the module constructors */
+};
+// the set (hook entry, fixture) linked ahead of a module's run; NULL when the run is at the head
+static TestSet set_before(TestSet set) {
+   TestSet prev = NULL;
+   for (TestSet it = test_sets; it && it != set; it = it->next)
+      prev = it;
+   return prev;
+}
+static HookRegistry *hooks_before(HookRegistry *entry) {
+   HookRegistry *prev = NULL;
+   for (HookRegistry *it = hook_registry; it && it != entry; it = it->next)
+      prev = it;
+   return prev;
+}
+static Fixture fixture_before(Fixture fixture) {
+   Fixture prev = NULL;
+   for (Fixture it = fixture_list; it && it != fixture; it = it->next)
+      prev = it;
+   return prev;
+}
+// first registry index and number of cases of a module
+static size_t module_cases(TestModule module, size_t *count) {
+   *count = 0;
+   if (!module->first)
+      return 0;
+   for (TestSet set = module->first;; set = set->next) {
+      *count += (size_t)set->info.count;
+      if (set == module->last)
+         break;
+   }
+   return module->last->first;
+}
+// Moves the sets and cases of a freshly loaded module into the place of those it replaces
+static void module_take_place(TestModule module, TestModule replaces) {
+   if (!module->first || !replaces->first)
+      return;
+   // sets: off the head of the list, in ahead of the replaced run
+   test_sets = module->last->next;
+   TestSet prev = set_before(replaces->first);
+   module->last->next = replaces->first;
+   if (prev)
+      prev->next = module->first;
+   else
+      test_sets = module->first;
+
+   // cases: the new block at the end of the registry rotates down ahead of the replaced block
+   size_t count, at = module_cases(replaces, &count);
+   size_t added, from = module_cases(module, &added);
+   if (added == 0 || from == at)
+      return;
+   st_case_s *block = __real_malloc(added * sizeof(st_case_s));
+   if (!block) {
+      fwritelnf(stderr, "Error: Failed to allocate memory for module cases");
+      exit(EXIT_FAILURE);
+   }
+   memcpy(block, &registry.cases[from], added * sizeof(st_case_s));
+   memmove(&registry.cases[at + added], &registry.cases[at], (from - at) * sizeof(st_case_s));
+   memcpy(&registry.cases[at], block, added * sizeof(st_case_s));
+   __real_free(block);
+   for (TestSet set = test_sets; set; set = set->next) {
+      if (set->first >= from)
+         set->first = set->first - from + at;
+      else if (set->first >= at)
+         set->first += added;
+   }
+}
+// Load a test shared object, optionally in the place of a loaded module
+TestModule st_module_load(const char *path, TestModule replaces) {
+   TestModule module = __real_calloc(1, sizeof(struct st_module_s));
+   if (!module) {
+      fwritelnf(stderr, "Error: Failed to allocate memory for module `%s`", path);
+      return NULL;
+   }
+   TestSet sets = test_sets;
+   HookRegistry *hooks = hook_registry;
+   Fixture fixtures = fixture_list;
+   st_options options = runner_options;
+
+   // a case registered ahead of any set of the module must not join another module's set
+   current_set = NULL;
+   current_hooks = NULL;
+   module->handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+   if (!module->handle) {
+      fwritelnf(stderr, "Error: Cannot load test module '%s': %s", path, dlerror());
+      __real_free(module);
+      return NULL;
+   }
+   module->hooks = current_hooks;
+   module->options = runner_options;
+   runner_options = options;
+   current_set = NULL;
+
+   if (test_sets != sets) {
+      module->first = test_sets;
+      for (module->last = test_sets; module->last->next != sets; module->last = module->last->next)
+         ;
+   }
+   if (hook_registry != hooks) {
+      module->hooks_first = hook_registry;
+      for (module->hooks_last = hook_registry; module->hooks_last->next != hooks; module->hooks_last = module->hooks_last->next)
+         ;
+   }
+   if (fixture_list != fixtures) {
+      module->fixtures_first = fixture_list;
+      for (module->fixtures_last = fixture_list; module->fixtures_last->next != fixtures;
+           module->fixtures_last = module->fixtures_last->next)
+         ;
+   }
+   if (replaces) {
+      module_take_place(module, replaces);
+      st_module_unload(replaces);
+   }
+   return module;
+}
+// Remove a module's sets, cases and hooks, then unload it
+void st_module_unload(TestModule module) {
+   if (!module)
+      return;
+   if (module->first) {
+      size_t count, at = module_cases(module, &count);
+      for (TestSet set = module->first;; set = set->next) {
+         if (set->pending) {
+            fclose(set->pending);
+            __real_free(set->pending_buf); // allocated by open_memstream
+         } else if (set->log_stream != stdout && set->log_stream) {
+            fclose(set->log_stream);
+         }
+         set->log_stream = NULL;
+         set->pending = NULL;
+         if (set == module->last)
+            break;
+      }
+      TestSet prev = set_before(module->first);
+      if (prev)
+         prev->next = module->last->next;
+      else
+         test_sets = module->last->next;
+
+      // the set structures stay in the arena until exit; their cases close up
+      memmove(&registry.cases[at], &registry.cases[at + count], (registry.count - at - count) * sizeof(st_case_s));
+      registry.count -= count;
+      for (TestSet set = test_sets; set; set = set->next) {
+         if (set->first >= at + count)
+            set->first -= count;
+      }
+   }
+   if (module->hooks_first) {
+      HookRegistry *prev = hooks_before(module->hooks_first);
+      if (prev)
+         prev->next = module->hooks_last->next;
+      else
+         hook_registry = module->hooks_last->next;
+   }
+   if (current_hooks && current_hooks == module->hooks)
+      current_hooks = NULL;
+   current_set = NULL;
+   if (module->fixtures_first) {
+      // built values are torn down while the module's teardown code is still mapped
+      Fixture prev = fixture_before(module->fixtures_first);
+      for (Fixture fixture = module->fixtures_first;; fixture = fixture->next) {
+         pthread_mutex_lock(&fixture->lock);
+         fixture_teardown(fixture);
+         pthread_mutex_unlock(&fixture->lock);
+         if (fixture == module->fixtures_last)
+            break;
+      }
+      if (prev)
+         prev->next = module->fixtures_last->next;
+      else
+         fixture_list = module->fixtures_last->next;
+   }
+
+   dlclose(module->handle);
+   __real_free(module);
+}
+// Run the sets of one module with its own hooks and runner options
+int st_module_run(TestModule module) {
+   if (!module || !module->first)
+      return 0;
+   // cases of other modules keep no selection into this run (sharding counts every case)
+   for (size_t i = 0; i < registry.count; i++)
+      registry.cases[i].selected = 0;
+
+   st_options options = runner_options;
+   runner_options = module->options;
+   TestSet next = module->last->next;
+   module->last->next = NULL;
+   int result = run_tests(module->first, module->hooks ? module->hooks : (ST_Hooks)&default_hooks);
+   module->last->next = next;
+   runner_options = options;
+   current_set = NULL;
+
+   return result;
+}
+
 #ifdef SIGTEST_TEST
 /*
         test executor entry point
 */
-int main(void) {
+int main(int argc, char **argv) {
+   if (parse_runner_args(argc, argv) != 0) {
+      fwritelnf(stderr, "Usage: %s [-j|--jobs <n>] [--isolate] [--track-leaks] [--filter <glob|/regex/>] [--tag <tags>]\n"
+                         "       [--shard-index <k> --shard-count <n> [--shard-durations <file>]]\n"
+                         "       [--bench-baseline <file> [--bench-tolerance <pct>] [--bench-update]]\n"
+                         "       [--fuzz-runs <n>] [--fuzz-time <ms>] [--fuzz-jobs <n>] [--fuzz-crashes <dir>]\n"
+                         "       [--fuzz-replay <file>]\n"
+                         "       [--timeout <ms>] [--cpu-time <ms>] [--max-heap <bytes>[k|m|g]] [--max-allocs <n>]\n"
+                         "       [--order registered|failed-first|longest-first|random] [--seed <n>] [--history <file>]\n"
+                         "       [--capture | --capture-fds] [--profile <dir>]", argv[0]);
+      return EXIT_FAILURE;
+   }
    int retResult = run_tests(test_sets, current_hooks);
    cleanup_test_runner();
 
@@ -1155,81 +3369,1232 @@ int main(void) {
 }
 #endif // SIGTEST_TEST
 
-// Runner state handlers
-static RunnerState runner_init(TestSet, ST_Hooks, int *, int *, ST_Hooks *);
-static RunnerState set_loop(TestSet *, int *);
-static RunnerState set_init(TestSet, int *, int *, int *, int *, TestSet *);
-static RunnerState before_set(ST_Hooks, int, TestSet, char *);
-static RunnerState case_loop(TestCase *);
-static RunnerState case_init(TestCase, TestSet);
-static RunnerState before_test(ST_Hooks);
-static RunnerState setup_test(TestSet);
-static RunnerState start_test(ST_Hooks);
-static RunnerState execute_test(TestCase, jmp_buf);
-static RunnerState execute_fuzzing(TestCase, jmp_buf, const void *, size_t, size_t);
-static RunnerState end_test(ST_Hooks);
-static RunnerState teardown_test(TestSet);
-static RunnerState after_test(ST_Hooks);
-static RunnerState process_result(TestCase, TestSet, ST_Hooks,
-                                  int *, int *, int *, int *, int *);
-static RunnerState after_set(ST_Hooks, TestSet,
-                             int, int, int, int, int);
-static void runner_summary(int, int, TestSet, ST_Hooks);
-static int runner_done(TestSet);
-
-// the actual test runner
-int run_tests(TestSet sets, ST_Hooks test_hooks) {
-   // VIRTUAL STATE: RUNNER_INIT
-   int total_tests = 0;
-   int set_sequence = 1;
-   char timestamp[32];
-   int total_sets = 0;
-   ST_Hooks hooks = NULL;
-
-   TestSet current_set_iter = sets;
-   TestCase current_tc_iter = NULL;
-   current_set = NULL;
-   TestCase tc = NULL;
+// get the value of `flag <value>` or `flag=<value>`; NULL if argv[*i] is not the flag
+static const char *runner_arg_value(int argc, char **argv, int *i, const char *flag, const char *alias, int *missing) {
+   size_t len = strlen(flag);
+   if (strcmp(argv[*i], flag) == 0 || (alias && strcmp(argv[*i], alias) == 0)) {
+      if (*i + 1 >= argc) {
+         fwritelnf(stderr, "Error: Missing value for '%s'", argv[*i]);
+         *missing = 1;
+         return NULL;
+      }
+      return argv[++*i];
+   }
+   if (strncmp(argv[*i], flag, len) == 0 && argv[*i][len] == '=')
+      return argv[*i] + len + 1;
+   return NULL;
+}
+// parse an integer option value of at least `min`
+static int runner_arg_int(const char *name, const char *value, long min, int *out) {
+   char *end = NULL;
+   long number = strtol(value, &end, 10);
+   if (!end || end == value || *end != '\0' || number < min || number > INT_MAX) {
+      fwritelnf(stderr, "Error: Invalid value: %s='%s'", name, value);
+      return 1;
+   }
+   *out = (int)number;
+   return 0;
+}
+// a count or size, with an optional k, m or g (binary) suffix
+static int runner_arg_size(const char *name, const char *value, size_t *out) {
+   char *end = NULL;
+   unsigned long long number = strtoull(value, &end, 10);
+   int shift = !*end ? 0 : *end == 'k' ? 10 : *end == 'm' ? 20 : *end == 'g' ? 30 : -1;
+   if (end == value || *value == '-' || shift < 0 || (*end && end[1])) {
+      fwritelnf(stderr, "Error: Invalid value: %s='%s'", name, value);
+      return 1;
+   }
+   *out = (size_t)(number << shift);
+   return 0;
+}
+// a run order name
+static int runner_arg_order(const char *value) {
+   static const struct {
+      const char *name;
+      RunOrder order;
+   } orders[] = {
+       {"registered", ORDER_REGISTERED},
+       {"failed-first", ORDER_FAILED_FIRST},
+       {"longest-first", ORDER_LONGEST_FIRST},
+       {"random", ORDER_RANDOM},
+   };
+   for (size_t i = 0; i < sizeof(orders) / sizeof(orders[0]); i++) {
+      if (strcmp(value, orders[i].name) == 0) {
+         runner_options.order = orders[i].order;
+         return 0;
+      }
+   }
+   fwritelnf(stderr, "Error: Invalid value: order='%s' (registered, failed-first, longest-first or random)", value);
+   return 1;
+}
+// Parse runner command line arguments
+int parse_runner_args(int argc, char **argv) {
+   for (int i = 1; i < argc; i++) {
+      const char *value = NULL;
+      int missing = 0;
+      if (strcmp(argv[i], "--isolate") == 0) {
+         runner_options.isolate = 1;
+      } else if (strcmp(argv[i], "--track-leaks") == 0) {
+         runner_options.track_leaks = 1;
+      } else if (strcmp(argv[i], "--bench-update") == 0) {
+         runner_options.bench_update = 1;
+      } else if (strcmp(argv[i], "--capture") == 0) {
+         runner_options.capture = CAPTURE_LOG;
+      } else if (strcmp(argv[i], "--capture-fds") == 0) {
+         runner_options.capture = CAPTURE_FDS;
+      } else if ((value = runner_arg_value(argc, argv, &i, "--jobs", "-j", &missing))) {
+         if (runner_arg_int("jobs", value, 0, &runner_options.jobs) != 0)
+            return 1;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--filter", NULL, &missing))) {
+         runner_options.filter = value;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--tag", NULL, &missing))) {
+         runner_options.tags = value;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--shard-index", NULL, &missing))) {
+         if (runner_arg_int("shard-index", value, 0, &runner_options.shard_index) != 0)
+            return 1;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--shard-count", NULL, &missing))) {
+         if (runner_arg_int("shard-count", value, 1, &runner_options.shard_count) != 0)
+            return 1;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--shard-durations", NULL, &missing))) {
+         runner_options.shard_durations = value;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--bench-baseline", NULL, &missing))) {
+         runner_options.bench_baseline = value;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--bench-tolerance", NULL, &missing))) {
+         if (runner_arg_int("bench-tolerance", value, 0, &runner_options.bench_tolerance) != 0)
+            return 1;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--fuzz-runs", NULL, &missing))) {
+         if (runner_arg_int("fuzz-runs", value, 1, &runner_options.fuzz_runs) != 0)
+            return 1;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--fuzz-time", NULL, &missing))) {
+         if (runner_arg_int("fuzz-time", value, 1, &runner_options.fuzz_time_ms) != 0)
+            return 1;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--fuzz-jobs", NULL, &missing))) {
+         if (runner_arg_int("fuzz-jobs", value, 1, &runner_options.fuzz_jobs) != 0)
+            return 1;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--fuzz-crashes", NULL, &missing))) {
+         runner_options.fuzz_crash_dir = value;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--fuzz-replay", NULL, &missing))) {
+         runner_options.fuzz_replay = value;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--timeout", NULL, &missing))) {
+         if (runner_arg_int("timeout", value, 0, &runner_options.budget.wall_ms) != 0)
+            return 1;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--cpu-time", NULL, &missing))) {
+         if (runner_arg_int("cpu-time", value, 0, &runner_options.budget.cpu_ms) != 0)
+            return 1;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--max-heap", NULL, &missing))) {
+         if (runner_arg_size("max-heap", value, &runner_options.budget.heap_bytes) != 0)
+            return 1;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--max-allocs", NULL, &missing))) {
+         if (runner_arg_size("max-allocs", value, &runner_options.budget.allocs) != 0)
+            return 1;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--order", NULL, &missing))) {
+         if (runner_arg_order(value) != 0)
+            return 1;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--seed", NULL, &missing))) {
+         char *end = NULL;
+         runner_options.seed = strtoul(value, &end, 10);
+         if (end == value || *end || *value == '-') {
+            fwritelnf(stderr, "Error: Invalid value: seed='%s'", value);
+            return 1;
+         }
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--history", NULL, &missing))) {
+         runner_options.history = value;
+      } else if (!missing && (value = runner_arg_value(argc, argv, &i, "--profile", NULL, &missing))) {
+         runner_options.profile = value;
+      } else {
+         if (!missing)
+            fwritelnf(stderr, "Error: Unexpected argument or flag: '%s'", argv[i]);
+         return 1;
+      }
+   }
+   if (runner_options.shard_count > 1 && runner_options.shard_index >= runner_options.shard_count) {
+      fwritelnf(stderr, "Error: Invalid value: shard-index=%d (shard-count=%d)",
+                runner_options.shard_index, runner_options.shard_count);
+      return 1;
+   }
 
-   int tc_total = 0;
-   int tc_passed = 0;
-   int tc_failed = 0;
-   int tc_skipped = 0;
+   return 0;
+}
 
-   RunnerState state = RUNNER_INIT;
-   while (state != RUNNER_DONE) {
-      default_ctx.info.state = state; // update default context state
-      switch (state) {
-      case RUNNER_INIT:
-         state = runner_init(sets, test_hooks, &total_tests, &total_sets, &hooks);
+/*
+ * Sharding (`--shard-index`, `--shard-count`)
+ * Splits the selected cases across machines without coordination: every shard computes the
+ * same assignment from the registry order alone. By default each shard takes a contiguous run
+ * of an equal number of cases; with a durations file, cases are assigned longest first to the
+ * least loaded shard so each shard finishes in about the same time.
+ */
+typedef struct {
+   char *name; // `set/case`
+   double ms;
+   int fails; // consecutive failed runs (--history)
+} st_duration;
+typedef struct {
+   size_t index; // registry index
+   double ms;
+} st_shard_item;
+
+static int duration_cmp(const void *a, const void *b) {
+   return strcmp(((const st_duration *)a)->name, ((const st_duration *)b)->name);
+}
+static int shard_item_cmp(const void *a, const void *b) {
+   const st_shard_item *left = a, *right = b;
+   if (left->ms != right->ms)
+      return left->ms < right->ms ? 1 : -1;
+   return left->index < right->index ? -1 : left->index > right->index;
+}
+// load `set/case<TAB>ms[ fails]` lines sorted by name; returns the entry count, or -1 on error
+static long load_durations(const char *path, st_duration **durations) {
+   FILE *file = fopen(path, "r");
+   if (!file) {
+      fwritelnf(stderr, "Error: Cannot open durations '%s': %s", path, strerror(errno));
+      return -1;
+   }
 
-         break;
-      case SET_LOOP:
-         state = set_loop(&current_set_iter, &set_sequence);
-         if (state == RUNNER_SUMMARY) {
-            break;
+   long count = 0, capacity = 0;
+   st_duration *entries = NULL;
+   char line[1024];
+   while (fgets(line, sizeof(line), file)) {
+      char *sep = strrchr(line, '\t');
+      if (!sep || line[0] == '#')
+         continue;
+      char *end = NULL;
+      double ms = strtod(sep + 1, &end);
+      if (end == sep + 1 || ms < 0)
+         continue;
+      if (count == capacity) {
+         capacity = capacity ? capacity * 2 : 64;
+         entries = __real_realloc(entries, capacity * sizeof(st_duration));
+         if (!entries) {
+            fwritelnf(stderr, "Error: Failed to allocate shard durations");
+            exit(EXIT_FAILURE);
          }
-         current_set = current_set_iter;
-         state = SET_INIT;
+      }
+      *sep = '\0';
+      entries[count].name = arena_strdup(line);
+      entries[count].ms = ms;
+      entries[count].fails = (int)strtol(end, NULL, 10);
+      count++;
+   }
+   fclose(file);
 
-         break;
-      case SET_INIT:
-         state = set_init(current_set_iter, &tc_total, &tc_passed, &tc_failed, &tc_skipped, &current_set);
+   qsort(entries, count, sizeof(st_duration), duration_cmp);
+   *durations = entries;
+   return count;
+}
+// keep only the selected cases that belong to this shard; parameterized cases run on every
+// shard and split their rows instead
+static int shard_cases(void) {
+   size_t total = 0;
+   for (size_t i = 0; i < registry.count; i++)
+      total += registry.cases[i].selected && !registry.cases[i].is_param;
+   if (total == 0)
+      return 0;
+
+   size_t count = (size_t)runner_options.shard_count;
+   size_t shard = (size_t)runner_options.shard_index;
+   if (!runner_options.shard_durations) {
+      size_t n = 0;
+      for (size_t i = 0; i < registry.count; i++) {
+         if (registry.cases[i].selected && !registry.cases[i].is_param)
+            registry.cases[i].selected = (n++ * count) / total == shard;
+      }
+      return 0;
+   }
 
-         break;
-      case BEFORE_SET:
-         state = before_set(hooks, set_sequence, current_set, timestamp);
-         current_tc_iter = current_set->cases;
-         state = CASE_LOOP;
+   st_duration *durations = NULL;
+   long known = load_durations(runner_options.shard_durations, &durations);
+   if (known < 0)
+      return -1;
+   st_shard_item *items = __real_malloc(total * sizeof(st_shard_item));
+   double *loads = __real_calloc(count, sizeof(double));
+   if (!items || !loads) {
+      fwritelnf(stderr, "Error: Failed to allocate shard plan");
+      exit(EXIT_FAILURE);
+   }
 
-         break;
-      case CASE_LOOP:
-         state = case_loop(&current_tc_iter);
+   // cases without a recorded duration count as the mean of the recorded ones
+   size_t n = 0, found = 0;
+   double sum = 0;
+   for (size_t i = 0; i < registry.count; i++) {
+      TestCase tc = &registry.cases[i];
+      if (!tc->selected || tc->is_param)
+         continue;
+      char full_name[512];
+      snprintf(full_name, sizeof(full_name), "%s/%s", tc->set->info.name, tc->info.name);
+      st_duration key = {.name = full_name};
+      st_duration *entry = known ? bsearch(&key, durations, known, sizeof(st_duration), duration_cmp) : NULL;
+      items[n].index = i;
+      items[n].ms = entry ? entry->ms : -1;
+      if (entry) {
+         sum += entry->ms;
+         found++;
+      }
+      n++;
+   }
+   double fallback = found ? sum / found : 1.0;
+   for (size_t i = 0; i < n; i++) {
+      if (items[i].ms < 0)
+         items[i].ms = fallback;
+   }
 
-         break;
+   qsort(items, n, sizeof(st_shard_item), shard_item_cmp);
+   for (size_t i = 0; i < n; i++) {
+      size_t target = 0;
+      for (size_t s = 1; s < count; s++) {
+         if (loads[s] < loads[target])
+            target = s;
+      }
+      loads[target] += items[i].ms;
+      registry.cases[items[i].index].selected = target == shard;
+   }
+
+   __real_free(loads);
+   __real_free(items);
+   __real_free(durations);
+   return 0;
+}
+const char *st_shard_path(const char *path, char *buffer, size_t size) {
+   if (runner_options.shard_count <= 1 || !path)
+      return path;
+
+   // insert the shard ahead of the extension of the last path component
+   const char *base = strrchr(path, '/');
+   const char *ext = strrchr(base ? base : path, '.');
+   if (!ext || ext == (base ? base + 1 : path))
+      ext = path + strlen(path);
+   snprintf(buffer, size, "%.*s.shard-%d%s", (int)(ext - path), path, runner_options.shard_index, ext);
+   return buffer;
+}
+
+/*
+ * Test selection (`--filter`, `--tag`)
+ * Evaluated once before the run: a case is selected when its `set/case` name matches the
+ * filter (a glob, or an extended regex written as `/regex/`) and its tags, together with the
+ * tags of its set, include any selected tag and no excluded (`!tag`) one.
+ */
+static int select_name(const char *filter, regex_t *regex, TestSet set, TestCase tc) {
+   if (!filter)
+      return 1;
+
+   char full_name[512];
+   snprintf(full_name, sizeof(full_name), "%s/%s", set->info.name, tc->info.name);
+   if (regex)
+      return regexec(regex, full_name, 0, NULL, 0) == 0;
+   // a glob may name the case alone or `set/case`
+   return fnmatch(filter, full_name, 0) == 0 || fnmatch(filter, tc->info.name, 0) == 0;
+}
+// mark the selected cases; returns the number of sets with at least one, or -1 on error
+static int select_cases(TestSet sets) {
+   const char *filter = runner_options.filter;
+   regex_t regex;
+   int use_regex = 0;
+   if (filter && filter[0] == '/' && strlen(filter) > 1 && filter[strlen(filter) - 1] == '/') {
+      char pattern[512];
+      snprintf(pattern, sizeof(pattern), "%.*s", (int)strlen(filter) - 2, filter + 1);
+      int rc = regcomp(&regex, pattern, REG_EXTENDED | REG_NOSUB);
+      if (rc != 0) {
+         char error[128];
+         regerror(rc, &regex, error, sizeof(error));
+         fwritelnf(stderr, "Error: Invalid filter '%s': %s", filter, error);
+         return -1;
+      }
+      use_regex = 1;
+   }
+
+   // without a plain (non `!`) tag every case passes the tag check; a plain tag that no case
+   // carries selects nothing
+   uint64_t exclude = 0;
+   int has_include = 0;
+   uint64_t include = parse_tags(runner_options.tags, FALSE, &exclude, &has_include);
+
+   for (TestSet set = sets; set; set = set->next) {
+      for (int i = 0; i < set->info.count; i++) {
+         TestCase tc = &registry.cases[set->first + i];
+         uint64_t tags = tc->tags | set->tags;
+         tc->selected = select_name(filter, use_regex ? &regex : NULL, set, tc) &&
+                        !(tags & exclude) &&
+                        (!has_include || (tags & include));
+      }
+   }
+   if (use_regex)
+      regfree(&regex);
+   if (runner_options.shard_count > 1 && shard_cases() != 0)
+      return -1;
+
+   int selected_sets = 0;
+   for (TestSet set = sets; set; set = set->next) {
+      set->selected = 0;
+      for (int i = 0; i < set->info.count; i++) {
+         if (registry.cases[set->first + i].selected) {
+            set->selected++;
+            set->last = (size_t)i;
+         }
+      }
+      if (set->selected > 0)
+         selected_sets++;
+   }
+
+   return selected_sets;
+}
+// run the deferred set config and replay anything logged to the set before it
+static void configure_set(TestSet set) {
+   if (set->configured)
+      return;
+
+   FILE *stream = stdout;
+   set->config(&stream);
+   if (!stream) {
+      stream = stdout; // Fallback to stdout if config fails
+   }
+   if (set->pending) {
+      fclose(set->pending);
+      if (set->pending_len > 0) {
+         fwrite(set->pending_buf, 1, set->pending_len, stream);
+         fflush(stream);
+      }
+      __real_free(set->pending_buf); // allocated by open_memstream
+      set->pending = NULL;
+      set->pending_buf = NULL;
+   }
+   set->log_stream = stream;
+   set->configured = 1;
+}
+
+/*
+ * Run order (`--order`, `--seed`, `--history`)
+ * The history file holds one `set/case<TAB>ms fails` line per case: its last duration (setup
+ * through teardown) and its number of consecutive failed runs. It reads as a
+ * `--shard-durations` file too, and is rewritten after every run, keeping the cases that did
+ * not run. An order other than registration relinks the set list and gives each set a case
+ * order for the run only; both are put back when the run ends.
+ */
+#define ST_HISTORY_FILE ".sigtest_history"
+
+// the history file in use: explicit, or the default when the order reads it
+static const char *history_path(void) {
+   if (runner_options.history)
+      return runner_options.history;
+   if (runner_options.order == ORDER_FAILED_FIRST || runner_options.order == ORDER_LONGEST_FIRST)
+      return ST_HISTORY_FILE;
+   return NULL;
+}
+// load the history sorted by name; a missing file is an empty history
+static long load_history(st_duration **entries) {
+   const char *path = history_path();
+   *entries = NULL;
+   if (!path || access(path, F_OK) != 0)
+      return 0;
+   return load_durations(path, entries);
+}
+static st_duration *history_find(st_duration *entries, long count, TestSet set, TestCase tc) {
+   if (count <= 0)
+      return NULL;
+   char full_name[512];
+   snprintf(full_name, sizeof(full_name), "%s/%s", set->info.name, tc->info.name);
+   st_duration key = {.name = full_name};
+   return bsearch(&key, entries, count, sizeof(st_duration), duration_cmp);
+}
+// splitmix64: a seeded, reproducible shuffle key
+static uint64_t order_random(uint64_t *state) {
+   uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+   z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+   z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+   return z ^ (z >> 31);
+}
+// order the cases of a set and return the set's own sort key
+static double order_cases(TestSet set, st_duration *history, long known, double fallback, uint64_t *rng) {
+   size_t count = (size_t)set->info.count;
+   st_shard_item *items = __real_malloc((count ? count : 1) * sizeof(st_shard_item));
+   set->order = __real_malloc((count ? count : 1) * sizeof(size_t));
+   if (!items || !set->order) {
+      fwritelnf(stderr, "Error: Failed to allocate run order");
+      exit(EXIT_FAILURE);
+   }
+
+   double set_key = 0;
+   for (size_t i = 0; i < count; i++) {
+      TestCase tc = &registry.cases[set->first + i];
+      st_duration *entry = history_find(history, known, set, tc);
+      double key = 0;
+      if (runner_options.order == ORDER_FAILED_FIRST) {
+         key = entry ? entry->fails : 0;
+         if (tc->selected && key > set_key)
+            set_key = key; // the set's longest failing streak
+      } else if (runner_options.order == ORDER_LONGEST_FIRST) {
+         key = entry ? entry->ms : fallback;
+         if (tc->selected)
+            set_key += key; // the set's total
+      } else {
+         key = (double)(order_random(rng) >> 11);
+      }
+      items[i] = (st_shard_item){.index = i, .ms = key};
+   }
+   if (runner_options.order == ORDER_RANDOM)
+      set_key = (double)(order_random(rng) >> 11);
+
+   // largest key first; ties keep registration order
+   qsort(items, count, sizeof(st_shard_item), shard_item_cmp);
+   for (size_t i = 0; i < count; i++) {
+      set->order[i] = items[i].index;
+      if (registry.cases[set->first + items[i].index].selected)
+         set->last = items[i].index;
+   }
+   __real_free(items);
+   return set_key;
+}
+// relink the sets and order their cases for the run; returns the new head and the
+// NULL-terminated registration order to restore
+static TestSet order_sets(TestSet sets, TestSet **original) {
+   *original = NULL;
+   if (runner_options.order == ORDER_REGISTERED || !sets)
+      return sets;
+
+   st_duration *history = NULL;
+   long known = load_history(&history);
+   if (known < 0)
+      exit(EXIT_FAILURE);
+   // cases without a recorded duration count as the mean of the recorded ones
+   double sum = 0;
+   for (long i = 0; i < known; i++)
+      sum += history[i].ms;
+   double fallback = known ? sum / known : 1.0;
+
+   uint64_t rng = runner_options.seed;
+   if (runner_options.order == ORDER_RANDOM) {
+      if (!runner_options.seed) {
+         ts_time now;
+         sys_gettime(&now);
+         runner_options.seed = ((unsigned long)now.tv_nsec ^ ((unsigned long)getpid() << 16)) | 1;
+         rng = runner_options.seed;
+      }
+      fwritelnf(stdout, "Random order seed: %lu", runner_options.seed);
+   }
+
+   size_t count = 0;
+   for (TestSet set = sets; set; set = set->next)
+      count++;
+   TestSet *list = __real_malloc((count + 1) * sizeof(TestSet));
+   st_shard_item *items = __real_malloc(count * sizeof(st_shard_item));
+   if (!list || !items) {
+      fwritelnf(stderr, "Error: Failed to allocate run order");
+      exit(EXIT_FAILURE);
+   }
+   size_t n = 0;
+   for (TestSet set = sets; set; set = set->next, n++) {
+      list[n] = set;
+      items[n] = (st_shard_item){.index = n, .ms = order_cases(set, history, known, fallback, &rng)};
+   }
+   list[count] = NULL;
+
+   qsort(items, count, sizeof(st_shard_item), shard_item_cmp);
+   for (size_t i = 0; i < count; i++)
+      list[items[i].index]->next = i + 1 < count ? list[items[i + 1].index] : NULL;
+   TestSet head = list[items[0].index];
+
+   __real_free(items);
+   __real_free(history);
+   *original = list;
+   return head;
+}
+// put back the registration order saved by order_sets
+static void restore_sets(TestSet *original) {
+   if (!original)
+      return;
+   for (size_t i = 0; original[i]; i++) {
+      original[i]->next = original[i + 1];
+      __real_free(original[i]->order);
+      original[i]->order = NULL;
+   }
+   __real_free(original);
+}
+// record the outcome and duration of every case that ran
+static void history_save(TestSet sets) {
+   const char *path = history_path();
+   if (!path)
+      return;
+
+   st_duration *old = NULL;
+   long known = load_history(&old);
+   if (known < 0)
+      known = 0; // unreadable: start over
+   st_duration *entries = __real_malloc((known + registry.count + 1) * sizeof(st_duration));
+   if (!entries) {
+      fwritelnf(stderr, "Error: Failed to allocate history");
+      __real_free(old);
+      return;
+   }
+   if (known)
+      memcpy(entries, old, known * sizeof(st_duration));
+
+   size_t count = (size_t)known;
+   for (TestSet set = sets; set; set = set->next) {
+      for (int i = 0; i < set->info.count; i++) {
+         TestCase tc = &registry.cases[set->first + i];
+         if (!tc->selected)
+            continue;
+         st_duration *entry = history_find(entries, known, set, tc);
+         if (!entry) {
+            char full_name[512];
+            snprintf(full_name, sizeof(full_name), "%s/%s", set->info.name, tc->info.name);
+            entry = &entries[count++];
+            *entry = (st_duration){.name = arena_strdup(full_name)};
+         }
+         TestState state = tc->info.result.state;
+         entry->ms = tc->elapsed_ms;
+         if (state == FAIL || state == TIMEOUT || state == OVERBUDGET)
+            entry->fails++;
+         else if (state != SKIP)
+            entry->fails = 0;
+      }
+   }
+   qsort(entries, count, sizeof(st_duration), duration_cmp);
+
+   // write beside the old history and swap it in, so a crash never leaves half a file
+   char temp[PATH_MAX];
+   snprintf(temp, sizeof(temp), "%s.tmp", path);
+   FILE *file = fopen(temp, "w");
+   if (!file) {
+      fwritelnf(stderr, "Error: Cannot write history '%s': %s", temp, strerror(errno));
+   } else {
+      fprintf(file, "# set/case\tms fails\n");
+      for (size_t i = 0; i < count; i++)
+         fprintf(file, "%s\t%.3f %d\n", entries[i].name, entries[i].ms, entries[i].fails);
+      if (fclose(file) != 0 || rename(temp, path) != 0)
+         fwritelnf(stderr, "Error: Cannot write history '%s': %s", path, strerror(errno));
+   }
+   __real_free(entries);
+   __real_free(old);
+}
+
+/*
+ * Aggregate results of a test run (or of a single set) merged into the runner summary
+ */
+typedef struct st_totals_s {
+   int tests;
+   int passed;
+   int failed;
+   int skipped;
+   int regressed;
+} st_totals;
+
+// Runner state handlers
+static RunnerState runner_init(TestSet, ST_Hooks, int *, int *, ST_Hooks *);
+static RunnerState set_loop(TestSet *, int *);
+static RunnerState set_init(TestSet, int *, int *, int *, int *, TestSet *);
+static RunnerState before_set(ST_Hooks, int, TestSet, char *);
+static RunnerState case_loop(TestSet, size_t *);
+static RunnerState case_init(TestCase, TestSet);
+static RunnerState before_test(ST_Hooks);
+static RunnerState setup_test(TestSet);
+static RunnerState start_test(ST_Hooks);
+static RunnerState execute_test(TestCase, jmp_buf);
+static RunnerState execute_fuzzing(TestCase, jmp_buf, const void *, size_t, size_t);
+static RunnerState execute_fuzz_case(TestCase);
+static RunnerState execute_param_case(TestCase);
+static RunnerState execute_fuzz_engine(TestCase, const void *, size_t, size_t);
+static RunnerState execute_bench(TestCase, jmp_buf);
+static void bench_compare(TestCase, TestSet);
+static void bench_report(ST_Hooks, TestCase, TestSet);
+static void param_report(ST_Hooks, TestCase, TestSet);
+static int baseline_open(void);
+static int baseline_save(TestSet);
+static RunnerState end_test(ST_Hooks);
+static RunnerState teardown_test(TestSet);
+static RunnerState after_test(ST_Hooks);
+static RunnerState process_result(TestCase, TestSet, ST_Hooks,
+                                  int *, int *, int *, int *, int *);
+static RunnerState after_set(ST_Hooks, TestSet,
+                             int, int, int, int, int);
+static int runner_workers(int, ST_Hooks);
+static RunnerState dispatch_sets(TestSet, int, int, ST_Hooks, st_totals *);
+static void run_set(TestSet, int, ST_Hooks, tc_context *, st_totals *);
+static void runner_summary(st_totals *, int, TestSet, ST_Hooks);
+static int runner_done(st_totals *);
+
+/*
+ * Process isolation (`--isolate`)
+ *
+ * A pool of pre-forked worker processes runs the setup, test body and teardown of each case
+ * on behalf of the runner. Each runner thread owns one worker; it sends a request (operation
+ * and case index) over a pipe and the worker streams back the case result along with any
+ * output the case produced. Crashes, signals and `exit()` calls only take down the worker:
+ * the case is reported as FAIL and a fresh worker is forked in its place.
+ */
+typedef enum {
+   ISO_SETUP,
+   ISO_EXECUTE,
+   ISO_TEARDOWN,
+} IsoOp;
+
+typedef struct st_iso_request_s {
+   IsoOp op;
+   size_t index;       /* Registry index of the case */
+   int ran_no_newline; /* "Running:" line state in the runner */
+   int had_debug;
+} st_iso_request;
+
+typedef struct st_iso_response_s {
+   TestState state; /* Case result; only meaningful for ISO_EXECUTE */
+   int ran_no_newline;
+   int had_debug;
+   size_t message_len;
+   size_t output_len;
+   size_t debug_len; /* Debug log text for the runner's on_debug_log hook */
+   size_t allocs; /* Allocations made by the worker for this request */
+   size_t frees;
+   size_t leak_live; /* Leak tracking totals of the case inside the worker */
+   size_t leak_peak;
+   st_bench_stats bench; /* Benchmark statistics; `samples` sample times follow the debug log */
+   st_param_results params; /* Row counts of a parameterized case; `param_len` bytes of rows follow */
+   size_t param_len;
+} st_iso_response;
+/* Failed or skipped row of a parameterized case; `message_len` message bytes follow */
+typedef struct st_iso_param_row_s {
+   size_t row;
+   TestState state;
+   size_t message_len;
+} st_iso_param_row;
+
+typedef struct st_iso_worker_s {
+   pid_t pid;
+   int request_fd;  /* Runner -> worker */
+   int response_fd; /* Worker -> runner */
+} st_iso_worker;
+
+static st_iso_worker *iso_workers = NULL;
+static int iso_worker_count = 0;
+static atomic_int iso_next_worker = 0;
+static _Thread_local st_iso_worker *iso_worker = NULL; /* Worker bound to this runner thread */
+static int iso_child = 0;                               /* Set in worker processes */
+static FILE *iso_debug = NULL;                          /* Worker capture for hooked debug logs */
+
+static int write_full(int fd, const void *buf, size_t len) {
+   const char *p = buf;
+   while (len > 0) {
+      ssize_t n = write(fd, p, len);
+      if (n < 0 && errno == EINTR)
+         continue;
+      if (n <= 0)
+         return -1;
+      p += n;
+      len -= (size_t)n;
+   }
+   return 0;
+}
+static int read_full(int fd, void *buf, size_t len) {
+   char *p = buf;
+   while (len > 0) {
+      ssize_t n = read(fd, p, len);
+      if (n < 0 && errno == EINTR)
+         continue;
+      if (n <= 0)
+         return -1;
+      p += n;
+      len -= (size_t)n;
+   }
+   return 0;
+}
+// worker process main loop; never returns
+static void iso_worker_loop(int request_fd, int response_fd) {
+   char *output = NULL, *debug = NULL;
+   size_t output_len = 0, debug_len = 0;
+   FILE *capture = open_memstream(&output, &output_len);
+   iso_debug = open_memstream(&debug, &debug_len);
+   if (!capture || !iso_debug)
+      _exit(EXIT_FAILURE);
+
+   iso_child = 1;
+   capture_forked();
+   // counts inherited from the runner were already reported there
+   size_t inherited_allocs, inherited_frees;
+   take_alloc_counts(&inherited_allocs, &inherited_frees);
+   st_iso_request req;
+   while (read_full(request_fd, &req, sizeof(req)) == 0) {
+      if (req.index >= registry.count)
+         break;
+
+      TestCase tc = &registry.cases[req.index];
+      TestSet set = tc->set;
+      FILE *log_stream = set->log_stream;
+      set->log_stream = capture;
+      current_set = set;
+      set->current = tc;
+      current_tc = tc;
+      tc->ran_no_newline = req.ran_no_newline;
+      tc->had_debug = req.had_debug;
+
+      switch (req.op) {
+      case ISO_SETUP:
+         inside_test = 0;
+         line_open = 0;
+         if (set->setup && setjmp(jmpbuffer) == 0)
+            set->setup();
+
+         break;
+      case ISO_EXECUTE:
+         inside_test = 1;
+         // the runner holds the output of the case; only its descriptors are redirected here
+         if (capture_mode == CAPTURE_FDS)
+            capture_begin(1);
+         cross_begin(tc);
+         budget_arm(tc);
+         profile_arm(tc);
+         switch (execute_test(tc, jmpbuffer)) {
+         case FUZZING_INIT:
+            execute_fuzz_case(tc);
+            break;
+         case PARAM_INIT:
+            execute_param_case(tc);
+            break;
+         case BENCH_INIT:
+            execute_bench(tc, jmpbuffer);
+            break;
+         default:
+            break;
+         }
+         profile_disarm(tc);
+         budget_disarm(tc);
+         cross_end(tc);
+         capture_finish(1);
+         inside_test = 0;
+         // without a teardown request the case ends here
+         if (!set->teardown)
+            fixture_release(tc);
+
+         break;
+      case ISO_TEARDOWN:
+         inside_test = 0;
+         if (set->teardown && setjmp(jmpbuffer) == 0)
+            set->teardown();
+         fixture_release(tc);
+
+         break;
+      }
+
+      fflush(capture);
+      fflush(iso_debug);
+      set->log_stream = log_stream;
+
+      const char *message = tc->info.result.message;
+      size_t allocs, frees;
+      take_alloc_counts(&allocs, &frees);
+      st_iso_response res = {
+          .state = tc->info.result.state,
+          .ran_no_newline = tc->ran_no_newline,
+          .had_debug = tc->had_debug,
+          .message_len = (req.op == ISO_EXECUTE && message) ? strlen(message) : 0,
+          .output_len = output_len,
+          .debug_len = debug_len,
+          .allocs = allocs,
+          .frees = frees,
+          .leak_live = tc->leak_live,
+          .leak_peak = tc->leak_peak,
+      };
+      if (req.op == ISO_EXECUTE && tc->bench)
+         res.bench = tc->bench->stats;
+      // only the rows that did not pass go back to the runner
+      char *rows = NULL;
+      size_t rows_len = 0;
+      if (req.op == ISO_EXECUTE && tc->params) {
+         res.params = *tc->params;
+         FILE *stream = open_memstream(&rows, &rows_len);
+         for (size_t row = res.params.first; stream && row < res.params.last; row++) {
+            const st_param_row *result = &tc->params->rows[row];
+            if (result->state == PASS)
+               continue;
+            st_iso_param_row entry = {row, result->state, result->message ? strlen(result->message) : 0};
+            fwrite(&entry, sizeof(entry), 1, stream);
+            fwrite(result->message, 1, entry.message_len, stream);
+         }
+         if (stream)
+            fclose(stream);
+         res.param_len = rows_len;
+      }
+      int failed = write_full(response_fd, &res, sizeof(res)) != 0 ||
+                   write_full(response_fd, message, res.message_len) != 0 ||
+                   write_full(response_fd, output, output_len) != 0 ||
+                   write_full(response_fd, debug, debug_len) != 0 ||
+                   write_full(response_fd, res.bench.sample_ns, res.bench.samples * sizeof(double)) != 0 ||
+                   write_full(response_fd, rows, rows_len) != 0;
+      __real_free(rows);
+      if (failed)
+         break;
+
+      fseek(capture, 0, SEEK_SET);
+      fseek(iso_debug, 0, SEEK_SET);
+   }
+
+   fixture_sweep(NULL);
+   _exit(EXIT_SUCCESS);
+}
+// fork a worker process into the given slot
+static int iso_spawn(st_iso_worker *worker) {
+   int request[2], response[2];
+   if (pipe(request) != 0)
+      return -1;
+   if (pipe(response) != 0) {
+      close(request[0]);
+      close(request[1]);
+      return -1;
+   }
+
+   fflush(NULL); // never let a worker inherit unflushed output
+   pid_t pid = fork();
+   if (pid < 0) {
+      close(request[0]);
+      close(request[1]);
+      close(response[0]);
+      close(response[1]);
+      return -1;
+   }
+   if (pid == 0) {
+      close(request[1]);
+      close(response[0]);
+      // drop the pipes of sibling workers
+      for (int i = 0; i < iso_worker_count; i++) {
+         if (&iso_workers[i] != worker && iso_workers[i].pid > 0) {
+            close(iso_workers[i].request_fd);
+            close(iso_workers[i].response_fd);
+         }
+      }
+      iso_worker_loop(request[0], response[1]);
+   }
+
+   close(request[0]);
+   close(response[1]);
+   worker->pid = pid;
+   worker->request_fd = request[1];
+   worker->response_fd = response[0];
+   return 0;
+}
+// reap a worker process and describe how it ended
+static void iso_reap(st_iso_worker *worker, char *reason, size_t len) {
+   int status = 0;
+   close(worker->request_fd);
+   close(worker->response_fd);
+   if (waitpid(worker->pid, &status, 0) == worker->pid && WIFSIGNALED(status)) {
+      snprintf(reason, len, "Test crashed: signal %d (%s)", WTERMSIG(status), strsignal(WTERMSIG(status)));
+   } else if (WIFEXITED(status)) {
+      snprintf(reason, len, "Test exited with status %d", WEXITSTATUS(status));
+   } else {
+      snprintf(reason, len, "Test worker terminated unexpectedly");
+   }
+   worker->pid = -1;
+}
+// pre-fork the worker pool
+static int iso_start(int workers) {
+   iso_workers = __real_calloc(workers, sizeof(st_iso_worker));
+   if (!iso_workers) {
+      fwritelnf(stderr, "Error: Failed to allocate isolation worker pool");
+      return -1;
+   }
+
+   // a dead worker must not take the runner down with SIGPIPE
+   signal(SIGPIPE, SIG_IGN);
+   for (iso_worker_count = 0; iso_worker_count < workers; iso_worker_count++) {
+      if (iso_spawn(&iso_workers[iso_worker_count]) != 0) {
+         fwritelnf(stderr, "Error: Failed to start isolation worker: %s", strerror(errno));
+         return -1;
+      }
+   }
+   atomic_store(&iso_next_worker, 0);
+
+   return 0;
+}
+// shut the worker pool down
+static void iso_stop(void) {
+   for (int i = 0; i < iso_worker_count; i++) {
+      if (iso_workers[i].pid > 0) {
+         close(iso_workers[i].request_fd);
+         close(iso_workers[i].response_fd);
+         waitpid(iso_workers[i].pid, NULL, 0);
+      }
+   }
+   __real_free(iso_workers);
+   iso_workers = NULL;
+   iso_worker_count = 0;
+}
+// bind the calling runner thread to the next free worker
+static void iso_bind(void) {
+   int slot = atomic_fetch_add(&iso_next_worker, 1);
+   iso_worker = slot < iso_worker_count ? &iso_workers[slot] : NULL;
+}
+// wait for the response to a case no longer than its wall budget allows; past it the worker
+// is killed and -1 returned
+static int iso_wait(st_iso_worker *worker, IsoOp op, TestCase tc) {
+   tc->budget_hit = 0;
+   int wall_ms = op == ISO_EXECUTE ? budget_of(tc).wall_ms : 0;
+   if (wall_ms <= 0)
+      return 0;
+   struct pollfd response = {.fd = worker->response_fd, .events = POLLIN};
+   int ready;
+   while ((ready = poll(&response, 1, wall_ms + ST_BUDGET_GRACE_MS)) < 0 && errno == EINTR)
+      ;
+   if (ready != 0)
+      return 0;
+   kill(worker->pid, SIGKILL);
+   tc->budget_hit = BUDGET_WALL;
+   return -1;
+}
+// run one operation of the given case in the bound worker; returns 0, or -1 if the worker died
+static int iso_run(IsoOp op, TestCase tc, char *reason, size_t reason_len) {
+   st_iso_worker *worker = iso_worker;
+   st_iso_request req = {
+       .op = op,
+       .index = (size_t)(tc - registry.cases),
+       // a captured case keeps its Running line open until the capture is written out
+       .ran_no_newline = captured.active ? 0 : tc->ran_no_newline,
+       .had_debug = tc->had_debug,
+   };
+   st_iso_response res;
+   if (worker->pid <= 0 && iso_spawn(worker) != 0) {
+      snprintf(reason, reason_len, "Failed to start isolation worker: %s", strerror(errno));
+      return -1;
+   }
+   if (write_full(worker->request_fd, &req, sizeof(req)) != 0 || iso_wait(worker, op, tc) != 0 ||
+       read_full(worker->response_fd, &res, sizeof(res)) != 0) {
+      iso_reap(worker, reason, reason_len);
+      if (tc->budget_hit)
+         snprintf(reason, reason_len, "Timeout: exceeded the %d ms wall time budget (worker killed)", budget_of(tc).wall_ms);
+      iso_spawn(worker);
+      return -1;
+   }
+
+   char *message = res.message_len ? arena_alloc(res.message_len + 1) : NULL;
+   char *output = res.output_len ? __real_malloc(res.output_len) : NULL;
+   char *debug = res.debug_len ? __real_malloc(res.debug_len + 1) : NULL;
+   char *rows = res.param_len ? __real_malloc(res.param_len) : NULL;
+   if ((res.message_len && (!message || read_full(worker->response_fd, message, res.message_len) != 0)) ||
+       (res.output_len && (!output || read_full(worker->response_fd, output, res.output_len) != 0)) ||
+       (res.debug_len && (!debug || read_full(worker->response_fd, debug, res.debug_len) != 0)) ||
+       (res.bench.samples && (!tc->bench || res.bench.samples > ST_BENCH_SAMPLES ||
+                              read_full(worker->response_fd, tc->bench->samples, res.bench.samples * sizeof(double)) != 0)) ||
+       (res.param_len && (!rows || read_full(worker->response_fd, rows, res.param_len) != 0))) {
+      __real_free(output);
+      __real_free(debug);
+      __real_free(rows);
+      iso_reap(worker, reason, reason_len);
+      iso_spawn(worker);
+      return -1;
+   }
+
+   if (output && captured.active) {
+      capture_write(output, res.output_len);
+      __real_free(output);
+   } else if (output) {
+      FILE *stream = (current_set && current_set->log_stream) ? current_set->log_stream : stdout;
+      fwrite(output, 1, res.output_len, stream);
+      fflush(stream);
+      __real_free(output);
+   }
+   if (debug) {
+      debug[res.debug_len] = '\0';
+      if (current_set->hooks && current_set->hooks->on_debug_log)
+         current_set->hooks->on_debug_log(current_ctx, DBG_DEBUG, "%s", debug);
+      __real_free(debug);
+   }
+   if (!captured.active) {
+      tc->ran_no_newline = res.ran_no_newline;
+      tc->had_debug = res.had_debug;
+   }
+   add_alloc_counts(res.allocs, res.frees);
+   tc->leak_live = res.leak_live;
+   tc->leak_peak = res.leak_peak;
+
+   if (op == ISO_EXECUTE && tc->bench) {
+      tc->bench->stats = res.bench;
+      tc->bench->stats.sample_ns = tc->bench->samples;
+   }
+   if (op == ISO_EXECUTE && tc->params) {
+      st_param_results *results = tc->params;
+      results->first = res.params.first;
+      results->last = res.params.last;
+      results->passed = res.params.passed;
+      results->failed = res.params.failed;
+      results->skipped = res.params.skipped;
+      for (size_t row = results->first; row < results->last && row < results->count; row++)
+         results->rows[row] = (st_param_row){PASS, NULL};
+      for (size_t at = 0; at + sizeof(st_iso_param_row) <= res.param_len;) {
+         st_iso_param_row entry;
+         memcpy(&entry, rows + at, sizeof(entry));
+         at += sizeof(entry);
+         if (entry.row >= results->count || entry.message_len > res.param_len - at)
+            break;
+         string row_message = entry.message_len ? arena_alloc(entry.message_len + 1) : NULL;
+         if (row_message)
+            memcpy(row_message, rows + at, entry.message_len);
+         results->rows[entry.row] = (st_param_row){entry.state, row_message};
+         at += entry.message_len;
+      }
+   }
+   __real_free(rows);
+   if (op == ISO_EXECUTE) {
+      tc->info.result.state = res.state;
+      tc->info.result.message = message;
+      if (message)
+         message[res.message_len] = '\0';
+   }
+
+   return 0;
+}
+static RunnerState setup_isolated(TestCase tc, TestSet set) {
+   char reason[128];
+   if (set->setup && iso_run(ISO_SETUP, tc, reason, sizeof(reason)) != 0) {
+      // the case cannot run without its setup; report it as failed
+      tc->iso_setup_failed = 1;
+      tc->info.result.state = FAIL;
+      tc->info.result.message = arena_strdup(reason);
+   }
+   return START_TEST;
+}
+static RunnerState execute_isolated(TestCase tc) {
+   char reason[128];
+   current_tc = tc;
+   if (tc->iso_setup_failed) {
+      tc->iso_setup_failed = 0;
+      return END_TEST;
+   }
+   if (iso_run(ISO_EXECUTE, tc, reason, sizeof(reason)) != 0) {
+      tc->info.result.state = tc->budget_hit ? TIMEOUT : FAIL;
+      tc->info.result.message = arena_strdup(reason);
+   }
+   return END_TEST;
+}
+static RunnerState teardown_isolated(TestCase tc, TestSet set) {
+   char reason[128];
+   if (set->teardown && iso_run(ISO_TEARDOWN, tc, reason, sizeof(reason)) != 0) {
+      fwritelnf(set->log_stream, "Error: teardown of `%s` failed: %s", tc->info.name, reason);
+   }
+   return AFTER_TEST;
+}
+// the actual test runner
+int run_tests(TestSet sets, ST_Hooks test_hooks) {
+   // VIRTUAL STATE: RUNNER_INIT
+   int total_tests = 0;
+   int set_sequence = 1;
+   int total_sets = 0;
+   int selected_sets = 0;
+   int workers = 1;
+   ST_Hooks hooks = NULL;
+   st_totals totals = {0};
+   TestSet *registered = NULL;
+
+   TestSet current_set_iter = sets;
+   current_set = NULL;
+
+   RunnerState state = RUNNER_INIT;
+   while (state != RUNNER_DONE) {
+      if (current_ctx)
+         current_ctx->info.state = state; // update hooks context state
+      switch (state) {
+      case RUNNER_INIT:
+         state = runner_init(sets, test_hooks, &total_tests, &total_sets, &hooks);
+         current_ctx = hooks ? hooks->context : NULL;
+         selected_sets = select_cases(sets);
+         if (selected_sets < 0 || baseline_open() != 0)
+            exit(EXIT_FAILURE);
+         sets = order_sets(sets, &registered);
+         current_set_iter = sets;
+         fixture_count(sets);
+         workers = runner_workers(selected_sets, hooks);
+         capture_mode = runner_options.capture;
+         if (capture_mode == CAPTURE_FDS && workers > 1 && !runner_options.isolate) {
+            fwritelnf(stderr, "Warning: --capture-fds needs serial sets or --isolate; capturing log output only");
+            capture_mode = CAPTURE_LOG;
+         }
+         // fork the isolation workers before any runner thread exists; workers must see the
+         // state set up by set configs, so those run first
+         if (runner_options.isolate) {
+            for (TestSet set = sets; set; set = set->next) {
+               if (set->selected > 0)
+                  configure_set(set);
+            }
+            if (iso_start(workers) != 0)
+               exit(EXIT_FAILURE);
+            // with set workers each of them binds its own worker process
+            if (workers <= 1)
+               iso_bind();
+         }
+         // log output is buffered until a test boundary; don't lose it to a crash
+         install_crash_flush();
+
+         break;
+      case SET_LOOP:
+         if (workers > 1) {
+            state = dispatch_sets(sets, selected_sets, workers, hooks, &totals);
+            break;
+         }
+         state = set_loop(&current_set_iter, &set_sequence);
+         if (state == RUNNER_SUMMARY) {
+            break;
+         }
+         // VIRTUAL STATES: SET_INIT -> AFTER_SET
+         run_set(current_set_iter, set_sequence, hooks, current_ctx, &totals);
+         current_set_iter = current_set_iter->next;
+         state = SET_LOOP;
+
+         break;
+      case RUNNER_SUMMARY:
+         if (baseline_save(sets) != 0)
+            totals.failed++;
+         history_save(sets);
+         fixture_sweep(NULL);
+         runner_summary(&totals, total_sets, sets, test_hooks);
+         state = RUNNER_DONE;
+
+         break;
+      case RUNNER_DONE:
+         break;
+      default:
+         fwritelnf(stderr, "Error: Unknown runner state %d", state);
+         state = RUNNER_DONE;
+         break;
+      }
+   }
+
+   if (runner_options.isolate)
+      iso_stop();
+   restore_sets(registered);
+
+   return runner_done(&totals);
+}
+// Runs a single test set (SET_INIT through AFTER_SET) on the calling thread
+static void run_set(TestSet set, int set_sequence, ST_Hooks hooks, tc_context *ctx, st_totals *totals) {
+   char timestamp[32];
+   size_t case_index = 0;
+   TestCase tc = NULL;
+   ts_time case_start, case_end;
+
+   int tc_total = 0;
+   int tc_passed = 0;
+   int tc_failed = 0;
+   int tc_skipped = 0;
+
+   current_ctx = ctx;
+   current_set = set;
+
+   RunnerState state = SET_INIT;
+   while (state != SET_LOOP) {
+      ctx->info.state = state; // update hooks context state
+      switch (state) {
+      case SET_INIT:
+         state = set_init(set, &tc_total, &tc_passed, &tc_failed, &tc_skipped, &current_set);
+
+         break;
+      case BEFORE_SET:
+         state = before_set(hooks, set_sequence, current_set, timestamp);
+         case_index = 0;
+         state = CASE_LOOP;
+
+         break;
+      case CASE_LOOP:
+         state = case_loop(current_set, &case_index);
+
+         break;
       case CASE_INIT:
-         tc = current_tc_iter;
+         tc = set_case(current_set, case_index);
          state = case_init(tc, current_set);
+         sys_gettime(&case_start);
 
          break;
       case BEFORE_TEST:
@@ -1237,7 +4602,7 @@ int run_tests(TestSet sets, ST_Hooks test_hooks) {
 
          break;
       case SETUP_TEST:
-         state = setup_test(current_set);
+         state = iso_worker ? setup_isolated(tc, current_set) : setup_test(current_set);
 
          break;
       case START_TEST:
@@ -1245,49 +4610,27 @@ int run_tests(TestSet sets, ST_Hooks test_hooks) {
 
          break;
       case EXECUTE_TEST:
-         state = execute_test(tc, jmpbuffer);
+         state = iso_worker ? execute_isolated(tc) : execute_test(tc, jmpbuffer);
 
          break;
       case FUZZING_INIT:
          // FUZZ TEST EXECUTION
-         const void *dataset;
-         size_t count;
-         size_t elem_size;
-
-         switch (tc->fuzz_type) {
-         case FUZZ_INT:
-            dataset = fuzz_int_values;
-            count = fuzz_int_count;
-            elem_size = sizeof(int);
+         state = execute_fuzz_case(tc);
 
-            break;
-         case FUZZ_SIZE_T:
-            dataset = fuzz_size_t_values;
-            count = fuzz_size_t_count;
-            elem_size = sizeof(size_t);
-
-            break;
-         case FUZZ_FLOAT:
-            dataset = fuzz_float_values;
-            count = fuzz_float_count;
-            elem_size = sizeof(float);
-
-            break;
-         case FUZZ_BYTE:
-            dataset = fuzz_byte_values;
-            count = fuzz_byte_count;
-            elem_size = sizeof(signed char);
+         break;
+      case PARAM_INIT:
+         state = execute_param_case(tc);
 
-            break;
-         default:
-            tc->info.result.state = FAIL;
-            tc->info.result.message = strdup("Invalid FuzzType in fuzz test");
-            return END_TEST; // or your next state
-         }
-         state = execute_fuzzing(tc, jmpbuffer, dataset, count, elem_size);
+         break;
+      case BENCH_INIT:
+         state = execute_bench(tc, jmpbuffer);
 
          break;
       case END_TEST:
+         if (tc->is_bench)
+            bench_report(hooks, tc, current_set);
+         if (tc->is_param)
+            param_report(hooks, tc, current_set);
          state = end_test(hooks);
 
          break;
@@ -1295,47 +4638,200 @@ int run_tests(TestSet sets, ST_Hooks test_hooks) {
          /* Process result before teardown so the elapsed/status prints inside teardown scope */
          state = process_result(tc, current_set, hooks,
                                 &tc_passed, &tc_failed, &tc_skipped,
-                                &tc_total, &total_tests);
+                                &tc_total, &totals->tests);
          /* advance iterator now (we will still run teardown for current test)
           * process_result returns CASE_LOOP normally but we force teardown next */
-         current_tc_iter = current_tc_iter->next;
-         state = teardown_test(current_set);
+         case_index++;
+         state = iso_worker ? teardown_isolated(tc, current_set) : teardown_test(current_set);
 
          break;
       case AFTER_TEST:
          state = after_test(hooks);
          default_on_testcase_finish();
+         if (!iso_worker)
+            fixture_release(tc);
+         sys_gettime(&case_end);
+         tc->elapsed_ms = get_elapsed_ms(&case_start, &case_end);
 
          break;
       case PROCESS_RESULT:
          /* no-op: results are processed in TEARDOWN_TEST to ensure result prints before teardown
           * keep iterator advance as a fallback */
-         if (current_tc_iter)
-            current_tc_iter = current_tc_iter->next;
+         case_index++;
          state = CASE_LOOP;
 
          break;
       case AFTER_SET:
          state = after_set(hooks, current_set,
                            set_sequence, tc_total, tc_passed, tc_failed, tc_skipped);
-         current_set_iter = current_set_iter->next;
-
-         break;
-      case RUNNER_SUMMARY:
-         runner_summary(total_tests, total_sets, sets, test_hooks);
-         state = RUNNER_DONE;
+         totals->passed += tc_passed;
+         totals->failed += tc_failed;
+         totals->skipped += tc_skipped;
+         totals->regressed += current_set->info.regressed;
 
-         break;
-      case RUNNER_DONE:
          break;
       default:
          fwritelnf(stderr, "Error: Unknown runner state %d", state);
-         state = RUNNER_DONE;
+         state = SET_LOOP;
+         break;
+      }
+   }
+
+   current_set = NULL;
+   current_tc = NULL;
+}
+
+/*
+ * Parallel set dispatch
+ *
+ * Each registered set becomes a job; a pool of runner threads claims jobs by index and runs
+ * them through `run_set` with a private hooks context. Sets logging to the console are
+ * captured into a per-set memory stream and replayed in registration order, so the merged
+ * output and totals are the same as a serial run.
+ */
+typedef struct st_set_job_s {
+   TestSet set;
+   int sequence;
+   st_totals totals;
+   char *capture; /* Captured console output */
+   size_t capture_len;
+   int done;
+} st_set_job;
+
+typedef struct st_set_pool_s {
+   st_set_job *jobs;
+   int count;
+   atomic_int next; /* Next unclaimed job index */
+   ST_Hooks hooks;
+   pthread_mutex_t lock;
+   pthread_cond_t job_done;
+} st_set_pool;
+
+static void *set_worker(void *arg) {
+   st_set_pool *pool = arg;
+   // each worker owns a copy of the default hooks context
+   tc_context ctx = *pool->hooks->context;
+   ctx.output_buffer = NULL;
+   ctx.buffer_used = 0;
+   ctx.buffer_size = 0;
+   if (runner_options.isolate)
+      iso_bind();
+
+   for (;;) {
+      int index = atomic_fetch_add(&pool->next, 1);
+      if (index >= pool->count)
+         break;
+
+      st_set_job *job = &pool->jobs[index];
+      configure_set(job->set);
+      FILE *log_stream = job->set->log_stream;
+      FILE *capture = NULL;
+      if (!log_stream || log_stream == stdout || log_stream == stderr) {
+         capture = open_memstream(&job->capture, &job->capture_len);
+         if (capture)
+            job->set->log_stream = capture;
+      }
+
+      run_set(job->set, job->sequence, pool->hooks, &ctx, &job->totals);
+
+      if (capture) {
+         fclose(capture);
+         job->set->log_stream = log_stream ? log_stream : stdout;
+      }
+
+      pthread_mutex_lock(&pool->lock);
+      job->done = 1;
+      pthread_cond_broadcast(&pool->job_done);
+      pthread_mutex_unlock(&pool->lock);
+   }
+
+   __real_free(ctx.output_buffer);
+   return NULL;
+}
+// Resolves the number of runner threads for the run
+static int runner_workers(int total_sets, ST_Hooks hooks) {
+   int jobs = runner_options.jobs;
+   if (jobs <= 0) {
+      long online = sysconf(_SC_NPROCESSORS_ONLN);
+      jobs = online > 0 ? (int)online : 1;
+   }
+   if (jobs > total_sets)
+      jobs = total_sets;
+   if (jobs <= 1)
+      return 1;
+
+   // runner-provided hook contexts are shared state; only the default hooks can be duplicated
+   if (!hooks || hooks->context != &default_ctx) {
+      fwritelnf(stderr, "Warning: hooks '%s' are not reentrant; running test sets serially", hooks && hooks->name ? hooks->name : "(null)");
+      return 1;
+   }
+
+   return jobs;
+}
+static RunnerState dispatch_sets(TestSet sets, int total_sets, int jobs, ST_Hooks hooks, st_totals *totals) {
+   st_set_pool pool = {
+       .jobs = __real_calloc(total_sets, sizeof(st_set_job)),
+       .count = total_sets,
+       .hooks = hooks,
+   };
+   pthread_t *workers = __real_calloc(jobs, sizeof(pthread_t));
+   if (!pool.jobs || !workers) {
+      fwritelnf(stderr, "Error: Failed to allocate parallel runner");
+      exit(EXIT_FAILURE);
+   }
+   atomic_init(&pool.next, 0);
+   pthread_mutex_init(&pool.lock, NULL);
+   pthread_cond_init(&pool.job_done, NULL);
+
+   int index = 0;
+   for (TestSet set = sets; set; set = set->next) {
+      if (set->selected == 0)
+         continue;
+      pool.jobs[index].set = set;
+      pool.jobs[index].sequence = index + 2; // matches the serial SET_LOOP sequence
+      index++;
+   }
+
+   fflush(NULL);
+   int started = 0;
+   for (; started < jobs; started++) {
+      if (pthread_create(&workers[started], NULL, set_worker, &pool) != 0)
          break;
+   }
+   if (started == 0) {
+      // no worker could be started; run the whole pool on this thread
+      set_worker(&pool);
+   }
+
+   // merge results in registration order as each set completes
+   for (int i = 0; i < total_sets; i++) {
+      st_set_job *job = &pool.jobs[i];
+      pthread_mutex_lock(&pool.lock);
+      while (!job->done)
+         pthread_cond_wait(&pool.job_done, &pool.lock);
+      pthread_mutex_unlock(&pool.lock);
+
+      if (job->capture) {
+         fwrite(job->capture, 1, job->capture_len, stdout);
+         fflush(stdout);
+         __real_free(job->capture); // allocated by open_memstream
       }
+      totals->tests += job->totals.tests;
+      totals->passed += job->totals.passed;
+      totals->failed += job->totals.failed;
+      totals->skipped += job->totals.skipped;
+      totals->regressed += job->totals.regressed;
+   }
+
+   for (int i = 0; i < started; i++) {
+      pthread_join(workers[i], NULL);
    }
+   pthread_cond_destroy(&pool.job_done);
+   pthread_mutex_destroy(&pool.lock);
+   __real_free(workers);
+   __real_free(pool.jobs);
 
-   return runner_done(sets);
+   return RUNNER_SUMMARY;
 }
 // State handlers:
 static RunnerState runner_init(TestSet sets, ST_Hooks test_hooks, int *total_tests_out, int *total_sets_out, ST_Hooks *hooks_out) {
@@ -1358,162 +4854,1275 @@ static RunnerState runner_init(TestSet sets, ST_Hooks test_hooks, int *total_tes
          hooks = set->hooks;
       }
 
-      current_hooks = hooks;
-      if (hooks) {
-         if (!hooks->before_test)
-            hooks->before_test = default_before_test;
-         if (!hooks->after_test)
-            hooks->after_test = default_after_test;
-         if (!hooks->on_start_test)
-            hooks->on_start_test = default_on_start_test;
-         if (!hooks->on_end_test)
-            hooks->on_end_test = default_on_end_test;
-         if (!hooks->on_error)
-            hooks->on_error = default_on_error;
-         if (!hooks->on_test_result)
-            hooks->on_test_result = default_on_test_result;
+      current_hooks = hooks;
+      if (hooks) {
+         if (!hooks->before_test)
+            hooks->before_test = default_before_test;
+         if (!hooks->after_test)
+            hooks->after_test = default_after_test;
+         if (!hooks->on_start_test)
+            hooks->on_start_test = default_on_start_test;
+         if (!hooks->on_end_test)
+            hooks->on_end_test = default_on_end_test;
+         if (!hooks->on_error)
+            hooks->on_error = default_on_error;
+         if (!hooks->on_test_result)
+            hooks->on_test_result = default_on_test_result;
+      }
+   }
+
+   *total_sets_out = total_sets;
+   *hooks_out = hooks;
+
+   return SET_LOOP;
+}
+static RunnerState set_loop(TestSet *set_iter, int *sequence_out) {
+   // sets without selected cases are skipped entirely: no config, setup or cleanup
+   while (*set_iter && (*set_iter)->selected == 0) {
+      *set_iter = (*set_iter)->next;
+   }
+   if (!*set_iter) {
+      return RUNNER_SUMMARY;
+   }
+
+   (*sequence_out)++;
+   return SET_INIT;
+}
+static RunnerState set_init(TestSet current_set_iter, int *tc_total_out, int *tc_passed_out, int *tc_failed_out, int *tc_skipped_out, TestSet *current) {
+   TestSet set = current_set_iter;
+   *tc_total_out = 0;
+   *tc_passed_out = 0;
+   *tc_failed_out = 0;
+   *tc_skipped_out = 0;
+
+   configure_set(set);
+   if (!set->log_stream) {
+      set->log_stream = stdout;
+   }
+   // Set current_set to the executing set for writef/debugf
+   *current = set;
+   (*current)->logger = (Logger)&DebugLogger;
+
+   return BEFORE_SET;
+}
+static RunnerState before_set(ST_Hooks hooks, int set_sequence, TestSet current, char *timestamp) {
+   current_ctx->info.logger = current->logger;
+   if (hooks && hooks->before_set) {
+      hooks->before_set((TsInfo)&current->info, current_ctx);
+   } else {
+      get_timestamp(timestamp, "%Y-%m-%d  %H:%M:%S");
+      char header[128];
+      snprintf(header, sizeof(header), "[%d] %-25s : %4d : %20s",
+               set_sequence, current->info.name, current->selected, timestamp);
+      int pad = 80 - (int)strlen(header);
+      if (pad < 0)
+         pad = 0;
+      fwritelnf(current->log_stream, "%s%*s", header, pad, "");
+      print_sep(current->log_stream, 80);
+   }
+
+   return CASE_LOOP;
+}
+static RunnerState case_loop(TestSet set, size_t *case_index) {
+   while (*case_index < (size_t)set->info.count && !set_case(set, *case_index)->selected) {
+      (*case_index)++;
+   }
+   if (*case_index >= (size_t)set->info.count) {
+      return AFTER_SET;
+   }
+   return CASE_INIT;
+}
+static RunnerState case_init(TestCase tc, TestSet set) {
+   tc->info.has_next = (tc->info.index != set->last);
+   set->current = tc; // Set current test for set_test_context
+   set->info.tc_info = (TcInfo)&tc->info;
+   return BEFORE_TEST;
+}
+static RunnerState before_test(ST_Hooks hooks) {
+   current_ctx->info.logger = current_set->logger;
+   if (hooks && hooks->before_test) {
+      hooks->before_test(current_ctx);
+   }
+   return SETUP_TEST;
+}
+static RunnerState setup_test(TestSet set) {
+   if (set->setup) {
+      set->setup();
+   }
+   return START_TEST;
+}
+static RunnerState start_test(ST_Hooks hooks) {
+   current_tc = current_set->current;
+   current_ctx->info.logger = current_set->logger;
+   if (hooks && hooks->on_start_test) {
+      hooks->on_start_test(current_ctx);
+   } else {
+      default_on_start_test(current_ctx);
+   }
+   // an isolated case is charged inside its worker, which also redirects its descriptors
+   capture_begin(!iso_worker);
+   if (!iso_worker) {
+      cross_begin(current_tc);
+      budget_arm(current_tc);
+      profile_arm(current_tc);
+   }
+   return EXECUTE_TEST;
+}
+static RunnerState execute_test(TestCase tc, jmp_buf jmpbuffer) {
+   current_tc = tc;
+   if (setjmp(jmpbuffer) == 0) {
+      if (tc->is_bench) {
+         return BENCH_INIT;
+      } else if (tc->is_param) {
+         return PARAM_INIT;
+      } else if (!tc->is_fuzz) {
+         BUDGET_CALL(tc->func.test());
+      } else {
+         return FUZZING_INIT;
+      }
+   } else {
+      // handle exception
+   }
+   BUDGET_LEAVE();
+   return END_TEST;
+}
+static RunnerState execute_fuzz_case(TestCase tc) {
+   const void *dataset;
+   size_t count;
+   size_t elem_size;
+
+   switch (tc->fuzz_type) {
+   case FUZZ_INT:
+      dataset = fuzz_int_values;
+      count = fuzz_int_count;
+      elem_size = sizeof(int);
+
+      break;
+   case FUZZ_SIZE_T:
+      dataset = fuzz_size_t_values;
+      count = fuzz_size_t_count;
+      elem_size = sizeof(size_t);
+
+      break;
+   case FUZZ_FLOAT:
+      dataset = fuzz_float_values;
+      count = fuzz_float_count;
+      elem_size = sizeof(float);
+
+      break;
+   case FUZZ_BYTE:
+      dataset = fuzz_byte_values;
+      count = fuzz_byte_count;
+      elem_size = sizeof(signed char);
+
+      break;
+   case FUZZ_BUFFER:
+      // no fixed table: buffers are always generated by the engine
+      dataset = NULL;
+      count = 0;
+      elem_size = 0;
+
+      break;
+   default:
+      tc->info.result.state = FAIL;
+      tc->info.result.message = arena_strdup("Invalid FuzzType in fuzz test");
+      return END_TEST;
+   }
+
+   if (tc->fuzz_type == FUZZ_BUFFER || runner_options.fuzz_runs > 0 || runner_options.fuzz_time_ms > 0 ||
+       runner_options.fuzz_replay)
+      return execute_fuzz_engine(tc, dataset, count, elem_size);
+   return execute_fuzzing(tc, jmpbuffer, dataset, count, elem_size);
+}
+static RunnerState execute_fuzzing(TestCase tc, jmp_buf jmpbuffer, const void *dataset, size_t count, size_t elem_size) {
+   current_tc = tc;
+   int failed_count = 0;
+   char val_buf[64];
+
+   for (size_t i = 0; i < count && !tc->budget_hit; ++i) {
+      const void *input = (const char *)dataset + (i * elem_size);
+
+      format_fuzz_value(tc->fuzz_type, input, val_buf, sizeof(val_buf));
+      writef("value = %-10.3s", val_buf);
+
+      if (setjmp(jmpbuffer) == 0) {
+         BUDGET_CALL(tc->func.fuzz((void *)input));
+         writelnf("Okay");
+      } else {
+         BUDGET_LEAVE();
+         const char *msg = tc->info.result.message ? tc->info.result.message : "Unknown failure";
+         writelnf("Failed:\n  - %s", msg);
+         failed_count++;
+
+         // Reset message for next iteration
+         if (tc->info.result.message) {
+            tc->info.result.message = NULL;
+         }
+      }
+   }
+
+   // Final result for the fuzz test case
+   if (failed_count == 0) {
+      tc->info.result.state = PASS;
+      tc->info.result.message = NULL;
+   } else {
+      tc->info.result.state = FAIL;
+      char summary[128];
+      snprintf(summary, sizeof(summary),
+               "%ld of %zu fuzz iterations passed", count - failed_count, count);
+      tc->info.result.message = arena_strdup(summary);
+   }
+
+   return END_TEST;
+}
+/*
+ * Fuzzing engine (`--fuzz-runs`, `--fuzz-time`, `--fuzz-jobs`, FUZZ_BUFFER)
+ * Mutates inputs from a corpus and keeps the ones that reach new coverage. Coverage comes from
+ * code built with `-fsanitize-coverage=trace-pc-guard` (clang) or `-fsanitize-coverage=trace-pc`
+ * (gcc); without it the engine still runs, blind. Each callback records first hits in a list
+ * so a run costs time in proportion to the edges it touched, not to the map size. Nothing is
+ * logged or allocated per input; the first failing input ends the case.
+ *
+ * A session runs on `--fuzz-jobs` threads sharing one coverage map and one append-only corpus.
+ * Entries are claimed with an atomic index and published with a ready flag, so neither adding
+ * nor reading takes a lock. Every ST_FUZZ_CHUNK runs a worker picks up the new entries and
+ * culls its view to the smallest inputs that still cover every edge seen (favored inputs).
+ */
+#define ST_FUZZ_MAP_SIZE 65536 // coverage map entries (power of two)
+#define ST_FUZZ_MAX_LEN 4096   // largest FUZZ_BUFFER input
+#define ST_FUZZ_CORPUS 4096    // most inputs kept in the corpus
+#define ST_FUZZ_RUNS 100000    // FUZZ_BUFFER budget without --fuzz-runs or --fuzz-time
+#define ST_FUZZ_CHUNK 1024     // runs a worker claims from the budget at a time
+#define ST_FUZZ_GROWTH 16      // coverage growth samples kept for the summary
+
+typedef struct {
+   uint8_t hits[ST_FUZZ_MAP_SIZE];      // saturating hit counts of this run
+   uint32_t touched[ST_FUZZ_MAP_SIZE]; // edges hit so far in this run
+   size_t count;
+   int instrumented; // any run reported coverage
+} st_fuzz_cov;
+typedef struct {
+   uint8_t *data;
+   size_t size;
+   uint32_t *edges; // edges the input reached when it was kept
+   size_t edge_count;
+   atomic_int ready;
+} st_fuzz_entry;
+typedef struct {
+   TestCase tc;
+   TestSet set;
+   size_t elem_size; // 0 for FUZZ_BUFFER
+   uint64_t budget;
+   ts_time start;
+   st_fuzz_entry corpus[ST_FUZZ_CORPUS];
+   atomic_size_t claimed; // corpus entries handed out
+   atomic_uchar seen[ST_FUZZ_MAP_SIZE]; // hit count buckets seen so far per edge
+   atomic_size_t edges;
+   atomic_uint_fast64_t next_run; // runs handed out
+   atomic_uint_fast64_t runs;     // runs executed
+   atomic_int stop;
+   pthread_mutex_t fail_lock;
+   int failed;
+   string fail_message;
+   uint8_t fail_input[ST_FUZZ_MAX_LEN];
+   size_t fail_size;
+   struct {
+      double ms;
+      size_t edges;
+   } growth[ST_FUZZ_GROWTH];
+   int growth_count;
+   double growth_next_ms;
+} st_fuzz_session;
+typedef struct {
+   st_fuzz_session *session;
+   int id;
+   TestCase tc; // worker 0 reports into the case, the others into their own copy
+   struct st_case_s copy;
+   pthread_t thread;
+   uint64_t rng;
+   uint64_t next, end, done; // current claim of runs, and runs executed
+   size_t seed_next;
+   size_t synced;                      // corpus entries in this worker's view
+   uint32_t top[ST_FUZZ_MAP_SIZE];     // smallest entry + 1 reaching each edge
+   uint8_t covered[ST_FUZZ_MAP_SIZE];  // cull scratch
+   uint32_t favored[ST_FUZZ_CORPUS];
+   size_t favored_count;
+   uint8_t input[ST_FUZZ_MAX_LEN];
+   size_t size;
+   uint8_t exec[ST_FUZZ_MAX_LEN]; // FUZZ_BUFFER data is moved to the end
+   FuzzBuffer buffer;
+   union {
+      int i;
+      size_t z;
+      float f;
+      signed char c;
+      uint8_t bytes[16];
+   } scalar;
+   st_fuzz_cov cov;
+} st_fuzz_worker;
+
+static _Thread_local st_fuzz_cov *fuzz_cov = NULL; // only set while a fuzz engine runs
+static _Thread_local uint32_t fuzz_prev = 0;
+static uint32_t fuzz_guards = 0;
+
+static const uint8_t FUZZ_INTERESTING[] = {0x00, 0x01, 0x10, 0x20, 0x40, 0x7f, 0x80, 0xfe, 0xff};
+
+static inline void fuzz_hit(uint32_t edge) {
+   st_fuzz_cov *cov = fuzz_cov;
+   if (!cov)
+      return;
+   edge &= ST_FUZZ_MAP_SIZE - 1;
+   if (cov->hits[edge] == 0)
+      cov->touched[cov->count++] = edge;
+   if (cov->hits[edge] != 0xff)
+      cov->hits[edge]++;
+}
+// coverage callbacks; weak so a linked libFuzzer or sanitizer runtime takes precedence
+__attribute__((weak)) void __sanitizer_cov_trace_pc_guard_init(uint32_t *start, uint32_t *stop) {
+   if (start == stop || *start)
+      return;
+   for (uint32_t *guard = start; guard < stop; guard++)
+      *guard = ++fuzz_guards;
+}
+__attribute__((weak)) void __sanitizer_cov_trace_pc_guard(uint32_t *guard) {
+   fuzz_hit(*guard);
+}
+__attribute__((weak)) void __sanitizer_cov_trace_pc(void) {
+   // gcc reports blocks, not edges; pair each block with its predecessor
+   uintptr_t pc = (uintptr_t)__builtin_return_address(0);
+   uint32_t block = (uint32_t)(pc ^ (pc >> 15));
+   fuzz_hit(block ^ fuzz_prev);
+   fuzz_prev = block >> 1;
+}
+
+static uint64_t fuzz_rand(st_fuzz_worker *w) {
+   // xorshift64*
+   w->rng ^= w->rng >> 12;
+   w->rng ^= w->rng << 25;
+   w->rng ^= w->rng >> 27;
+   return w->rng * 0x2545F4914F6CDD1DULL;
+}
+static uint8_t fuzz_bucket(uint8_t hits) {
+   if (hits <= 2)
+      return hits;
+   if (hits == 3)
+      return 4;
+   if (hits < 8)
+      return 8;
+   if (hits < 16)
+      return 16;
+   if (hits < 32)
+      return 32;
+   return hits < 128 ? 64 : 128;
+}
+// fold this run's hits into the shared buckets; reports whether anything was new
+static int fuzz_new_coverage(st_fuzz_session *fz, const st_fuzz_cov *cov) {
+   int found = 0;
+   for (size_t i = 0; i < cov->count; i++) {
+      uint32_t edge = cov->touched[i];
+      uint8_t bucket = fuzz_bucket(cov->hits[edge]);
+      // the plain load keeps the common, nothing new, case free of atomic writes
+      if (!(bucket & ~atomic_load_explicit(&fz->seen[edge], memory_order_relaxed)))
+         continue;
+      uint8_t old = atomic_fetch_or_explicit(&fz->seen[edge], bucket, memory_order_relaxed);
+      if (bucket & ~old) {
+         if (!old)
+            atomic_fetch_add_explicit(&fz->edges, 1, memory_order_relaxed);
+         found = 1;
+      }
+   }
+   return found;
+}
+static void fuzz_reset(st_fuzz_cov *cov) {
+   cov->instrumented |= cov->count > 0;
+   for (size_t i = 0; i < cov->count; i++)
+      cov->hits[cov->touched[i]] = 0;
+   cov->count = 0;
+   fuzz_prev = 0;
+}
+static void fuzz_keep(st_fuzz_session *fz, const uint8_t *data, size_t size, const st_fuzz_cov *cov) {
+   size_t index = atomic_fetch_add_explicit(&fz->claimed, 1, memory_order_relaxed);
+   if (index >= ST_FUZZ_CORPUS)
+      return;
+   st_fuzz_entry *entry = &fz->corpus[index];
+   entry->data = __real_malloc(size ? size : 1);
+   size_t edge_count = cov ? cov->count : 0;
+   entry->edges = edge_count ? __real_malloc(edge_count * sizeof(uint32_t)) : NULL;
+   // a failed copy is still published, empty, so readers never wait on the slot
+   if (entry->data && (entry->edges || !edge_count)) {
+      memcpy(entry->data, data, size);
+      entry->size = size;
+      if (edge_count)
+         memcpy(entry->edges, cov->touched, edge_count * sizeof(uint32_t));
+      entry->edge_count = edge_count;
+   }
+   atomic_store_explicit(&entry->ready, 1, memory_order_release);
+}
+// pick up entries published by any worker and cull to the favored inputs
+static void fuzz_sync(st_fuzz_worker *w) {
+   st_fuzz_session *fz = w->session;
+   size_t published = atomic_load_explicit(&fz->claimed, memory_order_relaxed);
+   if (published > ST_FUZZ_CORPUS)
+      published = ST_FUZZ_CORPUS;
+   int changed = 0;
+   while (w->synced < published && atomic_load_explicit(&fz->corpus[w->synced].ready, memory_order_acquire)) {
+      const st_fuzz_entry *entry = &fz->corpus[w->synced];
+      for (size_t i = 0; i < entry->edge_count; i++) {
+         uint32_t edge = entry->edges[i];
+         if (!w->top[edge] || entry->size < fz->corpus[w->top[edge] - 1].size) {
+            w->top[edge] = (uint32_t)w->synced + 1;
+            changed = 1;
+         }
+      }
+      w->synced++;
+   }
+   if (!changed)
+      return;
+
+   // greedy cover: the smallest input of each uncovered edge, with everything it reaches
+   memset(w->covered, 0, sizeof(w->covered));
+   w->favored_count = 0;
+   for (uint32_t edge = 0; edge < ST_FUZZ_MAP_SIZE; edge++) {
+      if (!w->top[edge] || w->covered[edge])
+         continue;
+      const st_fuzz_entry *entry = &fz->corpus[w->top[edge] - 1];
+      w->favored[w->favored_count++] = w->top[edge] - 1;
+      for (size_t i = 0; i < entry->edge_count; i++)
+         w->covered[entry->edges[i]] = 1;
+   }
+}
+// apply one to four random mutations; fixed size inputs are never resized
+static size_t fuzz_mutate(st_fuzz_worker *w, uint8_t *buf, size_t size, int fixed) {
+   int rounds = 1 + (int)(fuzz_rand(w) % 4);
+   for (int round = 0; round < rounds; round++) {
+      uint64_t r = fuzz_rand(w);
+      size_t pos = size ? (size_t)(r >> 8) % size : 0;
+      switch (r % 8) {
+      case 0: // flip a bit
+         if (size)
+            buf[pos] ^= (uint8_t)(1u << ((r >> 40) & 7));
+         break;
+      case 1: // random byte
+         if (size)
+            buf[pos] = (uint8_t)(r >> 48);
+         break;
+      case 2: // boundary byte
+         if (size)
+            buf[pos] = FUZZ_INTERESTING[(r >> 40) % sizeof(FUZZ_INTERESTING)];
+         break;
+      case 3: // small delta
+         if (size)
+            buf[pos] = (uint8_t)(buf[pos] + (uint8_t)((r >> 40) % 33) - 16);
+         break;
+      case 4: // insert a byte
+         if (!fixed && size < ST_FUZZ_MAX_LEN) {
+            memmove(buf + pos + 1, buf + pos, size - pos);
+            buf[pos] = (uint8_t)(r >> 48);
+            size++;
+         }
+         break;
+      case 5: // erase a byte
+         if (!fixed && size > 0) {
+            memmove(buf + pos, buf + pos + 1, size - pos - 1);
+            size--;
+         }
+         break;
+      case 6: // copy a run of bytes within the input
+         if (size > 1) {
+            size_t from = (size_t)(r >> 32) % size;
+            size_t room = size - (pos > from ? pos : from);
+            memmove(buf + pos, buf + from, 1 + (size_t)(r >> 48) % room);
+         }
+         break;
+      case 7: // splice in the tail of another corpus input
+         if (!fixed && w->synced > 0) {
+            const st_fuzz_entry *other = &w->session->corpus[(r >> 32) % w->synced];
+            size_t from = other->size ? (size_t)(r >> 48) % other->size : 0;
+            size_t length = other->size - from;
+            if (length > ST_FUZZ_MAX_LEN - pos)
+               length = ST_FUZZ_MAX_LEN - pos;
+            memcpy(buf + pos, other->data + from, length);
+            size = pos + length;
+         }
+         break;
+      }
+   }
+   return size;
+}
+// claim the next runs of the budget; reports whether the worker should go on
+static int fuzz_claim(st_fuzz_worker *w) {
+   st_fuzz_session *fz = w->session;
+   if (atomic_load_explicit(&fz->stop, memory_order_relaxed))
+      return 0;
+   w->next = atomic_fetch_add_explicit(&fz->next_run, ST_FUZZ_CHUNK, memory_order_relaxed);
+   if (w->next >= fz->budget)
+      return 0;
+   w->end = fz->budget - w->next < ST_FUZZ_CHUNK ? fz->budget : w->next + ST_FUZZ_CHUNK;
+
+   ts_time now;
+   sys_gettime(&now);
+   double elapsed = get_elapsed_ms(&fz->start, &now);
+   if (runner_options.fuzz_time_ms > 0 && elapsed >= runner_options.fuzz_time_ms) {
+      atomic_store_explicit(&fz->stop, 1, memory_order_relaxed);
+      return 0;
+   }
+   // the first worker samples coverage at doubling intervals from 1 ms, when it changed
+   if (w->id == 0 && elapsed >= fz->growth_next_ms) {
+      size_t edges = atomic_load_explicit(&fz->edges, memory_order_relaxed);
+      if (fz->growth_count < ST_FUZZ_GROWTH - 1 && (!fz->growth_count || fz->growth[fz->growth_count - 1].edges != edges)) {
+         fz->growth[fz->growth_count].ms = elapsed;
+         fz->growth[fz->growth_count++].edges = edges;
+      }
+      while (fz->growth_next_ms <= elapsed)
+         fz->growth_next_ms *= 2;
+   }
+   fuzz_sync(w);
+   return w->synced > 0;
+}
+static void fuzz_work(st_fuzz_worker *w) {
+   st_fuzz_session *fz = w->session;
+   int fixed = fz->elem_size > 0;
+   fuzz_cov = &w->cov;
+   fuzz_prev = 0;
+   while (w->next < w->end || fuzz_claim(w)) {
+      // the first worker runs every seed once unchanged; then inputs are mutated from the
+      // favored inputs four times in five
+      const st_fuzz_entry *parent;
+      int seed = w->seed_next < w->synced;
+      if (seed) {
+         parent = &fz->corpus[w->seed_next++];
+      } else if (w->favored_count && fuzz_rand(w) % 5) {
+         parent = &fz->corpus[w->favored[fuzz_rand(w) % w->favored_count]];
+      } else {
+         parent = &fz->corpus[fuzz_rand(w) % w->synced];
+      }
+      memcpy(w->input, parent->data, parent->size);
+      w->size = parent->size;
+      if (!seed)
+         w->size = fuzz_mutate(w, w->input, w->size, fixed);
+
+      void *arg;
+      if (fixed) {
+         memcpy(w->scalar.bytes, w->input, fz->elem_size);
+         arg = &w->scalar;
+      } else {
+         // end aligned, so reads past the input run off the buffer
+         memcpy(w->exec + ST_FUZZ_MAX_LEN - w->size, w->input, w->size);
+         w->buffer = (FuzzBuffer){w->exec + ST_FUZZ_MAX_LEN - w->size, w->size};
+         arg = &w->buffer;
+      }
+
+      w->tc->info.result.state = PASS;
+      if (setjmp(jmpbuffer) == 0) {
+         w->tc->func.fuzz(arg);
       }
+      w->next++;
+      w->done++;
+      if (w->tc->info.result.state == FAIL) {
+         pthread_mutex_lock(&fz->fail_lock);
+         if (!fz->failed) {
+            fz->failed = 1;
+            fz->fail_message = w->tc->info.result.message;
+            memcpy(fz->fail_input, w->input, w->size);
+            fz->fail_size = w->size;
+         }
+         pthread_mutex_unlock(&fz->fail_lock);
+         atomic_store_explicit(&fz->stop, 1, memory_order_relaxed);
+         fuzz_reset(&w->cov);
+         break;
+      }
+      // a skipped input is rejected by the test; it earns no place in the corpus
+      if (fuzz_new_coverage(fz, &w->cov) && w->tc->info.result.state == PASS)
+         fuzz_keep(fz, w->input, w->size, &w->cov);
+      fuzz_reset(&w->cov);
    }
-
-   *total_sets_out = total_sets;
-   *hooks_out = hooks;
-
-   return SET_LOOP;
+   atomic_fetch_add_explicit(&fz->runs, w->done, memory_order_relaxed);
+   fuzz_cov = NULL;
 }
-static RunnerState set_loop(TestSet *set_iter, int *sequence_out) {
-   if (!*set_iter) {
-      return RUNNER_SUMMARY;
+static void *fuzz_worker_main(void *arg) {
+   st_fuzz_worker *w = arg;
+   current_set = w->session->set;
+   current_tc = w->tc;
+   worker_case = w->tc;
+   fuzz_work(w);
+   worker_case = NULL;
+   return NULL;
+}
+// write the failing input to --fuzz-crashes; returns the path, or NULL
+static const char *fuzz_save_crash(st_fuzz_session *fz, char *path, size_t size) {
+   const char *dir = runner_options.fuzz_crash_dir;
+   if (!dir || (mkdir(dir, 0755) != 0 && errno != EEXIST))
+      return NULL;
+   uint64_t hash = 0xcbf29ce484222325ULL;
+   for (size_t i = 0; i < fz->fail_size; i++)
+      hash = (hash ^ fz->fail_input[i]) * 0x100000001b3ULL;
+   int used = snprintf(path, size, "%s/crash-%s-%s-%016llx", dir, fz->set->info.name, fz->tc->info.name,
+                       (unsigned long long)hash);
+   if (used < 0 || (size_t)used >= size)
+      return NULL;
+   for (char *c = path + strlen(dir) + 1; *c; c++) {
+      if (!((*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') || (*c >= '0' && *c <= '9') || *c == '-'))
+         *c = '_';
    }
-
-   (*sequence_out)++;
-   return SET_INIT;
+   FILE *file = fopen(path, "wb");
+   if (!file)
+      return NULL;
+   size_t written = fwrite(fz->fail_input, 1, fz->fail_size, file);
+   if (fclose(file) != 0 || written != fz->fail_size)
+      return NULL;
+   return path;
 }
-static RunnerState set_init(TestSet current_set_iter, int *tc_total_out, int *tc_passed_out, int *tc_failed_out, int *tc_skipped_out, TestSet *current) {
-   TestSet set = current_set_iter;
-   *tc_total_out = 0;
-   *tc_passed_out = 0;
-   *tc_failed_out = 0;
-   *tc_skipped_out = 0;
+// load the --fuzz-replay input as the only seed
+static int fuzz_load_replay(st_fuzz_session *fz, char *error, size_t size) {
+   FILE *file = fopen(runner_options.fuzz_replay, "rb");
+   if (!file) {
+      snprintf(error, size, "Cannot open replay input %s: %s", runner_options.fuzz_replay, strerror(errno));
+      return -1;
+   }
+   uint8_t *data = __real_malloc(ST_FUZZ_MAX_LEN + 1);
+   size_t length = data ? fread(data, 1, ST_FUZZ_MAX_LEN + 1, file) : 0;
+   fclose(file);
+   if (!data || length > ST_FUZZ_MAX_LEN || (fz->elem_size && length != fz->elem_size)) {
+      snprintf(error, size, "Replay input %s has %zu bytes, expected %zu", runner_options.fuzz_replay, length,
+               fz->elem_size ? fz->elem_size : (size_t)ST_FUZZ_MAX_LEN);
+      __real_free(data);
+      return -1;
+   }
+   fuzz_keep(fz, data, length, NULL);
+   __real_free(data);
+   return 0;
+}
+static RunnerState execute_fuzz_engine(TestCase tc, const void *seeds, size_t seed_count, size_t elem_size) {
+   current_tc = tc;
+   int jobs = runner_options.fuzz_jobs > 1 ? runner_options.fuzz_jobs : 1;
+   if (runner_options.fuzz_replay)
+      jobs = 1;
+   st_fuzz_session *fz = __real_calloc(1, sizeof(st_fuzz_session));
+   st_fuzz_worker *workers = __real_calloc((size_t)jobs, sizeof(st_fuzz_worker));
+   if (!fz || !workers) {
+      __real_free(fz);
+      __real_free(workers);
+      tc->info.result.state = FAIL;
+      tc->info.result.message = (string) "Failed to allocate the fuzz engine";
+      return END_TEST;
+   }
+   fz->tc = tc;
+   fz->set = current_set;
+   fz->elem_size = elem_size;
+   fz->budget = runner_options.fuzz_runs > 0 ? (uint64_t)runner_options.fuzz_runs : UINT64_MAX;
+   if (runner_options.fuzz_runs <= 0 && runner_options.fuzz_time_ms <= 0)
+      fz->budget = ST_FUZZ_RUNS;
+   fz->growth_next_ms = 1;
+   pthread_mutex_init(&fz->fail_lock, NULL);
+
+   // an empty buffer starts the corpus of FUZZ_BUFFER cases; the boundary table the others
+   char error[256];
+   if (runner_options.fuzz_replay) {
+      fz->budget = 1;
+      if (fuzz_load_replay(fz, error, sizeof(error)) != 0) {
+         tc->info.result.state = FAIL;
+         tc->info.result.message = arena_strdup(error);
+         goto cleanup;
+      }
+   } else if (elem_size) {
+      for (size_t i = 0; i < seed_count; i++)
+         fuzz_keep(fz, (const uint8_t *)seeds + i * elem_size, elem_size, NULL);
+   } else {
+      fuzz_keep(fz, NULL, 0, NULL);
+   }
 
-   if (!set->log_stream) {
-      set->log_stream = stdout;
+   // runs are reproducible per worker: the generators are seeded from the case name
+   uint64_t seed = 0xcbf29ce484222325ULL;
+   for (const char *c = tc->info.name; *c; c++)
+      seed = (seed ^ (uint8_t)*c) * 0x100000001b3ULL;
+   sys_gettime(&fz->start);
+   int started = 1;
+   for (int i = 0; i < jobs; i++) {
+      st_fuzz_worker *w = &workers[i];
+      w->session = fz;
+      w->id = i;
+      w->rng = seed + (uint64_t)i * 0x9E3779B97F4A7C15ULL;
+      w->seed_next = i == 0 ? 0 : SIZE_MAX;
+      if (i == 0) {
+         w->tc = tc;
+         continue;
+      }
+      w->copy = *tc;
+      w->tc = &w->copy;
+      if (pthread_create(&w->thread, NULL, fuzz_worker_main, w) != 0)
+         break;
+      started++;
+   }
+   fuzz_work(&workers[0]);
+   for (int i = 1; i < started; i++)
+      pthread_join(workers[i].thread, NULL);
+
+   ts_time now;
+   sys_gettime(&now);
+   double elapsed = get_elapsed_ms(&fz->start, &now);
+   uint64_t runs = atomic_load(&fz->runs);
+   size_t edges = atomic_load(&fz->edges);
+   size_t corpus = atomic_load(&fz->claimed);
+   double rate = elapsed > 0 ? (double)runs / elapsed * 1000.0 : 0;
+   if (corpus > ST_FUZZ_CORPUS)
+      corpus = ST_FUZZ_CORPUS;
+   int instrumented = 0;
+   for (int i = 0; i < started; i++)
+      instrumented |= workers[i].cov.instrumented;
+   if (!instrumented) {
+      writelnf("%llu runs in %.1f ms (%.2fM exec/s, %d workers), no coverage feedback: build the code under test with -fsanitize-coverage",
+               (unsigned long long)runs, elapsed, rate / 1e6, started);
+   } else {
+      fuzz_sync(&workers[0]);
+      writelnf("%llu runs in %.1f ms (%.2fM exec/s, %d workers), corpus %zu (%zu favored), %zu edges",
+               (unsigned long long)runs, elapsed, rate / 1e6, started, corpus, workers[0].favored_count, edges);
+      if (fz->growth_count > 0) {
+         char growth[512];
+         int used = snprintf(growth, sizeof(growth), "coverage:");
+         for (int i = 0; i < fz->growth_count && used < (int)sizeof(growth); i++)
+            used += snprintf(growth + used, sizeof(growth) - used, " %zu@%.0fms", fz->growth[i].edges, fz->growth[i].ms);
+         if (used < (int)sizeof(growth) && fz->growth[fz->growth_count - 1].edges != edges)
+            snprintf(growth + used, sizeof(growth) - used, " %zu@%.0fms", edges, elapsed);
+         writelnf("%s", growth);
+      }
    }
-   // Set current_set to the executing set for writef/debugf
-   *current = set;
-   (*current)->logger = (Logger)&DebugLogger;
 
-   return BEFORE_SET;
-}
-static RunnerState before_set(ST_Hooks hooks, int set_sequence, TestSet current, char *timestamp) {
-   hooks->context->info.logger = current->logger;
-   if (hooks && hooks->before_set) {
-      hooks->before_set((TsInfo)&current->info, hooks->context);
+   if (fz->failed) {
+      // room for the failure, the input, and a reproducer naming the program and the crash path twice
+      char input[128], path[PATH_MAX], summary[ST_MESSAGE_SIZE + sizeof(input) + 3 * PATH_MAX];
+      if (elem_size) {
+         memcpy(workers[0].scalar.bytes, fz->fail_input, elem_size);
+         format_fuzz_value(tc->fuzz_type, &workers[0].scalar, input, sizeof(input));
+      } else {
+         FuzzBuffer failing = {fz->fail_input, fz->fail_size};
+         format_fuzz_value(FUZZ_BUFFER, &failing, input, sizeof(input));
+      }
+      int used = snprintf(summary, sizeof(summary), "%s\n    - input %s (run %llu)",
+                          fz->fail_message ? fz->fail_message : "Unknown failure", input, (unsigned long long)runs);
+      const char *saved = runner_options.fuzz_replay ? NULL : fuzz_save_crash(fz, path, sizeof(path));
+      if (saved && used > 0 && used < (int)sizeof(summary)) {
+         snprintf(summary + used, sizeof(summary) - used, "\n    - saved %s, reproduce with: %s --filter '%s/%s' --fuzz-replay %s",
+                  saved, program_invocation_name, fz->set->info.name, tc->info.name, saved);
+      }
+      tc->info.result.state = FAIL;
+      tc->info.result.message = arena_strdup(summary);
    } else {
-      get_timestamp(timestamp, "%Y-%m-%d  %H:%M:%S");
-      char header[128];
-      snprintf(header, sizeof(header), "[%d] %-25s : %4d : %20s",
-               set_sequence, current->info.name, current->info.count, timestamp);
-      int pad = 80 - (int)strlen(header);
-      if (pad < 0)
-         pad = 0;
-      fwritelnf(current->log_stream, "%s%*s", header, pad, "");
-      print_sep(current->log_stream, 80);
+      tc->info.result.state = PASS;
+      tc->info.result.message = NULL;
    }
 
-   return CASE_LOOP;
+cleanup:
+   for (size_t i = 0; i < ST_FUZZ_CORPUS; i++) {
+      __real_free(fz->corpus[i].data);
+      __real_free(fz->corpus[i].edges);
+   }
+   pthread_mutex_destroy(&fz->fail_lock);
+   __real_free(fz);
+   __real_free(workers);
+   return END_TEST;
 }
-static RunnerState case_loop(TestCase *tc_iter) {
-   if (!*tc_iter) {
-      return AFTER_SET;
+/*
+ * Parameterized test cases (param_testcase)
+ * Runs the function once per table row, in place: a passing row costs one setjmp and one call,
+ * with no allocation or output. With `--shard-count` each shard runs its contiguous slice of
+ * the rows; with `--jobs` the slice is split across threads that report into their own copy
+ * of the case. Failed and skipped rows are listed in row order once every row has run, by
+ * `on_param_result`.
+ */
+#define ST_PARAM_MIN_ROWS 64 // fewest rows worth a thread of their own
+#define ST_PARAM_LISTED 20   // failed or skipped rows listed in the output
+
+typedef struct {
+   struct st_case_s copy;
+   size_t first;
+   size_t last;
+   pthread_t thread;
+} st_param_worker;
+
+static void param_rows(TestCase tc, st_param_results *results, size_t first, size_t last) {
+   for (size_t row = first; row < last && !tc->budget_hit; row++) {
+      tc->info.result.state = PASS;
+      tc->info.result.message = NULL;
+      if (setjmp(jmpbuffer) == 0) {
+         BUDGET_CALL(tc->func.param((const char *)results->table + row * results->elem_size));
+      }
+      BUDGET_LEAVE();
+      results->rows[row].state = tc->info.result.state;
+      results->rows[row].message = tc->info.result.message;
    }
-   return CASE_INIT;
 }
-static RunnerState case_init(TestCase tc, TestSet set) {
-   tc->info.has_next = (tc->next != NULL);
-   set->current = tc; // Set current test for set_test_context
-   return BEFORE_TEST;
+static void *param_worker_main(void *arg) {
+   st_param_worker *w = arg;
+   current_set = w->copy.set;
+   current_tc = &w->copy;
+   worker_case = &w->copy;
+   param_rows(&w->copy, w->copy.params, w->first, w->last);
+   worker_case = NULL;
+   return NULL;
 }
-static RunnerState before_test(ST_Hooks hooks) {
-   hooks->context->info.logger = current_set->logger;
-   if (hooks && hooks->before_test) {
-      hooks->before_test(hooks->context);
+static int param_threads(size_t rows) {
+   int jobs = runner_options.jobs;
+   if (jobs <= 0) {
+      long online = sysconf(_SC_NPROCESSORS_ONLN);
+      jobs = online > 0 ? (int)online : 1;
    }
-   return SETUP_TEST;
+   size_t most = rows / ST_PARAM_MIN_ROWS;
+   if ((size_t)jobs > most)
+      jobs = most ? (int)most : 1;
+   return jobs;
 }
-static RunnerState setup_test(TestSet set) {
-   if (set->setup) {
-      set->setup();
+static void default_on_param_result(const TsInfo ts, tc_context *ctx, const st_param_results *results) {
+   (void)ts;
+   (void)ctx;
+   size_t listed = 0;
+   char label[128];
+   for (size_t row = results->first; row < results->last; row++) {
+      const st_param_row *result = &results->rows[row];
+      if (result->state == PASS || listed++ >= ST_PARAM_LISTED)
+         continue;
+      writelnf("[%zu]%s%s %s: %s", row, results->format ? " " : "",
+               results->format ? st_param_label(results, row, label, sizeof(label)) : "",
+               result->state == FAIL ? "failed" : "skipped", result->message ? result->message : "No message");
+   }
+   if (listed > ST_PARAM_LISTED)
+      writelnf("... %zu more failed or skipped rows", listed - ST_PARAM_LISTED);
+   size_t rows = results->last - results->first;
+   if (rows == results->count) {
+      writelnf("%zu rows: %zu passed, %zu failed, %zu skipped", rows, results->passed, results->failed, results->skipped);
+   } else {
+      writelnf("rows %zu-%zu of %zu: %zu passed, %zu failed, %zu skipped", results->first, results->last,
+               results->count, results->passed, results->failed, results->skipped);
    }
-   return START_TEST;
 }
-static RunnerState start_test(ST_Hooks hooks) {
-   current_tc = current_set->current;
-   hooks->context->info.logger = current_set->logger;
-   if (hooks && hooks->on_start_test) {
-      hooks->on_start_test(hooks->context);
+static void param_report(ST_Hooks hooks, TestCase tc, TestSet set) {
+   set->info.tc_info = (TcInfo)&tc->info;
+   current_ctx->info.logger = set->logger;
+   if (hooks && hooks->on_param_result) {
+      hooks->on_param_result((TsInfo)&set->info, current_ctx, tc->params);
    } else {
-      default_on_start_test(hooks->context);
+      default_on_param_result((TsInfo)&set->info, current_ctx, tc->params);
    }
-   return EXECUTE_TEST;
 }
-static RunnerState execute_test(TestCase tc, jmp_buf jmpbuffer) {
+static RunnerState execute_param_case(TestCase tc) {
    current_tc = tc;
-   if (setjmp(jmpbuffer) == 0) {
-      if (!tc->is_fuzz) {
-         tc->func.test();
-      } else {
-         return FUZZING_INIT;
-      }
+   st_param_results *results = tc->params;
+   results->first = 0;
+   results->last = results->count;
+   if (runner_options.shard_count > 1) {
+      size_t count = (size_t)runner_options.shard_count;
+      size_t shard = (size_t)runner_options.shard_index;
+      results->first = results->count * shard / count;
+      results->last = results->count * (shard + 1) / count;
+   }
+   size_t rows = results->last - results->first;
+
+   // the calling thread runs the first part, and the part of any thread that did not start
+   int threads = param_threads(rows);
+   st_param_worker *workers = threads > 1 ? __real_calloc((size_t)threads, sizeof(st_param_worker)) : NULL;
+   if (!workers)
+      threads = 1;
+   int started = 1;
+   for (int i = 1; i < threads; i++) {
+      st_param_worker *w = &workers[i];
+      w->copy = *tc;
+      w->first = results->first + rows * (size_t)i / (size_t)threads;
+      w->last = results->first + rows * (size_t)(i + 1) / (size_t)threads;
+      if (pthread_create(&w->thread, NULL, param_worker_main, w) != 0)
+         break;
+      started++;
+   }
+   param_rows(tc, results, results->first, results->first + rows / (size_t)threads);
+   param_rows(tc, results, results->first + rows * (size_t)started / (size_t)threads, results->last);
+   for (int i = 1; i < started; i++)
+      pthread_join(workers[i].thread, NULL);
+   __real_free(workers);
+
+   results->passed = results->failed = results->skipped = 0;
+   size_t first_failed = SIZE_MAX;
+   for (size_t row = results->first; row < results->last; row++) {
+      TestState state = results->rows[row].state;
+      results->passed += state == PASS;
+      results->skipped += state == SKIP;
+      if (state == FAIL && results->failed++ == 0)
+         first_failed = row;
+   }
+
+   if (results->failed) {
+      const st_param_row *result = &results->rows[first_failed];
+      char summary[512], label[128];
+      snprintf(summary, sizeof(summary), "%zu of %zu rows failed, first [%zu]%s%s:\n    - %s", results->failed, rows,
+               first_failed, results->format ? " " : "",
+               results->format ? st_param_label(results, first_failed, label, sizeof(label)) : "",
+               result->message ? result->message : "Unknown failure");
+      tc->info.result.state = FAIL;
+      tc->info.result.message = arena_strdup(summary);
+   } else if (results->skipped == rows) {
+      tc->info.result.state = SKIP;
+      tc->info.result.message = rows ? (string) "All rows skipped" : (string) "No rows to run";
    } else {
-      // handle exception
+      tc->info.result.state = PASS;
+      tc->info.result.message = NULL;
    }
    return END_TEST;
 }
-static RunnerState execute_fuzzing(TestCase tc, jmp_buf jmpbuffer, const void *dataset, size_t count, size_t elem_size) {
+/*
+ * Benchmarks (bench_testcase)
+ * The iteration count is calibrated until one sample takes about ST_BENCH_SAMPLE_NS. Warmup
+ * samples run untimed, then up to ST_BENCH_SAMPLES samples are timed, fewer when a slow
+ * function would overrun ST_BENCH_BUDGET_NS. Statistics are per iteration.
+ */
+// time `iterations` calls of the benchmark function, in nanoseconds
+static uint64_t bench_batch(TestFunc func, size_t iterations) {
+   ts_time start, end;
+   sys_gettime(&start);
+   for (size_t i = 0; i < iterations; i++)
+      func();
+   sys_gettime(&end);
+   int64_t ns = (int64_t)(end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+   return ns > 0 ? (uint64_t)ns : 0;
+}
+static int sample_cmp(const void *a, const void *b) {
+   double left = *(const double *)a, right = *(const double *)b;
+   return (left > right) - (left < right);
+}
+static void bench_stats(st_bench_run *run, size_t samples, size_t iterations, uint64_t total_ns) {
+   st_bench_stats *stats = &run->stats;
+   double sorted[ST_BENCH_SAMPLES];
+   memcpy(sorted, run->samples, samples * sizeof(double));
+   qsort(sorted, samples, sizeof(double), sample_cmp);
+
+   double mean = 0;
+   for (size_t i = 0; i < samples; i++)
+      mean += sorted[i];
+   mean /= (double)samples;
+   double variance = 0;
+   for (size_t i = 0; i < samples; i++)
+      variance += (sorted[i] - mean) * (sorted[i] - mean);
+
+   stats->iterations = iterations;
+   stats->samples = samples;
+   stats->min_ns = sorted[0];
+   stats->median_ns = samples % 2 ? sorted[samples / 2] : (sorted[samples / 2 - 1] + sorted[samples / 2]) / 2.0;
+   stats->p99_ns = sorted[(size_t)ceil(0.99 * (double)samples) - 1];
+   stats->stddev_ns = samples > 1 ? sqrt(variance / (double)(samples - 1)) : 0.0;
+   stats->ns_per_op = (double)total_ns / ((double)samples * (double)iterations);
+   stats->sample_ns = run->samples;
+}
+static RunnerState execute_bench(TestCase tc, jmp_buf jmpbuffer) {
    current_tc = tc;
-   int failed_count = 0;
-   char val_buf[64];
+   st_bench_run *run = tc->bench;
+   memset(&run->stats, 0, sizeof(run->stats));
+   if (setjmp(jmpbuffer) != 0) {
+      // an assertion failed inside the benchmark, or it ran out of budget; the result is set
+      BUDGET_LEAVE();
+      return END_TEST;
+   }
+   budget_thread.jump = 1; // every sample below runs test code
+
+   TestFunc func = tc->func.test;
+   size_t iterations = 1;
+   uint64_t ns = bench_batch(func, iterations);
+   while (ns < ST_BENCH_SAMPLE_NS && iterations < ((size_t)1 << 32)) {
+      // scale towards the sample duration, at most 100x per step
+      double scale = ns > 0 ? (double)ST_BENCH_SAMPLE_NS / (double)ns * 1.1 : 100.0;
+      size_t next = (size_t)((double)iterations * (scale < 100.0 ? scale : 100.0));
+      iterations = next > iterations ? next : iterations + 1;
+      ns = bench_batch(func, iterations);
+   }
 
-   for (size_t i = 0; i < count; ++i) {
-      const void *input = (const char *)dataset + (i * elem_size);
+   size_t samples = ST_BENCH_SAMPLES;
+   size_t warmup = ST_BENCH_WARMUP;
+   if (ns > 0 && ns * (ST_BENCH_SAMPLES + ST_BENCH_WARMUP) > ST_BENCH_BUDGET_NS) {
+      uint64_t fit = ST_BENCH_BUDGET_NS / ns;
+      // the budget may still fit every sample once the warmup shrinks to one
+      samples = fit > ST_BENCH_SAMPLES ? ST_BENCH_SAMPLES : fit > 5 ? (size_t)fit : 5;
+      warmup = 1;
+   }
+   for (size_t i = 0; i < warmup; i++)
+      bench_batch(func, iterations);
+
+   uint64_t total_ns = 0;
+   for (size_t i = 0; i < samples; i++) {
+      uint64_t sample = bench_batch(func, iterations);
+      run->samples[i] = (double)sample / (double)iterations;
+      total_ns += sample;
+   }
+   BUDGET_LEAVE();
+   bench_stats(run, samples, iterations, total_ns);
+   bench_compare(tc, current_set);
 
-      format_fuzz_value(tc->fuzz_type, input, val_buf, sizeof(val_buf));
-      writef("value = %-10.3s", val_buf);
+   return END_TEST;
+}
+// format a duration in nanoseconds with a readable unit
+static void format_ns(double ns, char *buffer, size_t size) {
+   if (ns < 1000.0)
+      snprintf(buffer, size, "%.1f ns", ns);
+   else if (ns < 1000000.0)
+      snprintf(buffer, size, "%.2f µs", ns / 1000.0);
+   else if (ns < 1000000000.0)
+      snprintf(buffer, size, "%.2f ms", ns / 1000000.0);
+   else
+      snprintf(buffer, size, "%.3f s", ns / 1000000000.0);
+}
+static void default_on_bench_result(const TsInfo ts, tc_context *ctx, const st_bench_stats *stats) {
+   (void)ts;
+   (void)ctx;
+   char op[32], min[32], median[32], p99[32], stddev[32];
+   format_ns(stats->ns_per_op, op, sizeof(op));
+   format_ns(stats->min_ns, min, sizeof(min));
+   format_ns(stats->median_ns, median, sizeof(median));
+   format_ns(stats->p99_ns, p99, sizeof(p99));
+   format_ns(stats->stddev_ns, stddev, sizeof(stddev));
+   writelnf("%s/op over %zu x %zu iterations (min %s, median %s, p99 %s, stddev %s)",
+            op, stats->samples, stats->iterations, min, median, p99, stddev);
+}
+/*
+ * Benchmark baselines (`--bench-baseline`)
+ * A flat file of fixed size entries sorted by `set/case`, mapped read-only at start up and
+ * searched in place. A benchmark regresses when its median is slower than the baseline median
+ * by more than the tolerance and a one sided Mann-Whitney U test on the samples agrees, so a
+ * noisy run alone does not fail the case. New benchmarks are added to the file at the end of
+ * the run; existing entries are only replaced with `--bench-update`.
+ */
+#define ST_BASELINE_MAGIC "STBL"
+#define ST_BASELINE_VERSION 1
+#define ST_BASELINE_KEY 128
+#define ST_BASELINE_ALPHA 0.01
+
+typedef struct {
+   char magic[4];
+   uint32_t version;
+   uint32_t count;
+   uint32_t sample_capacity; // ST_BENCH_SAMPLES of the writer
+} st_baseline_header;
+typedef struct {
+   char key[ST_BASELINE_KEY]; // `set/case`, zero padded
+   uint64_t iterations;
+   uint64_t samples;
+   double median_ns;
+   double ns_per_op;
+   double sample_ns[ST_BENCH_SAMPLES];
+} st_baseline_entry;
+typedef struct {
+   double ns;
+   int current;
+} st_rank_item;
+
+static void *baseline_map = NULL;
+static size_t baseline_map_size = 0;
+static const st_baseline_entry *baseline_entries = NULL;
+static size_t baseline_count = 0;
+
+static void baseline_key(TestSet set, TestCase tc, char key[ST_BASELINE_KEY]) {
+   memset(key, 0, ST_BASELINE_KEY);
+   snprintf(key, ST_BASELINE_KEY, "%s/%s", set->info.name, tc->info.name);
+}
+static int baseline_cmp(const void *a, const void *b) {
+   return strncmp(((const st_baseline_entry *)a)->key, ((const st_baseline_entry *)b)->key, ST_BASELINE_KEY);
+}
+static int baseline_key_cmp(const void *key, const void *entry) {
+   return strncmp(key, ((const st_baseline_entry *)entry)->key, ST_BASELINE_KEY);
+}
+static const st_baseline_entry *baseline_find(TestSet set, TestCase tc) {
+   if (!baseline_entries)
+      return NULL;
+   char key[ST_BASELINE_KEY];
+   baseline_key(set, tc, key);
+   return bsearch(key, baseline_entries, baseline_count, sizeof(st_baseline_entry), baseline_key_cmp);
+}
+// map the baseline file; a missing file is not an error, it is written at the end of the run
+static int baseline_open(void) {
+   const char *path = runner_options.bench_baseline;
+   if (!path || baseline_map)
+      return 0;
+   int fd = open(path, O_RDONLY);
+   if (fd < 0) {
+      if (errno == ENOENT)
+         return 0;
+      fwritelnf(stderr, "Error: Cannot open benchmark baseline '%s': %s", path, strerror(errno));
+      return -1;
+   }
 
-      if (setjmp(jmpbuffer) == 0) {
-         tc->func.fuzz((void *)input);
-         writelnf("Okay");
-      } else {
-         const char *msg = tc->info.result.message ? tc->info.result.message : "Unknown failure";
-         writelnf("Failed:\n  - %s", msg);
-         failed_count++;
+   struct stat st;
+   void *map = MAP_FAILED;
+   if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(st_baseline_header))
+      map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   const st_baseline_header *header = map;
+   if (map == MAP_FAILED || memcmp(header->magic, ST_BASELINE_MAGIC, 4) != 0 ||
+       header->version != ST_BASELINE_VERSION || header->sample_capacity != ST_BENCH_SAMPLES ||
+       (size_t)st.st_size != sizeof(*header) + header->count * sizeof(st_baseline_entry)) {
+      fwritelnf(stderr, "Error: Invalid benchmark baseline '%s'; delete it to record a new one", path);
+      if (map != MAP_FAILED)
+         munmap(map, (size_t)st.st_size);
+      return -1;
+   }
 
-         // Reset message for next iteration
-         if (tc->info.result.message) {
-            tc->info.result.message = NULL;
-         }
+   baseline_map = map;
+   baseline_map_size = (size_t)st.st_size;
+   baseline_entries = (const st_baseline_entry *)(header + 1);
+   baseline_count = header->count;
+   return 0;
+}
+static int rank_cmp(const void *a, const void *b) {
+   double left = ((const st_rank_item *)a)->ns, right = ((const st_rank_item *)b)->ns;
+   return (left > right) - (left < right);
+}
+// one sided Mann-Whitney U test (normal approximation with tie and continuity correction):
+// the p value for the current samples coming from a slower distribution than the baseline
+static double mann_whitney_p(const double *current, size_t n1, const double *baseline, size_t n2) {
+   st_rank_item pooled[2 * ST_BENCH_SAMPLES];
+   size_t n = n1 + n2;
+   for (size_t i = 0; i < n1; i++)
+      pooled[i] = (st_rank_item){current[i], 1};
+   for (size_t i = 0; i < n2; i++)
+      pooled[n1 + i] = (st_rank_item){baseline[i], 0};
+   qsort(pooled, n, sizeof(st_rank_item), rank_cmp);
+
+   double rank_sum = 0, ties = 0;
+   for (size_t i = 0; i < n;) {
+      size_t j = i;
+      while (j < n && pooled[j].ns == pooled[i].ns)
+         j++;
+      double rank = (double)(i + j + 1) / 2.0; // average of ranks i+1 .. j
+      for (size_t k = i; k < j; k++) {
+         if (pooled[k].current)
+            rank_sum += rank;
       }
+      double t = (double)(j - i);
+      ties += t * t * t - t;
+      i = j;
    }
 
-   // Final result for the fuzz test case
-   if (failed_count == 0) {
-      tc->info.result.state = PASS;
-      tc->info.result.message = NULL;
-   } else {
-      tc->info.result.state = FAIL;
-      char summary[128];
-      snprintf(summary, sizeof(summary),
-               "%ld of %zu fuzz iterations passed", count - failed_count, count);
-      tc->info.result.message = strdup(summary);
+   double u = rank_sum - (double)n1 * (double)(n1 + 1) / 2.0;
+   double mean = (double)n1 * (double)n2 / 2.0;
+   double variance = (double)n1 * (double)n2 / 12.0 * ((double)(n + 1) - ties / ((double)n * (double)(n - 1)));
+   if (variance <= 0)
+      return 1.0;
+   double z = (u - mean - 0.5) / sqrt(variance);
+   return 0.5 * erfc(z / sqrt(2.0));
+}
+// compare a finished benchmark against its baseline entry; a regression fails the case
+static void bench_compare(TestCase tc, TestSet set) {
+   st_bench_stats *stats = &tc->bench->stats;
+   stats->baseline_ns = 0;
+   stats->p_value = 1.0;
+   stats->regressed = 0;
+   const st_baseline_entry *base = baseline_find(set, tc);
+   if (!base || base->samples < 2 || stats->samples < 2)
+      return;
+
+   stats->baseline_ns = base->median_ns;
+   stats->p_value = mann_whitney_p(tc->bench->samples, stats->samples, base->sample_ns, (size_t)base->samples);
+   double limit = base->median_ns * (1.0 + runner_options.bench_tolerance / 100.0);
+   if (stats->median_ns <= limit || stats->p_value >= ST_BASELINE_ALPHA)
+      return;
+
+   stats->regressed = 1;
+   if (tc->info.result.state != PASS)
+      return;
+   char median[32], baseline[32], message[256];
+   format_ns(stats->median_ns, median, sizeof(median));
+   format_ns(base->median_ns, baseline, sizeof(baseline));
+   snprintf(message, sizeof(message), "Benchmark regressed: median %s vs baseline %s (+%.1f%%, p=%.4f)",
+            median, baseline, (stats->median_ns / base->median_ns - 1.0) * 100.0, stats->p_value);
+   tc->info.result.state = FAIL;
+   tc->info.result.message = arena_strdup(message);
+}
+// write the baseline back with this run's new (or, with `--bench-update`, all) benchmarks
+static int baseline_save(TestSet sets) {
+   const char *path = runner_options.bench_baseline;
+   if (!path)
+      return 0;
+
+   size_t capacity = baseline_count;
+   for (size_t i = 0; i < registry.count; i++) {
+      if (registry.cases[i].is_bench)
+         capacity++;
+   }
+   st_baseline_entry *entries = __real_calloc(capacity ? capacity : 1, sizeof(st_baseline_entry));
+   if (!entries) {
+      fwritelnf(stderr, "Error: Failed to allocate the benchmark baseline");
+      return -1;
    }
+   if (baseline_count)
+      memcpy(entries, baseline_entries, baseline_count * sizeof(st_baseline_entry));
 
-   return END_TEST;
+   size_t count = baseline_count;
+   int changed = 0;
+   for (TestSet set = sets; set; set = set->next) {
+      for (int i = 0; i < set->info.count; i++) {
+         TestCase tc = &registry.cases[set->first + i];
+         if (!tc->is_bench || !tc->bench || tc->bench->stats.samples == 0)
+            continue;
+         const st_baseline_entry *old = baseline_find(set, tc);
+         if (old && !runner_options.bench_update)
+            continue;
+
+         st_baseline_entry *entry = old ? &entries[old - baseline_entries] : &entries[count++];
+         memset(entry, 0, sizeof(*entry));
+         baseline_key(set, tc, entry->key);
+         entry->iterations = tc->bench->stats.iterations;
+         entry->samples = tc->bench->stats.samples;
+         entry->median_ns = tc->bench->stats.median_ns;
+         entry->ns_per_op = tc->bench->stats.ns_per_op;
+         memcpy(entry->sample_ns, tc->bench->samples, entry->samples * sizeof(double));
+         changed = 1;
+      }
+   }
+
+   int result = 0;
+   if (changed) {
+      qsort(entries, count, sizeof(st_baseline_entry), baseline_cmp);
+      st_baseline_header header = {.version = ST_BASELINE_VERSION, .count = (uint32_t)count, .sample_capacity = ST_BENCH_SAMPLES};
+      memcpy(header.magic, ST_BASELINE_MAGIC, 4);
+      // write a sibling file and rename it over the old one, so a failed write keeps the baseline
+      char temp[PATH_MAX];
+      snprintf(temp, sizeof(temp), "%s.tmp", path);
+      FILE *file = fopen(temp, "wb");
+      if (!file || fwrite(&header, sizeof(header), 1, file) != 1 ||
+          (count && fwrite(entries, sizeof(st_baseline_entry), count, file) != count) ||
+          fclose(file) != 0 || rename(temp, path) != 0) {
+         if (file)
+            fclose(file);
+         fwritelnf(stderr, "Error: Cannot write benchmark baseline '%s': %s", path, strerror(errno));
+         result = -1;
+      }
+   }
+   __real_free(entries);
+
+   if (baseline_map) {
+      munmap(baseline_map, baseline_map_size);
+      baseline_map = NULL;
+      baseline_entries = NULL;
+      baseline_count = 0;
+   }
+   return result;
+}
+// hand the statistics of a finished benchmark to the hooks, ahead of its result
+static void bench_report(ST_Hooks hooks, TestCase tc, TestSet set) {
+   if (!tc->bench || tc->bench->stats.samples == 0)
+      return;
+
+   set->info.tc_info = (TcInfo)&tc->info;
+   current_ctx->info.logger = set->logger;
+   if (hooks && hooks->on_bench_result) {
+      hooks->on_bench_result((TsInfo)&set->info, current_ctx, &tc->bench->stats);
+   } else {
+      default_on_bench_result((TsInfo)&set->info, current_ctx, &tc->bench->stats);
+   }
 }
 static RunnerState end_test(ST_Hooks hooks) {
-   hooks->context->info.logger = current_set->logger;
+   budget_disarm(current_set->current);
+   capture_release_fds();
+   if (!iso_worker)
+      cross_end(current_set->current);
+   current_ctx->info.logger = current_set->logger;
    if (hooks && hooks->on_end_test) {
-      hooks->on_end_test(hooks->context);
+      hooks->on_end_test(current_ctx);
    }
+   // folded once the hooks have timed the case
+   profile_disarm(current_set->current);
    return TEARDOWN_TEST;
 }
 static RunnerState teardown_test(TestSet set) {
@@ -1523,9 +6132,9 @@ static RunnerState teardown_test(TestSet set) {
    return AFTER_TEST;
 }
 static RunnerState after_test(ST_Hooks hooks) {
-   hooks->context->info.logger = current_set->logger;
+   current_ctx->info.logger = current_set->logger;
    if (hooks && hooks->after_test) {
-      hooks->after_test(hooks->context);
+      hooks->after_test(current_ctx);
    }
    return CASE_LOOP;
 }
@@ -1533,39 +6142,36 @@ static RunnerState process_result(TestCase tc, TestSet set, ST_Hooks hooks,
                                   int *tc_passed, int *tc_failed, int *tc_skipped,
                                   int *tc_total, int *total_tests) {
    // VIRTUAL STATE: PROCESS_RESULT
+   // messages are never freed individually, so the fixed outcomes need no copy
    if (tc->expect_fail) {
       if (tc->info.result.state == FAIL) {
          tc->info.result.state = PASS;
          if (tc->info.result.message) {
-            __real_free(tc->info.result.message);
-            tc->info.result.message = strdup("Expected failure occurred");
+            tc->info.result.message = (string) "Expected failure occurred";
          }
-      } else if (tc->info.result.state != SKIP) {
+      } else if (tc->info.result.state == PASS) {
          tc->info.result.state = FAIL;
-         if (tc->info.result.message)
-            __real_free(tc->info.result.message);
-         tc->info.result.message = strdup("Expected failure but passed");
+         tc->info.result.message = (string) "Expected failure but passed";
       }
    } else if (tc->expect_throw) {
       if (tc->info.result.state == FAIL) {
          tc->info.result.state = PASS;
          if (tc->info.result.message) {
-            __real_free(tc->info.result.message);
-            tc->info.result.message = strdup("Expected throw occurred");
+            tc->info.result.message = (string) "Expected throw occurred";
          }
-      } else if (tc->info.result.state != SKIP) {
+      } else if (tc->info.result.state == PASS) {
          tc->info.result.state = FAIL;
-         if (tc->info.result.message)
-            __real_free(tc->info.result.message);
-         tc->info.result.message = strdup("Expected throw but passed");
+         tc->info.result.message = (string) "Expected throw but passed";
       }
    }
+   // the output of a case, teardown included, is only worth its I/O when the case did not pass
+   capture_finish(tc->info.result.state != PASS && tc->info.result.state != SKIP);
 
    if (tc->info.result.state == PASS) {
       set->info.tc_info = (TcInfo)&tc->info;
-      hooks->context->info.logger = current_set->logger;
+      current_ctx->info.logger = current_set->logger;
       if (hooks && hooks->on_test_result) {
-         hooks->on_test_result((TsInfo)&set->info, hooks->context);
+         hooks->on_test_result((TsInfo)&set->info, current_ctx);
       } else {
          set->logger->log("[PASS]\n");
       }
@@ -1573,9 +6179,9 @@ static RunnerState process_result(TestCase tc, TestSet set, ST_Hooks hooks,
       set->info.passed++;
    } else if (tc->info.result.state == SKIP) {
       set->info.tc_info = (TcInfo)&tc->info;
-      hooks->context->info.logger = current_set->logger;
+      current_ctx->info.logger = current_set->logger;
       if (hooks && hooks->on_test_result) {
-         hooks->on_test_result((TsInfo)&set->info, hooks->context);
+         hooks->on_test_result((TsInfo)&set->info, current_ctx);
       } else {
          set->logger->log("[SKIP]\n");
       }
@@ -1583,14 +6189,16 @@ static RunnerState process_result(TestCase tc, TestSet set, ST_Hooks hooks,
       set->info.skipped++;
    } else {
       set->info.tc_info = (TcInfo)&tc->info;
-      hooks->context->info.logger = current_set->logger;
+      current_ctx->info.logger = current_set->logger;
       if (hooks && hooks->on_test_result) {
-         hooks->on_test_result((TsInfo)&set->info, hooks->context);
+         hooks->on_test_result((TsInfo)&set->info, current_ctx);
       } else {
          set->logger->log("[FAIL]\n     %s", tc->info.result.message ? tc->info.result.message : "Unknown");
       }
       (*tc_failed)++;
       set->info.failed++;
+      if (tc->bench && tc->bench->stats.regressed)
+         set->info.regressed++;
    }
 
    (*tc_total)++;
@@ -1601,9 +6209,9 @@ static RunnerState process_result(TestCase tc, TestSet set, ST_Hooks hooks,
 }
 static RunnerState after_set(ST_Hooks hooks, TestSet set,
                              int sequence, int tc_total, int tc_passed, int tc_failed, int tc_skipped) {
-   hooks->context->info.logger = current_set->logger;
+   current_ctx->info.logger = current_set->logger;
    if (hooks && hooks->after_set) {
-      hooks->after_set((TsInfo)&current_set->info, hooks->context);
+      hooks->after_set((TsInfo)&current_set->info, current_ctx);
    }
 
    /* Emit per-set summary */
@@ -1613,106 +6221,320 @@ static RunnerState after_set(ST_Hooks hooks, TestSet set,
        .tc_passed = tc_passed,
        .tc_failed = tc_failed,
        .tc_skipped = tc_skipped,
+       .tc_regressed = set->info.regressed,
        .total_mallocs = _sigtest_alloc_count,
        .total_frees = _sigtest_free_count};
    if (hooks && hooks->on_set_summary) {
-      hooks->on_set_summary((TsInfo)&current_set->info, hooks->context, &summary);
+      hooks->on_set_summary((TsInfo)&current_set->info, current_ctx, &summary);
    } else {
       print_sep(set->log_stream, 80);
       char stats[128];
       snprintf(stats, sizeof(stats), "[%d]     TESTS=%3d        PASS=%3d        FAIL=%3d        SKIP=%3d",
                sequence, tc_total, tc_passed, tc_failed, tc_skipped);
       fwritelnf(set->log_stream, "%s", stats);
+      if (set->info.regressed > 0) {
+         fwritelnf(set->log_stream, "[%d]     REGRESSED=%3d (benchmarks slower than their baseline)", sequence, set->info.regressed);
+      }
    }
 
    /* file-local separator */
    if (false) {
       default_on_testset_finished();
    }
+   fixture_sweep(set);
    if (set->cleanup) {
       set->cleanup();
    }
+   if (runner_options.track_leaks && !(hooks && hooks->on_set_summary)) {
+      leak_set_report(set);
+   }
+   fflush(set->log_stream);
    return SET_LOOP;
 }
-static void runner_summary(int total_tests, int total_sets, TestSet set, ST_Hooks test_hooks) {
+static void runner_summary(st_totals *totals, int total_sets, TestSet set, ST_Hooks test_hooks) {
    char timestamp[32];
    get_timestamp(timestamp, "%Y-%m-%d %H:%M:%S");
    char hdr[128];
-   snprintf(hdr, sizeof(hdr), "[%s]   Test Set:                    %s", timestamp, set->info.name);
+   snprintf(hdr, sizeof(hdr), "[%s]   Test Set:                    %s", timestamp, set ? set->info.name : "");
    int hpad = 80 - (int)strlen(hdr);
    if (hpad < 0)
       hpad = 0;
    fwritelnf(stdout, "%s%*s", hdr, hpad, "");
    print_sep(stdout, 80);
    fwritelnf(stdout, "Tests run: %d, Passed: %d, Failed: %d, Skipped: %d",
-             total_tests, set->info.passed, set->info.failed, set->info.skipped);
+             totals->tests, totals->passed, totals->failed, totals->skipped);
+   if (totals->regressed > 0) {
+      fwritelnf(stdout, "Benchmark regressions:      %d", totals->regressed);
+   }
    fwritelnf(stdout, "Total test sets registered: %d", total_sets);
    /* Print aggregate malloc/free totals with adjusted alignment */
    fwritelnf(stdout, "Total mallocs:              %zu", _sigtest_alloc_count);
    fwritelnf(stdout, "Total frees:                %zu", _sigtest_free_count);
+   if (runner_options.track_leaks) {
+      leak_report(stdout);
+   }
 }
-static int runner_done(TestSet set) {
+static int runner_done(st_totals *totals) {
    // Final cleanup if needed
-   return set->info.failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+   return totals->failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/*
+ * Report writer
+ * A single producer, single consumer ring of result records drained by a background thread, so
+ * hooks serialize their reports without formatting or I/O on the test thread. Either side only
+ * takes the lock to wake the other after finding the ring empty (writer) or full (producer).
+ * Note text is copied into a buffer of its ring slot, reused once the writer is past it.
+ */
+#define ST_REPORT_RING 1024 // records; a power of 2
+struct st_report_writer_s {
+   st_report_record ring[ST_REPORT_RING];
+   struct {
+      char *text;
+      size_t size;
+   } notes[ST_REPORT_RING]; // note text of each slot; grows to the longest note it held
+   _Alignas(ST_CACHE_LINE) atomic_size_t head; // next slot to fill (producer)
+   _Alignas(ST_CACHE_LINE) atomic_size_t tail; // next slot to serialize (writer)
+   atomic_int writer_waiting;
+   atomic_int producer_waiting;
+   atomic_int closing;
+   pthread_mutex_t lock;
+   pthread_cond_t ready; // records queued or closing
+   pthread_cond_t room;  // a slot was freed
+   pthread_t thread;
+   ReportWrite write;
+   object data;
+};
+
+static void *report_writer_main(void *arg) {
+   ReportWriter writer = arg;
+   for (;;) {
+      size_t tail = atomic_load_explicit(&writer->tail, memory_order_relaxed);
+      if (tail == atomic_load(&writer->head)) {
+         pthread_mutex_lock(&writer->lock);
+         atomic_store(&writer->writer_waiting, 1);
+         while (tail == atomic_load(&writer->head) && !atomic_load(&writer->closing))
+            pthread_cond_wait(&writer->ready, &writer->lock);
+         atomic_store(&writer->writer_waiting, 0);
+         pthread_mutex_unlock(&writer->lock);
+         if (tail == atomic_load(&writer->head))
+            break; // closing and drained
+         continue;
+      }
+
+      writer->write(&writer->ring[tail & (ST_REPORT_RING - 1)], writer->data);
+      atomic_store(&writer->tail, tail + 1);
+      if (atomic_load(&writer->producer_waiting)) {
+         pthread_mutex_lock(&writer->lock);
+         pthread_cond_signal(&writer->room);
+         pthread_mutex_unlock(&writer->lock);
+      }
+   }
+
+   return NULL;
+}
+ReportWriter st_report_open(ReportWrite write, object data) {
+   if (!write)
+      return NULL;
+
+   ReportWriter writer = __real_calloc(1, sizeof(struct st_report_writer_s));
+   if (!writer) {
+      fwritelnf(stderr, "Error: Failed to allocate report writer");
+      return NULL;
+   }
+   writer->write = write;
+   writer->data = data;
+   pthread_mutex_init(&writer->lock, NULL);
+   pthread_cond_init(&writer->ready, NULL);
+   pthread_cond_init(&writer->room, NULL);
+   if (pthread_create(&writer->thread, NULL, report_writer_main, writer) != 0) {
+      fwritelnf(stderr, "Error: Failed to start report writer");
+      pthread_cond_destroy(&writer->room);
+      pthread_cond_destroy(&writer->ready);
+      pthread_mutex_destroy(&writer->lock);
+      __real_free(writer);
+      return NULL;
+   }
+
+   return writer;
+}
+void st_report_push(ReportWriter writer, const st_report_record *record) {
+   size_t head = atomic_load_explicit(&writer->head, memory_order_relaxed);
+   if (head - atomic_load(&writer->tail) == ST_REPORT_RING) {
+      pthread_mutex_lock(&writer->lock);
+      atomic_store(&writer->producer_waiting, 1);
+      while (head - atomic_load(&writer->tail) == ST_REPORT_RING)
+         pthread_cond_wait(&writer->room, &writer->lock);
+      atomic_store(&writer->producer_waiting, 0);
+      pthread_mutex_unlock(&writer->lock);
+   }
+
+   size_t index = head & (ST_REPORT_RING - 1);
+   st_report_record *slot = &writer->ring[index];
+   *slot = *record;
+   if (record->kind == REPORT_NOTE && record->message) {
+      size_t len = strlen(record->message) + 1;
+      if (len > writer->notes[index].size) {
+         char *text = __real_realloc(writer->notes[index].text, len);
+         if (text) {
+            writer->notes[index].text = text;
+            writer->notes[index].size = len;
+         }
+      }
+      if (len <= writer->notes[index].size) {
+         memcpy(writer->notes[index].text, record->message, len);
+         slot->message = writer->notes[index].text;
+      } else {
+         slot->message = NULL;
+      }
+   }
+   atomic_store(&writer->head, head + 1);
+   if (atomic_load(&writer->writer_waiting)) {
+      pthread_mutex_lock(&writer->lock);
+      pthread_cond_signal(&writer->ready);
+      pthread_mutex_unlock(&writer->lock);
+   }
+}
+void st_report_close(ReportWriter writer) {
+   if (!writer)
+      return;
+
+   pthread_mutex_lock(&writer->lock);
+   atomic_store(&writer->closing, 1);
+   pthread_cond_signal(&writer->ready);
+   pthread_mutex_unlock(&writer->lock);
+   pthread_join(writer->thread, NULL);
+
+   for (size_t i = 0; i < ST_REPORT_RING; i++)
+      __real_free(writer->notes[i].text);
+   pthread_cond_destroy(&writer->room);
+   pthread_cond_destroy(&writer->ready);
+   pthread_mutex_destroy(&writer->lock);
+   __real_free(writer);
+}
+FILE *st_log_stream(void) {
+   return (current_set && current_set->log_stream) ? current_set->log_stream : stdout;
+}
+void st_case_allocs(size_t *allocs, size_t *frees) {
+   // read the pending per-thread counts without taking them
+   int used = atomic_load_explicit(&alloc_slots_used, memory_order_relaxed);
+   *allocs = 0;
+   *frees = 0;
+   for (int i = 0; i <= used; i++) {
+      st_alloc_slot *slot = &alloc_slots[i < used ? i : ST_ALLOC_SLOTS];
+      *allocs += atomic_load_explicit(&slot->allocs, memory_order_relaxed);
+      *frees += atomic_load_explicit(&slot->frees, memory_order_relaxed);
+   }
 }
 
 #if 1 // Region: Logging functions with formatted test ouput
-static void flog_debug(DebugLevel level, FILE *stream, const char *fmt, ...) {
-   if (current_set && current_set->hooks && current_set->hooks->on_debug_log) {
-      va_list args;
-      va_start(args, fmt);
-      char buf[2048];
-      vsnprintf(buf, sizeof(buf), fmt, args);
-      va_end(args);
-      current_set->hooks->on_debug_log(current_set->hooks->context, level, "[%s] %s", DBG_LEVELS[level], buf);
+// write one debug message
+static void flog_debug_held(DebugLevel level, FILE *stream, const char *fmt, va_list args) {
+   if (iso_child && current_set && current_set->hooks && current_set->hooks->on_debug_log) {
+      // hooked debug output is handed back to the runner with the case result
+      fprintf(iso_debug, "[%s] ", DBG_LEVELS[level]);
+      vfprintf(iso_debug, fmt, args);
+   } else if (current_set && current_set->hooks && current_set->hooks->on_debug_log) {
+      char local[1024];
+      int len;
+      char *text = format_text(local, sizeof(local), &len, fmt, args);
+      if (!text)
+         return;
+      tc_context *ctx = current_ctx ? current_ctx : current_set->hooks->context;
+      current_set->hooks->on_debug_log(ctx, level, "[%s] %s", DBG_LEVELS[level], text);
+      if (text != local)
+         __real_free(text);
+   } else if (captured.active && stream == st_log_stream()) {
+      char local[1024];
+      int len;
+      char *text = format_text(local, sizeof(local), &len, fmt, args);
+      if (!text)
+         return;
+      char prefix[16];
+      int prefix_len = snprintf(prefix, sizeof(prefix), "[%s] ", DBG_LEVELS[level]);
+      capture_write(prefix, (size_t)prefix_len);
+      capture_write(text, (size_t)len);
+      if (text != local)
+         __real_free(text);
    } else {
       fprintf(stream, "[%s] ", DBG_LEVELS[level]);
-      va_list args;
-      va_start(args, fmt);
       vfprintf(stream, fmt, args);
-      va_end(args);
-      fflush(stream);
    }
 }
-// This function is used to write formatted messages to the log stream
-void writef(const char *fmt, ...) {
+// debug output takes the stream and hook locks; an exceeded budget unwinds past it
+static void flog_debug(DebugLevel level, FILE *stream, const char *fmt, ...) {
    va_list args;
    va_start(args, fmt);
-
+   BUDGET_HOLD();
+   flog_debug_held(level, stream, fmt, args);
+   BUDGET_RELEASE();
+   va_end(args);
+}
+// write a formatted message to the set log (stdout without a set); output is flushed at test
+// boundaries, so no per-message flush here
+static void log_sink(const char *fmt, va_list args, int newline) {
    FILE *stream = (current_set && current_set->log_stream) ? current_set->log_stream : stdout;
-   /* If Running was printed without newline and this is the first debug output, break the line
-    * so debug lines start on the next line and are indented. Also mark that debug occurred. */
-   if (inside_test && current_tc->ran_no_newline && strncmp(fmt, "Running:", 8) != 0 && strncmp(fmt, "[%d]", 4) != 0 && strncmp(fmt, "=", 1) != 0) {
-      fputc('\n', stream);
-      current_tc->ran_no_newline = 0;
-      current_tc->had_debug = 1;
+   char local[1024];
+   int len;
+   char *text = format_text(local, sizeof(local), &len, fmt, args);
+   if (!text)
+      return;
+
+   // a thread of the test logs with its case; the runner writes it out when the body returns
+   if (!current_set && !worker_case && cross_write(text, (size_t)len)) {
+      if (text != local)
+         __real_free(text);
+      return;
    }
-   if (inside_test && strncmp(fmt, "Running:", 8) != 0 && strncmp(fmt, "[%d]", 4) != 0 && strncmp(fmt, "=", 1) != 0) {
-      fprintf(stream, "  - ");
+   if (captured.active) {
+      // a captured case breaks its Running line only if the capture is written out
+      if (inside_test && !line_open)
+         capture_write("  - ", 4);
+      capture_write(text, (size_t)len);
+      if (newline)
+         capture_write("\n", 1);
+   } else {
+      if (inside_test) {
+         /* The first output after an open "Running:" line breaks the line so debug lines start
+          * on the next line and are indented. Also mark that debug occurred. */
+         if (current_tc->ran_no_newline) {
+            fputc('\n', stream);
+            current_tc->ran_no_newline = 0;
+            current_tc->had_debug = 1;
+            line_open = 0;
+         }
+         // output continuing an open line is not prefixed again
+         if (!line_open)
+            fputs("  - ", stream);
+      }
+      fwrite(text, 1, (size_t)len, stream);
+      if (newline)
+         fputc('\n', stream);
    }
-   vfprintf(stream, fmt, args);
-   fflush(stream);
+   if (newline)
+      line_open = 0;
+   else if (len > 0)
+      line_open = text[len - 1] != '\n';
 
+   if (text != local)
+      __real_free(text);
+}
+// This function is used to write formatted messages to the log stream
+void writef(const char *fmt, ...) {
+   va_list args;
+   va_start(args, fmt);
+   BUDGET_HOLD();
+   log_sink(fmt, args, 0);
+   BUDGET_RELEASE();
    va_end(args);
 }
 // This function is used to write formatted messages with a newline to the log stream
 void writelnf(const char *fmt, ...) {
    va_list args;
    va_start(args, fmt);
-
-   FILE *stream = (current_set && current_set->log_stream) ? current_set->log_stream : stdout;
-   if (inside_test && current_tc->ran_no_newline && strncmp(fmt, "Running:", 8) != 0 && strncmp(fmt, "[%d]", 4) != 0 && strncmp(fmt, "=", 1) != 0) {
-      fputc('\n', stream);
-      current_tc->ran_no_newline = 0;
-      current_tc->had_debug = 1;
-   }
-   if (inside_test && strncmp(fmt, "Running:", 8) != 0 && strncmp(fmt, "[%d]", 4) != 0 && strncmp(fmt, "=", 1) != 0) {
-      fprintf(stream, "  - ");
-   }
-   vfprintf(stream, fmt, args);
-   fprintf(stream, "\n");
-   fflush(stream);
-
+   BUDGET_HOLD();
+   log_sink(fmt, args, 1);
+   BUDGET_RELEASE();
    va_end(args);
 }
 // This function is used to write formatted messages to the given stream
@@ -1721,8 +6543,12 @@ void fwritef(FILE *stream, const char *fmt, ...) {
    va_start(args, fmt);
 
    stream = stream ? stream : stdout;
+   // keep buffered console output ahead of errors
+   if (stream == stderr)
+      fflush(stdout);
+   BUDGET_HOLD();
    vfprintf(stream, fmt, args);
-   fflush(stream);
+   BUDGET_RELEASE();
 
    va_end(args);
 }
@@ -1732,12 +6558,32 @@ void fwritelnf(FILE *stream, const char *fmt, ...) {
    va_start(args, fmt);
 
    stream = stream ? stream : stdout;
+   if (stream == stderr)
+      fflush(stdout);
+   BUDGET_HOLD();
    vfprintf(stream, fmt, args);
-   fprintf(stream, "\n");
-   fflush(stream);
+   fputc('\n', stream);
+   BUDGET_RELEASE();
 
    va_end(args);
 }
+// flush buffered output before a fatal signal takes the process down
+static void crash_flush(int sig) {
+   // best effort: stdio is not async-signal-safe, but the process is going down anyway
+   capture_finish(1);
+   fflush(NULL);
+   raise(sig);
+}
+static void install_crash_flush(void) {
+   struct sigaction action;
+   memset(&action, 0, sizeof(action));
+   action.sa_handler = crash_flush;
+   action.sa_flags = SA_RESETHAND | SA_NODEFER;
+   sigemptyset(&action.sa_mask);
+   const int signals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT, SIGTERM};
+   for (size_t i = 0; i < sizeof(signals) / sizeof(signals[0]); i++)
+      sigaction(signals[i], &action, NULL);
+}
 #endif
 
 // Public global TestRunner interface
@@ -25,11 +25,18 @@
  * Description: Source file for SigmaTest CLI definitions and interfaces
  */
 #include "sigtest_cli.h"
+#include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <poll.h>
+#include <sys/inotify.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <time.h>
 #include <unistd.h> // For getpid; use <process.h> on Windows
 
@@ -48,30 +55,123 @@ static const char *DBG_LEVELS[] = {
 static CliState cli = {
     .state = START,
     .mode = DEFAULT,
-    .test_src = NULL,
+    .test_path_count = 0,
+    .build_jobs = 0,
+    .combined = 0,
+    .watch = 0,
     .no_clean = 0,
     .log_level = LOG_MINIMAL,
     .debug_level = DBG_DEBUG,
+    .runner_argc = 0,
+};
+// Test runner flags forwarded to the test executable
+static const struct {
+   const char *flag;
+   int has_value;
+} RUNNER_FLAGS[] = {
+    {"--shard-index", 1},
+    {"--shard-count", 1},
+    {"--shard-durations", 1},
+    {"--jobs", 1},
+    {"-j", 1},
+    {"--filter", 1},
+    {"--tag", 1},
+    {"--isolate", 0},
+    {"--track-leaks", 0},
+    {"--bench-baseline", 1},
+    {"--bench-tolerance", 1},
+    {"--bench-update", 0},
+    {"--fuzz-runs", 1},
+    {"--fuzz-time", 1},
+    {"--fuzz-jobs", 1},
+    {"--fuzz-crashes", 1},
+    {"--fuzz-replay", 1},
+    {"--timeout", 1},
+    {"--cpu-time", 1},
+    {"--max-heap", 1},
+    {"--max-allocs", 1},
+    {"--order", 1},
+    {"--seed", 1},
+    {"--history", 1},
+    {"--capture", 0},
+    {"--capture-fds", 0},
+    {"--profile", 1},
+    {NULL, 0},
 };
 
 #define MAX_DEPS 10
 #define MAX_NAME_LEN 128
+#define MAX_HEADERS 64
 #define BUILD_DIR "build/tmp"
+#define COMPILE_FLAGS "-Iinclude -DSIGTEST_TEST"
+#define LINK_FLAGS "-Llib"
+#define MODULE_FLAGS " -fPIC"
+#define MODULE_LINK_FLAGS "-shared -Llib -Wl,--wrap=malloc -Wl,--wrap=free -Wl,--wrap=calloc -Wl,--wrap=realloc"
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_MOVED_FROM)
+#define WATCH_SETTLE_MS 50
+#define FNV_OFFSET 1469598103934665603ULL
+
+// Build plan: the distinct objects and the runners linked from them
+typedef struct {
+   const char *source; /* Source of the object */
+   char obj[256];      /* Cached object path */
+   uint64_t key;       /* Content key */
+} BuildUnit;
+typedef struct {
+   const char *source; /* Test source, or "combined" */
+   int *units;         /* Objects to link */
+   int unit_count;
+   char exe[256];      /* Cached executable path */
+} Runner;
+typedef int (*CliJob)(int);
+
+static const char **test_sources = NULL;
+static int source_count = 0;
+static BuildUnit *units = NULL;
+static int unit_count = 0;
+static Runner *runners = NULL;
+static int runner_count = 0;
+static int *pending = NULL; /* Units or runners a job pool works through */
+static int pending_count = 0;
+static int watch_fd = -1; /* inotify descriptor with `--watch` */
+static int replanning = 0; /* A watch replan; test sources may have been deleted */
 
 void parse_args(int, char **, FILE *);
 int touch_file(const char *, FILE *);
 int verify_directory(const char *, FILE *);
-void detect_dependencies(const char *, const char **, int *);
-void gen_filenames(const char *, char *, char *, size_t);
-int compile_suite(const char *[], int, char *[], FILE *);
+const char *compiler(void);
+const char *compile_flags(void);
+const char *link_flags(void);
+uint64_t hash_bytes(uint64_t, const void *, size_t);
+uint64_t hash_text(uint64_t, const char *);
+char *read_source(const char *, size_t *);
+void detect_dependencies(const char *, const char *, const char **, int *);
+uint64_t source_key(const char *, const char *, size_t);
+void prune_stale(const char *);
+int collect_sources(FILE *);
+int plan_suite(const char *, FILE *);
+void plan_combined(void);
+int run_jobs(int, CliJob, int *);
+void run_pending(CliJob, int *);
+void build_plan(int *, int *);
+int compile_job(int);
+int link_job(int);
+int run_job(int);
+void gen_filenames(const char *, uint64_t, char *, char *, size_t);
+int compile_unit(const char *, const char *, FILE *);
 int link_executable(const char *[], int, const char *, const char *, FILE *);
-int run_and_cleanup(const char *, const char *);
+int runner_flag(const char *);
+int run_suite(const char *);
+void watch_path(const char *);
+int watch_suites(const int *);
 
 int main(int argc, char **argv) {
    parse_args(argc, argv, stderr);
 
    if (cli.state == ERROR) {
-      fwritelnf(stdout, "Usage: sigtest -t <path>|[-s|--no-clean|--about|[-v|--verbose]]\n");
+      fwritelnf(stdout, "Usage: sigtest -t <file|dir|glob> [-t ...]|[-s|--no-clean|--about|[-v|--verbose]]\n"
+                        "       [-J|--build-jobs <n>] [--combined] [--watch]\n"
+                        "       [--shard-index <k> --shard-count <n> [--shard-durations <file>]|<runner flags>]\n");
       return 1;
    }
 
@@ -93,44 +193,68 @@ int main(int argc, char **argv) {
    // char obj_template[MAX_TEMPLATE_LEN];
    // char exe_template[MAX_TEMPLATE_LEN];
 
-   // Validate test source file
-   if (touch_file(cli.test_src, stderr) != 0) {
-      return 1;
-   } else if (cli.log_level == LOG_VERBOSE) {
-      fdebugf(stdout, cli.log_level, DBG_INFO, "Verified: source=`%s`\n", cli.test_src);
-   }
    // Validate build directory
    if (verify_directory(BUILD_DIR, stderr) != 0) {
       return 1;
    } else if (cli.log_level == LOG_VERBOSE) {
       fdebugf(stdout, cli.log_level, DBG_INFO, "Verified: build directory=`%s`\n", BUILD_DIR);
    }
-
-   // Build ...
-   const char *sources[2];
-   char *objs[2], exe[256], obj_buffers[2][256];
-   int source_count = 0;
-   sources[0] = cli.test_src;
-   detect_dependencies(cli.test_src, sources + 1, &source_count);
-   source_count++;
-   // Generate filenames
-   for (int i = 0; i < source_count; i++) {
-      objs[i] = obj_buffers[i]; // Point to fixed-size buffers
-      gen_filenames(sources[i], objs[i], i == 0 ? exe : NULL, sizeof(obj_buffers[i]));
+   if (cli.build_jobs < 1) {
+      long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+      cli.build_jobs = cpus > 0 ? (int)cpus : 1;
    }
-   // Compile the test suite
-   if (compile_suite(sources, source_count, objs, stderr) != 0) {
+   if (cli.watch && (watch_fd = inotify_init1(IN_CLOEXEC)) < 0) {
+      fdebugf(stderr, LOG_VERBOSE, DBG_ERROR, "Cannot watch for changes: %s\n", strerror(errno));
       return 1;
    }
-   fdebugf(stdout, cli.log_level, DBG_INFO, "Compiled: source=`%s`, object=`%s`, executable=`%s`\n", sources[0], objs[0], exe);
 
-   // Link the object files into an executable
-   if (link_executable((const char **)objs, source_count, exe, "-Llib", stderr) != 0) {
+   // Plan the build: test sources, their objects keyed by content, and the runners to link
+   if (collect_sources(stderr) != 0) {
       return 1;
    }
-   fdebugf(stdout, cli.log_level, DBG_INFO, "Linked: object=`%s`, executable=`%s`\n", objs[0], exe);
-   // Run the test suite
-   return run_and_cleanup(exe, objs[0]);
+   for (int i = 0; i < source_count; i++) {
+      if (plan_suite(test_sources[i], stderr) != 0) {
+         return 1;
+      }
+   }
+   if (cli.combined) {
+      plan_combined();
+   }
+   int *unit_status = calloc(unit_count, sizeof(int));
+   int *runner_status = calloc(runner_count, sizeof(int));
+   build_plan(unit_status, runner_status);
+   if (cli.watch) {
+      return watch_suites(runner_status);
+   }
+
+   // Run the test suites that built
+   for (int i = 0; i < runner_count; i++) {
+      if (!runner_status[i])
+         pending[pending_count++] = i;
+   }
+   run_pending(run_job, runner_status);
+   int failed = 0;
+   for (int i = 0; i < runner_count; i++)
+      failed += runner_status[i] != 0;
+   if (runner_count > 1) {
+      fdebugf(stdout, cli.log_level, DBG_INFO, "Suites: %d, Passed: %d, Failed: %d\n", runner_count, runner_count - failed, failed);
+      for (int i = 0; i < runner_count; i++) {
+         if (runner_status[i] != 0) {
+            fdebugf(stdout, cli.log_level, DBG_INFO, "  - %s\n", runners[i].source);
+         }
+      }
+   }
+   if (!cli.no_clean) {
+      // the artifacts just used stay cached; older builds of the same sources go
+      for (int i = 0; i < unit_count; i++)
+         prune_stale(units[i].obj);
+      for (int i = 0; i < runner_count; i++)
+         prune_stale(runners[i].exe);
+   }
+   free(unit_status);
+   free(runner_status);
+
+   return failed ? 1 : 0;
 }
 
 // Parse command line arguments
@@ -139,7 +263,14 @@ void parse_args(int argc, char **argv, FILE *err_stream) {
    for (int i = 1; i < argc; i++) {
       switch (cli.state) {
       case START: {
-         if (strcmp(argv[i], "--about") == 0) {
+         int runner = runner_flag(argv[i]);
+         if (runner != 0 && cli.runner_argc >= MAX_RUNNER_ARGS - 1) {
+            fdebugf(err_stream, LOG_VERBOSE, DBG_ERROR, "Too many runner arguments: '%s'\n", argv[i]);
+            cli.state = ERROR;
+         } else if (runner != 0) {
+            cli.runner_args[cli.runner_argc++] = argv[i];
+            cli.state = runner > 0 ? RUNNER_ARG : START;
+         } else if (strcmp(argv[i], "--about") == 0) {
             cli.mode = VERSION;
             cli.state = DONE;
          } else if (strcmp(argv[i], "-f") == 0) {
@@ -148,6 +279,18 @@ void parse_args(int argc, char **argv, FILE *err_stream) {
             cli.state = IGNORE;
          } else if (strcmp(argv[i], "-t") == 0) {
             cli.state = TEST_SRC;
+         } else if (strcmp(argv[i], "-J") == 0 || strcmp(argv[i], "--build-jobs") == 0) {
+            cli.state = BUILD_JOBS;
+         } else if (strncmp(argv[i], "--build-jobs=", 13) == 0) {
+            cli.build_jobs = atoi(argv[i] + 13);
+            if (cli.build_jobs < 1) {
+               fdebugf(err_stream, LOG_VERBOSE, DBG_ERROR, "Invalid value: build jobs='%s'\n", argv[i] + 13);
+               cli.state = ERROR;
+            }
+         } else if (strcmp(argv[i], "--combined") == 0) {
+            cli.combined = 1;
+         } else if (strcmp(argv[i], "--watch") == 0) {
+            cli.watch = 1;
          } else if (strcmp(argv[i], "-s") == 0) {
             cli.mode = SIMPLE;
          } else if (strcmp(argv[i], "--no-clean") == 0) {
@@ -185,21 +328,38 @@ void parse_args(int argc, char **argv, FILE *err_stream) {
          break;
       }
       case TEST_SRC: {
-         if (cli.test_src == NULL) {
-            cli.test_src = argv[i];
+         if (cli.test_path_count < MAX_TEST_PATHS) {
+            cli.test_paths[cli.test_path_count++] = argv[i];
             cli.state = START;
          } else {
-            fdebugf(err_stream, cli.log_level, DBG_ERROR, "Multiple test source files");
+            fdebugf(err_stream, LOG_VERBOSE, DBG_ERROR, "Too many test sources: '%s'\n", argv[i]);
             cli.state = ERROR;
          }
 
          break;
       }
+      case BUILD_JOBS: {
+         cli.build_jobs = atoi(argv[i]);
+         if (cli.build_jobs < 1) {
+            fdebugf(err_stream, LOG_VERBOSE, DBG_ERROR, "Invalid value: build jobs='%s'\n", argv[i]);
+            cli.state = ERROR;
+         } else {
+            cli.state = START;
+         }
+
+         break;
+      }
       case IGNORE: {
          cli.state = START;
 
          break;
       }
+      case RUNNER_ARG: {
+         cli.runner_args[cli.runner_argc++] = argv[i];
+         cli.state = START;
+
+         break;
+      }
       case DONE: {
          fdebugf(err_stream, LOG_VERBOSE, DBG_ERROR, "Error: Unexpected argument or flag: '%s'", argv[i]);
          cli.state = ERROR;
@@ -215,10 +375,16 @@ void parse_args(int argc, char **argv, FILE *err_stream) {
    if (cli.state == TEST_SRC) {
       fwritelnf(err_stream, "Error: No test source file provided");
       cli.state = ERROR;
-   } else if (cli.state == IGNORE && cli.test_src == NULL) {
+   } else if (cli.state == BUILD_JOBS) {
+      fwritelnf(err_stream, "Error: Missing value for build jobs");
+      cli.state = ERROR;
+   } else if (cli.state == RUNNER_ARG) {
+      fwritelnf(err_stream, "Error: Missing value for '%s'", cli.runner_args[cli.runner_argc - 1]);
+      cli.state = ERROR;
+   } else if (cli.state == IGNORE && cli.test_path_count == 0) {
       fdebugf(err_stream, cli.log_level, DBG_ERROR, "No test source or options provided\n");
       cli.state = ERROR;
-   } else if (cli.state == START && cli.mode != VERSION && cli.test_src == NULL) {
+   } else if (cli.state == START && cli.mode != VERSION && cli.test_path_count == 0) {
       fdebugf(err_stream, LOG_VERBOSE, DBG_ERROR, "No test source or options provided\n");
       cli.state = ERROR;
    }
@@ -268,18 +434,141 @@ int verify_directory(const char *dir, FILE *err_stream) {
 
    return 0;
 }
-// Detect dependencies
-void detect_dependencies(const char *src, const char **deps, int *dep_count) {
-   fdebugf(stdout, cli.log_level, DBG_INFO, "Detecting dependencies for source file: %s\n", src);
-   FILE *file = fopen(src, "r");
-   if (!file) {
-      fdebugf(stderr, LOG_VERBOSE, DBG_ERROR, "Cannot open source file: %s\n", src);
+/*
+ * Object cache (`build/tmp`)
+ * Objects and executables are named by a content hash (FNV-1a) of the compiler, the flags,
+ * the source and every local header it includes, so an unchanged test or hook skips
+ * compilation and an unchanged set of objects skips the link. Artifacts are written under a
+ * temporary name and renamed into place; stale entries for the same source are pruned after
+ * the run unless `--no-clean` is given.
+ */
+const char *compiler(void) {
+   return getenv("CC") ? getenv("CC") : "gcc";
+}
+// watched tests are built as position independent modules
+const char *compile_flags(void) {
+   return cli.watch ? COMPILE_FLAGS MODULE_FLAGS : COMPILE_FLAGS;
+}
+const char *link_flags(void) {
+   return cli.watch ? MODULE_LINK_FLAGS : LINK_FLAGS;
+}
+uint64_t hash_bytes(uint64_t hash, const void *data, size_t size) {
+   const unsigned char *bytes = data;
+   for (size_t i = 0; i < size; i++)
+      hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+   return hash;
+}
+uint64_t hash_text(uint64_t hash, const char *text) {
+   // the terminator separates adjacent fields
+   return hash_bytes(hash, text, strlen(text) + 1);
+}
+// Read a whole source file; the caller frees it
+char *read_source(const char *path, size_t *size) {
+   FILE *file = fopen(path, "rb");
+   if (!file)
+      return NULL;
+   fseek(file, 0, SEEK_END);
+   long length = ftell(file);
+   fseek(file, 0, SEEK_SET);
+   char *text = length >= 0 ? malloc((size_t)length + 1) : NULL;
+   if (text) {
+      *size = fread(text, 1, (size_t)length, file);
+      text[*size] = '\0';
    }
+   fclose(file);
+   return text;
+}
+// Fold every `#include "..."` header reachable from text into the hash, each once
+static uint64_t hash_includes(uint64_t hash, const char *path, const char *text, char *seen[], int *seen_count) {
+   const char *slash = strrchr(path, '/');
+   int dir_len = slash ? (int)(slash - path) : 0;
+   for (const char *line = text; line; line = strchr(line, '\n') ? strchr(line, '\n') + 1 : NULL) {
+      const char *c = line;
+      while (*c == ' ' || *c == '\t')
+         c++;
+      if (*c++ != '#')
+         continue;
+      while (*c == ' ' || *c == '\t')
+         c++;
+      if (strncmp(c, "include", 7) != 0)
+         continue;
+      c += 7;
+      while (*c == ' ' || *c == '\t')
+         c++;
+      const char *end = *c == '"' ? strchr(c + 1, '"') : NULL;
+      if (!end || memchr(c, '\n', end - c))
+         continue;
+
+      // resolve like the compiler: next to the includer first, then -Iinclude
+      char header[512];
+      size_t size = 0;
+      char *header_text = NULL;
+      int name_len = (int)(end - c - 1);
+      if (dir_len)
+         snprintf(header, sizeof(header), "%.*s/%.*s", dir_len, path, name_len, c + 1);
+      else
+         snprintf(header, sizeof(header), "%.*s", name_len, c + 1);
+      if (access(header, R_OK) != 0)
+         snprintf(header, sizeof(header), "include/%.*s", name_len, c + 1);
+
+      int known = 0;
+      for (int i = 0; i < *seen_count && !known; i++)
+         known = strcmp(seen[i], header) == 0;
+      if (known || *seen_count >= MAX_HEADERS || !(header_text = read_source(header, &size)))
+         continue;
+      seen[(*seen_count)++] = strdup(header);
+      watch_path(header);
+      hash = hash_bytes(hash_text(hash, header), header_text, size);
+      hash = hash_includes(hash, header, header_text, seen, seen_count);
+      free(header_text);
+   }
+   return hash;
+}
+// Cache key of one translation unit
+uint64_t source_key(const char *src, const char *text, size_t size) {
+   char *seen[MAX_HEADERS];
+   int seen_count = 0;
+   uint64_t hash = hash_text(hash_text(hash_text(FNV_OFFSET, compiler()), compile_flags()), src);
+   hash = hash_includes(hash_bytes(hash, text, size), src, text, seen, &seen_count);
+   for (int i = 0; i < seen_count; i++)
+      free(seen[i]);
+   return hash;
+}
+// Remove cached artifacts of the same source and kind that no longer match its key
+void prune_stale(const char *artifact) {
+   const char *name = strrchr(artifact, '/') ? strrchr(artifact, '/') + 1 : artifact;
+   const char *dash = strrchr(name, '-');
+   DIR *dir = opendir(BUILD_DIR);
+   if (!dash || !dir) {
+      if (dir)
+         closedir(dir);
+      return;
+   }
+   size_t prefix = (size_t)(dash - name) + 1;
+   const char *suffix = dash + 1 + 16;
+   for (struct dirent *entry; (entry = readdir(dir));) {
+      size_t len = strlen(entry->d_name);
+      if (len != strlen(name) || strncmp(entry->d_name, name, prefix) != 0 || strcmp(entry->d_name + (suffix - name), suffix) != 0 ||
+          strcmp(entry->d_name, name) == 0)
+         continue;
+      char stale[512];
+      snprintf(stale, sizeof(stale), "%s/%s", BUILD_DIR, entry->d_name);
+      remove(stale);
+      fdebugf(stdout, cli.log_level, DBG_DEBUG, "Pruned: %s\n", stale);
+   }
+   closedir(dir);
+}
+// Detect dependencies
+void detect_dependencies(const char *src, const char *text, const char **deps, int *dep_count) {
    fdebugf(stdout, cli.log_level, DBG_INFO, "Building dependency list for source: %s\n", src);
-   // iterate lines
+   // iterate lines of the text already read for the cache key
    char line[256];
    *dep_count = 0;
-   while (fgets(line, sizeof(line), file) && *dep_count < MAX_DEPS) {
+   for (const char *next = text; *next && *dep_count < MAX_DEPS;) {
+      const char *eol = strchr(next, '\n');
+      size_t line_len = eol ? (size_t)(eol - next) : strlen(next);
+      snprintf(line, sizeof(line), "%.*s", (int)line_len, next);
+      next += eol ? line_len + 1 : line_len;
       // Check for *include directives with convention: "_hooks.h"
       if (strncmp(line, "#include", 8) == 0 && strstr(line, "_hooks.h")) {
          // Extract the filename from the line
@@ -291,7 +580,6 @@ void detect_dependencies(const char *src, const char **deps, int *dep_count) {
             if (len > (MAX_NAME_LEN - 5)) {
                fdebugf(stderr, cli.log_level, DBG_ERROR, "Dependency name length: %s (%zu bytes, max 123)\nUse `--cfg sigtest.json` configuration to specify depoendencies.",
                        start, len);
-               fclose(file);
                exit(1); // gracefully exit with warning
             }
 
@@ -303,7 +591,6 @@ void detect_dependencies(const char *src, const char **deps, int *dep_count) {
                fdebugf(stderr, cli.log_level, DBG_ERROR,
                        "Invalid hook dependency (no extension): %s. Use -c sigtest.json to specify dependencies.\n",
                        dep);
-               fclose(file);
                exit(1);
             }
 
@@ -356,78 +643,517 @@ void detect_dependencies(const char *src, const char **deps, int *dep_count) {
             fdebugf(stderr, cli.log_level, DBG_ERROR,
                     "Cannot find dependency: %s or %s for %s. Use -c sigtest.json to specify dependencies.\n",
                     src_dep, dep, line);
-            fclose(file);
             exit(1);
          }
       }
    }
 
    fdebugf(stdout, cli.log_level, DBG_INFO, "Dependency detection completed for %s: %d dependencies found\n", src, *dep_count);
-   fclose(file);
+}
+/*
+ * Build plan and jobs (`-t <file|dir|glob>`, `-J`, `--combined`)
+ * Every test source becomes a runner linked from its own object and its hook objects; with
+ * `--combined` all objects go into one runner instead. Objects shared between runners are
+ * compiled once. Compiles, links and runs each go through a pool of `-J` forked jobs; a job
+ * writes into its own log, which is printed whole when the job ends, so the output of
+ * concurrent suites never interleaves. A single job runs in place with live output.
+ */
+// Add a test source once
+static void add_source(const char *path) {
+   for (int i = 0; i < source_count; i++) {
+      if (strcmp(test_sources[i], path) == 0)
+         return;
+   }
+   test_sources = realloc(test_sources, (source_count + 1) * sizeof(*test_sources));
+   test_sources[source_count++] = strdup(path);
+}
+// Expand the -t paths: files as given, directories to their test_*.c, anything else as a glob
+int collect_sources(FILE *err_stream) {
+   for (int i = 0; i < cli.test_path_count; i++) {
+      const char *path = cli.test_paths[i];
+      char pattern[512];
+      struct stat st;
+      if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+         snprintf(pattern, sizeof(pattern), "%s/test_*.c", path);
+      } else if (strpbrk(path, "*?[")) {
+         snprintf(pattern, sizeof(pattern), "%s", path);
+      } else {
+         if (replanning && access(path, F_OK) != 0)
+            continue;
+         if (touch_file(path, err_stream) != 0)
+            return 1;
+         add_source(path);
+         continue;
+      }
+
+      glob_t found;
+      if (glob(pattern, 0, NULL, &found) != 0 || found.gl_pathc == 0) {
+         globfree(&found);
+         if (replanning)
+            continue;
+         fdebugf(err_stream, LOG_VERBOSE, DBG_ERROR, "No test sources match: '%s'\n", pattern);
+         return 1;
+      }
+      for (size_t j = 0; j < found.gl_pathc; j++) {
+         if (touch_file(found.gl_pathv[j], err_stream) != 0) {
+            globfree(&found);
+            return 1;
+         }
+         add_source(found.gl_pathv[j]);
+      }
+      globfree(&found);
+   }
+   if (cli.log_level == LOG_VERBOSE) {
+      fdebugf(stdout, cli.log_level, DBG_INFO, "Verified: %d test source(s)\n", source_count);
+   }
+   pending = realloc(pending, sizeof(int) * (source_count * (MAX_DEPS + 1) + 1));
+   return 0;
+}
+// Add an object to build; runners sharing a source and key share the object
+static int add_unit(const char *source, uint64_t key) {
+   char obj[256];
+   gen_filenames(source, key, obj, NULL, sizeof(obj));
+   for (int i = 0; i < unit_count; i++) {
+      if (strcmp(units[i].obj, obj) == 0)
+         return i;
+   }
+   units = realloc(units, (unit_count + 1) * sizeof(*units));
+   units[unit_count].source = source;
+   units[unit_count].key = key;
+   strcpy(units[unit_count].obj, obj);
+   return unit_count++;
+}
+// key of an executable linked from the given objects
+static uint64_t runner_key(const int *objs, int count) {
+   uint64_t key = hash_text(hash_text(FNV_OFFSET, compiler()), link_flags());
+   for (int i = 0; i < count; i++)
+      key = hash_bytes(key, &units[objs[i]].key, sizeof(units[objs[i]].key));
+   return key;
+}
+// Plan one test source: its hook dependencies, their objects and its runner
+int plan_suite(const char *src, FILE *err_stream) {
+   // the test source is read once: its dependencies and its cache key come from the same text
+   size_t size;
+   char *text = read_source(src, &size);
+   if (!text) {
+      fdebugf(err_stream, LOG_VERBOSE, DBG_ERROR, "Cannot open source file: %s\n", src);
+      return 1;
+   }
+   const char *sources[MAX_DEPS + 1] = {src};
+   int dep_count = 0;
+   detect_dependencies(src, text, sources + 1, &dep_count);
+
+   runners = realloc(runners, (runner_count + 1) * sizeof(*runners));
+   Runner *runner = &runners[runner_count++];
+   runner->source = src;
+   runner->units = malloc((dep_count + 1) * sizeof(int));
+   runner->unit_count = 0;
+   for (int i = 0; i <= dep_count; i++) {
+      char *unit_text = i == 0 ? text : read_source(sources[i], &size);
+      if (!unit_text) {
+         fdebugf(err_stream, LOG_VERBOSE, DBG_ERROR, "Cannot open source file: %s\n", sources[i]);
+         return 1;
+      }
+      uint64_t key = source_key(sources[i], unit_text, size);
+      watch_path(sources[i]);
+      free(unit_text);
+      runner->units[runner->unit_count++] = add_unit(sources[i], key);
+   }
+   gen_filenames(src, runner_key(runner->units, runner->unit_count), NULL, runner->exe, sizeof(runner->exe));
+   return 0;
+}
+// Replace the per-source runners with one linking every object
+void plan_combined(void) {
+   for (int i = 0; i < runner_count; i++)
+      free(runners[i].units);
+   runner_count = 1;
+   runners[0].source = "combined";
+   runners[0].units = malloc(unit_count * sizeof(int));
+   runners[0].unit_count = unit_count;
+   for (int i = 0; i < unit_count; i++)
+      runners[0].units[i] = i;
+   gen_filenames("combined", runner_key(runners[0].units, unit_count), NULL, runners[0].exe, sizeof(runners[0].exe));
+}
+int compile_job(int i) {
+   int unit = pending[i];
+   return compile_unit(units[unit].source, units[unit].obj, stderr);
+}
+int link_job(int i) {
+   const Runner *runner = &runners[pending[i]];
+   const char **objs = malloc(runner->unit_count * sizeof(*objs));
+   for (int j = 0; j < runner->unit_count; j++)
+      objs[j] = units[runner->units[j]].obj;
+   int ret = link_executable(objs, runner->unit_count, runner->exe, link_flags(), stderr);
+   if (ret == 0) {
+      fdebugf(stdout, cli.log_level, DBG_INFO, "Linked: source=`%s`, executable=`%s`\n", runner->source, runner->exe);
+   }
+   free(objs);
+   return ret;
+}
+int run_job(int i) {
+   return run_suite(runners[pending[i]].exe);
+}
+// Copy a finished job's log to stdout in one piece
+static void print_log(const char *log) {
+   FILE *file = fopen(log, "r");
+   if (file) {
+      char buffer[4096];
+      for (size_t n; (n = fread(buffer, 1, sizeof(buffer), file)) > 0;)
+         fwrite(buffer, 1, n, stdout);
+      fclose(file);
+   }
+   fflush(stdout);
+   remove(log);
+}
+// Run count jobs, cli.build_jobs at a time; returns the number that failed
+int run_jobs(int count, CliJob job, int *status) {
+   int failed = 0;
+   if (cli.build_jobs <= 1 || count <= 1) {
+      for (int i = 0; i < count; i++) {
+         int ret = job(i);
+         failed += ret != 0;
+         if (status)
+            status[i] = ret;
+      }
+      return failed;
+   }
+
+   pid_t *pids = calloc(count, sizeof(pid_t));
+   int next = 0, running = 0;
+   while (next < count || running > 0) {
+      while (running < cli.build_jobs && next < count) {
+         // children share what is still buffered; print it once from here
+         fflush(stdout);
+         fflush(stderr);
+         pid_t pid = fork();
+         if (pid == 0) {
+            char log[256];
+            snprintf(log, sizeof(log), "%s/st_job-%d.log", BUILD_DIR, getpid());
+            int fd = open(log, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd >= 0) {
+               dup2(fd, STDOUT_FILENO);
+               dup2(fd, STDERR_FILENO);
+               close(fd);
+            }
+            int ret = job(next);
+            fflush(stdout);
+            fflush(stderr);
+            _exit(ret != 0);
+         } else if (pid < 0) {
+            // no process to spare: run it here
+            int ret = job(next);
+            failed += ret != 0;
+            if (status)
+               status[next] = ret;
+            next++;
+            continue;
+         }
+         pids[next++] = pid;
+         running++;
+      }
+      if (running == 0)
+         continue;
+
+      int wstatus;
+      pid_t done = waitpid(-1, &wstatus, 0);
+      if (done < 0)
+         break;
+      int ret = !WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0;
+      for (int i = 0; i < next; i++) {
+         if (pids[i] == done) {
+            running--;
+            failed += ret;
+            if (status)
+               status[i] = ret;
+            char log[256];
+            snprintf(log, sizeof(log), "%s/st_job-%d.log", BUILD_DIR, done);
+            print_log(log);
+            break;
+         }
+      }
+   }
+   free(pids);
+   return failed;
+}
+// Run a job for each pending item and record each nonzero result against its item
+void run_pending(CliJob job, int *item_status) {
+   int *status = calloc(pending_count ? pending_count : 1, sizeof(int));
+   run_jobs(pending_count, job, status);
+   for (int i = 0; i < pending_count; i++)
+      item_status[pending[i]] |= status[i];
+   free(status);
+   pending_count = 0;
+}
+// Compile the objects that are not cached, then link the runners that are not
+void build_plan(int *unit_status, int *runner_status) {
+   for (int i = 0; i < unit_count; i++) {
+      if (access(units[i].obj, R_OK) == 0) {
+         fdebugf(stdout, cli.log_level, DBG_INFO, "Cached: source='%s', object='%s'\n", units[i].source, units[i].obj);
+      } else {
+         pending[pending_count++] = i;
+      }
+   }
+   run_pending(compile_job, unit_status);
+   for (int i = 0; i < runner_count; i++) {
+      // a runner missing an object is failed without linking or running
+      for (int j = 0; j < runners[i].unit_count; j++)
+         runner_status[i] |= unit_status[runners[i].units[j]];
+      if (runner_status[i]) {
+         continue;
+      } else if (access(runners[i].exe, X_OK) == 0) {
+         fdebugf(stdout, cli.log_level, DBG_INFO, "Cached: executable=`%s`\n", runners[i].exe);
+      } else {
+         pending[pending_count++] = i;
+      }
+   }
+   run_pending(link_job, runner_status);
 }
 // Generate filenames
-void gen_filenames(const char *src, char *obj, char *exe, size_t len) {
-   char basename[256];
+void gen_filenames(const char *src, uint64_t key, char *obj, char *exe, size_t len) {
    const char *name = strrchr(src, '/') ? strrchr(src, '/') + 1 : src;
-   snprintf(basename, sizeof(basename), "%s_%d", name, getpid());
-   snprintf(obj, len, "%s/st_%s.o", BUILD_DIR, basename);
+   if (obj) {
+      snprintf(obj, len, "%s/st_%s-%016" PRIx64 "%s", BUILD_DIR, name, key, cli.watch ? ".pic.o" : ".o");
+      fdebugf(stdout, cli.log_level, DBG_INFO, "Generated filenames: source='%s', object='%s'\n", src, obj);
+   }
    if (exe) {
-      snprintf(exe, len, "%s/st_%s.exe", BUILD_DIR, basename);
+      snprintf(exe, len, "%s/st_%s-%016" PRIx64 "%s", BUILD_DIR, name, key, cli.watch ? ".so" : ".exe");
+      fdebugf(stdout, cli.log_level, DBG_INFO, "Generated filenames: source='%s', executable='%s'\n", src, exe);
    }
+}
+// Compile one object; the caller has checked the cache
+int compile_unit(const char *source, const char *obj, FILE *err_stream) {
+   char cmd[1024], tmp[300];
+   snprintf(tmp, sizeof(tmp), "%s.%d.tmp", obj, getpid());
+   snprintf(cmd, sizeof(cmd), "%s -c %s %s -o %s", compiler(), source, compile_flags(), tmp);
    if (cli.log_level != LOG_NONE) {
-      fdebugf(stdout, cli.log_level, DBG_INFO, "Generated filenames: source='%s', object='%s', executable='%s'\n", src, obj, exe);
+      fdebugf(stdout, cli.log_level, DBG_INFO, "Compiling: command='%s'\n", cmd);
    }
-}
-// Compile the test suite
-int compile_suite(const char *sources[], int count, char *objs[], FILE *err_stream) {
-   for (int i = 0; i < count; i++) {
-      char cmd[512];
-      snprintf(cmd, sizeof(cmd), "%s -c %s -Iinclude -DSIGTEST_TEST -o %s",
-               getenv("CC") ? getenv("CC") : "gcc", sources[i], objs[i]);
-      if (cli.log_level != LOG_NONE) {
-         fdebugf(stdout, cli.log_level, DBG_INFO, "Compiling: command='%s'\n", cmd);
-      }
-      int ret = system(cmd);
-      if (ret != 0) {
-         fdebugf(err_stream, cli.log_level, DBG_ERROR, "Build failed: source='%s'\n", sources[i]);
-         return 1;
-      }
+   int ret = system(cmd);
+   if (ret != 0 || rename(tmp, obj) != 0) {
+      remove(tmp);
+      fdebugf(err_stream, cli.log_level, DBG_ERROR, "Build failed: source='%s'\n", source);
+      return 1;
    }
 
    return 0;
 }
 // Link the object files into an executable
 int link_executable(const char *objs[], int count, const char *exe, const char *linker_flags, FILE *err_stream) {
-   char cmd[512], obj_list[256] = "";
-   for (int i = 0; i < count; i++) {
-      strncat(obj_list, objs[i], sizeof(obj_list) - strlen(obj_list) - 1);
-      strncat(obj_list, " ", sizeof(obj_list) - strlen(obj_list) - 1);
-   }
-   snprintf(cmd, sizeof(cmd), "%s %s -o %s -lsigtest %s",
-            getenv("CC") ? getenv("CC") : "gcc", obj_list, exe, linker_flags ? linker_flags : "");
+   // a combined runner links every object, so the command is sized to fit
+   char tmp[300];
+   snprintf(tmp, sizeof(tmp), "%s.%d.tmp", exe, getpid());
+   size_t len = strlen(compiler()) + strlen(tmp) + (linker_flags ? strlen(linker_flags) : 0) + 32;
+   for (int i = 0; i < count; i++)
+      len += strlen(objs[i]) + 1;
+   char *cmd = malloc(len);
+   size_t used = snprintf(cmd, len, "%s ", compiler());
+   for (int i = 0; i < count; i++)
+      used += snprintf(cmd + used, len - used, "%s ", objs[i]);
+   snprintf(cmd + used, len - used, "-o %s -lsigtest %s", tmp, linker_flags ? linker_flags : "");
    if (cli.log_level != LOG_NONE) {
       fdebugf(stdout, cli.log_level, DBG_INFO, "Linking: %s\n", cmd);
    }
    int ret = system(cmd);
-   if (ret != 0) {
+   free(cmd);
+   if (ret != 0 || rename(tmp, exe) != 0) {
+      remove(tmp);
       fdebugf(err_stream, cli.log_level, DBG_ERROR, "Linking failed\n");
       return 1;
    }
 
    return 0;
 }
-// Run the test suite and clean up
-int run_and_cleanup(const char *exe, const char *obj) {
-   fdebugf(stdout, cli.log_level, DBG_INFO, "Running: %s\n", exe);
+// Check for a test runner flag: 1 if its value follows, -1 if it has none (or is `flag=value`), 0 if not one
+int runner_flag(const char *arg) {
+   for (int i = 0; RUNNER_FLAGS[i].flag; i++) {
+      size_t len = strlen(RUNNER_FLAGS[i].flag);
+      if (strcmp(arg, RUNNER_FLAGS[i].flag) == 0) {
+         return RUNNER_FLAGS[i].has_value ? 1 : -1;
+      }
+      if (RUNNER_FLAGS[i].has_value && strncmp(arg, RUNNER_FLAGS[i].flag, len) == 0 && arg[len] == '=') {
+         return -1;
+      }
+   }
 
-   int ret = system(exe);
-   if (!cli.no_clean) {
-      remove(obj);
-      remove(exe);
-      fdebugf(stdout, cli.log_level, DBG_INFO, "Cleaned: %s, %s\n", obj, exe);
+   return 0;
+}
+// Run one test suite; nonzero when it failed
+int run_suite(const char *exe) {
+   // forward the runner flags, single quoted for the shell
+   char cmd[2048];
+   size_t used = snprintf(cmd, sizeof(cmd), "%s", exe);
+   for (int i = 0; i < cli.runner_argc && used < sizeof(cmd); i++) {
+      used += snprintf(cmd + used, sizeof(cmd) - used, " '");
+      for (const char *c = cli.runner_args[i]; *c && used < sizeof(cmd); c++) {
+         used += snprintf(cmd + used, sizeof(cmd) - used, *c == '\'' ? "'\\''" : "%c", *c);
+      }
+      if (used < sizeof(cmd))
+         used += snprintf(cmd + used, sizeof(cmd) - used, "'");
+   }
+   if (used >= sizeof(cmd)) {
+      fdebugf(stderr, cli.log_level, DBG_ERROR, "Runner arguments too long\n");
+      return 1;
    }
+   fdebugf(stdout, cli.log_level, DBG_INFO, "Running: %s\n", cmd);
 
-   return ret;
+   return system(cmd) != 0;
+}
+
+/*
+ * Watch mode (`--watch`)
+ * Each runner is linked as a shared object and loaded into this process as a test module
+ * (`st_module_load`), and the directories of the sources and of every header they include are
+ * watched. After a change settles, the plan is rebuilt: only objects whose key moved are
+ * compiled, and each runner that relinks is reloaded in place of its old module and rerun. The
+ * other suites stay loaded and do not run. A test that crashes takes the watcher with it.
+ */
+typedef struct {
+   TestModule module;
+   char path[256]; /* Shared object the module was loaded from */
+} LoadedSuite;
+static LoadedSuite *loaded = NULL;
+static int loaded_count = 0;
+
+// Watch the directory holding path; a directory already watched keeps its watch
+void watch_path(const char *path) {
+   if (watch_fd < 0)
+      return;
+   char dir[512];
+   const char *slash = strrchr(path, '/');
+   if (slash)
+      snprintf(dir, sizeof(dir), "%.*s", (int)(slash - path), path);
+   else
+      snprintf(dir, sizeof(dir), ".");
+   if (inotify_add_watch(watch_fd, dir, WATCH_EVENTS) < 0)
+      fdebugf(stderr, cli.log_level, DBG_WARNING, "Cannot watch directory: %s (%s)\n", dir, strerror(errno));
+}
+// Block until a C source or header changes, then until the writes have settled
+static int wait_for_change(void) {
+   char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+   int changed = 0;
+   while (!changed || poll(&(struct pollfd){.fd = watch_fd, .events = POLLIN}, 1, WATCH_SETTLE_MS) > 0) {
+      ssize_t len = read(watch_fd, buffer, sizeof(buffer));
+      if (len < 0 && errno == EINTR)
+         continue;
+      if (len <= 0) {
+         fdebugf(stderr, LOG_VERBOSE, DBG_ERROR, "Watch failed: %s\n", strerror(errno));
+         return 1;
+      }
+      const struct inotify_event *event;
+      for (char *next = buffer; next < buffer + len; next += sizeof(*event) + event->len) {
+         event = (const struct inotify_event *)next;
+         const char *ext = event->len ? strrchr(event->name, '.') : NULL;
+         changed |= ext && (strcmp(ext, ".c") == 0 || strcmp(ext, ".h") == 0);
+      }
+   }
+   return 0;
+}
+// Load a runner's module in place of the one loaded before and run its sets
+static int reload_suite(int i) {
+   TestModule module = st_module_load(runners[i].exe, loaded[i].module);
+   if (!module)
+      return 1;
+   loaded[i].module = module;
+   snprintf(loaded[i].path, sizeof(loaded[i].path), "%s", runners[i].exe);
+   fdebugf(stdout, cli.log_level, DBG_INFO, "Loaded: source=`%s`, module=`%s`\n", runners[i].source, runners[i].exe);
+   return st_module_run(module);
+}
+// Drop the test sources deleted since the last plan, unloading their suites
+static void drop_missing_sources(void) {
+   int kept = 0, kept_suites = 0;
+   for (int i = 0; i < source_count; i++) {
+      // a combined runner has one suite for every source; it relinks without the deleted ones
+      int suite = !cli.combined && i < loaded_count;
+      if (access(test_sources[i], F_OK) != 0) {
+         if (suite)
+            st_module_unload(loaded[i].module);
+         free((char *)test_sources[i]);
+         continue;
+      }
+      if (suite)
+         loaded[kept_suites++] = loaded[i];
+      test_sources[kept++] = test_sources[i];
+   }
+   if (!cli.combined)
+      loaded_count = kept_suites;
+   source_count = kept;
+}
+// Plan again from the sources on disk; the sources found before keep their runner index
+static int replan(void) {
+   for (int i = 0; i < runner_count; i++)
+      free(runners[i].units);
+   runner_count = unit_count = 0;
+   drop_missing_sources();
+   replanning = 1;
+   int ret = collect_sources(stderr);
+   replanning = 0;
+   if (ret != 0)
+      return 1;
+   for (int i = 0; i < source_count; i++) {
+      if (plan_suite(test_sources[i], stderr) != 0)
+         return 1;
+   }
+   if (cli.combined)
+      plan_combined();
+   loaded = realloc(loaded, runner_count * sizeof(*loaded));
+   for (; loaded_count < runner_count; loaded_count++)
+      loaded[loaded_count] = (LoadedSuite){0};
+   return 0;
+}
+// Run every suite that built, then rebuild and rerun the suites a change touches until stopped
+int watch_suites(const int *runner_status) {
+   // the runner flags apply to this process now
+   char *args[MAX_RUNNER_ARGS + 1] = {"stest"};
+   for (int i = 0; i < cli.runner_argc; i++)
+      args[i + 1] = (char *)cli.runner_args[i];
+   if (parse_runner_args(cli.runner_argc + 1, args) != 0)
+      return 1;
+
+   loaded = calloc(runner_count, sizeof(*loaded));
+   loaded_count = runner_count;
+   for (int i = 0; i < runner_count; i++) {
+      if (!runner_status[i])
+         reload_suite(i);
+   }
+   for (;;) {
+      fdebugf(stdout, cli.log_level, DBG_INFO, "Watching %d suite(s) for changes...\n", runner_count);
+      if (wait_for_change() != 0)
+         return 1;
+      struct timespec start, end;
+      clock_gettime(CLOCK_MONOTONIC, &start);
+
+      // the plan is rebuilt silently; compiles, links and the runs still report
+      LogLevel level = cli.log_level;
+      cli.log_level = LOG_NONE;
+      int ret = replan();
+      cli.log_level = level;
+      if (ret != 0)
+         continue;
+      int *unit_status = calloc(unit_count ? unit_count : 1, sizeof(int));
+      int *status = calloc(runner_count ? runner_count : 1, sizeof(int));
+      build_plan(unit_status, status);
+
+      int rerun = 0, failed = 0;
+      for (int i = 0; i < runner_count; i++) {
+         if (status[i]) {
+            failed++;
+         } else if (strcmp(loaded[i].path, runners[i].exe) != 0) {
+            failed += reload_suite(i) != 0;
+            rerun++;
+         }
+      }
+      if (!cli.no_clean) {
+         for (int i = 0; i < unit_count; i++)
+            prune_stale(units[i].obj);
+         for (int i = 0; i < runner_count; i++)
+            prune_stale(runners[i].exe);
+      }
+      free(unit_status);
+      free(status);
+      clock_gettime(CLOCK_MONOTONIC, &end);
+      double ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+      fdebugf(stdout, cli.log_level, DBG_INFO, "Rerun: %d suite(s), %d failed, in %.1f ms\n", rerun, failed, ms);
+   }
 }
 
 // Debug logging function
@@ -31,6 +31,8 @@
 #include <stdio.h>
 
 #define MAX_TEMPLATE_LEN 64
+#define MAX_RUNNER_ARGS 32
+#define MAX_TEST_PATHS 64
 
 // Output log levels
 typedef enum {
@@ -48,16 +50,24 @@ typedef struct
       DONE,
       ERROR,
       IGNORE,
+      RUNNER_ARG,
+      BUILD_JOBS,
    } state;
    enum {
       DEFAULT,
       SIMPLE,
       VERSION,
    } mode;
-   const char *test_src;
+   const char *test_paths[MAX_TEST_PATHS]; // test sources, directories or globs given with -t
+   int test_path_count;
+   int build_jobs; // concurrent compile, link and run jobs
+   int combined;   // link every test into one runner
+   int watch;      // keep running: rebuild changed tests and rerun them in place
    int no_clean;
    LogLevel log_level;
    DebugLevel debug_level;
+   const char *runner_args[MAX_RUNNER_ARGS]; // forwarded to the test executable
+   int runner_argc;
 } CliState;
 
 /**
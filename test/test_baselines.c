@@ -0,0 +1,85 @@
+// test_baselines.c
+#include "sigtest.h"
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Test set for benchmark baselines (`--bench-baseline`).
+ * The constructor writes a baseline in which `slow` used to take 1 ns and `steady` 1 s, so
+ * `slow` must regress (and fail) while `steady` must not; `fresh` has no baseline entry yet.
+ */
+#define BASELINE_FILE "logs/test_baselines.baseline"
+#define BASELINE_SAMPLES 50
+
+// mirrors the baseline file layout written by the runner
+typedef struct {
+   char magic[4];
+   uint32_t version;
+   uint32_t count;
+   uint32_t sample_capacity;
+} baseline_header;
+typedef struct {
+   char key[128];
+   uint64_t iterations;
+   uint64_t samples;
+   double median_ns;
+   double ns_per_op;
+   double sample_ns[BASELINE_SAMPLES];
+} baseline_entry;
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_baselines.log", "w");
+}
+static void write_entry(FILE *file, const char *key, double ns) {
+   baseline_entry entry = {.iterations = 1, .samples = BASELINE_SAMPLES, .median_ns = ns, .ns_per_op = ns};
+   strncpy(entry.key, key, sizeof(entry.key) - 1);
+   for (int i = 0; i < BASELINE_SAMPLES; i++)
+      entry.sample_ns[i] = ns;
+   fwrite(&entry, sizeof(entry), 1, file);
+}
+// benchmarks
+static void bench_work(void) {
+   volatile unsigned sum = 0;
+   for (unsigned i = 0; i < 512; i++)
+      sum += i;
+}
+// test cases
+static void test_slow_regressed(void) {
+   const st_bench_stats *stats = st_bench_result(st_case_at(0));
+   Assert.isTrue(stats->regressed, "slow should be reported as regressed");
+   Assert.isTrue(stats->baseline_ns == 1.0, "Expected the 1 ns baseline, got %.3f", stats->baseline_ns);
+   Assert.isTrue(stats->p_value < 0.01, "Expected a significant slowdown, got p=%.4f", stats->p_value);
+}
+static void test_steady_kept(void) {
+   const st_bench_stats *stats = st_bench_result(st_case_at(1));
+   Assert.isFalse(stats->regressed, "steady is faster than its baseline");
+   Assert.isTrue(stats->p_value > 0.5, "Expected no slowdown, got p=%.4f", stats->p_value);
+}
+static void test_fresh_unbaselined(void) {
+   const st_bench_stats *stats = st_bench_result(st_case_at(2));
+   Assert.isFalse(stats->regressed, "fresh has nothing to regress against");
+   Assert.isTrue(stats->baseline_ns == 0.0, "fresh should have no baseline");
+}
+
+// Register test cases
+__attribute__((constructor)) void init_baseline_tests(void) {
+   FILE *file = fopen(BASELINE_FILE, "wb");
+   if (file) {
+      baseline_header header = {.version = 1, .count = 2, .sample_capacity = BASELINE_SAMPLES};
+      memcpy(header.magic, "STBL", 4);
+      fwrite(&header, sizeof(header), 1, file);
+      // entries are sorted by key
+      write_entry(file, "baselines/slow", 1.0);
+      write_entry(file, "baselines/steady", 1000000000.0);
+      fclose(file);
+   }
+   runner_options.bench_baseline = BASELINE_FILE;
+
+   testset("baselines", set_config, NULL);
+   bench_testcase("slow", bench_work);
+   bench_testcase("steady", bench_work);
+   bench_testcase("fresh", bench_work);
+   testcase("slow_regressed", test_slow_regressed);
+   testcase("steady_kept", test_steady_kept);
+   testcase("fresh_unbaselined", test_fresh_unbaselined);
+}
@@ -0,0 +1,68 @@
+// test_bench.c
+#include "sigtest.h"
+#include <time.h>
+
+/*
+ * Test set for benchmark cases (`bench_testcase`).
+ * The benchmark runs calibration, warmup and timed samples; the case after it checks the
+ * reported statistics against the number of calls the function saw. A function just fast
+ * enough for all samples to fit the sampling budget must not record more than that.
+ */
+extern double get_elapsed_ms(ts_time *, ts_time *);
+
+static size_t sum_calls = 0;
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_bench.log", "w");
+}
+// benchmarks
+static void bench_sum(void) {
+   volatile unsigned sum = 0;
+   for (unsigned i = 0; i < 256; i++)
+      sum += i;
+   sum_calls++;
+}
+// slow enough to shorten the warmup, fast enough for more samples than are kept to fit
+static void bench_slow(void) {
+   struct timespec pause = {0, 39000000};
+   nanosleep(&pause, NULL);
+}
+// test cases
+static void test_bench_stats(void) {
+   const st_bench_stats *stats = st_bench_result(st_case_at(0));
+   Assert.isNotNull((object)stats, "Benchmark statistics should be recorded");
+
+   Assert.isTrue(stats->samples == 50, "Expected 50 samples, got %zu", stats->samples);
+   Assert.isTrue(stats->iterations > 0, "Expected a calibrated iteration count");
+   Assert.isTrue(sum_calls >= stats->iterations * (stats->samples + 3),
+                 "Expected at least %zu calls, got %zu", stats->iterations * (stats->samples + 3), sum_calls);
+   Assert.isTrue(stats->min_ns <= stats->median_ns && stats->median_ns <= stats->p99_ns,
+                 "Expected min <= median <= p99, got %.1f / %.1f / %.1f", stats->min_ns, stats->median_ns, stats->p99_ns);
+   Assert.isTrue(stats->ns_per_op > 0 && stats->stddev_ns >= 0, "Expected positive timings");
+   Assert.isTrue(stats->sample_ns[0] >= stats->min_ns, "Samples should be kept in run order");
+}
+static void test_not_a_bench(void) {
+   Assert.isNull((object)st_bench_result(st_case_at(1)), "A plain test case has no benchmark statistics");
+}
+static void test_slow_bench_stats(void) {
+   const st_bench_stats *stats = st_bench_result(st_case_at(4));
+   Assert.isNotNull((object)stats, "Benchmark statistics should be recorded");
+   Assert.isTrue(stats->samples == 50, "Expected the samples to be capped at 50, got %zu", stats->samples);
+   Assert.isTrue(stats->min_ns >= 39e6, "Expected at least 39 ms per call, got %.0f ns", stats->min_ns);
+}
+static void test_elapsed_over_seconds(void) {
+   ts_time start = {1, 900000000}, end = {3, 100000000};
+   double elapsed = get_elapsed_ms(&start, &end);
+   Assert.isTrue(elapsed > 1199.999 && elapsed < 1200.001, "Expected 1200 ms, got %.3f", elapsed);
+}
+
+// Register test cases
+__attribute__((constructor)) void init_bench_tests(void) {
+   testset("bench", set_config, NULL);
+   bench_testcase("sum", bench_sum);
+   testcase("bench_stats", test_bench_stats);
+   testcase("not_a_bench", test_not_a_bench);
+   testcase("elapsed_over_seconds", test_elapsed_over_seconds);
+   bench_testcase("slow", bench_slow);
+   testcase("slow_bench_stats", test_slow_bench_stats);
+}
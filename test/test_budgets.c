@@ -0,0 +1,112 @@
+// test_budgets.c
+#include "sigtest.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Test sets for resource budgets (budget_testcase, budget_testset).
+ * Each over-budget case must be aborted in place and reported as TIMEOUT or OVERBUDGET. Sets
+ * run newest first, so the results set registered first reads them back from the registry
+ * once the others have run. The churn cases allocate in a loop until their wall budget runs
+ * out, repeatedly, so the budget signal often lands inside the memory wrappers; they must
+ * still unwind without leaving a lock held. The aborted cases are the failures of this run.
+ */
+#define CHURN_CASES 20
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_budgets.log", "w");
+}
+// test cases - budgets
+static void test_hangs(void) {
+   for (volatile int spin = 1; spin;)
+      ;
+}
+static void test_burns_cpu(void) {
+   volatile unsigned long sum = 0;
+   for (;;)
+      sum += 1;
+}
+static void test_allocates(void) {
+   for (int i = 0; i < 100; i++)
+      free(malloc(16));
+   Assert.fail("The 11th allocation should have been over budget");
+}
+static void test_grows_heap(void) {
+   void *small = malloc(1024);
+   void *large = malloc(1 << 20);
+   free(large);
+   free(small);
+   Assert.fail("The large allocation should have been over budget");
+}
+static void test_within_budget(void) {
+   void *block = malloc(64);
+   Assert.isNotNull(block, "Allocation within budget should succeed");
+   free(block);
+}
+// test cases - set budget
+static void test_sleeps(void) {
+   nanosleep(&(struct timespec){5, 0}, NULL);
+}
+// test cases - allocation churn
+static void test_churns(void) {
+   for (;;) {
+      void *block = malloc(64);
+      block = realloc(block, 128);
+      free(calloc(4, 16));
+      free(block);
+   }
+}
+// test cases - results
+static void test_reports_results(void) {
+   static const struct {
+      TestState state;
+      const char *message;
+   } expected[] = {
+       {TIMEOUT, "Timeout: exceeded the 50 ms wall time budget"},
+       {TIMEOUT, "Timeout: exceeded the 30 ms CPU time budget"},
+       {OVERBUDGET, "Over budget: more than 10 allocations"},
+       {OVERBUDGET, "Over budget: "},
+       {PASS, NULL},
+       {TIMEOUT, "Timeout: exceeded the 40 ms wall time budget"},
+   };
+   for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+      TcInfo info = st_case_at(i + 1);
+      Assert.isTrue(info->result.state == expected[i].state, "`%s`: expected state %d, got %d", info->name,
+                    expected[i].state, info->result.state);
+      if (expected[i].message)
+         Assert.isTrue(info->result.message && strncmp(info->result.message, expected[i].message, strlen(expected[i].message)) == 0,
+                       "`%s`: unexpected message '%s'", info->name, info->result.message);
+   }
+   for (int i = 0; i < CHURN_CASES; i++) {
+      TcInfo info = st_case_at(7 + i);
+      Assert.isTrue(info->result.state == TIMEOUT, "`%s` #%d: expected a timeout, got %d", info->name, i,
+                    info->result.state);
+   }
+}
+
+// Register test cases
+__attribute__((constructor)) void init_budget_tests(void) {
+   testset("budgets_results", NULL, NULL);
+   testcase("reports_results", test_reports_results);
+
+   testset("budgets", set_config, NULL);
+   testcase("hangs", test_hangs);
+   budget_testcase((st_budget){.wall_ms = 50});
+   testcase("burns_cpu", test_burns_cpu);
+   budget_testcase((st_budget){.cpu_ms = 30});
+   testcase("allocates", test_allocates);
+   budget_testcase((st_budget){.allocs = 10});
+   testcase("grows_heap", test_grows_heap);
+   budget_testcase((st_budget){.heap_bytes = 64 * 1024});
+   testcase("within_budget", test_within_budget);
+   budget_testcase((st_budget){.wall_ms = 1000, .allocs = 10, .heap_bytes = 4096});
+
+   testset("budgets_set", NULL, NULL);
+   budget_testset((st_budget){.wall_ms = 40});
+   testcase("sleeps", test_sleeps);
+
+   testset("budgets_churn", NULL, NULL);
+   budget_testset((st_budget){.wall_ms = 10, .heap_bytes = 1 << 30});
+   for (int i = 0; i < CHURN_CASES; i++)
+      testcase("churns", test_churns);
+}
@@ -0,0 +1,102 @@
+// test_bulk_asserts.c
+#include "sigtest.h"
+#include <math.h>
+#include <string.h>
+
+/*
+ * Test set for the bulk assertions (`arrayEqual`, `arrayWithin`, `memEqual`).
+ * Equal arrays of every length up to a few vector widths must pass, so the kernels neither
+ * read past the end nor skip the tail. The `*_mismatch` cases fail on purpose; `messages`
+ * checks that each one names the first mismatch and shows the values around it.
+ */
+#define LARGE_COUNT (1 << 20)
+#define LARGE_BAD 777777
+
+static int large_expected[LARGE_COUNT];
+static int large_actual[LARGE_COUNT];
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_bulk_asserts.log", "w");
+}
+// test cases
+static void test_equal_arrays(void) {
+   Assert.arrayEqual(large_expected, large_actual, LARGE_COUNT, INT, "Large arrays should match");
+
+   double a[100], b[100];
+   unsigned char bytes[100], copy[100];
+   for (int i = 0; i < 100; i++) {
+      a[i] = i / 3.0;
+      b[i] = a[i] + 1e-12;
+      bytes[i] = copy[i] = (unsigned char)i;
+   }
+   for (size_t n = 0; n <= 100; n++) {
+      Assert.arrayWithin(a, b, n, DOUBLE, 1e-9, "Length %zu", n);
+      Assert.memEqual(bytes, copy, n, "Length %zu", n);
+   }
+   float f[3] = {INFINITY, -0.0f, 1.5f}, g[3] = {INFINITY, 0.0f, 1.5f};
+   Assert.arrayEqual(f, g, 3, FLOAT, "Equal infinities and signed zeros should match");
+}
+static void test_string_arrays(void) {
+   char first[] = "alpha";
+   const char *expected[] = {"alpha", "beta", "gamma"};
+   const char *actual[] = {first, "beta", "gamma"};
+   Assert.arrayEqual(expected, actual, 3, STRING, "String arrays compare by content");
+}
+static void test_int_mismatch(void) {
+   large_actual[LARGE_BAD] = -1;
+   Assert.arrayEqual(large_expected, large_actual, LARGE_COUNT, INT, "frame %d", 7);
+}
+static void test_tail_mismatch(void) {
+   double expected[37], actual[37];
+   for (int i = 0; i < 37; i++)
+      expected[i] = actual[i] = i * 0.25;
+   actual[36] += 0.01;
+   Assert.arrayWithin(expected, actual, 37, DOUBLE, 0.001, NULL);
+}
+static void test_mem_mismatch(void) {
+   unsigned char expected[100], actual[100];
+   for (int i = 0; i < 100; i++)
+      expected[i] = actual[i] = (unsigned char)i;
+   actual[50] = 0xff;
+   Assert.memEqual(expected, actual, sizeof(expected), NULL);
+}
+static void test_nan_mismatch(void) {
+   float expected[8] = {NAN}, actual[8] = {NAN};
+   Assert.arrayEqual(expected, actual, 8, FLOAT, NULL);
+}
+static void test_messages(void) {
+   const char *expected[] = {
+       "Arrays differ at index 777777 of 1048576\n"
+       "    expected [777773]: 777773 777774 777775 777776 <777777> 777778 777779 777780 777781\n"
+       "    actual   [777773]: 777773 777774 777775 777776 <-1> 777778 777779 777780 777781\n"
+       "    - frame 7",
+       "Arrays differ by more than 0.001 at index 36 of 37\n"
+       "    expected [32]: 8 8.25 8.5 8.75 <9>\n"
+       "    actual   [32]: 8 8.25 8.5 8.75 <9.01>",
+       "Memory differs at byte 50 of 100\n"
+       "    expected [42]: 2a 2b 2c 2d 2e 2f 30 31 <32> 33 34 35 36 37 38 39 3a\n"
+       "    actual   [42]: 2a 2b 2c 2d 2e 2f 30 31 <ff> 33 34 35 36 37 38 39 3a",
+       "Arrays differ at index 0 of 8\n"
+       "    expected [0]: <nan> 0 0 0 0\n"
+       "    actual   [0]: <nan> 0 0 0 0",
+   };
+   for (size_t i = 0; i < 4; i++) {
+      const char *message = st_case_at(2 + i)->result.message;
+      Assert.isTrue(message && strcmp(message, expected[i]) == 0, "Unexpected message for case %zu:\n%s", 2 + i, message);
+   }
+}
+
+// Register test cases
+__attribute__((constructor)) void init_bulk_assert_tests(void) {
+   for (int i = 0; i < LARGE_COUNT; i++)
+      large_expected[i] = large_actual[i] = i;
+
+   testset("bulk_asserts", set_config, NULL);
+   testcase("equal_arrays", test_equal_arrays);
+   testcase("string_arrays", test_string_arrays);
+   testcase("int_mismatch", test_int_mismatch);
+   testcase("tail_mismatch", test_tail_mismatch);
+   testcase("mem_mismatch", test_mem_mismatch);
+   testcase("nan_mismatch", test_nan_mismatch);
+   testcase("messages", test_messages);
+}
@@ -0,0 +1,93 @@
+// test_capture.c
+#include "sigtest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Test sets for captured output (`--capture-fds`). The capture set writes through every
+ * captured channel; the check set, registered first so it runs last, reads the set log back:
+ * only the failing cases may have left output there. The two failing cases are the failures
+ * of this run.
+ */
+#define CAPTURE_LOG_FILE "logs/test_capture.log"
+#define SPILL_LINES 2048 // well past the 64 KiB ring
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen(CAPTURE_LOG_FILE, "w");
+}
+// test cases - capture
+static void test_passes_quietly(void) {
+   DebugLogger.log("quiet: first");
+   printf("quiet: stdout\n");
+   fprintf(stderr, "quiet: stderr\n");
+   DebugLogger.debug(DBG_INFO, stdout, "quiet: debug\n");
+   DebugLogger.log("quiet: last");
+}
+static void test_fails_loudly(void) {
+   DebugLogger.log("loud: first");
+   printf("loud: stdout\n");
+   fprintf(stderr, "loud: stderr\n");
+   DebugLogger.debug(DBG_INFO, stdout, "loud: debug\n");
+   DebugLogger.log("loud: last");
+   Assert.fail("The captured output should be written");
+}
+static void test_spills(void) {
+   for (int i = 0; i < SPILL_LINES; i++)
+      DebugLogger.log("spill: line %04d of output long enough to outgrow the capture ring", i);
+   DebugLogger.log("spill: last");
+   Assert.fail("The spilled output should be written");
+}
+// test cases - check
+static char *read_log(void) {
+   FILE *in = fopen(CAPTURE_LOG_FILE, "r");
+   if (!in)
+      return NULL;
+   static char data[512 * 1024];
+   size_t size = fread(data, 1, sizeof(data) - 1, in);
+   fclose(in);
+   data[size] = '\0';
+   return data;
+}
+static void test_passing_output_discarded(void) {
+   char *log = read_log();
+   Assert.isNotNull(log, "The capture log should exist");
+   Assert.isTrue(strstr(log, "Running: passes_quietly") != NULL, "The passing case should still be reported");
+   Assert.isTrue(strstr(log, "quiet:") == NULL, "Output of a passing case should be discarded");
+}
+static void test_failing_output_written(void) {
+   char *log = read_log();
+   Assert.isNotNull(log, "The capture log should exist");
+   // stdout is buffered by stdio, so only the unbuffered stderr line may run ahead of it
+   const char *lines[] = {"  - loud: first", "loud: stdout", "[INFO] loud: debug", "  - loud: last"};
+   const char *at = log;
+   for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++) {
+      const char *found = strstr(at, lines[i]);
+      Assert.isTrue(found != NULL, "'%s' should follow the previous output", lines[i]);
+      at = found;
+   }
+   Assert.isTrue(strstr(log, "loud: stderr") != NULL, "Output to stderr should be captured");
+}
+static void test_spilled_output_written(void) {
+   char *log = read_log();
+   Assert.isNotNull(log, "The capture log should exist");
+   const char *first = strstr(log, "spill: line 0000 ");
+   const char *last = strstr(log, "  - spill: last");
+   Assert.isTrue(first && last && first < last, "Spilled output should be written in order");
+   Assert.isTrue(strstr(log, "spill: line 2047 ") != NULL, "No spilled line should be lost");
+}
+
+// Register test cases
+__attribute__((constructor)) void init_capture_tests(void) {
+   runner_options.capture = CAPTURE_FDS;
+
+   testset("capture_check", NULL, NULL);
+   testcase("passing_output_discarded", test_passing_output_discarded);
+   testcase("failing_output_written", test_failing_output_written);
+   testcase("spilled_output_written", test_spilled_output_written);
+
+   testset("capture", set_config, NULL);
+   testcase("passes_quietly", test_passes_quietly);
+   testcase("fails_loudly", test_fails_loudly);
+   testcase("spills", test_spills);
+}
@@ -0,0 +1,62 @@
+// test_fast_asserts.c
+#include "sigtest.h"
+#include <string.h>
+
+/*
+ * Test set for the assertion pass path and the inline `ST_ASSERT_*` checks.
+ * Passing checks must not touch the failure buffer; failing ones compose the check and
+ * the user message there. `int_message` and `empty_message` fail on purpose and are
+ * inspected by `messages`.
+ */
+#define CHECK_COUNT 1000000
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_fast_asserts.log", "w");
+}
+// test cases
+static void test_passes(void) {
+   int value = 0;
+   const char *name = "sigma";
+   for (int i = 0; i < CHECK_COUNT; i++) {
+      ST_ASSERT_TRUE(i >= 0, "index %d", i);
+      ST_ASSERT_FALSE(i < 0);
+      ST_ASSERT_EQ_INT(i, value++);
+      ST_ASSERT_NOT_NULL(name);
+      ST_ASSERT_WITHIN(i * 0.5, 0.0, CHECK_COUNT / 2.0, "half of %d", i);
+      Assert.isTrue(i == value - 1, "index %d", i);
+      Assert.areEqual(&i, &(int){value - 1}, INT, "index %d", i);
+   }
+   ST_ASSERT_EQ_STR("sigma", name);
+   ST_ASSERT_EQ_PTR(name, name);
+   ST_ASSERT_NULL(NULL);
+}
+static void test_int_message(void) {
+   int pushes = 3;
+   ST_ASSERT_EQ_INT(4, pushes + 2, "after %d pushes", pushes);
+}
+static void test_empty_message(void) {
+   int value = 0;
+   Assert.isNull(&value, "%s", "");
+}
+static void test_long_not_equal(void) {
+   long a = 1L << 40, b = 1L << 41;
+   Assert.areNotEqual(&a, &b, LONG, "Distinct longs should differ");
+}
+static void test_messages(void) {
+   const char *message = st_case_at(1)->result.message;
+   Assert.isTrue(message && strcmp(message, "Expected 4, but was 5\n    - after 3 pushes") == 0,
+                 "Unexpected inline message '%s'", message);
+   message = st_case_at(2)->result.message;
+   Assert.isTrue(message && strcmp(message, "Pointer is not NULL") == 0,
+                 "An empty user message should leave the check alone, got '%s'", message);
+}
+
+// Register test cases
+__attribute__((constructor)) void init_fast_assert_tests(void) {
+   testset("fast_asserts", set_config, NULL);
+   testcase("passes", test_passes);
+   testcase("int_message", test_int_message);
+   testcase("empty_message", test_empty_message);
+   testcase("long_not_equal", test_long_not_equal);
+   testcase("messages", test_messages);
+}
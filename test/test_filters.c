@@ -0,0 +1,63 @@
+// test_filters.c
+#include "sigtest.h"
+
+/*
+ * Test sets for case selection (`--filter`, `--tag`).
+ * Only cases named `selected*` that carry the `fast` tag (directly or through their set) and
+ * not the `slow` tag may run; sets without a selected case must never be configured.
+ */
+static int skipped_config_count = 0;
+static int skipped_setup_count = 0;
+static int skipped_cleanup_count = 0;
+
+//	test set config and cleanup
+static void skipped_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_filters_skipped.log", "w");
+   skipped_config_count++;
+}
+static void skipped_cleanup(void) {
+   skipped_cleanup_count++;
+}
+static void skipped_setup(void) {
+   skipped_setup_count++;
+}
+// test cases
+static void test_selected_by_set_tag(void) {
+   Assert.isTrue(skipped_config_count == 0, "Skipped set config should not run, got %d", skipped_config_count);
+   Assert.isTrue(skipped_setup_count == 0, "Skipped set setup should not run, got %d", skipped_setup_count);
+}
+static void test_selected_by_case_tag(void) {
+   Assert.isTrue(skipped_cleanup_count == 0, "Skipped set cleanup should not run, got %d", skipped_cleanup_count);
+}
+static void test_selected_by_regex_free_glob(void) {
+   Assert.isTrue(1, "Matched by the case name alone");
+}
+static void test_not_selected(void) {
+   Assert.fail("This case should have been filtered out");
+}
+
+// Register test cases
+__attribute__((constructor)) void init_filters_tests(void) {
+   runner_options.filter = "selected*";
+   runner_options.tags = "fast, !slow";
+
+   testset("filters_tagged_set", NULL, NULL);
+   tag_testset("fast");
+   testcase("selected_by_set_tag", test_selected_by_set_tag);
+   testcase("selected_but_slow", test_not_selected);
+   tag_testcase("slow");
+   testcase("unselected_name", test_not_selected);
+
+   testset("filters_skipped_set", skipped_config, skipped_cleanup);
+   setup_testcase(skipped_setup);
+   DebugLogger.log("Logged at registration; dropped with the skipped set");
+   testcase("selected_untagged", test_not_selected);
+
+   testset("filters_case_tags", NULL, NULL);
+   testcase("selected_by_case_tag", test_selected_by_case_tag);
+   tag_testcase("fast,integration");
+   testcase("selected_by_glob", test_selected_by_regex_free_glob);
+   tag_testcase("fast");
+   testcase("selected_other_tag", test_not_selected);
+   tag_testcase("integration");
+}
@@ -0,0 +1,96 @@
+// test_fixtures.c
+#include "sigtest.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Test sets for fixtures (`testfixture`, `fixture_testcase`, `fixture_testset`, `st_fixture`).
+ * Each fixture must be built once, on first request, and torn down right after its last
+ * declared user; a declared fixture no case asks for is never built. The check set,
+ * registered first, runs last and reads back the event sequence.
+ */
+static char events[512];
+static Fixture snapshot, decoded, unused;
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_fixtures.log", "a");
+}
+static void event(const char *name) {
+   strncat(events, name, sizeof(events) - strlen(events) - 2);
+   strcat(events, ",");
+}
+// fixtures
+static object build_snapshot(void) {
+   event("+snapshot");
+   int *rows = malloc(sizeof(int));
+   *rows = 42;
+   return rows;
+}
+static void drop_snapshot(object value) {
+   event("-snapshot");
+   free(value);
+}
+static object build_decoded(void) {
+   event("+decoded");
+   return "decoded asset";
+}
+static void drop_decoded(object value) {
+   (void)value;
+   event("-decoded");
+}
+static object build_unused(void) {
+   event("+unused");
+   return NULL;
+}
+// test cases - set fixture
+static void test_first_user(void) {
+   event("a1");
+   int *rows = st_fixture(snapshot);
+   Assert.isTrue(*rows == 42, "Snapshot should hold 42 rows, got %d", *rows);
+}
+static void test_no_fixture(void) {
+   event("a2");
+}
+static void test_last_user(void) {
+   event("a3");
+   int *rows = st_fixture(snapshot);
+   Assert.isTrue(*rows == 42, "Snapshot should be shared, got %d rows", *rows);
+   Assert.isTrue(strcmp(st_fixture(decoded), "decoded asset") == 0, "Decoded asset should be built");
+}
+static void test_after_users(void) {
+   event("a4");
+}
+// test cases - process fixture
+static void test_shared(void) {
+   event("b1");
+   Assert.isTrue(strcmp(st_fixture(decoded), "decoded asset") == 0, "Decoded asset should be shared across sets");
+}
+// test cases - check
+static void test_events(void) {
+   const char *expected = "a1,+snapshot,a2,a3,+decoded,-snapshot,a4,b1,-decoded,";
+   Assert.isTrue(strcmp(events, expected) == 0, "Expected '%s', got '%s'", expected, events);
+}
+
+// Register test cases
+__attribute__((constructor)) void init_fixture_tests(void) {
+   testset("fixtures_check", set_config, NULL);
+   testcase("events", test_events);
+
+   decoded = testfixture("decoded", FIXTURE_PROCESS, build_decoded, drop_decoded);
+
+   testset("fixtures_shared", set_config, NULL);
+   fixture_testset(decoded);
+   testcase("shared", test_shared);
+
+   testset("fixtures_set", set_config, NULL);
+   snapshot = testfixture("snapshot", FIXTURE_SET, build_snapshot, drop_snapshot);
+   unused = testfixture("unused", FIXTURE_SET, build_unused, NULL);
+   testcase("first_user", test_first_user);
+   fixture_testcase(snapshot);
+   fixture_testcase(unused);
+   testcase("no_fixture", test_no_fixture);
+   testcase("last_user", test_last_user);
+   fixture_testcase(snapshot);
+   fixture_testcase(decoded);
+   testcase("after_users", test_after_users);
+}
@@ -0,0 +1,70 @@
+// test_fuzz_engine.c
+#include "fuzzing.h"
+#include "sigtest.h"
+#include <limits.h>
+#include <string.h>
+
+/*
+ * Test set for the coverage guided fuzzing engine (`--fuzz-runs`, FUZZ_BUFFER).
+ * This file is built with `-fsanitize-coverage=trace-pc`. The magic input is only found by
+ * keeping inputs that pass one more comparison than before; a blind search of 1000000 runs
+ * would need about 2^32. The failing input must be reported, and skipped inputs must not fail.
+ */
+#define FUZZ_RUNS 1000000
+
+static int int_calls = 0;
+static int short_inputs = 0;
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_fuzz_engine.log", "w");
+}
+// fuzz cases
+static void fuzz_magic(void *param) {
+   const FuzzBuffer *input = param;
+   if (input->size >= 4 && input->data[0] == 'F') {
+      if (input->data[1] == 'U') {
+         if (input->data[2] == 'Z') {
+            if (input->data[3] == 'Z') {
+               Assert.fail("Found the magic prefix");
+            }
+         }
+      }
+   }
+}
+static void fuzz_reject_short(void *param) {
+   const FuzzBuffer *input = param;
+   if (input->size < 2) {
+      short_inputs++;
+      Assert.skip("Input too short");
+   }
+   Assert.isTrue(input->data + input->size > input->data, "Input should not be empty");
+}
+static void fuzz_int_budget(void *param) {
+   int value = *(int *)param;
+   int_calls++;
+   Assert.isTrue(value <= INT_MAX, "Value should fit an int");
+}
+// checks
+static void test_magic_reported(void) {
+   TcInfo magic = st_case_at(0);
+   Assert.isTrue(magic->result.state == FAIL, "The magic input should have been found");
+   Assert.isNotNull(strstr(magic->result.message, "46 55 5a 5a"), "Failing input should be reported: %s",
+                    magic->result.message);
+}
+static void test_runs_counted(void) {
+   Assert.isTrue(st_case_at(1)->result.state == PASS, "Skipped inputs should not fail the case");
+   Assert.isTrue(short_inputs > 0, "Short inputs should have been generated");
+   Assert.isTrue(int_calls == FUZZ_RUNS, "Expected %d runs, got %d", FUZZ_RUNS, int_calls);
+}
+
+// Register test cases
+__attribute__((constructor)) void init_fuzz_engine_tests(void) {
+   runner_options.fuzz_runs = FUZZ_RUNS;
+
+   testset("fuzz_engine", set_config, NULL);
+   fuzz_testcase("magic", fuzz_magic, FUZZ_BUFFER);
+   fuzz_testcase("reject_short", fuzz_reject_short, FUZZ_BUFFER);
+   fuzz_testcase("int_budget", fuzz_int_budget, FUZZ_INT);
+   testcase("magic_reported", test_magic_reported);
+   testcase("runs_counted", test_runs_counted);
+}
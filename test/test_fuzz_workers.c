@@ -0,0 +1,76 @@
+// test_fuzz_workers.c
+#include "fuzzing.h"
+#include "sigtest.h"
+#include <stdatomic.h>
+#include <string.h>
+
+/*
+ * Test set for fuzz engine worker threads (`--fuzz-jobs`, `--fuzz-crashes`).
+ * This file is built with `-fsanitize-coverage=trace-pc`. Four workers share the budget
+ * exactly, and the failing input found by any of them is saved with a reproducer command.
+ */
+#define FUZZ_RUNS 1000000
+#define CRASH_DIR "logs/fuzz_crashes"
+
+static atomic_int int_calls = 0;
+static atomic_int int_negatives = 0;
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_fuzz_workers.log", "w");
+}
+// fuzz cases
+static void fuzz_magic(void *param) {
+   const FuzzBuffer *input = param;
+   if (input->size >= 4 && input->data[0] == 'F') {
+      if (input->data[1] == 'U') {
+         if (input->data[2] == 'Z') {
+            if (input->data[3] == 'Z') {
+               Assert.fail("Found the magic prefix");
+            }
+         }
+      }
+   }
+}
+static void fuzz_int_budget(void *param) {
+   Assert.isNotNull(param, "Each run should get an input");
+   atomic_fetch_add(&int_calls, 1);
+   atomic_fetch_add(&int_negatives, *(int *)param < 0);
+}
+// checks
+static void test_crash_saved(void) {
+   TcInfo magic = st_case_at(0);
+   Assert.isTrue(magic->result.state == FAIL, "The magic input should have been found");
+   const char *saved = strstr(magic->result.message, "saved " CRASH_DIR "/crash-fuzz_workers-magic-");
+   Assert.isNotNull((object)saved, "Crash file should be reported: %s", magic->result.message);
+   Assert.isNotNull((object)strstr(saved, "--filter 'fuzz_workers/magic' --fuzz-replay " CRASH_DIR "/"),
+                    "Reproducer should be reported: %s", saved);
+
+   char path[256];
+   sscanf(saved + strlen("saved "), "%255[^,]", path);
+   FILE *file = fopen(path, "rb");
+   Assert.isNotNull(file, "Crash file %s should exist", path);
+   char data[4] = {0};
+   size_t length = fread(data, 1, sizeof(data), file);
+   fclose(file);
+   Assert.isTrue(length == 4 && memcmp(data, "FUZZ", 4) == 0, "Crash file should hold the failing input");
+}
+static void test_budget_shared(void) {
+   Assert.isTrue(atomic_load(&int_calls) == FUZZ_RUNS, "Expected %d runs, got %d", FUZZ_RUNS, atomic_load(&int_calls));
+   // mutated inputs cover both signs, not one value replayed by every worker
+   int negatives = atomic_load(&int_negatives);
+   Assert.isTrue(negatives > 0 && negatives < FUZZ_RUNS, "Expected inputs of both signs, got %d negative of %d",
+                 negatives, FUZZ_RUNS);
+}
+
+// Register test cases
+__attribute__((constructor)) void init_fuzz_worker_tests(void) {
+   runner_options.fuzz_runs = FUZZ_RUNS;
+   runner_options.fuzz_jobs = 4;
+   runner_options.fuzz_crash_dir = CRASH_DIR;
+
+   testset("fuzz_workers", set_config, NULL);
+   fuzz_testcase("magic", fuzz_magic, FUZZ_BUFFER);
+   fuzz_testcase("int_budget", fuzz_int_budget, FUZZ_INT);
+   testcase("crash_saved", test_crash_saved);
+   testcase("budget_shared", test_budget_shared);
+}
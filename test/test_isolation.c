@@ -0,0 +1,73 @@
+// test_isolation.c
+#include "sigtest.h"
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/*
+ * Test sets for process isolation (`--isolate`).
+ * Every case runs in a pre-forked worker; crashes and exits must be reported as failures
+ * and must not take down the runner or the cases that follow. The sets run on parallel runner
+ * threads (`--jobs`), each of which must be bound to a worker of its own.
+ */
+static pid_t runner_pid = 0;
+static int setup_count = 0;
+
+//	test case setup
+static void iso_setup(void) {
+   setup_count++;
+}
+// test cases
+static void test_runs_in_worker(void) {
+   Assert.isTrue(getpid() != runner_pid, "Test should not run in the runner process");
+   Assert.isTrue(setup_count == 1, "Setup should run in the worker, got %d", setup_count);
+}
+static void test_segfault(void) {
+   volatile int *ptr = NULL;
+   *ptr = 42;
+}
+static void test_after_crash(void) {
+   Assert.isTrue(getpid() != runner_pid, "Worker should be replaced after a crash");
+   Assert.isTrue(setup_count == 1, "Replacement worker should start fresh, got %d", setup_count);
+}
+static void test_exit(void) {
+   exit(3);
+}
+static void test_abort(void) {
+   abort();
+}
+static void test_fail_message(void) {
+   Assert.isTrue(0, "Failures are reported back from the worker");
+}
+static void test_skip(void) {
+   Assert.skip("Skipped in the worker");
+}
+static void test_parallel_in_worker(void) {
+   // keep every runner thread busy, so each set is taken by a different one
+   usleep(20000);
+   Assert.isTrue(getpid() != runner_pid, "Parallel sets should not run in the runner process");
+}
+
+// Register test cases
+__attribute__((constructor)) void init_isolation_tests(void) {
+   runner_options.isolate = 1;
+   runner_options.jobs = 3;
+   runner_pid = getpid();
+
+   char *parallel_sets[] = {"isolation_jobs_a", "isolation_jobs_b", "isolation_jobs_c"};
+   for (int i = 0; i < 3; i++) {
+      testset(parallel_sets[i], NULL, NULL);
+      testcase("parallel_in_worker", test_parallel_in_worker);
+      testcase("parallel_in_worker_again", test_parallel_in_worker);
+   }
+
+   testset("isolation_set", NULL, NULL);
+   setup_testcase(iso_setup);
+   testcase("runs_in_worker", test_runs_in_worker);
+   fail_testcase("segfault", test_segfault);
+   testcase("after_crash", test_after_crash);
+   fail_testcase("exit", test_exit);
+   fail_testcase("abort", test_abort);
+   fail_testcase("fail_message", test_fail_message);
+   testcase("skip", test_skip);
+}
@@ -8,8 +8,9 @@
  * format.
  */
 static void set_config(FILE **log_stream) {
-   // initialize the log stream
-   *log_stream = fopen("reports/json_hooks.json", "w");
+   // initialize the log stream; a sharded run writes one report per shard
+   char path[256];
+   *log_stream = fopen(st_shard_path("reports/json_hooks.json", path, sizeof(path)), "w");
 }
 
 void hooks_test_true(void) { Assert.isTrue(1 == 1, "1 should equal 1"); }
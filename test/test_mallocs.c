@@ -1,5 +1,6 @@
 // tests/test_memory_checks.c
 #include "sigtest.h"
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -7,6 +8,12 @@ static void set_config(FILE **log_stream) {
   *log_stream = fopen("logs/test_mallocs.log", "w");
 }
 
+extern size_t _sigtest_alloc_count;
+extern size_t _sigtest_free_count;
+extern int _sigtest_alloc_slot(void);
+static size_t allocs_before = 0;
+static size_t frees_before = 0;
+
 // === Freebie Memory Allocations Tracking (always on) ===
 static void test_basic_global_leak_detection(void) {
   void *p = malloc(100);
@@ -18,14 +25,93 @@ static void test_basic_clean_run(void) {
   free(p);
   // Should be clean
 }
+static void test_calloc_realloc(void) {
+  allocs_before = _sigtest_alloc_count;
+  frees_before = _sigtest_free_count;
+  int *values = calloc(4, sizeof(int));
+  values = realloc(values, 64 * sizeof(int)); // a move is neither a malloc nor a free
+  char *grown = realloc(NULL, 32);            // same as malloc
+  free(values);
+  free(grown);
+}
+static void test_calloc_realloc_counted(void) {
+  Assert.isTrue(_sigtest_alloc_count - allocs_before == 2,
+                "Expected 2 mallocs from calloc/realloc, got %zu", _sigtest_alloc_count - allocs_before);
+  Assert.isTrue(_sigtest_free_count - frees_before == 2,
+                "Expected 2 frees, got %zu", _sigtest_free_count - frees_before);
+}
+
+// === Allocations made on threads owned by the code under test ===
+#define ALLOC_THREADS 4
+#define ALLOCS_PER_THREAD 1000
+
+static void *alloc_worker(void *arg) {
+  (void)arg;
+  for (int i = 0; i < ALLOCS_PER_THREAD; i++) {
+    free(malloc(16));
+  }
+  return NULL;
+}
+static void test_threaded_allocations(void) {
+  pthread_t threads[ALLOC_THREADS];
+  allocs_before = _sigtest_alloc_count;
+  frees_before = _sigtest_free_count;
+  for (int i = 0; i < ALLOC_THREADS; i++) {
+    pthread_create(&threads[i], NULL, alloc_worker, NULL);
+  }
+  for (int i = 0; i < ALLOC_THREADS; i++) {
+    pthread_join(threads[i], NULL);
+  }
+}
+static void test_threaded_counts_exact(void) {
+  size_t expected = ALLOC_THREADS * ALLOCS_PER_THREAD;
+  Assert.isTrue(_sigtest_alloc_count - allocs_before == expected,
+                "Expected %zu mallocs from worker threads, got %zu", expected, _sigtest_alloc_count - allocs_before);
+  Assert.isTrue(_sigtest_free_count - frees_before == expected,
+                "Expected %zu frees from worker threads, got %zu", expected, _sigtest_free_count - frees_before);
+}
+// === Counter slots are recycled when their threads exit ===
+#define SLOT_THREADS 200 // well past the 64 slots
+#define SHARED_SLOT 64
+
+static void *slot_worker(void *arg) {
+  free(malloc(16));
+  *(int *)arg = _sigtest_alloc_slot();
+  return NULL;
+}
+static void test_slots_recycled(void) {
+  allocs_before = _sigtest_alloc_count;
+  frees_before = _sigtest_free_count;
+  for (int i = 0; i < SLOT_THREADS; i++) {
+    int slot = -1;
+    pthread_t thread;
+    pthread_create(&thread, NULL, slot_worker, &slot);
+    pthread_join(thread, NULL);
+    Assert.isTrue(slot >= 0 && slot != SHARED_SLOT, "Thread %d should get a private slot, got %d", i, slot);
+  }
+}
+static void test_recycled_counts_exact(void) {
+  // counted while a thread exits: its slot hands them over before it is reused
+  Assert.isTrue(_sigtest_alloc_count - allocs_before == SLOT_THREADS,
+                "Expected %d mallocs from exited threads, got %zu", SLOT_THREADS, _sigtest_alloc_count - allocs_before);
+  Assert.isTrue(_sigtest_free_count - frees_before == SLOT_THREADS,
+                "Expected %d frees from exited threads, got %zu", SLOT_THREADS, _sigtest_free_count - frees_before);
+}
 
 __attribute__((constructor)) void init_memory_tests(void) {
   // we could add a feature later to throw on leaks, but for now just log them
+  runner_options.track_leaks = 1;
   testset("Memory Allocations Report", set_config, NULL);
 
   // Basic always-on checks
   testcase("Basic: Global leak detection", test_basic_global_leak_detection);
   testcase("Basic: Clean run", test_basic_clean_run);
+  testcase("Basic: calloc and realloc", test_calloc_realloc);
+  testcase("Basic: calloc and realloc are counted", test_calloc_realloc_counted);
+  testcase("Threads: Allocations on worker threads", test_threaded_allocations);
+  testcase("Threads: Per-thread counts are exact", test_threaded_counts_exact);
+  testcase("Threads: Slots of exited threads are reused", test_slots_recycled);
+  testcase("Threads: Counts of exited threads are kept", test_recycled_counts_exact);
 
   /*
      Reports at the end of each test set ...
@@ -0,0 +1,170 @@
+// test_order.c
+#include "sigtest.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Test sets for the run order (`--order`, `--seed`, `--history`).
+ * Runs failed-first on a seeded history: the failing set moves ahead of the plain set, and
+ * its cases run longest failing streak first, the rest in registration order. The check set,
+ * registered first, runs last in either order and reads back the sequence.
+ *
+ * The other orders need a run of their own. The checks run this binary again with
+ * ST_ORDER_CHILD set, which registers the child sets instead; the child prints the sequence
+ * it ran as it exits and rewrites its own seeded history.
+ */
+#define HISTORY_FILE "logs/test_order.history"
+#define CHILD_HISTORY "logs/test_order_child.history"
+
+static char sequence[256];
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_order.log", "a");
+}
+static void ran(const char *name) {
+   strncat(sequence, name, sizeof(sequence) - strlen(sequence) - 2);
+   strcat(sequence, ",");
+}
+// test cases - failing set
+static void test_first(void) { ran("first"); }
+static void test_recent(void) { ran("recent"); }
+static void test_streak(void) { ran("streak"); }
+static void test_last(void) { ran("last"); }
+// test cases - plain set
+static void test_plain(void) { ran("plain"); }
+// test cases - child sets
+static void test_quick(void) {
+   ran("quick");
+   Assert.fail("quick keeps failing");
+}
+static void test_slow(void) { ran("slow"); }
+static void test_mid(void) { ran("mid"); }
+static void test_solo(void) { ran("solo"); }
+static void print_sequence(void) {
+   printf("sequence: %s\n", sequence);
+}
+// run this binary on the child sets with a freshly seeded history; false if it did not report
+static int run_child(const char *args, char *out, size_t size) {
+   FILE *history = fopen(CHILD_HISTORY, "w");
+   if (!history)
+      return 0;
+   // sets by total: child_a 71ms, child_b 30ms; `gone` is not registered and must be kept
+   fprintf(history, "# set/case\tms fails\nchild_a/mid\t20.000 0\nchild_a/quick\t1.000 2\nchild_a/slow\t50.000 0\n"
+                    "child_b/solo\t30.000 1\ngone/case\t7.000 2\n");
+   fclose(history);
+
+   char exe[PATH_MAX], command[PATH_MAX + 256], line[512];
+   ssize_t len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+   if (len <= 0)
+      return 0;
+   exe[len] = '\0';
+   snprintf(command, sizeof(command), "ST_ORDER_CHILD=1 '%s' --history " CHILD_HISTORY " %s 2>/dev/null", exe, args);
+   FILE *child = popen(command, "r");
+   if (!child)
+      return 0;
+   out[0] = '\0';
+   int found = 0;
+   while (fgets(line, sizeof(line), child)) {
+      if (strncmp(line, "sequence: ", 10) == 0) {
+         snprintf(out, size, "%s", line + 10);
+         out[strcspn(out, "\n")] = '\0';
+         found = 1;
+      }
+   }
+   pclose(child);
+   return found;
+}
+// read the recorded duration and failing streak of one case from the child history
+static int history_entry(const char *name, double *ms, int *fails) {
+   FILE *history = fopen(CHILD_HISTORY, "r");
+   if (!history)
+      return 0;
+   char line[512];
+   int found = 0;
+   size_t length = strlen(name);
+   while (!found && fgets(line, sizeof(line), history))
+      found = strncmp(line, name, length) == 0 && line[length] == '\t' && sscanf(line + length, "%lf %d", ms, fails) == 2;
+   fclose(history);
+   return found;
+}
+// test cases - check
+static void test_failed_first(void) {
+   const char *expected = "streak,recent,first,last,plain,";
+   Assert.isTrue(strcmp(sequence, expected) == 0, "Expected '%s', ran '%s'", expected, sequence);
+}
+static void test_registered(void) {
+   char ran_order[256];
+   Assert.isTrue(run_child("--order registered", ran_order, sizeof(ran_order)), "The child run should report");
+   // newest set first, cases as registered; the history is not read
+   const char *expected = "solo,quick,slow,mid,";
+   Assert.isTrue(strcmp(ran_order, expected) == 0, "Expected '%s', ran '%s'", expected, ran_order);
+}
+static void test_longest_first(void) {
+   char ran_order[256];
+   Assert.isTrue(run_child("--order longest-first", ran_order, sizeof(ran_order)), "The child run should report");
+   const char *expected = "slow,mid,quick,solo,";
+   Assert.isTrue(strcmp(ran_order, expected) == 0, "Expected '%s', ran '%s'", expected, ran_order);
+}
+static void test_random_seeded(void) {
+   char first[256], again[256];
+   Assert.isTrue(run_child("--order random --seed 42", first, sizeof(first)), "The child run should report");
+   Assert.isTrue(run_child("--order random --seed 42", again, sizeof(again)), "The child run should report");
+   Assert.isTrue(strcmp(first, again) == 0, "The same seed should replay '%s', ran '%s'", first, again);
+   Assert.isTrue(strlen(first) == strlen("solo,quick,slow,mid,"), "Every case should run once, ran '%s'", first);
+   const char *names[] = {"quick,", "slow,", "mid,", "solo,"};
+   for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+      Assert.isNotNull((object)strstr(first, names[i]), "'%s' should have run, ran '%s'", names[i], first);
+}
+static void test_history_saved(void) {
+   char ran_order[256];
+   Assert.isTrue(run_child("--order longest-first", ran_order, sizeof(ran_order)), "The child run should report");
+   double ms;
+   int fails;
+   Assert.isTrue(history_entry("child_a/quick", &ms, &fails) && fails == 3, "A failure should extend the streak to 3");
+   Assert.isTrue(history_entry("child_b/solo", &ms, &fails) && fails == 0, "A pass should end the streak");
+   Assert.isTrue(history_entry("child_a/slow", &ms, &fails) && ms < 50.0, "The duration should be the last run's, got %.3f", ms);
+   Assert.isTrue(history_entry("gone/case", &ms, &fails) && ms == 7.0 && fails == 2,
+                 "A case that did not run should keep its entry");
+}
+
+// Register test cases
+__attribute__((constructor)) void init_order_tests(void) {
+   if (getenv("ST_ORDER_CHILD")) {
+      atexit(print_sequence);
+      testset("child_a", NULL, NULL);
+      testcase("quick", test_quick);
+      testcase("slow", test_slow);
+      testcase("mid", test_mid);
+
+      testset("child_b", NULL, NULL);
+      testcase("solo", test_solo);
+      return;
+   }
+   FILE *history = fopen(HISTORY_FILE, "w");
+   if (history) {
+      fprintf(history, "# set/case\tms fails\norder_failing/recent\t5.000 1\norder_failing/streak\t5.000 3\n"
+                       "order_plain/plain\t90.000 0\n");
+      fclose(history);
+   }
+   runner_options.order = ORDER_FAILED_FIRST;
+   runner_options.history = HISTORY_FILE;
+
+   testset("order_check", set_config, NULL);
+   testcase("failed_first", test_failed_first);
+   testcase("registered", test_registered);
+   testcase("longest_first", test_longest_first);
+   testcase("random_seeded", test_random_seeded);
+   testcase("history_saved", test_history_saved);
+
+   testset("order_failing", set_config, NULL);
+   testcase("first", test_first);
+   testcase("recent", test_recent);
+   testcase("streak", test_streak);
+   testcase("last", test_last);
+
+   testset("order_plain", set_config, NULL);
+   testcase("plain", test_plain);
+}
@@ -0,0 +1,71 @@
+// test_parallel.c
+#include "sigtest.h"
+#include <pthread.h>
+
+/*
+ * Test sets for parallel set execution (`--jobs`).
+ * Each set keeps its own counters; the runner must keep every set on one
+ * worker thread from SET_INIT through AFTER_SET.
+ */
+static int alpha_setup_count = 0;
+static int beta_setup_count = 0;
+static pthread_t alpha_thread;
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_parallel.log", "w");
+}
+//	test case setup
+static void alpha_setup(void) {
+   alpha_setup_count++;
+}
+static void beta_setup(void) {
+   beta_setup_count++;
+}
+// test cases - alpha set
+static void test_alpha_first(void) {
+   alpha_thread = pthread_self();
+   Assert.isTrue(alpha_setup_count == 1, "Alpha setup should be called once, got %d", alpha_setup_count);
+}
+static void test_alpha_second(void) {
+   Assert.isTrue(pthread_equal(alpha_thread, pthread_self()), "Alpha cases should run on the same worker");
+   Assert.isTrue(alpha_setup_count == 2, "Alpha setup should be called twice, got %d", alpha_setup_count);
+}
+static void test_alpha_fail(void) {
+   Assert.isTrue(0, "This failure should unwind on the worker thread");
+}
+// test cases - beta set
+static void test_beta_count(void) {
+   DebugLogger.log("beta debug output is captured per set");
+   Assert.isTrue(beta_setup_count == 1, "Beta setup should be called once, got %d", beta_setup_count);
+}
+static void test_beta_throws(void) {
+   Assert.throw("Thrown on a worker thread");
+}
+// test cases - gamma set
+static void test_gamma_skip(void) {
+   Assert.skip("Skipped on a worker thread");
+}
+static void test_gamma_equal(void) {
+   int expected = 42, actual = 42;
+   Assert.areEqual(&expected, &actual, INT, "%d should equal %d", expected, actual);
+}
+
+// Register test cases
+__attribute__((constructor)) void init_parallel_tests(void) {
+   runner_options.jobs = 3;
+
+   testset("parallel_alpha", set_config, NULL);
+   setup_testcase(alpha_setup);
+   testcase("alpha_first", test_alpha_first);
+   testcase("alpha_second", test_alpha_second);
+   fail_testcase("alpha_fail", test_alpha_fail);
+
+   testset("parallel_beta", NULL, NULL);
+   setup_testcase(beta_setup);
+   testcase("beta_count", test_beta_count);
+   testcase_throws("beta_throws", test_beta_throws);
+
+   testset("parallel_gamma", NULL, NULL);
+   testcase("gamma_skip", test_gamma_skip);
+   testcase("gamma_equal", test_gamma_equal);
+}
@@ -0,0 +1,85 @@
+// test_params.c
+#include "sigtest.h"
+#include <pthread.h>
+#include <string.h>
+
+/*
+ * Test set for parameterized test cases (`param_testcase`).
+ * Every row runs and is reported; one wrong row fails the case and is named in the message.
+ * With `jobs = 2` the rows of a large table are split across two threads.
+ */
+#define ROW_COUNT 200
+#define BAD_ROW 137
+
+typedef struct {
+   int a;
+   int b;
+   int sum;
+} sum_row;
+
+static sum_row sums[ROW_COUNT];
+static pthread_t row_threads[ROW_COUNT];
+static const int small_values[] = {1, 2, 3, 4, 5, 6};
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_params.log", "w");
+}
+static void format_sum(const void *row, char *buffer, size_t size) {
+   const sum_row *r = row;
+   snprintf(buffer, size, "%d + %d = %d", r->a, r->b, r->sum);
+}
+// parameterized cases
+static void test_sum(const void *row) {
+   const sum_row *r = row;
+   row_threads[r - sums] = pthread_self();
+   Assert.areEqual(&(int){r->a + r->b}, (object)&r->sum, INT, "Sum of row %td", r - sums);
+}
+static void test_skip_odd(const void *row) {
+   int value = *(const int *)row;
+   if (value % 2)
+      Assert.skip("Odd value %d", value);
+   Assert.isTrue(value % 2 == 0, "Value %d should be even", value);
+}
+// checks
+static void test_sum_results(void) {
+   const st_param_results *results = st_param_result(st_case_at(0));
+   Assert.isNotNull((object)results, "Sum case should have row results");
+   Assert.isTrue(results->passed == ROW_COUNT - 1 && results->failed == 1, "Expected %d passed and 1 failed, got %zu and %zu",
+                 ROW_COUNT - 1, results->passed, results->failed);
+   Assert.isTrue(results->rows[BAD_ROW].state == FAIL, "Row %d should have failed", BAD_ROW);
+   Assert.isTrue(results->rows[BAD_ROW - 1].state == PASS && !results->rows[BAD_ROW - 1].message,
+                 "Passing rows should carry no message");
+   const char *message = st_case_at(0)->result.message;
+   Assert.isNotNull(strstr(message, "[137] 137 + 1 = 0"), "Failed row should be named: %s", message);
+
+   char label[64];
+   Assert.isTrue(strcmp(st_param_label(results, 3, label, sizeof(label)), "3 + 1 = 4") == 0, "Unexpected label '%s'", label);
+}
+static void test_rows_split(void) {
+   int others = 0;
+   for (int i = 1; i < ROW_COUNT; i++)
+      others += !pthread_equal(row_threads[i], row_threads[0]);
+   Assert.isTrue(others > 0, "Rows should have run on more than one thread");
+}
+static void test_skipped_rows(void) {
+   const st_param_results *results = st_param_result(st_case_at(1));
+   Assert.isTrue(st_case_at(1)->result.state == PASS, "Skipped rows should not fail the case");
+   Assert.isTrue(results->passed == 3 && results->skipped == 3, "Expected 3 passed and 3 skipped, got %zu and %zu",
+                 results->passed, results->skipped);
+   char label[16];
+   Assert.isTrue(strcmp(st_param_label(results, 2, label, sizeof(label)), "#2") == 0, "Unexpected default label '%s'", label);
+}
+
+// Register test cases
+__attribute__((constructor)) void init_param_tests(void) {
+   for (int i = 0; i < ROW_COUNT; i++)
+      sums[i] = (sum_row){i, 1, i == BAD_ROW ? 0 : i + 1};
+   runner_options.jobs = 2;
+
+   testset("params", set_config, NULL);
+   param_testcase("sum", test_sum, sums, ROW_COUNT, sizeof(sum_row), format_sum);
+   param_testcase("skip_odd", test_skip_odd, small_values, 6, sizeof(int), NULL);
+   testcase("sum_results", test_sum_results);
+   testcase("rows_split", test_rows_split);
+   testcase("skipped_rows", test_skipped_rows);
+}
@@ -0,0 +1,63 @@
+// test/test_perf_hooks.c
+#include "hooks/perf_hooks.h"
+
+/*
+ * Test set for the hardware counter hooks (`perf_hooks_wrap`).
+ * The hooks wrap the default output. Hosts without a PMU available to the process (most
+ * containers and VMs) skip the counter checks; the run itself must be unaffected.
+ */
+static ST_Hooks hooks = NULL;
+static struct st_hooks_s other_hooks = {.name = "other"};
+static volatile unsigned long sink = 0;
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_perf_hooks.log", "w");
+}
+// test cases
+static void test_workload(void) {
+   unsigned long sum = 0;
+   for (unsigned long i = 0; i < 1000000; i++)
+      sum += i ^ (sum >> 3);
+   sink = sum;
+   Assert.isTrue(sink != 0, "The workload should produce a result");
+}
+static void test_counts_recorded(void) {
+   unsigned available = perf_hooks_available();
+   if (!(available & PERF_CYCLES))
+      Assert.skip("Hardware counters are unavailable on this host");
+   if (runner_options.isolate)
+      Assert.skip("Counters are not measured under --isolate");
+
+   const st_perf_counts *perf = &st_case_at(0)->perf;
+   Assert.isTrue(perf->valid & PERF_CYCLES, "Cycles should be measured");
+   Assert.isTrue(perf->cycles > 1000000, "A million iterations take more than a million cycles, got %llu",
+                 (unsigned long long)perf->cycles);
+   if (available & PERF_INSTRUCTIONS)
+      Assert.isTrue(perf->instructions > 1000000, "Expected more than a million instructions");
+}
+static void test_wraps_default(void) {
+   ST_Hooks defaults = init_hooks("default");
+   Assert.isTrue(hooks != defaults, "The perf hooks should be their own hook set");
+   Assert.isTrue(hooks->on_test_result == defaults->on_test_result, "Result output should be forwarded to the default hooks");
+   Assert.isTrue(hooks->context == defaults->context, "The default context should be used");
+   Assert.isTrue(st_case_at(2)->perf.valid == 0, "A running case has no counts yet");
+}
+static void test_wraps_one_set(void) {
+   Assert.isTrue(perf_hooks_wrap(NULL) == hooks, "Wrapping the same hooks again should return the perf hooks");
+   Assert.isNull(perf_hooks_wrap(&other_hooks), "A second hook set should be rejected");
+   Assert.isTrue(hooks->on_test_result == init_hooks("default")->on_test_result,
+                 "A rejected wrap should keep the wrapped hooks");
+}
+
+// Register test cases
+__attribute__((constructor)) void init_perf_hooks_tests(void) {
+   testset("perf_hooks", set_config, NULL);
+
+   hooks = perf_hooks_wrap(NULL);
+   register_hooks(hooks);
+
+   testcase("workload", test_workload);
+   testcase("counts_recorded", test_counts_recorded);
+   testcase("wraps_default", test_wraps_default);
+   testcase("wraps_one_set", test_wraps_one_set);
+}
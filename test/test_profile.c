@@ -0,0 +1,100 @@
+// test_profile.c
+#include "sigtest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Test sets for the sampling profiler (`--profile`). The profile set burns CPU in a named
+ * function, on the case thread and on pool threads; the check set, registered first so it
+ * runs last, reads the folded stacks back.
+ */
+#define PROFILE_DIR "logs/profile"
+#define SPIN_MS 200
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_profile.log", "w");
+}
+static double cpu_ms(void) {
+   struct timespec now;
+   clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+   return now.tv_sec * 1e3 + now.tv_nsec / 1e6;
+}
+__attribute__((noinline)) static double profile_spin(double ms) {
+   volatile double sum = 0;
+   for (double start = cpu_ms(); cpu_ms() - start < ms;)
+      for (int i = 0; i < 1000; i++)
+         sum += i * 0.5;
+   return sum;
+}
+static void pool_spin(size_t thread, object arg) {
+   (void)thread;
+   (void)arg;
+   profile_spin(SPIN_MS / 2);
+}
+// test cases - profile
+static void test_spins(void) {
+   profile_spin(SPIN_MS);
+}
+static void test_pool_spins(void) {
+   st_thread_pool(2, pool_spin, NULL, NULL);
+}
+static void test_returns(void) {
+   Assert.isTrue(1, "Too short to be sampled");
+}
+// test cases - check
+static void test_folded_stacks(void) {
+   FILE *in = fopen(PROFILE_DIR "/profile.spins.folded", "r");
+   Assert.isNotNull(in, "The profile of `spins` should be written");
+   static char line[8192];
+   size_t samples = 0, spinning = 0, lines = 0;
+   while (fgets(line, sizeof(line), in)) {
+      char *count = strrchr(line, ' ');
+      Assert.isTrue(count && strchr(line, '\n'), "Malformed line '%s'", line);
+      *count++ = '\0';
+      size_t n = strtoul(count, NULL, 10);
+      Assert.isTrue(n > 0, "Stack '%s' has no samples", line);
+      samples += n;
+      lines++;
+      // outermost frame first; static functions are named too
+      if (strstr(line, ";test_spins;profile_spin"))
+         spinning += n;
+   }
+   fclose(in);
+   // about one sample per millisecond of CPU time, or per tick of a kernel that ticks slower
+   Assert.isTrue(samples >= SPIN_MS / 10 && samples <= SPIN_MS + 10, "Expected up to %d samples, got %zu", SPIN_MS, samples);
+   Assert.isTrue(spinning * 10 >= samples * 9, "Expected most samples in profile_spin, got %zu of %zu", spinning, samples);
+   Assert.isTrue(lines < samples / 2, "Stacks through the same functions should be folded");
+}
+static void test_pool_threads_sampled(void) {
+   FILE *in = fopen(PROFILE_DIR "/profile.pool_spins.folded", "r");
+   Assert.isNotNull(in, "The profile of `pool_spins` should be written");
+   static char line[8192];
+   int pooled = 0;
+   while (fgets(line, sizeof(line), in))
+      pooled |= strstr(line, ";pool_spin;profile_spin") != NULL;
+   fclose(in);
+   Assert.isTrue(pooled, "Samples of the pool threads should be added to the profile of their case");
+}
+static void test_unsampled_not_written(void) {
+   FILE *in = fopen(PROFILE_DIR "/profile.returns.folded", "r");
+   if (in)
+      fclose(in);
+   Assert.isNull(in, "A case without samples should have no profile");
+}
+
+// Register test cases
+__attribute__((constructor)) void init_profile_tests(void) {
+   runner_options.profile = PROFILE_DIR;
+   remove(PROFILE_DIR "/profile.returns.folded");
+
+   testset("profile_check", NULL, NULL);
+   testcase("folded_stacks", test_folded_stacks);
+   testcase("pool_threads_sampled", test_pool_threads_sampled);
+   testcase("unsampled_not_written", test_unsampled_not_written);
+
+   testset("profile", set_config, NULL);
+   testcase("spins", test_spins);
+   testcase("pool_spins", test_pool_spins);
+   testcase("returns", test_returns);
+}
@@ -0,0 +1,68 @@
+// test_reports.c
+#include "sigtest.h"
+#include <string.h>
+
+/*
+ * Test set for the background report writer (`st_report_open`).
+ * Records must reach the serializer in push order, through more records than the ring holds,
+ * and note text must be copied so the producer may reuse its buffer.
+ */
+#define RECORD_COUNT 5000
+
+typedef struct {
+   size_t count;
+   size_t out_of_order;
+   char notes[64];
+} writer_state;
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_reports.log", "w");
+}
+// serializers - run on the writer thread
+static void count_records(const st_report_record *record, object data) {
+   writer_state *state = data;
+   if ((size_t)record->elapsed_ms != state->count)
+      state->out_of_order++;
+   state->count++;
+}
+static void collect_notes(const st_report_record *record, object data) {
+   writer_state *state = data;
+   if (record->kind == REPORT_NOTE)
+      strncat(state->notes, record->message, sizeof(state->notes) - strlen(state->notes) - 1);
+}
+// test cases
+static void test_records_in_order(void) {
+   writer_state state = {0};
+   ReportWriter writer = st_report_open(count_records, &state);
+   Assert.isNotNull(writer, "Report writer should start");
+
+   for (size_t i = 0; i < RECORD_COUNT; i++) {
+      st_report_push(writer, &(st_report_record){.kind = REPORT_CASE, .elapsed_ms = (double)i});
+   }
+   st_report_close(writer);
+
+   Assert.isTrue(state.count == RECORD_COUNT, "Expected %d records, got %zu", RECORD_COUNT, state.count);
+   Assert.isTrue(state.out_of_order == 0, "%zu records were serialized out of order", state.out_of_order);
+}
+static void test_notes_copied(void) {
+   writer_state state = {0};
+   ReportWriter writer = st_report_open(collect_notes, &state);
+   Assert.isNotNull(writer, "Report writer should start");
+
+   char note[16];
+   for (int i = 0; i < 3; i++) {
+      snprintf(note, sizeof(note), "note%d;", i);
+      st_report_push(writer, &(st_report_record){.kind = REPORT_NOTE, .message = note});
+   }
+   strcpy(note, "reused");
+   st_report_close(writer);
+
+   Assert.isTrue(strcmp(state.notes, "note0;note1;note2;") == 0, "Unexpected notes '%s'", state.notes);
+}
+
+// Register test cases
+__attribute__((constructor)) void init_report_tests(void) {
+   testset("reports", set_config, NULL);
+   testcase("records_in_order", test_records_in_order);
+   testcase("notes_copied", test_notes_copied);
+}
@@ -0,0 +1,54 @@
+// test_shards.c
+#include "sigtest.h"
+#include <string.h>
+
+/*
+ * Test set for sharding (`--shard-index`, `--shard-count`, `--shard-durations`).
+ * Runs shard 1 of 2 balanced by recorded durations: longest first onto the least loaded
+ * shard, with the unrecorded case counted as the mean (60ms). Shard 0 takes `slow` and `mid`;
+ * a count balanced split would have given shard 1 `mid` and `unknown` instead.
+ */
+#define DURATIONS_FILE "logs/test_shards.durations"
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_shards.log", "w");
+}
+// test cases
+static void test_slow(void) {
+   Assert.fail("slow (100ms) belongs to shard 0");
+}
+static void test_long(void) {
+   Assert.isTrue(1, "long (60ms) belongs to shard 1");
+}
+static void test_mid(void) {
+   Assert.fail("mid (50ms) belongs to shard 0");
+}
+static void test_short(void) {
+   char buffer[256];
+   const char *path = st_shard_path("reports/run.xml", buffer, sizeof(buffer));
+   Assert.isTrue(strcmp(path, "reports/run.shard-1.xml") == 0, "Expected reports/run.shard-1.xml, got %s", path);
+   path = st_shard_path("build.d/run", buffer, sizeof(buffer));
+   Assert.isTrue(strcmp(path, "build.d/run.shard-1") == 0, "Expected build.d/run.shard-1, got %s", path);
+}
+static void test_unknown(void) {
+   Assert.isTrue(1, "unknown (mean 60ms) belongs to shard 1");
+}
+
+// Register test cases
+__attribute__((constructor)) void init_shard_tests(void) {
+   FILE *durations = fopen(DURATIONS_FILE, "w");
+   if (durations) {
+      fprintf(durations, "shards/slow\t100\nshards/long\t60\nshards/mid\t50\nshards/short\t30\n");
+      fclose(durations);
+   }
+   runner_options.shard_index = 1;
+   runner_options.shard_count = 2;
+   runner_options.shard_durations = DURATIONS_FILE;
+
+   testset("shards", set_config, NULL);
+   testcase("slow", test_slow);
+   testcase("long", test_long);
+   testcase("mid", test_mid);
+   testcase("short", test_short);
+   testcase("unknown", test_unknown);
+}
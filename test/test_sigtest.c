@@ -102,6 +102,22 @@ void test_stringEqualsFail(void) {
 
    Assert.areEqual(exp, act, STRING, "'%s' is not equal to '%s'", exp, act);
 }
+/**
+ *	@brief	tests the case registry iteration API
+ */
+void test_registryIteration(void) {
+   Assert.isTrue(st_case_total() == 10, "10 cases should be registered, got %zu", st_case_total());
+
+   TcInfo first = st_case_at(0);
+   Assert.isNotNull(first, "First registered case should exist");
+   Assert.stringEqual(first->name, "assertTrue", TRUE, "First case should be 'assertTrue'");
+   Assert.isTrue(first->index == 0, "First case should be at index 0");
+
+   TcInfo last = st_case_at(st_case_total() - 1);
+   Assert.stringEqual(last->name, "registryIteration", TRUE, "Last case should be 'registryIteration'");
+   Assert.isTrue(last->index == 9, "Last case should be at index 9, got %zu", last->index);
+   Assert.isNull(st_case_at(st_case_total()), "Out of range index should be NULL");
+}
 
 //	register test cases
 __attribute__((constructor)) void init_sigtest_tests(void) {
@@ -121,4 +137,5 @@ __attribute__((constructor)) void init_sigtest_tests(void) {
    fail_testcase("pointersNotEqual", test_pointersNotEqual);
 
    fail_testcase("stringsNotComparable", test_stringsNotComparable);
+   testcase("registryIteration", test_registryIteration);
 }
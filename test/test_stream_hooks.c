@@ -0,0 +1,98 @@
+// test/test_stream_hooks.c
+#include "hooks/stream_hooks.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Test sets for the binary result stream hooks. The stream set writes its records to a file;
+ * the check set, registered first so it runs last, reads them back once the stream set ended.
+ */
+#define STREAM_FILE "reports/stream_hooks.bin"
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_stream_hooks.log", "w");
+}
+// test cases - stream
+static void stream_test_true(void) { Assert.isTrue(1 == 1, "1 should equal 1"); }
+static void stream_test_fail(void) { Assert.isTrue(1 == 0, "1 should not equal 0"); }
+static void stream_test_skip(void) { Assert.skip("This test is skipped"); }
+static void stream_test_allocs(void) {
+   void *blocks[3];
+   for (int i = 0; i < 3; i++)
+      blocks[i] = malloc(32);
+   for (int i = 0; i < 3; i++)
+      free(blocks[i]);
+   Assert.isTrue(1, "Allocations are counted");
+}
+// test cases - check
+static void stream_reads_back(void) {
+   FILE *in = fopen(STREAM_FILE, "rb");
+   Assert.isNotNull(in, "Stream file should exist");
+   static char data[4096];
+   size_t size = fread(data, 1, sizeof(data), in);
+   fclose(in);
+
+   const st_stream_header *header = (const st_stream_header *)data;
+   Assert.isTrue(size >= sizeof(*header) && memcmp(header->magic, ST_STREAM_MAGIC, 4) == 0, "Stream should start with its magic");
+   Assert.isTrue(header->version == ST_STREAM_VERSION && header->record_size == sizeof(st_stream_record) &&
+                     header->order == ST_STREAM_ORDER,
+                 "Unexpected stream header");
+
+   static const struct {
+      StreamKind kind;
+      TestState state;
+      const char *name;
+      const char *message;
+   } expected[] = {
+       {STREAM_SET_BEGIN, PASS, "stream_hooks", NULL},
+       {STREAM_CASE, PASS, "Stream: Should Pass", NULL},
+       {STREAM_CASE, PASS, "Stream: Should Fail", "Expected failure occurred"},
+       {STREAM_CASE, SKIP, "Stream: Should Skip", "This test is skipped"},
+       {STREAM_CASE, PASS, "Stream: Should Count Allocs", NULL},
+       {STREAM_SET_END, PASS, "stream_hooks", NULL},
+   };
+   size_t offset = sizeof(*header);
+   for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+      const st_stream_record *record = (const st_stream_record *)(data + offset);
+      Assert.isTrue(offset + sizeof(*record) <= size && offset + record->length <= size, "Record %zu is truncated", i);
+      Assert.isTrue(record->length % 8 == 0, "Record %zu is not padded", i);
+      Assert.isTrue(record->kind == expected[i].kind && record->set_id == 0, "Record %zu: unexpected kind %d", i, record->kind);
+      const char *name = record->name ? (const char *)record + record->name : "";
+      Assert.isTrue(strcmp(name, expected[i].name) == 0, "Record %zu: unexpected name '%s'", i, name);
+      if (record->kind == STREAM_CASE) {
+         Assert.isTrue(record->state == expected[i].state && record->case_id == i - 1, "`%s`: unexpected state %d", name, record->state);
+      }
+      if (expected[i].message) {
+         const char *message = record->message ? (const char *)record + record->message : "";
+         Assert.isTrue(strstr(message, expected[i].message) != NULL, "`%s`: unexpected message '%s'", name, message);
+      }
+      if (i == 4) {
+         Assert.isTrue(record->allocs >= 3 && record->frees >= 3, "`%s`: expected 3 allocs and frees, got %llu and %llu", name,
+                       (unsigned long long)record->allocs, (unsigned long long)record->frees);
+      }
+      if (record->kind == STREAM_SET_END) {
+         Assert.isTrue(record->case_id == 4, "Set end should count 4 cases, got %u", record->case_id);
+      }
+      offset += record->length;
+   }
+}
+
+// Register test cases
+__attribute__((constructor)) void init_stream_tests(void) {
+   static struct StreamHookContext ctx = {
+       .target = STREAM_FILE,
+   };
+   testset("stream_hooks_check", NULL, NULL);
+   testcase("reads_back", stream_reads_back);
+
+   // Register the test hooks
+   stream_hooks.context = (tc_context *)&ctx;
+   register_hooks((ST_Hooks)&stream_hooks);
+
+   testset("stream_hooks", set_config, NULL);
+   testcase("Stream: Should Pass", stream_test_true);
+   fail_testcase("Stream: Should Fail", stream_test_fail);
+   testcase("Stream: Should Skip", stream_test_skip);
+   testcase("Stream: Should Count Allocs", stream_test_allocs);
+}
@@ -0,0 +1,42 @@
+// test_thread_jobs.c
+#include "sigtest.h"
+#include <pthread.h>
+#include <unistd.h>
+
+/*
+ * Test sets for unattached threads of test code under parallel sets (`--jobs`).
+ * The two sets start together; the short case ends while the long one still runs, which must
+ * then own the unattached threads it starts again. Their failure fails it, as expected.
+ */
+static void short_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_thread_jobs_short.log", "w");
+}
+static void long_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_thread_jobs_long.log", "w");
+}
+static void *failing_thread(void *arg) {
+   (void)arg;
+   Assert.isTrue(0, "unattached thread failed");
+   return NULL;
+}
+// test cases
+static void test_short_case(void) {
+   usleep(50000);
+}
+static void test_outlives_short_case(void) {
+   usleep(250000);
+   pthread_t thread;
+   pthread_create(&thread, NULL, failing_thread, NULL);
+   pthread_join(thread, NULL);
+}
+
+// Register test cases
+__attribute__((constructor)) void init_thread_job_tests(void) {
+   runner_options.jobs = 2;
+
+   testset("thread_jobs_short", short_config, NULL);
+   testcase("short_case", test_short_case);
+
+   testset("thread_jobs_long", long_config, NULL);
+   fail_testcase("outlives_short_case", test_outlives_short_case);
+}
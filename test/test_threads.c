@@ -0,0 +1,149 @@
+// test_threads.c
+#include "sigtest.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+
+/*
+ * Test sets for assertions and output on threads of the code under test (`st_thread_pool`,
+ * `st_thread_attach`). Sets run newest first, so the results set registered first reads the
+ * outcomes back from the registry and the log. The three cases failing on a thread are the
+ * failures of this run.
+ */
+#define THREADS 4
+#define INCREMENTS 100000
+#define THREADS_LOG_FILE "logs/test_threads.log"
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen(THREADS_LOG_FILE, "w");
+}
+// lock-free stack pushed by every pool thread
+typedef struct node_s {
+   struct node_s *next;
+   size_t value;
+} node;
+static node nodes[THREADS * 1000];
+static node *_Atomic stack_top = NULL;
+static atomic_size_t counter = 0;
+static atomic_int after_failure = 0;
+
+static void push_nodes(size_t thread, object arg) {
+   (void)arg;
+   for (size_t i = 0; i < 1000; i++) {
+      node *n = &nodes[thread * 1000 + i];
+      n->value = thread;
+      n->next = atomic_load(&stack_top);
+      while (!atomic_compare_exchange_weak(&stack_top, &n->next, n))
+         ;
+   }
+}
+static void count_up(size_t thread, object arg) {
+   (void)arg;
+   for (size_t i = 0; i < INCREMENTS; i++)
+      atomic_fetch_add_explicit(&counter, 1, memory_order_relaxed);
+   Assert.isTrue(thread < THREADS, "Thread index %zu out of range", thread);
+}
+static void fail_on_two(size_t thread, object arg) {
+   (void)arg;
+   Assert.isFalse(thread == 2, "thread %zu failed", thread);
+   atomic_fetch_add(&after_failure, thread == 2);
+}
+static void *raw_failing_thread(void *arg) {
+   (void)arg;
+   Assert.isTrue(0, "raw thread failed");
+   // a thread the pool did not start carries on after the failed assertion
+   atomic_fetch_add(&after_failure, 10);
+   return NULL;
+}
+static void *raw_bulk_thread(void *arg) {
+   (void)arg;
+   int values[3] = {1, 2, 3}, others[3] = {1, 2, 4};
+   // each failed check returns on a raw thread, so none may read past its failure
+   Assert.arrayEqual(NULL, values, 3, INT, "raw NULL array");
+   Assert.arrayWithin(values, NULL, 3, DOUBLE, 0.5, "raw NULL array within");
+   Assert.memEqual(NULL, values, sizeof(values), "raw NULL region");
+   Assert.arrayEqual(values, others, 3, (AssertType)-1, "raw unsupported type");
+   atomic_fetch_add(&after_failure, 100);
+   return NULL;
+}
+static void *attached_logging_thread(void *arg) {
+   st_thread_attach(arg);
+   DebugLogger.log("from attached thread");
+   return NULL;
+}
+// test cases - threads
+static void test_pool_counts(void) {
+   st_thread_time times[THREADS];
+   atomic_store(&counter, 0);
+   Assert.isTrue(st_thread_pool(THREADS, count_up, NULL, times) == 0, "The pool should run");
+   Assert.isTrue(atomic_load(&counter) == THREADS * INCREMENTS, "Expected %d increments, got %zu",
+                 THREADS * INCREMENTS, atomic_load(&counter));
+   for (int i = 0; i < THREADS; i++) {
+      double ms = (times[i].end.tv_sec - times[i].start.tv_sec) * 1e3 + (times[i].end.tv_nsec - times[i].start.tv_nsec) / 1e6;
+      Assert.isTrue(times[i].start.tv_sec > 0 && ms >= 0, "Thread %d has no timestamps", i);
+   }
+}
+static void test_pool_lock_free_stack(void) {
+   Assert.isTrue(st_thread_pool(THREADS, push_nodes, NULL, NULL) == 0, "The pool should run");
+   size_t counts[THREADS] = {0};
+   for (node *n = atomic_load(&stack_top); n; n = n->next)
+      counts[n->value]++;
+   for (int i = 0; i < THREADS; i++)
+      Assert.isTrue(counts[i] == 1000, "Thread %d pushed %zu nodes", i, counts[i]);
+}
+static void test_pool_fails(void) {
+   atomic_store(&after_failure, 0);
+   st_thread_pool(THREADS, fail_on_two, NULL, NULL);
+   Assert.fail("A failed pool thread should fail the case at the join");
+}
+static void test_raw_thread_fails(void) {
+   pthread_t thread;
+   pthread_create(&thread, NULL, raw_failing_thread, NULL);
+   pthread_join(thread, NULL);
+}
+static void test_raw_thread_bulk_fails(void) {
+   pthread_t thread;
+   pthread_create(&thread, NULL, raw_bulk_thread, NULL);
+   pthread_join(thread, NULL);
+}
+static void test_attached_thread_logs(void) {
+   pthread_t thread;
+   pthread_create(&thread, NULL, attached_logging_thread, st_thread_case());
+   pthread_join(thread, NULL);
+}
+// test cases - results
+static void test_reports_results(void) {
+   TcInfo info = st_case_at(3);
+   Assert.isTrue(info->result.state == FAIL && info->result.message && strstr(info->result.message, "thread 2 failed"),
+                 "`%s`: unexpected result '%s'", info->name, info->result.message);
+   info = st_case_at(4);
+   Assert.isTrue(info->result.state == FAIL && info->result.message && strstr(info->result.message, "raw thread failed"),
+                 "`%s`: unexpected result '%s'", info->name, info->result.message);
+   Assert.isTrue(atomic_load(&after_failure) == 110, "Only the raw threads should run past their failures");
+   Assert.isTrue(st_case_at(5)->result.state == PASS, "The attached thread should pass");
+   info = st_case_at(6);
+   Assert.isTrue(info->result.state == FAIL && info->result.message && strstr(info->result.message, "Array is NULL"),
+                 "`%s`: unexpected result '%s'", info->name, info->result.message);
+
+   FILE *log = fopen(THREADS_LOG_FILE, "r");
+   Assert.isNotNull(log, "The threads log should exist");
+   static char data[16384];
+   size_t size = fread(data, 1, sizeof(data) - 1, log);
+   fclose(log);
+   data[size] = '\0';
+   Assert.isTrue(strstr(data, "  - from attached thread\n") != NULL, "Thread output should be logged with its case");
+}
+
+// Register test cases
+__attribute__((constructor)) void init_thread_tests(void) {
+   testset("threads_results", NULL, NULL);
+   testcase("reports_results", test_reports_results);
+
+   testset("threads", set_config, NULL);
+   testcase("pool_counts", test_pool_counts);
+   testcase("pool_lock_free_stack", test_pool_lock_free_stack);
+   testcase("pool_fails", test_pool_fails);
+   testcase("raw_thread_fails", test_raw_thread_fails);
+   testcase("attached_thread_logs", test_attached_thread_logs);
+   testcase("raw_thread_bulk_fails", test_raw_thread_bulk_fails);
+}
@@ -0,0 +1,90 @@
+// test_typed_asserts.c
+#include "sigtest.h"
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Test set for the typed `ST_ASSERT_EQ` and `ST_ASSERT_NE` checks.
+ * Passing checks of every supported type must compare by value in the common type of their
+ * operands. The four message cases fail on purpose and are inspected by `messages`.
+ */
+#define CHECK_COUNT 1000000
+
+static void set_config(FILE **log_stream) {
+   *log_stream = fopen("logs/test_typed_asserts.log", "w");
+}
+static int calls = 0;
+static int next_call(void) {
+   return ++calls;
+}
+// test cases
+static void test_passes(void) {
+   uint64_t wide = 0;
+   for (int i = 0; i < CHECK_COUNT; i++) {
+      ST_ASSERT_EQ(i, (int)wide++, "index %d", i);
+      ST_ASSERT_NE(i, i + 1);
+   }
+   ST_ASSERT_EQ(UINT64_MAX, (uint64_t)-1);
+   ST_ASSERT_EQ(INT64_MIN, -INT64_MAX - 1);
+   ST_ASSERT_EQ((uint8_t)255, (uint8_t)(254 + 1));
+   ST_ASSERT_EQ(3u, sizeof(int16_t) + 1);
+   ST_ASSERT_EQ('s', "sigma"[0]);
+   ST_ASSERT_EQ(0.1f, 0.05f + 0.05f);
+   ST_ASSERT_EQ(0.3, 0.1 + 0.2);
+   ST_ASSERT_NE(0.3, 0.31);
+
+   char name[8] = "sigma";
+   const char *same = "sigma";
+   ST_ASSERT_EQ("sigma", name);
+   ST_ASSERT_EQ(same, name);
+   ST_ASSERT_NE("sigmas", name);
+   ST_ASSERT_EQ((const char *)NULL, (char *)NULL);
+   ST_ASSERT_NE("sigma", (const char *)NULL);
+
+   int value = 0;
+   int *pointer = &value;
+   ST_ASSERT_EQ(&value, pointer);
+   ST_ASSERT_NE(NULL, pointer);
+}
+static void test_evaluated_once(void) {
+   calls = 0;
+   ST_ASSERT_EQ(1, next_call());
+   ST_ASSERT_NE(next_call(), 3);
+   ST_ASSERT_EQ(2, calls, "operands should be evaluated exactly once");
+}
+static void test_unsigned_message(void) {
+   ST_ASSERT_EQ(UINT64_MAX, (uint64_t)0, "after %d resets", 1);
+}
+static void test_real_message(void) {
+   ST_ASSERT_EQ(0.5, 0.25);
+}
+static void test_string_message(void) {
+   ST_ASSERT_EQ("sigma", (const char *)NULL);
+}
+static void test_differ_message(void) {
+   ST_ASSERT_NE(7, 7);
+}
+static void test_messages(void) {
+   static const char *expected[] = {
+       "Expected 18446744073709551615, but was 0\n    - after 1 resets",
+       "Expected 0.5, but was 0.25",
+       "Expected \"sigma\", but was NULL",
+       "Expected a value other than 7",
+   };
+   for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+      const char *message = st_case_at(i + 2)->result.message;
+      Assert.isTrue(message && strcmp(message, expected[i]) == 0, "Unexpected message '%s'", message);
+   }
+}
+
+// Register test cases
+__attribute__((constructor)) void init_typed_assert_tests(void) {
+   testset("typed_asserts", set_config, NULL);
+   testcase("passes", test_passes);
+   testcase("evaluated_once", test_evaluated_once);
+   testcase("unsigned_message", test_unsigned_message);
+   testcase("real_message", test_real_message);
+   testcase("string_message", test_string_message);
+   testcase("differ_message", test_differ_message);
+   testcase("messages", test_messages);
+}
@@ -0,0 +1,554 @@
+/* tools/merge_reports.c */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Combines the per-shard reports of a sharded run (`--shard-index`/`--shard-count`) into one
+ * report. Inputs are either all JSON (`json_hooks`) or all JUnit XML (`junit_hooks`); test sets
+ * split across shards are folded back into a single set. Optionally writes the recorded case
+ * durations in the `set/case<TAB>ms` format read by `--shard-durations`.
+ */
+
+static int verbose = 0;
+
+typedef struct
+{
+   char *data;
+   size_t used;
+   size_t size;
+} Buffer;
+
+typedef struct
+{
+   char name[256];
+   char timestamp[32];
+   char hostname[256];
+   Buffer cases;
+   long total;
+   long passed;
+   long failed;
+   long skipped;
+   long mallocs;
+   long frees;
+   double time;
+} Suite;
+
+static Suite *suites = NULL;
+static size_t suite_count = 0;
+static Buffer durations = {0};
+
+static void append(Buffer *buffer, const char *text, size_t len)
+{
+   if (buffer->used + len + 1 > buffer->size)
+   {
+      size_t size = buffer->size ? buffer->size : 4096;
+      while (buffer->used + len + 1 > size)
+      {
+         size *= 2;
+      }
+      char *data = realloc(buffer->data, size);
+      if (!data)
+      {
+         perror("Error growing buffer");
+         exit(1);
+      }
+      buffer->data = data;
+      buffer->size = size;
+   }
+   memcpy(buffer->data + buffer->used, text, len);
+   buffer->used += len;
+   buffer->data[buffer->used] = '\0';
+}
+
+// Find or add the suite for a test set; the earliest timestamp wins
+static Suite *get_suite(const char *name, const char *timestamp)
+{
+   for (size_t i = 0; i < suite_count; i++)
+   {
+      if (strcmp(suites[i].name, name) == 0)
+      {
+         if (timestamp && strcmp(timestamp, suites[i].timestamp) < 0)
+         {
+            snprintf(suites[i].timestamp, sizeof(suites[i].timestamp), "%s", timestamp);
+         }
+         return &suites[i];
+      }
+   }
+
+   suites = realloc(suites, (suite_count + 1) * sizeof(Suite));
+   if (!suites)
+   {
+      perror("Error allocating suite");
+      exit(1);
+   }
+   Suite *suite = &suites[suite_count++];
+   memset(suite, 0, sizeof(Suite));
+   snprintf(suite->name, sizeof(suite->name), "%s", name);
+   snprintf(suite->timestamp, sizeof(suite->timestamp), "%s", timestamp ? timestamp : "");
+   return suite;
+}
+
+static void add_duration(const char *set, const char *test, double ms)
+{
+   char line[1024];
+   int len = snprintf(line, sizeof(line), "%s/%s\t%.3f\n", set, test, ms);
+   if (len > 0 && (size_t)len < sizeof(line))
+   {
+      append(&durations, line, len);
+   }
+}
+
+static char *read_file(const char *path)
+{
+   FILE *in = fopen(path, "rb");
+   if (!in)
+   {
+      char err_msg[256];
+      snprintf(err_msg, sizeof(err_msg), "Error opening report: %s", path);
+      perror(err_msg);
+      return NULL;
+   }
+
+   Buffer buffer = {0};
+   char chunk[4096];
+   size_t n;
+   while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0)
+   {
+      append(&buffer, chunk, n);
+   }
+   fclose(in);
+   if (!buffer.data)
+   {
+      append(&buffer, "", 0);
+   }
+   return buffer.data;
+}
+
+// Copy the value of `"key": "value"` (or a bare number) following `key` on a line
+static int json_value(const char *line, const char *key, char *out, size_t len)
+{
+   char quoted[64];
+   snprintf(quoted, sizeof(quoted), "\"%s\":", key);
+   const char *start = strstr(line, quoted);
+   if (!start)
+   {
+      return 0;
+   }
+   start += strlen(quoted);
+   while (*start == ' ')
+   {
+      start++;
+   }
+   const char *end;
+   if (*start == '"')
+   {
+      start++;
+      end = strrchr(start, '"');
+   }
+   else
+   {
+      end = start + strcspn(start, ",\r\n");
+   }
+   if (!end || end < start)
+   {
+      return 0;
+   }
+   snprintf(out, len, "%.*s", (int)(end - start), start);
+   return 1;
+}
+
+/*
+ * JSON reports are read line by line in the layout written by `json_hooks`: one object per
+ * test set holding a `tests` array of one object per case and a `summary` object.
+ */
+static int merge_json(const char *path, char *text)
+{
+   Suite *suite = NULL;
+   int in_tests = 0;
+   Buffer test = {0};
+   char test_name[256] = "";
+   double duration_ms = 0;
+
+   for (char *line = strtok(text, "\n"); line; line = strtok(NULL, "\n"))
+   {
+      char value[256];
+      const char *trimmed = line + strspn(line, " \t");
+      if (json_value(trimmed, "test_set", value, sizeof(value)))
+      {
+         suite = get_suite(value, NULL);
+         in_tests = 0;
+      }
+      else if (!suite)
+      {
+         continue;
+      }
+      else if (json_value(trimmed, "timestamp", value, sizeof(value)) && !in_tests)
+      {
+         if (!suite->timestamp[0] || strcmp(value, suite->timestamp) < 0)
+         {
+            snprintf(suite->timestamp, sizeof(suite->timestamp), "%.31s", value);
+         }
+      }
+      else if (strncmp(trimmed, "\"tests\":", 8) == 0)
+      {
+         in_tests = 1;
+      }
+      else if (in_tests && trimmed[0] == '{')
+      {
+         test.used = 0;
+         test_name[0] = '\0';
+         duration_ms = 0;
+         append(&test, "    {\n", 6);
+      }
+      else if (in_tests && trimmed[0] == '}')
+      {
+         append(&test, "    }", 5);
+         if (suite->cases.used)
+         {
+            append(&suite->cases, ",\n", 2);
+         }
+         append(&suite->cases, test.data, test.used);
+         add_duration(suite->name, test_name, duration_ms);
+      }
+      else if (in_tests && trimmed[0] == ']')
+      {
+         in_tests = 0;
+      }
+      else if (in_tests)
+      {
+         if (json_value(trimmed, "test", value, sizeof(value)))
+         {
+            snprintf(test_name, sizeof(test_name), "%s", value);
+         }
+         else if (json_value(trimmed, "duration_us", value, sizeof(value)))
+         {
+            duration_ms = strtod(value, NULL) / 1000.0;
+         }
+         append(&test, line, strlen(line));
+         append(&test, "\n", 1);
+      }
+      else if (json_value(trimmed, "total", value, sizeof(value)))
+      {
+         suite->total += atol(value);
+      }
+      else if (json_value(trimmed, "passed", value, sizeof(value)))
+      {
+         suite->passed += atol(value);
+      }
+      else if (json_value(trimmed, "failed", value, sizeof(value)))
+      {
+         suite->failed += atol(value);
+      }
+      else if (json_value(trimmed, "skipped", value, sizeof(value)))
+      {
+         suite->skipped += atol(value);
+      }
+      else if (json_value(trimmed, "total_mallocs", value, sizeof(value)))
+      {
+         suite->mallocs += atol(value);
+      }
+      else if (json_value(trimmed, "total_frees", value, sizeof(value)))
+      {
+         suite->frees += atol(value);
+      }
+   }
+
+   free(test.data);
+   if (verbose)
+   {
+      fprintf(stdout, "merged json=%s\n", path);
+   }
+   return 0;
+}
+
+static void write_json(FILE *out)
+{
+   for (size_t i = 0; i < suite_count; i++)
+   {
+      Suite *suite = &suites[i];
+      fprintf(out, "{\n");
+      fprintf(out, "  \"test_set\": \"%s\",\n", suite->name);
+      fprintf(out, "  \"timestamp\": \"%s\",\n", suite->timestamp);
+      fprintf(out, "  \"tests\": [\n");
+      if (suite->cases.used)
+      {
+         fprintf(out, "%s\n", suite->cases.data);
+      }
+      fprintf(out, "  ],\n");
+      fprintf(out, "  \"summary\": {\n");
+      fprintf(out, "    \"total\": %ld,\n", suite->total);
+      fprintf(out, "    \"passed\": %ld,\n", suite->passed);
+      fprintf(out, "    \"failed\": %ld,\n", suite->failed);
+      fprintf(out, "    \"skipped\": %ld,\n", suite->skipped);
+      fprintf(out, "    \"total_mallocs\": %ld,\n", suite->mallocs);
+      fprintf(out, "    \"total_frees\": %ld\n", suite->frees);
+      fprintf(out, "  }\n");
+      fprintf(out, "}\n");
+   }
+}
+
+// Copy the value of attribute `name` from an XML start tag
+static int xml_attr(const char *tag, const char *end, const char *name, char *out, size_t len)
+{
+   char key[64];
+   snprintf(key, sizeof(key), " %s=\"", name);
+   const char *start = strstr(tag, key);
+   if (!start || start > end)
+   {
+      return 0;
+   }
+   start += strlen(key);
+   const char *close = strchr(start, '"');
+   if (!close || close > end)
+   {
+      return 0;
+   }
+   snprintf(out, len, "%.*s", (int)(close - start), start);
+   return 1;
+}
+
+// Undo the entity escaping of `junit_hooks` for the durations file
+static void xml_unescape(char *text)
+{
+   static const struct
+   {
+      const char *entity;
+      char c;
+   } entities[] = {{"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}};
+
+   char *out = text;
+   for (char *in = text; *in;)
+   {
+      size_t i = 0, n = sizeof(entities) / sizeof(entities[0]);
+      while (i < n && strncmp(in, entities[i].entity, strlen(entities[i].entity)) != 0)
+      {
+         i++;
+      }
+      if (i < n)
+      {
+         *out++ = entities[i].c;
+         in += strlen(entities[i].entity);
+      }
+      else
+      {
+         *out++ = *in++;
+      }
+   }
+   *out = '\0';
+}
+
+/*
+ * JUnit reports hold `<testsuite>` elements whose counts are summed and whose `<testcase>`
+ * elements are concatenated per suite name.
+ */
+static int merge_junit(const char *path, char *text)
+{
+   char *tag = text;
+   while ((tag = strstr(tag, "<testsuite ")) != NULL)
+   {
+      char *tag_end = strchr(tag, '>');
+      char *suite_end = tag_end ? strstr(tag_end, "</testsuite>") : NULL;
+      if (!suite_end)
+      {
+         fprintf(stderr, "Error: Unterminated testsuite in %s\n", path);
+         return 1;
+      }
+
+      char name[256] = "", timestamp[32] = "", value[64];
+      xml_attr(tag, tag_end, "name", name, sizeof(name));
+      xml_attr(tag, tag_end, "timestamp", timestamp, sizeof(timestamp));
+      Suite *suite = get_suite(name, timestamp);
+      if (!suite->hostname[0])
+      {
+         xml_attr(tag, tag_end, "hostname", suite->hostname, sizeof(suite->hostname));
+      }
+      if (xml_attr(tag, tag_end, "tests", value, sizeof(value)))
+      {
+         suite->total += atol(value);
+      }
+      if (xml_attr(tag, tag_end, "failures", value, sizeof(value)))
+      {
+         suite->failed += atol(value);
+      }
+      if (xml_attr(tag, tag_end, "skipped", value, sizeof(value)))
+      {
+         suite->skipped += atol(value);
+      }
+      if (xml_attr(tag, tag_end, "time", value, sizeof(value)))
+      {
+         suite->time += strtod(value, NULL);
+      }
+
+      // the testcase elements, from the line after the testsuite tag
+      char *cases = tag_end + 1;
+      if (*cases == '\n')
+      {
+         cases++;
+      }
+      char *cases_end = suite_end;
+      while (cases_end > cases && cases_end[-1] == ' ')
+      {
+         cases_end--;
+      }
+      append(&suite->cases, cases, cases_end - cases);
+
+      for (char *tc = strstr(cases, "<testcase "); tc && tc < cases_end; tc = strstr(tc + 1, "<testcase "))
+      {
+         char *tc_end = strchr(tc, '>');
+         char test[256], time[64];
+         if (tc_end && xml_attr(tc, tc_end, "name", test, sizeof(test)) && xml_attr(tc, tc_end, "time", time, sizeof(time)))
+         {
+            xml_unescape(test);
+            add_duration(suite->name, test, strtod(time, NULL) * 1000.0);
+         }
+      }
+      tag = suite_end;
+   }
+
+   if (verbose)
+   {
+      fprintf(stdout, "merged junit=%s\n", path);
+   }
+   return 0;
+}
+
+static void write_junit(FILE *out)
+{
+   long total = 0, failed = 0, skipped = 0;
+   double time = 0;
+   for (size_t i = 0; i < suite_count; i++)
+   {
+      total += suites[i].total;
+      failed += suites[i].failed;
+      skipped += suites[i].skipped;
+      time += suites[i].time;
+   }
+
+   fprintf(out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+   fprintf(out, "<testsuites tests=\"%ld\" failures=\"%ld\" skipped=\"%ld\" time=\"%.3f\">\n", total, failed, skipped, time);
+   for (size_t i = 0; i < suite_count; i++)
+   {
+      Suite *suite = &suites[i];
+      fprintf(out, "  <testsuite name=\"%s\" timestamp=\"%s\" hostname=\"%s\" "
+                   "tests=\"%ld\" failures=\"%ld\" skipped=\"%ld\" time=\"%.3f\">\n",
+              suite->name, suite->timestamp, suite->hostname, suite->total, suite->failed, suite->skipped, suite->time);
+      if (suite->cases.used)
+      {
+         fprintf(out, "%s", suite->cases.data);
+      }
+      fprintf(out, "  </testsuite>\n");
+   }
+   fprintf(out, "</testsuites>\n");
+}
+
+int main(int argc, char *argv[])
+{
+   const char *output_file = NULL;
+   const char *durations_file = NULL;
+   int first_input = 0;
+
+   // Parse arguments
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "-v") == 0)
+      {
+         verbose = 1;
+      }
+      else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+      {
+         output_file = argv[++i];
+      }
+      else if (strcmp(argv[i], "--durations") == 0 && i + 1 < argc)
+      {
+         durations_file = argv[++i];
+      }
+      else if (argv[i][0] != '-')
+      {
+         first_input = i;
+         break;
+      }
+      else
+      {
+         first_input = 0;
+         break;
+      }
+   }
+
+   if (!first_input)
+   {
+      fprintf(stderr, "Usage: %s [-v] [-o <output>] [--durations <file>] <report>...\n", argv[0]);
+      return 1;
+   }
+
+   // All reports share the format of the first one
+   int is_junit = -1;
+   for (int i = first_input; i < argc; i++)
+   {
+      char *text = read_file(argv[i]);
+      if (!text)
+      {
+         return 1;
+      }
+      const char *start = text + strspn(text, " \t\r\n");
+      int junit = *start == '<';
+      if (*start && is_junit < 0)
+      {
+         is_junit = junit;
+      }
+      if (*start && junit != is_junit)
+      {
+         fprintf(stderr, "Error: Mixed report formats: %s\n", argv[i]);
+         free(text);
+         return 1;
+      }
+      int ret = junit ? merge_junit(argv[i], text) : merge_json(argv[i], text);
+      free(text);
+      if (ret != 0)
+      {
+         return 1;
+      }
+   }
+
+   FILE *out = output_file ? fopen(output_file, "w") : stdout;
+   if (!out)
+   {
+      perror("Error opening output file");
+      return 1;
+   }
+   if (is_junit > 0)
+   {
+      write_junit(out);
+   }
+   else
+   {
+      write_json(out);
+   }
+   if (out != stdout)
+   {
+      fclose(out);
+   }
+
+   if (durations_file)
+   {
+      FILE *dur = fopen(durations_file, "w");
+      if (!dur)
+      {
+         perror("Error opening durations file");
+         return 1;
+      }
+      if (durations.used)
+      {
+         fputs(durations.data, dur);
+      }
+      fclose(dur);
+   }
+
+   for (size_t i = 0; i < suite_count; i++)
+   {
+      free(suites[i].cases.data);
+   }
+   free(suites);
+   free(durations.data);
+   return 0;
+}
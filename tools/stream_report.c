@@ -0,0 +1,467 @@
+/* tools/stream_report.c */
+#include "hooks/stream_hooks.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Converts binary result streams written by `stream_hooks` into the JSON report layout of
+ * `json_hooks` (default) or JUnit XML, so the outputs can be merged with `merge_reports` or
+ * read by CI. A stream cut short by a crashed runner is converted up to its last whole record;
+ * its open set is closed with the cases recorded so far.
+ */
+
+static int verbose = 0;
+static int junit = 0;
+
+typedef struct
+{
+   char *data;
+   size_t used;
+   size_t size;
+} Buffer;
+
+typedef struct
+{
+   int open;
+   int swap;
+   char name[256];
+   char timestamp[32];
+   char hostname[256];
+   Buffer cases;
+   long total;
+   long passed;
+   long failed;
+   long skipped;
+   uint64_t mallocs;
+   uint64_t frees;
+   double time;
+} Suite;
+
+static const char *const STATES[] = {"PASS", "FAIL", "SKIP", "TIMEOUT", "OVERBUDGET"};
+
+static void append(Buffer *buffer, const char *text, size_t len)
+{
+   if (buffer->used + len + 1 > buffer->size)
+   {
+      size_t size = buffer->size ? buffer->size : 4096;
+      while (buffer->used + len + 1 > size)
+      {
+         size *= 2;
+      }
+      char *data = realloc(buffer->data, size);
+      if (!data)
+      {
+         perror("Error growing buffer");
+         exit(1);
+      }
+      buffer->data = data;
+      buffer->size = size;
+   }
+   memcpy(buffer->data + buffer->used, text, len);
+   buffer->used += len;
+   buffer->data[buffer->used] = '\0';
+}
+
+static char *read_file(const char *path, size_t *size)
+{
+   FILE *in = fopen(path, "rb");
+   if (!in)
+   {
+      char err_msg[256];
+      snprintf(err_msg, sizeof(err_msg), "Error opening stream: %s", path);
+      perror(err_msg);
+      return NULL;
+   }
+
+   Buffer buffer = {0};
+   char chunk[65536];
+   size_t n;
+   while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0)
+   {
+      append(&buffer, chunk, n);
+   }
+   fclose(in);
+   *size = buffer.used;
+   return buffer.data ? buffer.data : calloc(1, 1);
+}
+
+// Escape a string for a JSON string body (json) or an XML attribute (junit)
+static void escape(Buffer *out, const char *text)
+{
+   for (const char *src = text ? text : ""; *src; src++)
+   {
+      const char *entity = NULL;
+      if (junit)
+      {
+         switch (*src)
+         {
+         case '&':
+            entity = "&amp;";
+            break;
+         case '<':
+            entity = "&lt;";
+            break;
+         case '>':
+            entity = "&gt;";
+            break;
+         case '"':
+            entity = "&quot;";
+            break;
+         case '\'':
+            entity = "&apos;";
+            break;
+         }
+      }
+      else if (*src == '"')
+      {
+         entity = "\\\"";
+      }
+      else if (*src == '\\')
+      {
+         entity = "\\\\";
+      }
+      else if (*src == '\n')
+      {
+         entity = "\\n";
+      }
+      if (entity)
+      {
+         append(out, entity, strlen(entity));
+      }
+      else
+      {
+         append(out, src, 1);
+      }
+   }
+}
+
+static void appendf(Buffer *out, const char *fmt, ...)
+{
+   char line[512];
+   va_list args;
+   va_start(args, fmt);
+   int len = vsnprintf(line, sizeof(line), fmt, args);
+   va_end(args);
+   if (len > 0)
+   {
+      append(out, line, (size_t)len < sizeof(line) ? (size_t)len : sizeof(line) - 1);
+   }
+}
+
+static uint32_t swap32(uint32_t value)
+{
+   return __builtin_bswap32(value);
+}
+
+static uint64_t swap64(uint64_t value)
+{
+   return __builtin_bswap64(value);
+}
+
+// Bring a record written on a host of the other byte order into host order
+static void swap_record(st_stream_record *record)
+{
+   record->length = swap32(record->length);
+   record->set_id = swap32(record->set_id);
+   record->case_id = swap32(record->case_id);
+   record->time_ns = swap64(record->time_ns);
+   record->allocs = swap64(record->allocs);
+   record->frees = swap64(record->frees);
+   record->name = swap32(record->name);
+   record->message = swap32(record->message);
+}
+
+// Get a record string; offsets outside the record read as empty
+static const char *record_string(const char *base, size_t length, uint32_t offset)
+{
+   if (!offset || offset >= length || !memchr(base + offset, '\0', length - offset))
+   {
+      return "";
+   }
+   return base + offset;
+}
+
+static void begin_suite(Suite *suite, const st_stream_record *record, const char *name, const char *hostname)
+{
+   suite->open = 1;
+   suite->cases.used = 0;
+   suite->total = suite->passed = suite->failed = suite->skipped = 0;
+   suite->mallocs = suite->frees = 0;
+   suite->time = 0;
+   snprintf(suite->name, sizeof(suite->name), "%s", name);
+   snprintf(suite->hostname, sizeof(suite->hostname), "%s", *hostname ? hostname : "localhost");
+
+   time_t start = (time_t)(record->time_ns / 1000000000ull);
+   strftime(suite->timestamp, sizeof(suite->timestamp), junit ? "%Y-%m-%dT%H:%M:%SZ" : "%Y-%m-%d %H:%M:%S",
+            junit ? gmtime(&start) : localtime(&start));
+}
+
+static void add_case(Suite *suite, const st_stream_record *record, const char *name, const char *message)
+{
+   const char *state = record->state < sizeof(STATES) / sizeof(STATES[0]) ? STATES[record->state] : "UNKNOWN";
+   int failed = record->state == FAIL || record->state == TIMEOUT || record->state == OVERBUDGET;
+   suite->total++;
+   if (failed)
+   {
+      suite->failed++;
+   }
+   else if (record->state == SKIP)
+   {
+      suite->skipped++;
+   }
+   else
+   {
+      suite->passed++;
+   }
+
+   Buffer *out = &suite->cases;
+   if (junit)
+   {
+      append(out, "    <testcase name=\"", 20);
+      escape(out, name);
+      appendf(out, "\" time=\"%.3f\"", record->time_ns / 1e9);
+      if (failed)
+      {
+         const char *type = record->state == TIMEOUT ? " type=\"timeout\"" : record->state == OVERBUDGET ? " type=\"overbudget\"" : "";
+         appendf(out, ">\n      <failure%s message=\"", type);
+         escape(out, *message ? message : "Unknown failure");
+         append(out, "\">", 2);
+         escape(out, *message ? message : "Unknown failure");
+         appendf(out, "</failure>\n    </testcase>\n");
+      }
+      else if (record->state == SKIP)
+      {
+         appendf(out, ">\n      <skipped/>\n    </testcase>\n");
+      }
+      else
+      {
+         append(out, "/>\n", 3);
+      }
+      return;
+   }
+
+   appendf(out, "%s    {\n      \"test\": \"", suite->total > 1 ? ",\n" : "");
+   escape(out, name);
+   appendf(out, "\",\n      \"status\": \"%s\",\n", state);
+   appendf(out, "      \"duration_us\": %.3f,\n", record->time_ns / 1000.0);
+   appendf(out, "      \"allocs\": %llu,\n", (unsigned long long)record->allocs);
+   appendf(out, "      \"frees\": %llu,\n", (unsigned long long)record->frees);
+   append(out, "      \"message\": \"", 18);
+   escape(out, message);
+   append(out, "\"\n    }", 7);
+}
+
+static void end_suite(FILE *out, Suite *suite)
+{
+   if (junit)
+   {
+      Buffer name = {0};
+      escape(&name, suite->name);
+      fprintf(out, "  <testsuite name=\"%s\" timestamp=\"%s\" hostname=\"%s\" "
+                   "tests=\"%ld\" failures=\"%ld\" skipped=\"%ld\" time=\"%.3f\">\n",
+              name.data ? name.data : "", suite->timestamp, suite->hostname, suite->total, suite->failed, suite->skipped,
+              suite->time);
+      if (suite->cases.used)
+      {
+         fwrite(suite->cases.data, 1, suite->cases.used, out);
+      }
+      fprintf(out, "  </testsuite>\n");
+      free(name.data);
+   }
+   else
+   {
+      Buffer name = {0};
+      escape(&name, suite->name);
+      fprintf(out, "{\n");
+      fprintf(out, "  \"test_set\": \"%s\",\n", name.data ? name.data : "");
+      fprintf(out, "  \"timestamp\": \"%s\",\n", suite->timestamp);
+      fprintf(out, "  \"tests\": [\n");
+      if (suite->cases.used)
+      {
+         fwrite(suite->cases.data, 1, suite->cases.used, out);
+         fprintf(out, "\n");
+      }
+      fprintf(out, "  ],\n");
+      fprintf(out, "  \"summary\": {\n");
+      fprintf(out, "    \"total\": %ld,\n", suite->total);
+      fprintf(out, "    \"passed\": %ld,\n", suite->passed);
+      fprintf(out, "    \"failed\": %ld,\n", suite->failed);
+      fprintf(out, "    \"skipped\": %ld,\n", suite->skipped);
+      fprintf(out, "    \"total_mallocs\": %llu,\n", (unsigned long long)suite->mallocs);
+      fprintf(out, "    \"total_frees\": %llu\n", (unsigned long long)suite->frees);
+      fprintf(out, "  }\n");
+      fprintf(out, "}\n");
+      free(name.data);
+   }
+   suite->open = 0;
+}
+
+// Convert every set of one stream; sets are written as they end
+static int convert(FILE *out, const char *path, Suite *suite)
+{
+   size_t size;
+   char *data = read_file(path, &size);
+   if (!data)
+   {
+      return 1;
+   }
+
+   st_stream_header header;
+   if (size < sizeof(header))
+   {
+      fprintf(stderr, "Error: Not a result stream: %s\n", path);
+      free(data);
+      return 1;
+   }
+   memcpy(&header, data, sizeof(header));
+   suite->swap = header.order == swap32(ST_STREAM_ORDER);
+   uint16_t version = suite->swap ? __builtin_bswap16(header.version) : header.version;
+   uint16_t record_size = suite->swap ? __builtin_bswap16(header.record_size) : header.record_size;
+   if (memcmp(header.magic, ST_STREAM_MAGIC, 4) != 0 || (header.order != ST_STREAM_ORDER && !suite->swap))
+   {
+      fprintf(stderr, "Error: Not a result stream: %s\n", path);
+      free(data);
+      return 1;
+   }
+   if (version != ST_STREAM_VERSION || record_size < sizeof(st_stream_record))
+   {
+      fprintf(stderr, "Error: Unsupported stream version %u in %s\n", version, path);
+      free(data);
+      return 1;
+   }
+
+   size_t records = 0;
+   size_t offset = sizeof(header);
+   while (offset + sizeof(st_stream_record) <= size)
+   {
+      st_stream_record record;
+      memcpy(&record, data + offset, sizeof(record));
+      if (suite->swap)
+      {
+         swap_record(&record);
+      }
+      if (record.length < sizeof(record) || record.length > size - offset)
+      {
+         break; // cut short
+      }
+      const char *base = data + offset;
+      const char *name = record_string(base, record.length, record.name);
+      const char *message = record_string(base, record.length, record.message);
+
+      switch (record.kind)
+      {
+      case STREAM_SET_BEGIN:
+         if (suite->open)
+         {
+            end_suite(out, suite);
+         }
+         begin_suite(suite, &record, name, message);
+         break;
+      case STREAM_CASE:
+         if (suite->open)
+         {
+            add_case(suite, &record, name, message);
+         }
+         break;
+      case STREAM_SET_END:
+         if (suite->open)
+         {
+            suite->mallocs = record.allocs;
+            suite->frees = record.frees;
+            suite->time = record.time_ns / 1e9;
+            end_suite(out, suite);
+         }
+         break;
+      default:
+         break; // kinds of a newer writer
+      }
+      records++;
+      offset += record.length;
+   }
+   if (offset != size)
+   {
+      fprintf(stderr, "Warning: Stream %s is truncated after %zu records\n", path, records);
+   }
+   if (suite->open)
+   {
+      end_suite(out, suite);
+   }
+   if (verbose)
+   {
+      fprintf(stdout, "converted stream=%s records=%zu\n", path, records);
+   }
+   free(data);
+   return 0;
+}
+
+int main(int argc, char *argv[])
+{
+   const char *output_file = NULL;
+   int first_input = 0;
+
+   // Parse arguments
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "-v") == 0)
+      {
+         verbose = 1;
+      }
+      else if (strcmp(argv[i], "--junit") == 0)
+      {
+         junit = 1;
+      }
+      else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+      {
+         output_file = argv[++i];
+      }
+      else if (argv[i][0] != '-')
+      {
+         first_input = i;
+         break;
+      }
+      else
+      {
+         first_input = 0;
+         break;
+      }
+   }
+
+   if (!first_input)
+   {
+      fprintf(stderr, "Usage: %s [-v] [--junit] [-o <output>] <stream>...\n", argv[0]);
+      return 1;
+   }
+
+   FILE *out = output_file ? fopen(output_file, "w") : stdout;
+   if (!out)
+   {
+      perror("Error opening output file");
+      return 1;
+   }
+   if (junit)
+   {
+      fprintf(out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+      fprintf(out, "<testsuites>\n");
+   }
+
+   Suite suite = {0};
+   int ret = 0;
+   for (int i = first_input; i < argc && ret == 0; i++)
+   {
+      ret = convert(out, argv[i], &suite);
+   }
+
+   if (junit)
+   {
+      fprintf(out, "</testsuites>\n");
+   }
+   if (out != stdout)
+   {
+      fclose(out);
+   }
+   free(suite.cases.data);
+   return ret;
+}